@@ -0,0 +1,168 @@
+#include "ScalingHarness.h"
+#include "core/BombeAttack.h"
+#include "core/EnigmaMachine.h"
+#include "core/ResultSink.h"
+#include "core/RotorConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+const std::vector<std::string> ALL_ROTORS = {"I", "II", "III", "IV", "V", "VI", "VII", "VIII"};
+
+// Words typical of Wehrmacht weather and situation reports
+const std::vector<std::string> VOCABULARY = {
+    "WETTER", "VORHERSAGE", "BISKAYA", "NORDWEST", "WIND", "STAERKE", "SICHT", "SEEMEILEN",
+    "BEDECKT", "REGEN", "KEINE", "BESONDEREN", "EREIGNISSE", "OBERKOMMANDO", "DER",
+    "WEHRMACHT", "FLOTTE", "GELEITZUG", "QUADRAT", "MELDUNG", "UHR", "EINS", "ZWO", "DREI",
+    "VIER", "FUNF", "NULL", "X", "HEIL", "HITLER", "ENDE", "ANGRIFF", "FEIND", "SICHTUNG"};
+
+using Clock = std::chrono::steady_clock;
+
+// Watches the raw candidate stream for the true key
+class KeyWatchSink : public ResultSink {
+public:
+    KeyWatchSink(const ScalingKey& key, Clock::time_point start) : key_(key), start_(start) {}
+
+    void write(const CandidateResult& result) override {
+        count_++;
+        if (!firstCorrect_.load() && result.rotorOrder == key_.rotorOrder && result.positions == key_.positions) {
+            double seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+            // Keep the earliest time when several threads find it at once
+            double current = firstSeconds_.load();
+            while ((current < 0 || seconds < current) &&
+                   !firstSeconds_.compare_exchange_weak(current, seconds)) {
+            }
+            firstCorrect_.store(true);
+        }
+    }
+
+    bool found() const { return firstCorrect_.load(); }
+    double firstSeconds() const { return firstSeconds_.load(); }
+
+private:
+    ScalingKey key_;
+    Clock::time_point start_;
+    std::atomic<bool> firstCorrect_{false};
+    std::atomic<double> firstSeconds_{-1.0};
+};
+
+} // namespace
+
+uint64_t WorkloadGenerator::next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int WorkloadGenerator::below(int bound) {
+    return static_cast<int>(next() % static_cast<uint64_t>(bound));
+}
+
+ScalingWorkload WorkloadGenerator::generate(int cribLength, int cipherLength, int rotorSetSize, int plugPairs) {
+    if (rotorSetSize < 3 || rotorSetSize > static_cast<int>(ALL_ROTORS.size())) {
+        throw std::invalid_argument("Rotor set size must be between 3 and 8");
+    }
+    if (cribLength < 1 || cribLength > cipherLength) {
+        throw std::invalid_argument("Crib length must be between 1 and the ciphertext length");
+    }
+    if (plugPairs < 0 || plugPairs > 13) {
+        throw std::invalid_argument("Plugboard pairs must be between 0 and 13");
+    }
+
+    ScalingWorkload workload;
+    workload.cribLength = cribLength;
+    workload.cipherLength = cipherLength;
+    workload.rotorSetSize = rotorSetSize;
+    workload.rotorSet.assign(ALL_ROTORS.begin(), ALL_ROTORS.begin() + rotorSetSize);
+
+    // Key: three distinct rotors from the set, random start positions, random plugs
+    std::vector<std::string> pool = workload.rotorSet;
+    for (int i = 0; i < 3; i++) {
+        int pick = below(static_cast<int>(pool.size()));
+        workload.key.rotorOrder.push_back(pool[pick]);
+        pool.erase(pool.begin() + pick);
+        workload.key.positions.push_back(below(26));
+    }
+    std::string letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (int i = 0; i < plugPairs; i++) {
+        int a = below(static_cast<int>(letters.size()));
+        char first = letters[a];
+        letters.erase(a, 1);
+        int b = below(static_cast<int>(letters.size()));
+        char second = letters[b];
+        letters.erase(b, 1);
+        workload.key.plugboard.push_back(std::string{first, second});
+    }
+
+    while (static_cast<int>(workload.plaintext.size()) < cipherLength) {
+        workload.plaintext += VOCABULARY[below(static_cast<int>(VOCABULARY.size()))];
+    }
+    workload.plaintext.resize(cipherLength);
+    workload.cribOffset = below(cipherLength - cribLength + 1);
+    workload.crib = workload.plaintext.substr(workload.cribOffset, cribLength);
+
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : workload.key.rotorOrder) {
+        const auto& definition = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(definition.wiring, definition.getFirstNotch()));
+    }
+    EnigmaMachine machine(std::move(rotors),
+                          std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at("B").wiring),
+                          std::make_unique<Plugboard>(workload.key.plugboard));
+    machine.setRotorPositions(workload.key.positions);
+    workload.ciphertext = machine.encrypt(workload.plaintext);
+    return workload;
+}
+
+ScalingPoint ScalingHarness::run(const ScalingWorkload& workload, int threads, int sample) {
+    ScalingPoint point;
+    point.cribLength = workload.cribLength;
+    point.cipherLength = workload.cipherLength;
+    point.rotorSetSize = workload.rotorSetSize;
+    point.sample = sample;
+    point.threads = threads;
+
+    BombeAttack attack(workload.crib, workload.ciphertext, workload.rotorSet, "B", true, false);
+    attack.setMaxThreads(threads);
+    attack.setResultLimit(1);
+
+    auto start = Clock::now();
+    auto sink = std::make_shared<KeyWatchSink>(workload.key, start);
+    attack.setResultSink(sink, true);
+    attack.attack(std::vector<CribEntry>{CribEntry{workload.crib, -1}});
+    point.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    point.found = sink->found();
+    point.firstCorrectSeconds = sink->firstSeconds();
+    point.rawCandidates = sink->count();
+    point.candidates = attack.getPackedResults().size();
+    return point;
+}
+
+std::vector<ScalingPoint> ScalingHarness::runMatrix(const Matrix& matrix,
+                                                    std::function<void(const ScalingPoint&)> onPoint) {
+    WorkloadGenerator generator(matrix.seed);
+    std::vector<ScalingPoint> points;
+    for (int rotorSetSize : matrix.rotorSetSizes) {
+        for (int cipherLength : matrix.cipherLengths) {
+            for (int cribLength : matrix.cribLengths) {
+                for (int sample = 0; sample < matrix.samples; sample++) {
+                    ScalingWorkload workload =
+                        generator.generate(cribLength, cipherLength, rotorSetSize, matrix.plugPairs);
+                    for (int threads : matrix.threads) {
+                        points.push_back(run(workload, threads, sample));
+                        if (onPoint) {
+                            onPoint(points.back());
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
@@ -0,0 +1,80 @@
+#ifndef SCALING_HARNESS_H
+#define SCALING_HARNESS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// The key a synthetic message was enciphered with (rings are left at A,
+// because the Bombe search does not cover ring settings)
+struct ScalingKey {
+    std::vector<std::string> rotorOrder;
+    std::vector<int> positions;
+    std::vector<std::string> plugboard;
+};
+
+// A known-answer workload: ciphertext plus a crib taken from its plaintext
+struct ScalingWorkload {
+    int cribLength = 0;
+    int cipherLength = 0;
+    int rotorSetSize = 0;
+    std::vector<std::string> rotorSet;   // rotors the attack may choose from (all orders are tested)
+    ScalingKey key;
+    std::string plaintext;
+    std::string ciphertext;
+    std::string crib;
+    int cribOffset = 0;                  // true offset; the attack is not told
+};
+
+// Reproducible traffic from a seed. Uses its own PRNG (splitmix64) instead of
+// <random> distributions so every platform generates the same workloads.
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(uint64_t seed) : state_(seed) {}
+
+    ScalingWorkload generate(int cribLength, int cipherLength, int rotorSetSize, int plugPairs);
+
+private:
+    uint64_t state_;
+
+    uint64_t next();
+    int below(int bound);
+};
+
+// One attack of one workload at one thread count
+struct ScalingPoint {
+    int cribLength = 0;
+    int cipherLength = 0;
+    int rotorSetSize = 0;
+    int sample = 0;
+    int threads = 0;
+    double totalSeconds = 0.0;
+    double firstCorrectSeconds = -1.0;   // -1 if the true key never appeared
+    bool found = false;
+    uint64_t rawCandidates = 0;
+    size_t candidates = 0;               // after merging
+};
+
+class ScalingHarness {
+public:
+    struct Matrix {
+        std::vector<int> cribLengths = {16};
+        std::vector<int> cipherLengths = {60};
+        std::vector<int> rotorSetSizes = {3};
+        std::vector<int> threads = {1};
+        int samples = 1;
+        int plugPairs = 0;
+        uint64_t seed = 1;
+    };
+
+    // Runs BombeAttack::attack on the workload and times the first candidate
+    // that matches the true key (rotor order and start positions)
+    static ScalingPoint run(const ScalingWorkload& workload, int threads, int sample);
+
+    // Every workload is generated once and attacked at each thread count
+    static std::vector<ScalingPoint> runMatrix(const Matrix& matrix,
+                                               std::function<void(const ScalingPoint&)> onPoint = nullptr);
+};
+
+#endif // SCALING_HARNESS_H
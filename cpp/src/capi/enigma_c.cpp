@@ -0,0 +1,361 @@
+#include "enigma_c.h"
+#include "core/BombeAttack.h"
+#include "core/EnigmaMachine.h"
+#include "core/RotorConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct enigma_machine {
+    std::unique_ptr<EnigmaMachine> machine;
+};
+
+struct enigma_attack {
+    std::unique_ptr<BombeAttack> attack;
+    std::vector<CribEntry> cribs;
+    size_t resultLimit = 0;
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> running{false};
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+enigma_status fail(enigma_status status, const std::string& message) {
+    lastError = message;
+    return status;
+}
+
+// Maps exceptions thrown by the engine onto status codes
+template <typename Body>
+enigma_status guarded(Body body) {
+    try {
+        lastError.clear();
+        return body();
+    } catch (const std::invalid_argument& e) {
+        return fail(ENIGMA_INVALID_ARGUMENT, e.what());
+    } catch (const std::bad_alloc&) {
+        return fail(ENIGMA_INTERNAL_ERROR, "Out of memory");
+    } catch (const std::exception& e) {
+        return fail(ENIGMA_INTERNAL_ERROR, e.what());
+    } catch (...) {
+        return fail(ENIGMA_INTERNAL_ERROR, "Unknown error");
+    }
+}
+
+std::vector<std::string> split(const char* text, char separator) {
+    std::vector<std::string> items;
+    std::string item;
+    std::istringstream stream(text ? text : "");
+    while (std::getline(stream, item, separator)) {
+        item.erase(0, item.find_first_not_of(' '));
+        item.erase(item.find_last_not_of(' ') + 1);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Three letters (case-insensitive) to rotor indexes; NULL means "AAA"
+std::vector<int> parseLetters(const char* text, const char* what) {
+    std::vector<int> values(3, 0);
+    if (!text) {
+        return values;
+    }
+    if (std::strlen(text) != 3) {
+        throw std::invalid_argument(std::string(what) + " must be three letters");
+    }
+    for (int i = 0; i < 3; i++) {
+        char c = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+        if (c < 'A' || c > 'Z') {
+            throw std::invalid_argument(std::string(what) + " must be three letters");
+        }
+        values[i] = c - 'A';
+    }
+    return values;
+}
+
+void copyString(char* output, size_t capacity, const std::string& value) {
+    size_t length = (std::min)(value.size(), capacity - 1);
+    std::memcpy(output, value.data(), length);
+    output[length] = '\0';
+}
+
+} // namespace
+
+extern "C" {
+
+int enigma_api_version(void) {
+    return ENIGMA_C_API_VERSION;
+}
+
+const char* enigma_last_error(void) {
+    return lastError.c_str();
+}
+
+enigma_status enigma_machine_create(const char* rotors,
+                                    const char* reflector,
+                                    const char* positions,
+                                    const char* rings,
+                                    const char* plugboard,
+                                    enigma_machine** out) {
+    if (!out || !rotors || !reflector) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "rotors, reflector and out are required");
+    }
+    *out = nullptr;
+    return guarded([&] {
+        std::vector<std::string> rotorTypes = split(rotors, ',');
+        if (rotorTypes.size() != 3) {
+            return fail(ENIGMA_INVALID_ARGUMENT, "Exactly three rotors are required");
+        }
+        std::vector<int> startPositions = parseLetters(positions, "positions");
+        std::vector<int> ringSettings = parseLetters(rings, "rings");
+
+        std::vector<std::unique_ptr<Rotor>> machineRotors;
+        for (size_t i = 0; i < rotorTypes.size(); i++) {
+            auto definition = enigma::ROTOR_DEFINITIONS.find(rotorTypes[i]);
+            if (definition == enigma::ROTOR_DEFINITIONS.end()) {
+                return fail(ENIGMA_INVALID_ARGUMENT, "Unknown rotor: " + rotorTypes[i]);
+            }
+            machineRotors.push_back(std::make_unique<Rotor>(
+                definition->second.wiring, definition->second.getFirstNotch(), ringSettings[i]));
+        }
+
+        auto reflectorDefinition = enigma::REFLECTOR_DEFINITIONS.find(reflector);
+        if (reflectorDefinition == enigma::REFLECTOR_DEFINITIONS.end()) {
+            return fail(ENIGMA_INVALID_ARGUMENT, std::string("Unknown reflector: ") + reflector);
+        }
+
+        std::vector<std::string> pairs = split(plugboard, ' ');
+        for (auto& pair : pairs) {
+            std::transform(pair.begin(), pair.end(), pair.begin(), ::toupper);
+            if (pair.size() != 2 || pair[0] < 'A' || pair[0] > 'Z' || pair[1] < 'A' || pair[1] > 'Z') {
+                return fail(ENIGMA_INVALID_ARGUMENT, "Invalid plugboard pair: " + pair);
+            }
+        }
+
+        auto handle = std::make_unique<enigma_machine>();
+        handle->machine = std::make_unique<EnigmaMachine>(
+            std::move(machineRotors),
+            std::make_unique<Reflector>(reflectorDefinition->second.wiring),
+            std::make_unique<Plugboard>(pairs));
+        handle->machine->setRotorPositions(startPositions);
+        *out = handle.release();
+        return ENIGMA_OK;
+    });
+}
+
+void enigma_machine_destroy(enigma_machine* machine) {
+    delete machine;
+}
+
+enigma_status enigma_machine_encrypt(enigma_machine* machine,
+                                     const char* input,
+                                     size_t length,
+                                     char* output,
+                                     size_t capacity,
+                                     size_t* written) {
+    if (!machine || (!input && length > 0) || !written) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "machine, input and written are required");
+    }
+    size_t letters = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (std::isalpha(static_cast<unsigned char>(input[i]))) {
+            letters++;
+        }
+    }
+    *written = letters;
+    if (letters > capacity || (letters > 0 && !output)) {
+        return fail(ENIGMA_BUFFER_TOO_SMALL, "Output buffer needs " + std::to_string(letters) + " bytes");
+    }
+
+    char* cursor = output;
+    for (size_t i = 0; i < length; i++) {
+        char c = input[i];
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if (c >= 'A' && c <= 'Z') {
+            *cursor++ = machine->machine->encryptChar(c);
+        }
+    }
+    lastError.clear();
+    return ENIGMA_OK;
+}
+
+enigma_status enigma_machine_seek(enigma_machine* machine, const char* positions) {
+    if (!machine || !positions) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "machine and positions are required");
+    }
+    return guarded([&] {
+        machine->machine->setRotorPositions(parseLetters(positions, "positions"));
+        return ENIGMA_OK;
+    });
+}
+
+enigma_status enigma_machine_get_positions(const enigma_machine* machine, char* output, size_t capacity) {
+    if (!machine || !output) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "machine and output are required");
+    }
+    std::string text;
+    for (int position : machine->machine->getRotorPositions()) {
+        text += static_cast<char>('A' + position);
+    }
+    if (capacity < text.size() + 1) {
+        return fail(ENIGMA_BUFFER_TOO_SMALL, "Output buffer needs " + std::to_string(text.size() + 1) + " bytes");
+    }
+    copyString(output, capacity, text);
+    lastError.clear();
+    return ENIGMA_OK;
+}
+
+void enigma_attack_options_init(enigma_attack_options* options) {
+    if (!options) {
+        return;
+    }
+    std::memset(options, 0, sizeof(*options));
+    options->struct_size = sizeof(*options);
+    options->crib_position = -1;
+    options->rotors = "I,II,III";
+    options->reflector = "B";
+    options->merge_equivalent = 1;
+}
+
+enigma_status enigma_attack_create(const enigma_attack_options* options, enigma_attack** out) {
+    if (!out || !options || options->struct_size < sizeof(enigma_attack_options)) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "Options must be initialised with enigma_attack_options_init");
+    }
+    *out = nullptr;
+    if (!options->cribs || !options->cipher) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "cribs and cipher are required");
+    }
+    return guarded([&] {
+        std::vector<std::string> rotorTypes = split(options->rotors ? options->rotors : "I,II,III", ',');
+        std::string reflector = options->reflector ? options->reflector : "B";
+        if (rotorTypes.size() < 3) {
+            return fail(ENIGMA_INVALID_ARGUMENT, "At least three rotors are required");
+        }
+        for (const auto& type : rotorTypes) {
+            if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
+                return fail(ENIGMA_INVALID_ARGUMENT, "Unknown rotor: " + type);
+            }
+        }
+        if (enigma::REFLECTOR_DEFINITIONS.find(reflector) == enigma::REFLECTOR_DEFINITIONS.end()) {
+            return fail(ENIGMA_INVALID_ARGUMENT, "Unknown reflector: " + reflector);
+        }
+
+        auto handle = std::make_unique<enigma_attack>();
+        for (const auto& crib : split(options->cribs, ',')) {
+            handle->cribs.push_back(CribEntry{crib, options->crib_position});
+        }
+        if (handle->cribs.empty()) {
+            return fail(ENIGMA_INVALID_ARGUMENT, "At least one crib is required");
+        }
+        handle->attack = std::make_unique<BombeAttack>(handle->cribs.front().text, options->cipher,
+                                                       rotorTypes, reflector,
+                                                       options->all_orders != 0, options->no_plugboard != 0);
+        handle->attack->setMergeEquivalent(options->merge_equivalent != 0);
+        // Candidates stay packed and are unpacked one at a time by enigma_attack_get_result
+        handle->attack->setResultLimit(1);
+        if (options->threads > 0) {
+            handle->attack->setMaxThreads(options->threads);
+        }
+        handle->resultLimit = options->result_limit;
+        *out = handle.release();
+        return ENIGMA_OK;
+    });
+}
+
+void enigma_attack_destroy(enigma_attack* attack) {
+    delete attack;
+}
+
+enigma_status enigma_attack_run(enigma_attack* attack,
+                                enigma_progress_fn progress,
+                                enigma_log_fn log,
+                                void* user_data) {
+    if (!attack) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "attack is required");
+    }
+    if (attack->running.exchange(true)) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "The attack is already running");
+    }
+    enigma_status status = guarded([&] {
+        if (progress) {
+            attack->attack->setProgressHandler([progress, user_data](long long done, long long total) {
+                progress(user_data, done, total);
+            });
+        }
+        std::function<void(const std::string&)> logCallback;
+        if (log) {
+            logCallback = [log, user_data](const std::string& message) {
+                log(user_data, message.c_str());
+            };
+        }
+        attack->attack->attack(attack->cribs, logCallback);
+        return attack->cancelled ? fail(ENIGMA_CANCELLED, "The attack was cancelled") : ENIGMA_OK;
+    });
+    attack->running = false;
+    return status;
+}
+
+void enigma_attack_cancel(enigma_attack* attack) {
+    if (attack) {
+        attack->cancelled = true;
+        attack->attack->stop();
+    }
+}
+
+size_t enigma_attack_result_count(const enigma_attack* attack) {
+    if (!attack || attack->running) {
+        return 0;
+    }
+    size_t count = attack->attack->getPackedResults().size();
+    return attack->resultLimit > 0 ? (std::min)(count, attack->resultLimit) : count;
+}
+
+enigma_status enigma_attack_get_result(const enigma_attack* attack, size_t index, enigma_result* result) {
+    if (!attack || !result) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "attack and result are required");
+    }
+    if (attack->running) {
+        return fail(ENIGMA_INVALID_ARGUMENT, "Results are not available while the attack is running");
+    }
+    if (index >= enigma_attack_result_count(attack)) {
+        return fail(ENIGMA_OUT_OF_RANGE, "Result index out of range");
+    }
+    return guarded([&] {
+        CandidateResult candidate = attack->attack->getPackedResults().unpack(index);
+
+        std::string plugboard;
+        for (const auto& pair : candidate.plugboard) {
+            if (!plugboard.empty()) plugboard += ' ';
+            plugboard += pair.first;
+            plugboard += pair.second;
+        }
+
+        std::memset(result, 0, sizeof(*result));
+        result->score = candidate.score;
+        result->match_rate = candidate.matchRate;
+        result->offset = candidate.offset;
+        result->plugboard_pairs = candidate.plugboardPairs;
+        result->equivalents = candidate.equivalentCount;
+        copyString(result->rotors, sizeof(result->rotors), candidate.getRotorString());
+        copyString(result->positions, sizeof(result->positions), candidate.getPositionString());
+        copyString(result->plugboard, sizeof(result->plugboard), plugboard);
+        copyString(result->crib, sizeof(result->crib), candidate.crib);
+        return ENIGMA_OK;
+    });
+}
+
+} // extern "C"
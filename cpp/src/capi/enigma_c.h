@@ -0,0 +1,161 @@
+#ifndef ENIGMA_C_H
+#define ENIGMA_C_H
+
+/*
+ * Plain C interface to the Enigma engine (libenigma_core).
+ *
+ * - All objects are opaque handles created and destroyed by the library.
+ * - Functions return enigma_status; on failure enigma_last_error() returns a
+ *   message for the calling thread (valid until the next call on that thread).
+ * - Strings are NUL-terminated ASCII. Output is written to caller-provided
+ *   buffers; nothing allocated by the library has to be freed by the caller
+ *   except through the matching *_destroy function.
+ * - Structs that may grow carry a struct_size field set by the *_init function.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && !defined(ENIGMA_C_STATIC)
+#  ifdef ENIGMA_C_BUILDING
+#    define ENIGMA_C_API __declspec(dllexport)
+#  else
+#    define ENIGMA_C_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define ENIGMA_C_API __attribute__((visibility("default")))
+#else
+#  define ENIGMA_C_API
+#endif
+
+#define ENIGMA_C_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum enigma_status {
+    ENIGMA_OK = 0,
+    ENIGMA_INVALID_ARGUMENT = 1,
+    ENIGMA_BUFFER_TOO_SMALL = 2,
+    ENIGMA_CANCELLED = 3,
+    ENIGMA_OUT_OF_RANGE = 4,
+    ENIGMA_INTERNAL_ERROR = 5
+} enigma_status;
+
+/* Version of this header the library was built from (ENIGMA_C_API_VERSION). */
+ENIGMA_C_API int enigma_api_version(void);
+
+/* Message describing the last failed call on this thread ("" if none). */
+ENIGMA_C_API const char* enigma_last_error(void);
+
+/* ---------------------------------------------------------------- machine */
+
+typedef struct enigma_machine enigma_machine;
+
+/*
+ * rotors:    three rotor names, comma separated ("I,II,III"), in the engine's
+ *            order: the first one is the fast rotor the signal enters first
+ * reflector: "B" or "C"
+ * positions: three letters in the same order as rotors; NULL means "AAA"
+ * rings:     three letters in the same order as rotors; NULL means "AAA"
+ * plugboard: space separated pairs ("AB CD"); NULL or "" for none
+ */
+ENIGMA_C_API enigma_status enigma_machine_create(const char* rotors,
+                                                 const char* reflector,
+                                                 const char* positions,
+                                                 const char* rings,
+                                                 const char* plugboard,
+                                                 enigma_machine** out);
+
+ENIGMA_C_API void enigma_machine_destroy(enigma_machine* machine);
+
+/*
+ * Encrypts length bytes of input. Letters are upper-cased, everything else is
+ * skipped, so at most length bytes are written (no terminator). *written is
+ * set to the number of letters. If capacity is too small nothing is encrypted,
+ * the rotors do not move and *written holds the required size.
+ */
+ENIGMA_C_API enigma_status enigma_machine_encrypt(enigma_machine* machine,
+                                                  const char* input,
+                                                  size_t length,
+                                                  char* output,
+                                                  size_t capacity,
+                                                  size_t* written);
+
+/* Moves the rotors to positions ("QEV"). */
+ENIGMA_C_API enigma_status enigma_machine_seek(enigma_machine* machine, const char* positions);
+
+/* Writes the current rotor positions as a NUL-terminated string (capacity >= 4). */
+ENIGMA_C_API enigma_status enigma_machine_get_positions(const enigma_machine* machine,
+                                                        char* output,
+                                                        size_t capacity);
+
+/* ----------------------------------------------------------------- attack */
+
+typedef struct enigma_attack enigma_attack;
+
+typedef struct enigma_attack_options {
+    size_t struct_size;          /* set by enigma_attack_options_init */
+    const char* cribs;           /* one or more cribs, comma separated */
+    int crib_position;           /* -1: try every offset */
+    const char* cipher;
+    const char* rotors;          /* comma separated; default "I,II,III" */
+    const char* reflector;       /* default "B" */
+    int all_orders;              /* test every ordering of rotors */
+    int no_plugboard;            /* search without plugboard deduction */
+    int merge_equivalent;        /* merge candidates with identical scrambler windows (default 1) */
+    int threads;                 /* 0: library default */
+    size_t result_limit;         /* results exposed after the run, 0 = all */
+} enigma_attack_options;
+
+ENIGMA_C_API void enigma_attack_options_init(enigma_attack_options* options);
+
+typedef void (*enigma_progress_fn)(void* user_data, long long done, long long total);
+typedef void (*enigma_log_fn)(void* user_data, const char* message);
+
+/* Validates the options and copies every string; options may be freed afterwards. */
+ENIGMA_C_API enigma_status enigma_attack_create(const enigma_attack_options* options,
+                                                enigma_attack** out);
+
+ENIGMA_C_API void enigma_attack_destroy(enigma_attack* attack);
+
+/*
+ * Runs the search on the calling thread and blocks until it finishes.
+ * Callbacks may be NULL and are invoked from search threads. Returns
+ * ENIGMA_CANCELLED if enigma_attack_cancel stopped it; the candidates found
+ * until then remain available.
+ */
+ENIGMA_C_API enigma_status enigma_attack_run(enigma_attack* attack,
+                                             enigma_progress_fn progress,
+                                             enigma_log_fn log,
+                                             void* user_data);
+
+/* Requests a running (or not yet started) search to stop. Safe from any thread. */
+ENIGMA_C_API void enigma_attack_cancel(enigma_attack* attack);
+
+typedef struct enigma_result {
+    double score;
+    double match_rate;
+    int offset;                  /* crib offset in the ciphertext */
+    int plugboard_pairs;
+    int equivalents;             /* merged candidates, including this one */
+    char rotors[32];             /* "I-II-III" */
+    char positions[8];           /* "DEF" */
+    char plugboard[40];          /* "AB CD EF" */
+    char crib[128];
+} enigma_result;
+
+/* Number of results available after enigma_attack_run (best first). */
+ENIGMA_C_API size_t enigma_attack_result_count(const enigma_attack* attack);
+
+/* Copies result index (0 = best) into *result. */
+ENIGMA_C_API enigma_status enigma_attack_get_result(const enigma_attack* attack,
+                                                    size_t index,
+                                                    enigma_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENIGMA_C_H */
@@ -0,0 +1,108 @@
+#include "BanburismusCommand.h"
+#include "CommandArgs.h"
+#include "core/Banburismus.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+void printBanburismusUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp banburismus <traffic.txt> [--rotors I,II,III,IV,V]\n";
+    std::cout << "                     [--max-offset 25] [--threshold 20] [--limit N]\n\n";
+    std::cout << "The traffic file holds one message per line: the enciphered message key\n";
+    std::cout << "indicator (3 letters) followed by the ciphertext.\n";
+}
+
+} // namespace
+
+std::vector<BanburismusMessage> readBanburismusTraffic(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    std::vector<BanburismusMessage> messages;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        BanburismusMessage message;
+        if (!(iss >> message.indicator)) continue;
+        std::getline(iss, message.cipherText);
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+int runBanburismusCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printBanburismusUsage();
+        return 2;
+    }
+    int maxOffset = args.getInt("max-offset", 25);
+    size_t limit = static_cast<size_t>(args.getInt("limit", 20));
+
+    std::vector<BanburismusMessage> messages;
+    try {
+        messages = readBanburismusTraffic(args.positional()[0]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        Banburismus banburismus(messages, args.getList("rotors", {"I", "II", "III", "IV", "V"}));
+        banburismus.setMaxOffset(maxOffset);
+        if (args.has("threshold")) {
+            banburismus.setThreshold(std::stod(args.get("threshold")));
+        }
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        BanburismusResult result = banburismus.analyze(
+            [](const std::string& message) { std::cout << message << "\n"; });
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - startTime);
+
+        std::cout << "Messages: " << messages.size() << ", pairs: " << result.pairsCompared
+                  << ", offsets: " << result.offsetsCompared << " (" << elapsed.count() << " ms)\n";
+
+        std::cout << "\nBest alignments:\n";
+        for (size_t i = 0; i < result.alignments.size() && i < limit; i++) {
+            const auto& a = result.alignments[i];
+            std::cout << "  " << a.first + 1 << " / " << a.second + 1
+                      << "  offset " << std::setw(3) << a.offset
+                      << "  " << a.repeats << "/" << a.overlap << " repeats  "
+                      << std::fixed << std::setprecision(1) << a.decibans << " db"
+                      << (a.sameWheels ? "" : "  (different wheels)") << "\n";
+        }
+
+        std::cout << "\nIndicator chains (right-hand letter, spaced by key offset):\n";
+        for (const auto& chain : result.chains) {
+            std::cout << "  " << chain.toString() << "\n";
+        }
+        std::cout << "Conflicting alignments: " << result.conflicts << "\n";
+
+        // For each rotor, how far the turnover constraints narrow the right-hand key
+        std::cout << "\nRight-hand rotor candidates (possible keys per indicator letter):\n";
+        for (const auto& rotor : result.rightRotorCandidates) {
+            std::cout << "  " << std::setw(4) << std::left << rotor << std::right;
+            for (char c = 'A'; c <= 'Z'; c++) {
+                std::cout << " " << c << ":" << result.countAllowedKeys(rotor, c);
+            }
+            std::cout << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef BANBURISMUS_COMMAND_H
+#define BANBURISMUS_COMMAND_H
+
+#include <string>
+#include <vector>
+#include "core/Banburismus.h"
+
+// EnigmaSimulatorCpp banburismus <traffic> ...
+int runBanburismusCommand(const std::vector<std::string>& args);
+
+// One message per line: the enciphered indicator (3 letters), then the ciphertext.
+// Throws std::runtime_error when the file cannot be opened.
+std::vector<BanburismusMessage> readBanburismusTraffic(const std::string& path);
+
+#endif // BANBURISMUS_COMMAND_H
@@ -0,0 +1,377 @@
+#include "BombeCommand.h"
+#include "BanburismusCommand.h"
+#include "CommandArgs.h"
+#include "core/BombeAttack.h"
+#include "core/ResultSink.h"
+#include "core/RotorConfig.h"
+#include "core/ScramblerTableStore.h"
+#include "core/TuningConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Exit codes (also listed in the usage text)
+constexpr int EXIT_FOUND = 0;
+constexpr int EXIT_ERROR = 1;
+constexpr int EXIT_USAGE = 2;
+constexpr int EXIT_NO_CANDIDATES = 3;
+constexpr int EXIT_INTERRUPTED = 130;
+
+std::atomic<BombeAttack*> activeAttack{nullptr};
+std::atomic<bool> interrupted{false};
+
+extern "C" void handleStopSignal(int) {
+    interrupted = true;
+    if (BombeAttack* attack = activeAttack.load()) {
+        attack->stop();
+    }
+}
+
+void printBombeUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp bombe --crib WETTER[,CRIB2...] (--cipher TEXT | --cipher-file PATH)\n";
+    std::cout << "                     [--crib-position N] [--rotors I,II,III] [--reflector B] [--all-orders]\n";
+    std::cout << "                     [--no-plugboard] [--no-merge] [--threads N] [--table-store PATH]\n";
+    std::cout << "                     [--out results.ndjson|results.bin] [--top K] [--trace trace.json]\n";
+    std::cout << "                     [--perf] [--log-file PATH|-] [--log-level info] [--dry-run]\n";
+    std::cout << "                     [--tuning PATH] [--shadow RATE]\n";
+    std::cout << "                     [--banburismus TRAFFIC --indicator XYZ [--depth-threshold DB]\n";
+    std::cout << "                      [--depth-max-offset N]]\n\n";
+    std::cout << "Runs the Bombe attack without the GUI. Progress and log lines are written to\n";
+    std::cout << "stderr as JSON objects with an \"event\" field (log, progress, done, error).\n";
+    std::cout << "With --out every candidate is streamed to the file as it is found; the ranked,\n";
+    std::cout << "merged top K (--top, default 10 without --out) is printed to stdout as NDJSON.\n";
+    std::cout << "--trace writes a Chrome trace-event timeline of the attack phases per thread\n";
+    std::cout << "(open it in chrome://tracing or ui.perfetto.dev).\n";
+    std::cout << "--perf adds hardware counters (cycles, instructions, L1D/LLC misses, branch\n";
+    std::cout << "misses) per stage and per position tested to the done event (Linux perf_event_open;\n";
+    std::cout << "reported as unavailable when the kernel or container does not allow it).\n";
+    std::cout << "--log-file appends structured JSON log records (levels trace, debug, info, warn,\n";
+    std::cout << "error); they are written by a background thread and never block the search.\n";
+    std::cout << "--dry-run prints an estimate instead of attacking: positions to test, menu closures\n";
+    std::cout << "and expected stops, runtime predicted from a short sample run on this host, expected\n";
+    std::cout << "candidates and result size, and warnings about the cribs.\n";
+    std::cout << "Thread count and chunk size default to the tuning file written by \"tune\"\n";
+    std::cout << "(--tuning overrides its path); --threads still takes precedence.\n";
+    std::cout << "--shadow RATE re-checks that fraction (e.g. 0.001) of the table-driven encryptions\n";
+    std::cout << "against the reference machine on a background thread. Mismatches are reported as\n";
+    std::cout << "shadow_mismatch events with the full key; the counts are added to the done event.\n";
+    std::cout << "--banburismus runs the depth analysis over the day's traffic (same format as the\n";
+    std::cout << "banburismus command) and only tries the right-hand rotors and right-hand keys it\n";
+    std::cout << "allows for this message, whose enciphered indicator is given by --indicator.\n\n";
+    std::cout << "Exit status: 0 candidates found, 1 error, 2 usage error, 3 no candidates,\n";
+    std::cout << "130 interrupted (partial results are still written).\n";
+}
+
+// Event lines also come from worker threads, so each line is written under a lock
+class EventWriter {
+public:
+    void write(const json& event) {
+        std::string line = event.dump();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::cerr << line << "\n";
+        std::cerr.flush();
+    }
+
+private:
+    std::mutex mutex_;
+};
+
+json perfToJson(const AttackHardwareCounters& counters) {
+    json out = {{"available", counters.available}};
+    if (!counters.reason.empty()) {
+        out["reason"] = counters.reason;
+    }
+    if (!counters.available) {
+        return out;
+    }
+    auto readingToJson = [](const PerfReading& reading, double divisor) {
+        json values = json::object();
+        for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+            if (reading.has(event)) {
+                values[PerfCounters::eventName(event)] = reading.values[event] / divisor;
+            }
+        }
+        if (reading.ipc() > 0) {
+            values["ipc"] = reading.ipc();
+        }
+        return values;
+    };
+    json stages = json::object();
+    for (int stage = 0; stage < AttackHardwareCounters::STAGE_COUNT; stage++) {
+        stages[AttackHardwareCounters::stageName(stage)] = readingToJson(counters.stages[stage], 1.0);
+    }
+    out["stages"] = stages;
+    out["positions"] = counters.positionsTested;
+    if (counters.positionsTested > 0) {
+        out["perPosition"] = readingToJson(counters.stages[AttackHardwareCounters::Search],
+                                           static_cast<double>(counters.positionsTested));
+    }
+    return out;
+}
+
+json estimateToJson(const AttackEstimate& estimate) {
+    return {{"event", "estimate"},
+            {"rotorOrders", estimate.rotorOrders},
+            {"offsetsPerPosition", estimate.offsetsPerPosition},
+            {"positions", estimate.totalPositions},
+            {"menuClosures", {{"min", estimate.minClosures}, {"max", estimate.maxClosures}}},
+            {"menuStops", estimate.menuStops},
+            {"samplePositions", estimate.samplePositions},
+            {"sampleCandidates", estimate.sampleCandidates},
+            {"nsPerPosition", estimate.nsPerPosition},
+            {"tableSeconds", estimate.tableSeconds},
+            {"threads", estimate.threads},
+            {"predictedSeconds", estimate.predictedSeconds},
+            {"expectedCandidates", estimate.expectedCandidates},
+            {"expectedResultBytes", estimate.expectedResultBytes},
+            {"warnings", estimate.warnings}};
+}
+
+} // namespace
+
+int runBombeCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs, {"all-orders", "no-plugboard", "no-merge", "perf", "dry-run"});
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return EXIT_USAGE;
+    }
+
+    std::vector<std::string> cribs = args.getList("crib", {});
+    std::string cipher = args.get("cipher");
+    if (args.has("cipher-file")) {
+        std::ifstream file(args.get("cipher-file"));
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open " << args.get("cipher-file") << "\n";
+            return EXIT_ERROR;
+        }
+        cipher.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    if (cribs.empty() || cipher.empty() || !args.positional().empty()) {
+        printBombeUsage();
+        return EXIT_USAGE;
+    }
+
+    int threads = args.getInt("threads", 0);
+    int top = args.getInt("top", args.has("out") ? 0 : 10);
+    int position = args.getInt("crib-position", -1);
+    int depthMaxOffset = args.getInt("depth-max-offset", 25);
+    if (threads < 0 || top < 0) {
+        std::cerr << "Error: --threads and --top must not be negative\n";
+        return EXIT_USAGE;
+    }
+
+    std::vector<std::string> rotors = args.getList("rotors", {"I", "II", "III"});
+    std::string reflector = args.get("reflector", "B");
+    for (const auto& rotor : rotors) {
+        if (enigma::ROTOR_DEFINITIONS.find(rotor) == enigma::ROTOR_DEFINITIONS.end()) {
+            std::cerr << "Error: Unknown rotor " << rotor << "\n";
+            return EXIT_USAGE;
+        }
+    }
+    if (rotors.size() < 3 || (rotors.size() > 3 && !args.has("all-orders"))) {
+        std::cerr << "Error: --rotors needs exactly 3 rotors (or more with --all-orders)\n";
+        return EXIT_USAGE;
+    }
+    if (enigma::REFLECTOR_DEFINITIONS.find(reflector) == enigma::REFLECTOR_DEFINITIONS.end()) {
+        std::cerr << "Error: Unknown reflector " << reflector << "\n";
+        return EXIT_USAGE;
+    }
+    std::string indicator = args.get("indicator");
+    if (args.has("banburismus") != args.has("indicator") ||
+        (args.has("indicator") && (indicator.size() != 3 || !std::all_of(indicator.begin(), indicator.end(),
+                                                                          [](unsigned char c) { return std::isalpha(c); })))) {
+        std::cerr << "Error: --banburismus needs --indicator with the message's 3-letter enciphered indicator\n";
+        return EXIT_USAGE;
+    }
+    double depthThreshold = 0.0;
+    if (args.has("depth-threshold") && !parseNumber(args.get("depth-threshold"), depthThreshold)) {
+        std::cerr << "Error: --depth-threshold must be a number (decibans)\n";
+        return EXIT_USAGE;
+    }
+    double shadowRate = 0.0;
+    if (args.has("shadow") &&
+        (!parseNumber(args.get("shadow"), shadowRate) || shadowRate < 0.0 || shadowRate > 1.0)) {
+        std::cerr << "Error: --shadow must be a rate between 0 and 1\n";
+        return EXIT_USAGE;
+    }
+
+    std::string logError = startLogging(args);
+    if (!logError.empty()) {
+        std::cerr << "Error: " << logError << "\n";
+        return EXIT_USAGE;
+    }
+    LogSession logSession;
+
+    EventWriter events;
+    try {
+        if (args.has("table-store")) {
+            ScramblerTableStore::setDefaultPath(args.get("table-store"));
+        }
+        if (args.has("tuning")) {
+            TuningConfig::setDefaultPath(args.get("tuning"));
+        }
+
+        BombeAttack attack(cribs[0], cipher, rotors, reflector,
+                           args.has("all-orders"),
+                           args.has("no-plugboard"));
+        if (threads > 0) {
+            attack.setMaxThreads(threads);
+        }
+        attack.setMergeEquivalent(!args.has("no-merge"));
+        attack.setResultLimit(static_cast<size_t>(top));
+        attack.setHardwareCounters(args.has("perf"));
+
+        if (args.has("banburismus")) {
+            Banburismus banburismus(readBanburismusTraffic(args.get("banburismus")), rotors);
+            banburismus.setMaxOffset(depthMaxOffset);
+            if (args.has("depth-threshold")) {
+                banburismus.setThreshold(depthThreshold);
+            }
+            BanburismusResult depth = banburismus.analyze();
+
+            // Right-hand keys still possible for this message, per surviving right-hand rotor
+            json allowedKeys = json::object();
+            for (const auto& rotor : depth.rightRotorCandidates) {
+                allowedKeys[rotor] = depth.countAllowedKeys(rotor, indicator[0]);
+            }
+            events.write({{"event", "banburismus"},
+                          {"alignments", depth.alignments.size()},
+                          {"chains", depth.chains.size()},
+                          {"rightRotors", depth.rightRotorCandidates},
+                          {"allowedRightKeys", allowedKeys}});
+            attack.setRotorOrderFilter(depth.rotorOrderFilter());
+            attack.setStartPositionFilter(depth.startPositionFilter(indicator));
+        }
+
+        std::vector<CribEntry> entries;
+        for (const auto& crib : cribs) {
+            entries.push_back(CribEntry{crib, position});
+        }
+
+        if (args.has("dry-run")) {
+            std::cout << estimateToJson(attack.estimate(entries)).dump() << "\n";
+            return EXIT_FOUND;
+        }
+
+        std::shared_ptr<ResultSink> sink;
+        if (args.has("out")) {
+            sink = ResultSink::open(args.get("out"));
+            // Without --top nothing needs to stay in memory
+            attack.setResultSink(sink, top > 0);
+        }
+
+        std::shared_ptr<ShadowValidator> shadow;
+        if (args.has("shadow")) {
+            shadow = std::make_shared<ShadowValidator>(shadowRate);
+            shadow->setMismatchHandler([&events](const ShadowMismatch& mismatch) {
+                events.write({{"event", "shadow_mismatch"},
+                              {"kind", mismatch.sample.kind},
+                              {"key", mismatch.sample.keyString()},
+                              {"input", mismatch.sample.input},
+                              {"fast", mismatch.sample.output},
+                              {"reference", mismatch.expected}});
+            });
+            attack.setShadowValidator(shadow);
+        }
+
+        std::shared_ptr<TraceRecorder> trace;
+        if (args.has("trace")) {
+            trace = std::make_shared<TraceRecorder>();
+            attack.setTraceRecorder(trace);
+        }
+
+        attack.setProgressHandler([&events](long long done, long long total) {
+            events.write({{"event", "progress"},
+                          {"done", done},
+                          {"total", total},
+                          {"percent", total > 0 ? done * 100.0 / total : 100.0}});
+        });
+
+        activeAttack = &attack;
+        auto previousInt = std::signal(SIGINT, handleStopSignal);
+        auto previousTerm = std::signal(SIGTERM, handleStopSignal);
+
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<CandidateResult> results;
+        try {
+            results = attack.attack(entries, [&events](const std::string& message) {
+                // Progress is reported as structured events, skip the text version
+                if (message.compare(0, 9, "Progress:") != 0) {
+                    events.write({{"event", "log"}, {"message", message}});
+                }
+            });
+        } catch (...) {
+            activeAttack = nullptr;
+            std::signal(SIGINT, previousInt);
+            std::signal(SIGTERM, previousTerm);
+            throw;
+        }
+        activeAttack = nullptr;
+        std::signal(SIGINT, previousInt);
+        std::signal(SIGTERM, previousTerm);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        for (const auto& result : results) {
+            std::cout << NdjsonResultSink::toJson(result) << "\n";
+        }
+        std::cout.flush();
+
+        if (trace) {
+            // Written even when interrupted: the partial timeline is still useful
+            trace->writeJson(args.get("trace"));
+        }
+
+        size_t candidates = attack.getPackedResults().size();
+        uint64_t streamed = sink ? sink->count() : 0;
+        json done = {{"event", "done"},
+                     {"status", interrupted ? "interrupted" : "completed"},
+                     {"candidates", candidates},
+                     {"seconds", elapsed.count()}};
+        if (sink) {
+            done["streamed"] = streamed;
+            done["out"] = args.get("out");
+        }
+        if (trace) {
+            done["trace"] = args.get("trace");
+            done["droppedSpans"] = trace->droppedSpans();
+        }
+        if (args.has("perf")) {
+            done["perf"] = perfToJson(attack.getHardwareCounters());
+        }
+        if (shadow) {
+            shadow->flush();
+            done["shadow"] = {{"rate", shadow->getRate()},
+                              {"checked", shadow->checked()},
+                              {"mismatches", shadow->mismatchCount()},
+                              {"dropped", shadow->dropped()}};
+        }
+        if (AttackStats::enabled()) {
+            json stats = json::object();
+            for (const auto& [name, value] : attack.getStats().fields()) {
+                stats[name] = value;
+            }
+            done["stats"] = stats;
+        }
+        events.write(done);
+
+        if (interrupted) {
+            return EXIT_INTERRUPTED;
+        }
+        return (candidates > 0 || streamed > 0) ? EXIT_FOUND : EXIT_NO_CANDIDATES;
+    } catch (const std::exception& e) {
+        events.write({{"event", "error"}, {"message", e.what()}});
+        return EXIT_ERROR;
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef BOMBE_COMMAND_H
+#define BOMBE_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp bombe --crib ... --cipher ... [options]
+int runBombeCommand(const std::vector<std::string>& args);
+
+#endif // BOMBE_COMMAND_H
@@ -0,0 +1,91 @@
+#include "CommandArgs.h"
+#include "core/Logger.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+CommandArgs::CommandArgs(const std::vector<std::string>& args,
+                         const std::vector<std::string>& flagNames) {
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            std::string name = arg.substr(2);
+            if (std::find(flagNames.begin(), flagNames.end(), name) != flagNames.end()) {
+                options_[name] = "1";
+            } else if (i + 1 < args.size()) {
+                options_[name] = args[++i];
+            } else {
+                error_ = "Missing value for --" + name;
+            }
+        } else {
+            positional_.push_back(arg);
+        }
+    }
+}
+
+bool CommandArgs::has(const std::string& name) const {
+    return options_.count(name) > 0;
+}
+
+std::string CommandArgs::get(const std::string& name, const std::string& defaultValue) const {
+    auto it = options_.find(name);
+    return it != options_.end() ? it->second : defaultValue;
+}
+
+int CommandArgs::getInt(const std::string& name, int defaultValue) const {
+    auto it = options_.find(name);
+    if (it == options_.end()) return defaultValue;
+    double value = 0.0;
+    if (!parseNumber(it->second, value) || value != std::floor(value) ||
+        value < INT_MIN || value > INT_MAX) {
+        throw UsageError("Invalid number for --" + name + ": " + it->second);
+    }
+    return static_cast<int>(value);
+}
+
+bool parseNumber(const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::vector<std::string> CommandArgs::getList(const std::string& name,
+                                              const std::vector<std::string>& defaultValue) const {
+    auto it = options_.find(name);
+    if (it == options_.end()) return defaultValue;
+
+    std::vector<std::string> result;
+    std::istringstream iss(it->second);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) result.push_back(item);
+    }
+    return result;
+}
+
+std::string startLogging(const CommandArgs& args) {
+    LogLevel level = LogLevel::Info;
+    if (args.has("log-level") && !Logger::parseLevel(args.get("log-level"), level)) {
+        return "Unknown --log-level " + args.get("log-level") +
+               " (trace, debug, info, warn, error, off)";
+    }
+    if (!args.has("log-file")) {
+        return args.has("log-level") ? "--log-level needs --log-file" : "";
+    }
+    try {
+        Logger::start(args.get("log-file"), level);
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+LogSession::~LogSession() {
+    Logger::stop();
+}
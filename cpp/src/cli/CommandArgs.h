@@ -0,0 +1,58 @@
+#ifndef COMMAND_ARGS_H
+#define COMMAND_ARGS_H
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Malformed option value; commands report it and exit with status 2 like other usage errors
+class UsageError : public std::invalid_argument {
+public:
+    using std::invalid_argument::invalid_argument;
+};
+
+// Minimal parser for "positional --option value --flag" style subcommand arguments.
+// Options listed in flagNames take no value; everything else starting with "--"
+// consumes the following argument.
+class CommandArgs {
+public:
+    CommandArgs(const std::vector<std::string>& args,
+                const std::vector<std::string>& flagNames = {});
+
+    const std::vector<std::string>& positional() const { return positional_; }
+    bool has(const std::string& name) const;
+    std::string get(const std::string& name, const std::string& defaultValue = "") const;
+    // Throws UsageError when the value is not a whole number ("12x", "1.5")
+    int getInt(const std::string& name, int defaultValue) const;
+
+    // Comma separated list, e.g. "--rotors I,II,III"
+    std::vector<std::string> getList(const std::string& name,
+                                     const std::vector<std::string>& defaultValue) const;
+
+    // Non-empty when an option was missing its value
+    const std::string& error() const { return error_; }
+
+private:
+    std::vector<std::string> positional_;
+    std::map<std::string, std::string> options_;
+    std::string error_;
+};
+
+// Whole-string number for option values ("0.5x" is rejected, unlike a bare std::stod)
+bool parseNumber(const std::string& text, double& value);
+
+// Starts the structured log from "--log-file PATH" (or "-" for stderr) and
+// "--log-level LEVEL" (default info). Returns an error message, or an empty
+// string on success or when --log-file was not given.
+std::string startLogging(const CommandArgs& args);
+
+// Flushes and stops the log when the command returns
+struct LogSession {
+    LogSession() = default;
+    LogSession(const LogSession&) = delete;
+    LogSession& operator=(const LogSession&) = delete;
+    ~LogSession();
+};
+
+#endif // COMMAND_ARGS_H
@@ -0,0 +1,104 @@
+#include "CribIndexCommand.h"
+#include "CommandArgs.h"
+#include "core/CribIndex.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+void printCribIndexUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp cribindex add <index> <crib> [--rotors I,II,III,IV,V] [--reflectors B,C]\n";
+    std::cout << "  EnigmaSimulatorCpp cribindex query <index> <ciphertext>\n";
+    std::cout << "  EnigmaSimulatorCpp cribindex list <index>\n\n";
+    std::cout << "Cribs are assumed to start at the first ciphertext letter on a machine\n";
+    std::cout << "without plugboard connections.\n";
+}
+
+int addCrib(const CommandArgs& args) {
+    if (args.positional().size() < 3) {
+        printCribIndexUsage();
+        return 2;
+    }
+
+    CribIndex index(args.positional()[1]);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t entries = index.addCrib(args.positional()[2],
+                                   args.getList("rotors", {"I", "II", "III", "IV", "V"}),
+                                   args.getList("reflectors", {"B", "C"}),
+                                   [](const std::string& message) { std::cout << message << "\n"; });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Added " << entries << " entries in " << elapsed.count() << " ms\n";
+    return 0;
+}
+
+int queryIndex(const CommandArgs& args) {
+    if (args.positional().size() < 3) {
+        printCribIndexUsage();
+        return 2;
+    }
+
+    CribIndex index(args.positional()[1]);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto matches = index.query(args.positional()[2]);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Matches: " << matches.size() << " (" << elapsed.count() / 1000.0 << " ms)\n";
+    for (const auto& match : matches) {
+        std::cout << "  " << match.crib << "  " << match.getRotorString()
+                  << "  reflector " << match.reflectorType
+                  << "  position " << match.getPositionString() << "\n";
+    }
+    return 0;
+}
+
+int listIndex(const CommandArgs& args) {
+    if (args.positional().size() < 2) {
+        printCribIndexUsage();
+        return 2;
+    }
+
+    CribIndex index(args.positional()[1]);
+    for (const auto& segment : index.getSegments()) {
+        std::cout << "  " << segment.crib << "  orders " << segment.orderCount << "  reflectors";
+        for (const auto& reflector : segment.reflectorTypes) {
+            std::cout << " " << reflector;
+        }
+        std::cout << "  entries " << segment.entryCount << "\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int runCribIndexCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printCribIndexUsage();
+        return 2;
+    }
+
+    try {
+        const std::string& action = args.positional()[0];
+        if (action == "add") {
+            return addCrib(args);
+        } else if (action == "query") {
+            return queryIndex(args);
+        } else if (action == "list") {
+            return listIndex(args);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    printCribIndexUsage();
+    return 2;
+}
@@ -0,0 +1,10 @@
+#ifndef CRIB_INDEX_COMMAND_H
+#define CRIB_INDEX_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp cribindex add|query|list ...
+int runCribIndexCommand(const std::vector<std::string>& args);
+
+#endif // CRIB_INDEX_COMMAND_H
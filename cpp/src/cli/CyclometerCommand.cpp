@@ -0,0 +1,109 @@
+#include "CyclometerCommand.h"
+#include "CommandArgs.h"
+#include "core/Cyclometer.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+void printCyclometerUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp cyclometer build <catalog> [--rotors I,II,III,IV,V] [--reflector B]\n";
+    std::cout << "  EnigmaSimulatorCpp cyclometer query <catalog> <indicators.txt> [--limit N]\n\n";
+    std::cout << "The indicators file holds one doubled indicator (6 letters) per line,\n";
+    std::cout << "all enciphered at the same ground setting.\n";
+}
+
+int buildCatalog(const CommandArgs& args) {
+    if (args.positional().size() < 2) {
+        printCyclometerUsage();
+        return 2;
+    }
+
+    std::string path = args.positional()[1];
+    auto rotors = args.getList("rotors", {"I", "II", "III", "IV", "V"});
+    std::string reflector = args.get("reflector", "B");
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t entries = Cyclometer::buildCatalog(path, rotors, reflector,
+        [](const std::string& message) { std::cout << message << "\n"; });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Built " << entries << " entries in " << elapsed.count() << " ms\n";
+    return 0;
+}
+
+int queryCatalog(const CommandArgs& args) {
+    if (args.positional().size() < 3) {
+        printCyclometerUsage();
+        return 2;
+    }
+
+    std::ifstream file(args.positional()[2]);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << args.positional()[2] << "\n";
+        return 1;
+    }
+    std::vector<std::string> indicators;
+    std::string line;
+    while (file >> line) {
+        indicators.push_back(line);
+    }
+
+    Cyclometer catalog(args.positional()[1]);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto characteristic = Cyclometer::characteristicFromIndicators(indicators);
+    auto matches = catalog.lookup(characteristic);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Indicators: " << indicators.size() << "\n";
+    std::cout << "Characteristic: " << Cyclometer::describe(characteristic) << "\n";
+    std::cout << "Matches: " << matches.size() << " of " << catalog.getEntryCount()
+              << " settings (reflector " << catalog.getReflectorType() << ", "
+              << elapsed.count() / 1000.0 << " ms)\n";
+
+    size_t limit = static_cast<size_t>(args.getInt("limit", 100));
+    for (size_t i = 0; i < matches.size() && i < limit; i++) {
+        std::cout << "  " << matches[i].getRotorString() << " " << matches[i].getPositionString() << "\n";
+    }
+    if (matches.size() > limit) {
+        std::cout << "  ... " << matches.size() - limit << " more\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int runCyclometerCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printCyclometerUsage();
+        return 2;
+    }
+
+    try {
+        const std::string& action = args.positional()[0];
+        if (action == "build") {
+            return buildCatalog(args);
+        } else if (action == "query") {
+            return queryCatalog(args);
+        }
+    } catch (const UsageError& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    printCyclometerUsage();
+    return 2;
+}
@@ -0,0 +1,10 @@
+#ifndef CYCLOMETER_COMMAND_H
+#define CYCLOMETER_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp cyclometer build|query ...
+int runCyclometerCommand(const std::vector<std::string>& args);
+
+#endif // CYCLOMETER_COMMAND_H
@@ -0,0 +1,455 @@
+#include "DaemonCommand.h"
+#include "CommandArgs.h"
+#include "LocalSocket.h"
+#include "core/AttackService.h"
+#include "core/Logger.h"
+#include "core/MetricsRegistry.h"
+#include "core/NgramScorer.h"
+#include "core/ResultSink.h"
+#include "core/ScramblerTableStore.h"
+#include "core/TuningConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::atomic<bool> stopRequested{false};
+
+extern "C" void handleDaemonSignal(int) {
+    stopRequested = true;
+}
+
+void printDaemonUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp daemon --socket PATH [--workers 1] [--threads N]\n";
+    std::cout << "                     [--ngrams FILE] [--cache-tables 64] [--table-store PATH]\n";
+    std::cout << "                     [--log-file PATH|-] [--log-level info] [--tuning PATH]\n";
+    std::cout << "                     [--shadow RATE] [--metrics-port PORT]\n";
+    std::cout << "                     [--metrics-file PATH] [--metrics-interval 15]\n\n";
+    std::cout << "Keeps scrambler tables and n-gram statistics loaded and runs Bombe jobs from a\n";
+    std::cout << "priority queue. Clients connect to the Unix socket and send one JSON request per line:\n";
+    std::cout << "  {\"op\":\"submit\",\"crib\":\"WETTER\",\"cipher\":\"...\",\"rotors\":[\"I\",\"II\",\"III\"],\n";
+    std::cout << "   \"reflector\":\"B\",\"allOrders\":false,\"noPlugboard\":false,\"top\":10,\n";
+    std::cout << "   \"hillClimb\":false,\"priority\":0}\n";
+    std::cout << "  {\"op\":\"cancel\",\"job\":1}   {\"op\":\"status\"}   {\"op\":\"shutdown\"}\n";
+    std::cout << "  {\"op\":\"log\",\"level\":\"debug\"}   (changes the level of --log-file at runtime)\n";
+    std::cout << "Replies are JSON lines with an \"event\" field: queued, started, log, progress,\n";
+    std::cout << "result, ranked, done, status, cancel, log, error. Jobs of a disconnected client are\n";
+    std::cout << "cancelled. A result is sent for every candidate as soon as it is found; after the\n";
+    std::cout << "search the merged top results follow as ranked events, best first (hill-climbed\n";
+    std::cout << "with \"hillClimb\").\n";
+    std::cout << "--shadow re-checks that fraction of the table-driven encryptions against the reference\n";
+    std::cout << "machine on a background thread; mismatches are printed and logged with the full key,\n";
+    std::cout << "and the counts appear in the status reply.\n";
+    std::cout << "--metrics-port serves Prometheus text metrics at http://127.0.0.1:PORT/metrics;\n";
+    std::cout << "--metrics-file rewrites the same text every --metrics-interval seconds (for the\n";
+    std::cout << "node_exporter textfile collector, use a name ending in .prom).\n";
+}
+
+std::vector<std::string> stringList(const json& value) {
+    if (value.is_string()) {
+        std::vector<std::string> items;
+        std::string text = value.get<std::string>();
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t comma = text.find(',', start);
+            if (comma == std::string::npos) comma = text.size();
+            if (comma > start) items.push_back(text.substr(start, comma - start));
+            start = comma + 1;
+        }
+        return items;
+    }
+    return value.get<std::vector<std::string>>();
+}
+
+AttackJob parseJob(const json& request) {
+    AttackJob job;
+    int cribPosition = request.value("cribPosition", -1);
+    for (const auto& crib : stringList(request.at("crib"))) {
+        job.cribs.push_back(CribEntry{crib, cribPosition});
+    }
+    job.cipherText = request.at("cipher").get<std::string>();
+    if (request.contains("rotors")) {
+        job.rotorTypes = stringList(request["rotors"]);
+    }
+    job.reflectorType = request.value("reflector", job.reflectorType);
+    job.testAllOrders = request.value("allOrders", false);
+    job.searchWithoutPlugboard = request.value("noPlugboard", false);
+    job.mergeEquivalent = request.value("merge", true);
+    job.topResults = request.value("top", job.topResults);
+    job.hillClimb = request.value("hillClimb", false);
+    job.priority = request.value("priority", 0);
+    return job;
+}
+
+json eventToJson(const AttackJobEvent& event) {
+    json out = {{"job", event.jobId}};
+    switch (event.type) {
+        case AttackJobEvent::Queued:
+            out["event"] = "queued";
+            out["position"] = event.queuePosition;
+            break;
+        case AttackJobEvent::Started:
+            out["event"] = "started";
+            break;
+        case AttackJobEvent::Log:
+            out["event"] = "log";
+            out["message"] = event.message;
+            break;
+        case AttackJobEvent::Progress:
+            out["event"] = "progress";
+            out["done"] = event.done;
+            out["total"] = event.total;
+            out["percent"] = event.total > 0 ? event.done * 100.0 / event.total : 100.0;
+            break;
+        case AttackJobEvent::Result:
+        case AttackJobEvent::Ranked: {
+            out["event"] = event.type == AttackJobEvent::Result ? "result" : "ranked";
+            out["result"] = json::parse(NdjsonResultSink::toJson(event.result->candidate));
+            if (event.result->climbed) {
+                json plugboard = json::array();
+                for (const auto& [a, b] : event.result->climbedPlugboard) {
+                    plugboard.push_back(std::string{a, b});
+                }
+                out["climbed"] = {{"plugboard", plugboard},
+                                  {"score", event.result->plaintextScore},
+                                  {"plaintext", event.result->plaintext}};
+            }
+            break;
+        }
+        case AttackJobEvent::Finished:
+            out["event"] = "done";
+            out["status"] = event.status;
+            out["candidates"] = event.candidates;
+            if (AttackStats::enabled() && event.status != "failed") {
+                json stats = json::object();
+                for (const auto& [name, value] : event.stats.fields()) {
+                    stats[name] = value;
+                }
+                out["stats"] = stats;
+            }
+            if (!event.message.empty()) {
+                out["message"] = event.message;
+            }
+            break;
+    }
+    return out;
+}
+
+// One client connection: reads requests until EOF, then cancels the client's
+// unfinished jobs. Job listeners keep the socket alive until their last event.
+void serveClient(std::shared_ptr<LocalSocket> socket, AttackService& service) {
+    auto jobsMutex = std::make_shared<std::mutex>();
+    auto openJobs = std::make_shared<std::set<uint64_t>>();
+
+    auto reply = [&socket](const json& message) {
+        socket->writeAll(message.dump() + "\n");
+    };
+
+    std::string line;
+    while (!stopRequested && socket->readLine(line)) {
+        if (line.empty()) continue;
+        try {
+            json request = json::parse(line);
+            std::string op = request.value("op", "");
+            if (op == "submit") {
+                auto listener = [socket, jobsMutex, openJobs](const AttackJobEvent& event) {
+                    if (event.type == AttackJobEvent::Finished) {
+                        std::lock_guard<std::mutex> lock(*jobsMutex);
+                        openJobs->erase(event.jobId);
+                    }
+                    socket->writeAll(eventToJson(event).dump() + "\n");
+                };
+                // The id is only known after submit, so register it from the queued event
+                auto trackingListener = [listener, jobsMutex, openJobs](const AttackJobEvent& event) {
+                    if (event.type == AttackJobEvent::Queued) {
+                        std::lock_guard<std::mutex> lock(*jobsMutex);
+                        openJobs->insert(event.jobId);
+                    }
+                    listener(event);
+                };
+                service.submit(parseJob(request), trackingListener);
+            } else if (op == "cancel") {
+                uint64_t job = request.at("job").get<uint64_t>();
+                reply({{"event", "cancel"}, {"job", job}, {"ok", service.cancel(job)}});
+            } else if (op == "status") {
+                auto status = service.status();
+                json out = {{"event", "status"},
+                            {"queued", status.queued},
+                            {"running", status.running},
+                            {"completed", status.completed},
+                            {"cachedTables", status.cachedTables}};
+                if (status.shadowEnabled) {
+                    out["shadow"] = {{"checked", status.shadowChecked},
+                                     {"mismatches", status.shadowMismatches},
+                                     {"dropped", status.shadowDropped}};
+                }
+                reply(out);
+            } else if (op == "log") {
+                LogLevel level;
+                std::string name = request.value("level", "");
+                if (!Logger::parseLevel(name, level)) {
+                    throw std::invalid_argument("Unknown log level: " + name);
+                }
+                Logger::setLevel(level);
+                reply({{"event", "log"}, {"level", Logger::levelName(Logger::level())}});
+            } else if (op == "shutdown") {
+                reply({{"event", "shutdown"}});
+                stopRequested = true;
+            } else {
+                reply({{"event", "error"}, {"message", "Unknown op: " + op}});
+            }
+        } catch (const std::exception& e) {
+            reply({{"event", "error"}, {"message", e.what()}});
+        }
+    }
+
+    std::set<uint64_t> unfinished;
+    {
+        std::lock_guard<std::mutex> lock(*jobsMutex);
+        unfinished = *openJobs;
+    }
+    for (uint64_t job : unfinished) {
+        service.cancel(job);
+    }
+}
+
+// Threads of the connected clients. Finished ones are joined from the accept loop,
+// so a long-running daemon does not pile them up; the destructor interrupts and
+// joins the rest, also when the daemon leaves through an exception.
+class ClientThreads {
+public:
+    ~ClientThreads() { joinAll(); }
+
+    void start(std::shared_ptr<LocalSocket> socket, AttackService& service) {
+        Client client;
+        client.socket = socket;
+        client.done = std::make_shared<std::atomic<bool>>(false);
+        client.thread = std::thread([socket, &service, done = client.done]() {
+            serveClient(socket, service);
+            *done = true;
+        });
+        clients_.push_back(std::move(client));
+    }
+
+    void reapFinished() {
+        auto finished = std::remove_if(clients_.begin(), clients_.end(), [](Client& client) {
+            if (!*client.done) return false;
+            client.thread.join();
+            return true;
+        });
+        clients_.erase(finished, clients_.end());
+    }
+
+    void joinAll() {
+        for (auto& client : clients_) {
+            if (auto socket = client.socket.lock()) {
+                socket->interrupt();
+            }
+        }
+        for (auto& client : clients_) {
+            client.thread.join();
+        }
+        clients_.clear();
+    }
+
+private:
+    struct Client {
+        std::weak_ptr<LocalSocket> socket;
+        std::shared_ptr<std::atomic<bool>> done;
+        std::thread thread;
+    };
+
+    std::vector<Client> clients_;
+};
+
+// Asks a background thread to stop and joins it when the daemon leaves the scope,
+// whether it returns normally or through an exception
+class StopAndJoin {
+public:
+    explicit StopAndJoin(std::thread& thread) : thread_(thread) {}
+    ~StopAndJoin() {
+        stopRequested = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    StopAndJoin(const StopAndJoin&) = delete;
+    StopAndJoin& operator=(const StopAndJoin&) = delete;
+
+private:
+    std::thread& thread_;
+};
+
+// Answers one HTTP request; only GET /metrics (or /) is served
+void answerMetricsRequest(LocalSocket& socket, MetricsRegistry& metrics) {
+    socket.setReadTimeout(2000);
+    std::string requestLine;
+    if (!socket.readLine(requestLine)) {
+        return;
+    }
+    std::string header;
+    while (socket.readLine(header) && !header.empty()) {
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (requestLine.rfind("GET /metrics ", 0) == 0 || requestLine.rfind("GET / ", 0) == 0) {
+        body = metrics.render();
+    } else {
+        status = "404 Not Found";
+        body = "Only GET /metrics is served\n";
+    }
+    socket.writeAll("HTTP/1.1 " + status + "\r\n"
+                    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                    "Connection: close\r\n\r\n" + body);
+}
+
+// Serves the metrics endpoint and rewrites the metrics file until the daemon stops
+void runMetricsExporter(MetricsRegistry& metrics, LocalSocketServer* server,
+                        const std::string& path, std::chrono::seconds interval) {
+    auto nextWrite = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+        if (!path.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+            try {
+                metrics.writeFile(path);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+            nextWrite = std::chrono::steady_clock::now() + interval;
+        }
+        if (server) {
+            if (auto client = server->accept(200)) {
+                answerMetricsRequest(*client, metrics);
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    }
+    if (!path.empty()) {
+        try {
+            metrics.writeFile(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+    }
+}
+
+} // namespace
+
+int runDaemonCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (!args.has("socket") || !args.positional().empty()) {
+        printDaemonUsage();
+        return 2;
+    }
+    double shadowRate = 0.0;
+    if (args.has("shadow") &&
+        (!parseNumber(args.get("shadow"), shadowRate) || shadowRate < 0.0 || shadowRate > 1.0)) {
+        std::cerr << "Error: --shadow must be a rate between 0 and 1\n";
+        return 2;
+    }
+    int workers = args.getInt("workers", 1);
+    int threads = args.getInt("threads", 0);
+    int cacheTables = args.getInt("cache-tables", 64);
+    int metricsPort = args.getInt("metrics-port", 0);
+    int metricsInterval = args.getInt("metrics-interval", 15);
+
+    std::string logError = startLogging(args);
+    if (!logError.empty()) {
+        std::cerr << "Error: " << logError << "\n";
+        return 2;
+    }
+    LogSession logSession;
+
+    try {
+        if (args.has("table-store")) {
+            ScramblerTableStore::setDefaultPath(args.get("table-store"));
+        }
+        if (args.has("tuning")) {
+            TuningConfig::setDefaultPath(args.get("tuning"));
+        }
+        if (auto tuning = TuningConfig::getDefault()) {
+            std::cerr << "Tuning: " << tuning->threads << " threads, chunk " << tuning->chunkSize
+                      << " (measured " << tuning->created << ")\n";
+        }
+
+        AttackService service(workers, threads);
+        service.setTableCacheLimit(static_cast<size_t>((std::max)(0, cacheTables)));
+        if (args.has("ngrams")) {
+            service.setScorer(NgramScorer::loadFromFile(args.get("ngrams")));
+        }
+        if (args.has("shadow")) {
+            auto shadow = std::make_shared<ShadowValidator>(shadowRate);
+            shadow->setMismatchHandler([](const ShadowMismatch& mismatch) {
+                std::cerr << "Shadow mismatch (" << mismatch.sample.kind << ") key "
+                          << mismatch.sample.keyString() << ": input " << mismatch.sample.input
+                          << " fast " << mismatch.sample.output << " reference " << mismatch.expected << "\n";
+            });
+            service.setShadowValidator(shadow);
+        }
+
+        std::shared_ptr<MetricsRegistry> metrics;
+        LocalSocketServer metricsServer;
+        std::thread metricsThread;
+        StopAndJoin metricsJoin(metricsThread);
+        if (args.has("metrics-port") || args.has("metrics-file")) {
+            metrics = std::make_shared<MetricsRegistry>();
+            metrics->addProcessMetrics();
+            service.setMetrics(metrics);
+            if (args.has("metrics-port")) {
+                metricsServer.listenLoopback(metricsPort);
+                std::cerr << "Metrics on http://127.0.0.1:" << metricsPort << "/metrics\n";
+            }
+        }
+
+        LocalSocketServer server;
+        server.listen(args.get("socket"));
+        if (metrics) {
+            metricsThread = std::thread(runMetricsExporter, std::ref(*metrics),
+                                        args.has("metrics-port") ? &metricsServer : nullptr,
+                                        args.get("metrics-file"),
+                                        std::chrono::seconds((std::max)(1, metricsInterval)));
+        }
+
+        std::signal(SIGINT, handleDaemonSignal);
+        std::signal(SIGTERM, handleDaemonSignal);
+#ifdef SIGPIPE
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        std::cerr << "Listening on " << args.get("socket") << "\n";
+
+        ClientThreads clients;
+        while (!stopRequested) {
+            clients.reapFinished();
+            auto accepted = server.accept(200);
+            if (!accepted) continue;
+            clients.start(std::shared_ptr<LocalSocket>(std::move(accepted)), service);
+        }
+
+        std::cerr << "Shutting down\n";
+        server.close();
+        clients.joinAll();
+        service.shutdown();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef DAEMON_COMMAND_H
+#define DAEMON_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp daemon --socket PATH [options]
+int runDaemonCommand(const std::vector<std::string>& args);
+
+#endif // DAEMON_COMMAND_H
@@ -0,0 +1,121 @@
+#include "DailyKeyCommand.h"
+#include "CommandArgs.h"
+#include "core/DailyKeyAttack.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+void printDailyKeyUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp daykey <traffic.txt> [--rotors I,II,III] [--reflector B]\n";
+    std::cout << "                     [--all-orders] [--ngrams FILE] [--max-hits N] [--limit N]\n\n";
+    std::cout << "The traffic file holds one message of the day per line: the ciphertext,\n";
+    std::cout << "optionally followed by a crib and the crib position (omit it to try every offset).\n";
+    std::cout << "The longest crib drives the Bombe search; the other cribs confirm or reject\n";
+    std::cout << "its plugboard, and messages without a crib are placed by n-gram score.\n";
+    std::cout << "--max-hits caps the primary hits checked per rotor order (default 4096).\n";
+}
+
+} // namespace
+
+int runDailyKeyCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs, {"all-orders"});
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printDailyKeyUsage();
+        return 2;
+    }
+
+    int limit = args.getInt("limit", 10);
+    int maxHits = args.getInt("max-hits", 4096);
+    if (limit < 0 || maxHits <= 0) {
+        std::cerr << "Error: --limit must not be negative and --max-hits must be positive\n";
+        return 2;
+    }
+
+    std::ifstream file(args.positional()[0]);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << args.positional()[0] << "\n";
+        return 1;
+    }
+
+    std::vector<TrafficMessage> messages;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        TrafficMessage message;
+        if (!(iss >> message.cipherText)) continue;
+        iss >> message.crib;
+        std::string position;
+        if (iss >> position) {
+            try {
+                message.cribPosition = std::stoi(position);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid crib position on line " << lineNumber << ": " << position << "\n";
+                return 2;
+            }
+        }
+        messages.push_back(message);
+    }
+
+    try {
+        DailyKeyAttack attack(messages, args.getList("rotors", {"I", "II", "III"}),
+                              args.get("reflector", "B"), args.has("all-orders"));
+        attack.setMaxPrimaryHits(static_cast<size_t>(maxHits));
+        if (args.has("ngrams")) {
+            attack.setScorer(NgramScorer::loadFromFile(args.get("ngrams")));
+        }
+
+        auto candidates = attack.attack([](const std::string& message) { std::cout << message << "\n"; });
+
+        std::cout << "\nBest daily keys:\n";
+        for (size_t i = 0; i < candidates.size() && i < static_cast<size_t>(limit); i++) {
+            const auto& candidate = candidates[i];
+            std::cout << "  #" << i + 1 << "  ";
+            for (size_t r = 0; r < candidate.rotorOrder.size(); r++) {
+                std::cout << (r > 0 ? "-" : "") << candidate.rotorOrder[r];
+            }
+            std::cout << "  score " << std::fixed << std::setprecision(1) << candidate.score
+                      << "  cribs placed " << candidate.constrainedMessages << "  plugs";
+            if (candidate.plugboard.empty()) {
+                std::cout << " -";
+            }
+            for (const auto& [a, b] : candidate.plugboard) {
+                std::cout << " " << a << b;
+            }
+            std::cout << "\n";
+
+            for (size_t m = 0; m < candidate.startPositions.size(); m++) {
+                std::cout << "      message " << m + 1 << ": ";
+                if (candidate.startPositions[m].empty()) {
+                    std::cout << "not placed\n";
+                    continue;
+                }
+                for (int position : candidate.startPositions[m]) {
+                    std::cout << static_cast<char>('A' + position);
+                }
+                if (candidate.cribOffsets[m] >= 0) {
+                    std::cout << "  crib at " << candidate.cribOffsets[m];
+                } else {
+                    std::cout << "  n-gram " << std::setprecision(1) << candidate.ngramScores[m];
+                }
+                std::cout << "\n";
+            }
+        }
+        if (candidates.empty()) {
+            std::cout << "  (none)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
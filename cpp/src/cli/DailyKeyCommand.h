@@ -0,0 +1,10 @@
+#ifndef DAILY_KEY_COMMAND_H
+#define DAILY_KEY_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp daykey <traffic> ...
+int runDailyKeyCommand(const std::vector<std::string>& args);
+
+#endif // DAILY_KEY_COMMAND_H
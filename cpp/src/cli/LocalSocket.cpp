@@ -0,0 +1,253 @@
+#include "LocalSocket.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#include <ws2tcpip.h>
+using NativeSocket = SOCKET;
+#define CLOSE_SOCKET closesocket
+#define POLL_SOCKET WSAPoll
+#else
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+using NativeSocket = int;
+#define CLOSE_SOCKET ::close
+#define POLL_SOCKET ::poll
+#endif
+
+namespace {
+
+#ifdef _WIN32
+void ensureWinsock() {
+    static bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) {
+        throw std::runtime_error("WSAStartup failed");
+    }
+}
+#else
+void ensureWinsock() {}
+#endif
+
+sockaddr_un makeAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+NativeSocket native(long long handle) {
+    return static_cast<NativeSocket>(handle);
+}
+
+bool isValid(NativeSocket fd) {
+#ifdef _WIN32
+    return fd != INVALID_SOCKET;
+#else
+    return fd >= 0;
+#endif
+}
+
+} // namespace
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+void LocalSocket::close() {
+    if (handle_ >= 0) {
+        CLOSE_SOCKET(native(handle_));
+        handle_ = -1;
+    }
+}
+
+void LocalSocket::setReadTimeout(int timeoutMs) {
+    if (handle_ < 0) {
+        return;
+    }
+#ifdef _WIN32
+    DWORD timeout = static_cast<DWORD>(timeoutMs);
+#else
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    ::setsockopt(native(handle_), SOL_SOCKET, SO_RCVTIMEO,
+                 reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+void LocalSocket::interrupt() {
+    if (handle_ >= 0) {
+#ifdef _WIN32
+        ::shutdown(native(handle_), SD_BOTH);
+#else
+        ::shutdown(native(handle_), SHUT_RDWR);
+#endif
+    }
+}
+
+bool LocalSocket::readLine(std::string& line) {
+    while (true) {
+        size_t newline = buffer_.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer_.substr(0, newline);
+            buffer_.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        if (handle_ < 0) {
+            return false;
+        }
+
+        char chunk[4096];
+        auto received = ::recv(native(handle_), chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+bool LocalSocket::writeAll(const std::string& data) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    size_t sent = 0;
+    while (sent < data.size()) {
+        if (handle_ < 0) {
+            return false;
+        }
+#ifdef MSG_NOSIGNAL
+        int flags = MSG_NOSIGNAL;  // a vanished client must not kill the daemon with SIGPIPE
+#else
+        int flags = 0;
+#endif
+        auto written = ::send(native(handle_), data.data() + sent,
+                              static_cast<int>(data.size() - sent), flags);
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+LocalSocket LocalSocket::connect(const std::string& path) {
+    ensureWinsock();
+    NativeSocket fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (!isValid(fd)) {
+        throw std::runtime_error("Could not create socket");
+    }
+    sockaddr_un address = makeAddress(path);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        CLOSE_SOCKET(fd);
+        throw std::runtime_error("Could not connect to " + path);
+    }
+    return LocalSocket(static_cast<long long>(fd));
+}
+
+LocalSocketServer::~LocalSocketServer() {
+    close();
+}
+
+void LocalSocketServer::listen(const std::string& path) {
+    ensureWinsock();
+    sockaddr_un address = makeAddress(path);
+    std::remove(path.c_str());
+
+    NativeSocket fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (!isValid(fd)) {
+        throw std::runtime_error("Could not create socket");
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        CLOSE_SOCKET(fd);
+        throw std::runtime_error("Could not listen on " + path);
+    }
+#ifndef _WIN32
+    // Only the daemon's user may connect; nobody can before listen(), so there is no window
+    if (::chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0) {
+        CLOSE_SOCKET(fd);
+        std::remove(path.c_str());
+        throw std::runtime_error("Could not restrict permissions of " + path);
+    }
+#endif
+    if (::listen(fd, 16) != 0) {
+        CLOSE_SOCKET(fd);
+        std::remove(path.c_str());
+        throw std::runtime_error("Could not listen on " + path);
+    }
+    handle_ = static_cast<long long>(fd);
+    path_ = path;
+}
+
+void LocalSocketServer::listenLoopback(int port) {
+    ensureWinsock();
+    if (port <= 0 || port > 65535) {
+        throw std::runtime_error("Invalid port: " + std::to_string(port));
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<unsigned short>(port));
+
+    NativeSocket fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (!isValid(fd)) {
+        throw std::runtime_error("Could not create socket");
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, 16) != 0) {
+        CLOSE_SOCKET(fd);
+        throw std::runtime_error("Could not listen on 127.0.0.1:" + std::to_string(port));
+    }
+    handle_ = static_cast<long long>(fd);
+    path_.clear();
+}
+
+std::unique_ptr<LocalSocket> LocalSocketServer::accept(int timeoutMs) {
+    if (handle_ < 0) {
+        return nullptr;
+    }
+
+    pollfd waiter;
+    waiter.fd = native(handle_);
+    waiter.events = POLLIN;
+    waiter.revents = 0;
+    if (POLL_SOCKET(&waiter, 1, timeoutMs) <= 0 || !(waiter.revents & POLLIN)) {
+        return nullptr;
+    }
+
+    NativeSocket client = ::accept(native(handle_), nullptr, nullptr);
+    if (!isValid(client)) {
+        return nullptr;
+    }
+    return std::make_unique<LocalSocket>(static_cast<long long>(client));
+}
+
+void LocalSocketServer::close() {
+    if (handle_ >= 0) {
+        CLOSE_SOCKET(native(handle_));
+        handle_ = -1;
+        if (!path_.empty()) {
+            std::remove(path_.c_str());
+        }
+    }
+}
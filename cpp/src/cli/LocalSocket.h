@@ -0,0 +1,64 @@
+#ifndef LOCAL_SOCKET_H
+#define LOCAL_SOCKET_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Minimal stream socket over a Unix domain socket path (AF_UNIX; on Windows this
+// needs Windows 10 1803 or later). Used by the daemon and its line-based protocol,
+// and over loopback TCP for the daemon's metrics endpoint.
+class LocalSocket {
+public:
+    LocalSocket() = default;
+    explicit LocalSocket(long long handle) : handle_(handle) {}
+    ~LocalSocket();
+
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+
+    bool isOpen() const { return handle_ >= 0; }
+
+    // Reads up to the next '\n' (not included). Returns false on EOF or error.
+    bool readLine(std::string& line);
+
+    // Writes the whole string; safe to call from several threads.
+    bool writeAll(const std::string& data);
+
+    // Makes readLine() give up after timeoutMs without data (0 waits forever).
+    void setReadTimeout(int timeoutMs);
+
+    // Wakes up a blocked readLine() from another thread (the socket stays open).
+    void interrupt();
+
+    void close();
+
+    static LocalSocket connect(const std::string& path);
+
+private:
+    long long handle_ = -1;
+    std::string buffer_;
+    std::mutex writeMutex_;
+};
+
+class LocalSocketServer {
+public:
+    ~LocalSocketServer();
+
+    // Binds and listens; an existing socket file at path is replaced.
+    void listen(const std::string& path);
+
+    // Binds and listens on 127.0.0.1:port (TCP, not reachable from other hosts).
+    void listenLoopback(int port);
+
+    // Waits up to timeoutMs for a client. Returns an open socket or nullptr on timeout.
+    std::unique_ptr<LocalSocket> accept(int timeoutMs);
+
+    void close();
+
+private:
+    long long handle_ = -1;
+    std::string path_;
+};
+
+#endif // LOCAL_SOCKET_H
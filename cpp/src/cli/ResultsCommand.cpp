@@ -0,0 +1,112 @@
+#include "ResultsCommand.h"
+#include "CommandArgs.h"
+#include "core/ResultReader.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+void printResultsUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp results top <file>... [--k 10]\n";
+    std::cout << "  EnigmaSimulatorCpp results sort <output> <file>... [--run-size 1000000]\n\n";
+    std::cout << "Files are NDJSON or length-prefixed binary result streams (detected automatically).\n";
+    std::cout << "sort merges all inputs into one ranked file using sorted temporary runs, so only\n";
+    std::cout << "--run-size results are held in memory. The output format follows the extension\n";
+    std::cout << "(.bin for binary, anything else for NDJSON).\n";
+}
+
+int showTop(const CommandArgs& args) {
+    if (args.positional().size() < 2) {
+        printResultsUsage();
+        return 2;
+    }
+
+    std::vector<std::string> inputs(args.positional().begin() + 1, args.positional().end());
+    int k = args.getInt("k", 10);
+    if (k <= 0) {
+        std::cerr << "Error: --k must be positive\n";
+        return 2;
+    }
+
+    auto top = ResultMerger::topK(inputs, static_cast<size_t>(k));
+    for (size_t i = 0; i < top.size(); i++) {
+        const auto& r = top[i];
+        std::string plugboard;
+        for (const auto& [a, b] : r.plugboard) {
+            if (!plugboard.empty()) plugboard += " ";
+            plugboard += a;
+            plugboard += b;
+        }
+        std::cout << std::setw(3) << i + 1 << ". " << r.getRotorString()
+                  << "  position " << r.getPositionString()
+                  << "  score " << std::fixed << std::setprecision(1) << r.score
+                  << "  match " << r.matchRate * 100 << "%"
+                  << "  offset " << r.offset
+                  << "  crib " << r.crib
+                  << "  plugboard " << (plugboard.empty() ? "None" : plugboard);
+        if (r.equivalentCount > 1) {
+            std::cout << "  (" << r.equivalentCount << " equivalent)";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+int sortResults(const CommandArgs& args) {
+    if (args.positional().size() < 3) {
+        printResultsUsage();
+        return 2;
+    }
+
+    const std::string& output = args.positional()[1];
+    std::vector<std::string> inputs(args.positional().begin() + 2, args.positional().end());
+    int runSize = args.getInt("run-size", 1000000);
+    if (runSize <= 0) {
+        std::cerr << "Error: --run-size must be positive\n";
+        return 2;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    uint64_t count = ResultMerger::sortFiles(inputs, output, static_cast<size_t>(runSize),
+        [](const std::string& message) { std::cout << message << "\n"; });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Wrote " << count << " results to " << output
+              << " in " << elapsed.count() << " ms\n";
+    return 0;
+}
+
+} // namespace
+
+int runResultsCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printResultsUsage();
+        return 2;
+    }
+
+    try {
+        const std::string& action = args.positional()[0];
+        if (action == "top") {
+            return showTop(args);
+        } else if (action == "sort" || action == "merge") {
+            return sortResults(args);
+        }
+    } catch (const UsageError& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    printResultsUsage();
+    return 2;
+}
@@ -0,0 +1,10 @@
+#ifndef RESULTS_COMMAND_H
+#define RESULTS_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp results top|sort ...
+int runResultsCommand(const std::vector<std::string>& args);
+
+#endif // RESULTS_COMMAND_H
@@ -0,0 +1,214 @@
+#include "TuneCommand.h"
+#include "CommandArgs.h"
+#include "bench/ScalingHarness.h"
+#include "core/BombeAttack.h"
+#include "core/ScramblerTable.h"
+#include "core/TuningConfig.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+void printTuneUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp tune [--out PATH] [--threads 1,2,4,8] [--chunks 8,16,32,64,128,256,512]\n";
+    std::cout << "                          [--min-time 0.5] [--seed 1] [--dry-run]\n\n";
+    std::cout << "Times short Bombe runs on a synthetic message for each thread count and OpenMP chunk\n";
+    std::cout << "size, then writes the fastest configuration for this host to the tuning file.\n";
+    std::cout << "bombe, daemon and the GUI read that file at startup. The default path is\n";
+    std::cout << "$ENIGMA_TUNING_FILE, otherwise the per-user cache directory (currently:\n";
+    std::cout << "  " << TuningConfig::defaultPath() << ")\n";
+    std::cout << "--dry-run prints the result without writing the file.\n";
+}
+
+// Thread counts worth trying when --threads is not given: 1 and quarters of the CPU count
+std::vector<int> defaultThreadCounts() {
+    int hardware = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+    std::vector<int> counts = {1, hardware / 4, hardware / 2, hardware * 3 / 4, hardware};
+    counts.erase(std::remove_if(counts.begin(), counts.end(), [](int count) { return count < 1; }),
+                 counts.end());
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+std::vector<int> parseCounts(const CommandArgs& args, const std::string& name, const std::vector<int>& defaults) {
+    if (!args.has(name)) {
+        return defaults;
+    }
+    std::vector<int> values;
+    for (const auto& item : args.getList(name, {})) {
+        int value = std::stoi(item);
+        if (value < 1) {
+            throw std::invalid_argument("--" + name + " values must be positive");
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        throw std::invalid_argument("--" + name + " needs at least one value");
+    }
+    return values;
+}
+
+class Calibration {
+public:
+    Calibration(const ScalingWorkload& workload, double minSeconds)
+        : workload_(workload), minSeconds_(minSeconds) {
+        // Keep every table alive so the runs time the search, not table construction
+        for (const auto& order : ScramblerTable::buildRotorOrders(workload_.rotorSet, true)) {
+            tables_.push_back(ScramblerTable::get(order, "B"));
+        }
+    }
+
+    // Fastest of repeated attacks (at least three, and at least minSeconds in total),
+    // as wall-clock nanoseconds per tested position
+    double measure(int threads, int chunkSize) {
+        using Clock = std::chrono::steady_clock;
+        double best = 0.0;
+        double total = 0.0;
+        for (int run = 0; run < 3 || total < minSeconds_; run++) {
+            BombeAttack attack(workload_.crib, workload_.ciphertext, workload_.rotorSet, "B", true, false);
+            attack.setMaxThreads(threads);
+            attack.setChunkSize(chunkSize);
+            attack.setResultLimit(1);
+
+            auto start = Clock::now();
+            attack.attack(std::vector<CribEntry>{CribEntry{workload_.crib, workload_.cribOffset}});
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            best = run == 0 ? seconds : (std::min)(best, seconds);
+            total += seconds;
+        }
+        double positions = static_cast<double>(tables_.size()) * ScramblerTable::NUM_STATES;
+        return best * 1e9 / positions;
+    }
+
+private:
+    ScalingWorkload workload_;
+    double minSeconds_;
+    std::vector<std::shared_ptr<const ScramblerTable>> tables_;
+};
+
+struct TunePoint {
+    int threads;
+    int chunkSize;
+    double nsPerPosition;
+};
+
+void printPoint(const TunePoint& point) {
+    std::cout << "  threads " << std::setw(4) << point.threads
+              << "  chunk " << std::setw(5) << point.chunkSize
+              << "  " << std::fixed << std::setprecision(1) << std::setw(9) << point.nsPerPosition
+              << " ns/position\n" << std::defaultfloat;
+}
+
+// Pick the smallest thread count within 3% of the fastest: extra threads that buy
+// nothing only take cores away from the rest of the machine
+TunePoint pickThreads(const std::vector<TunePoint>& points) {
+    double fastest = points.front().nsPerPosition;
+    for (const auto& point : points) {
+        fastest = (std::min)(fastest, point.nsPerPosition);
+    }
+    for (const auto& point : points) {
+        if (point.nsPerPosition <= fastest * 1.03) {
+            return point;
+        }
+    }
+    return points.front();
+}
+
+TunePoint pickFastest(const std::vector<TunePoint>& points) {
+    return *std::min_element(points.begin(), points.end(), [](const TunePoint& a, const TunePoint& b) {
+        return a.nsPerPosition < b.nsPerPosition;
+    });
+}
+
+} // namespace
+
+int runTuneCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs, {"dry-run", "help"});
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (!args.positional().empty() || args.has("help")) {
+        printTuneUsage();
+        return 2;
+    }
+    int seed = args.getInt("seed", 1);
+
+    try {
+        std::vector<int> threadCounts = parseCounts(args, "threads", defaultThreadCounts());
+        std::vector<int> chunkSizes = parseCounts(args, "chunks", {8, 16, 32, 64, 128, 256, 512});
+        std::sort(threadCounts.begin(), threadCounts.end());
+        double minSeconds = std::stod(args.get("min-time", "0.5"));
+        std::string path = args.get("out", TuningConfig::defaultPath());
+        if (path.empty() && !args.has("dry-run")) {
+            std::cerr << "Error: no default tuning path on this system, pass --out PATH\n";
+            return 2;
+        }
+
+        // 16 letter crib in a 60 letter message on all orders of three rotors with
+        // ten plugs, at the crib's known offset: the inner loop of a typical attack
+        WorkloadGenerator generator(static_cast<uint64_t>(seed));
+        ScalingWorkload workload = generator.generate(16, 60, 3, 10);
+        Calibration calibration(workload, minSeconds);
+        calibration.measure(threadCounts.back(), 64);  // warm up caches and the OpenMP pool
+
+        int hardware = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+        int defaultThreads = (std::max)(1, hardware * 3 / 4);
+        TunePoint baseline{defaultThreads, 64, calibration.measure(defaultThreads, 64)};
+        std::cout << "Untuned default:\n";
+        printPoint(baseline);
+
+        std::cout << "Thread count (chunk 64):\n";
+        std::vector<TunePoint> threadPoints;
+        for (int threads : threadCounts) {
+            threadPoints.push_back({threads, 64, calibration.measure(threads, 64)});
+            printPoint(threadPoints.back());
+        }
+        TunePoint best = pickThreads(threadPoints);
+
+        std::cout << "Chunk size (" << best.threads << " threads):\n";
+        std::vector<TunePoint> chunkPoints;
+        for (int chunkSize : chunkSizes) {
+            chunkPoints.push_back({best.threads, chunkSize,
+                                   chunkSize == 64 ? best.nsPerPosition : calibration.measure(best.threads, chunkSize)});
+            printPoint(chunkPoints.back());
+        }
+        best = pickFastest(chunkPoints);
+
+        // Compare the winner with the untuned default back to back, so the reported
+        // gain is not just drift between the first and last measurement
+        if (best.threads != baseline.threads || best.chunkSize != baseline.chunkSize) {
+            baseline.nsPerPosition = calibration.measure(baseline.threads, baseline.chunkSize);
+            best.nsPerPosition = calibration.measure(best.threads, best.chunkSize);
+        } else {
+            baseline.nsPerPosition = best.nsPerPosition;
+        }
+
+        TuningConfig config;
+        config.threads = best.threads;
+        config.chunkSize = best.chunkSize;
+        config.nsPerPosition = best.nsPerPosition;
+        config.cpu = TuningConfig::hostCpu();
+        config.hardwareThreads = std::thread::hardware_concurrency();
+
+        std::cout << "Selected: threads " << config.threads << ", chunk " << config.chunkSize << " ("
+                  << std::fixed << std::setprecision(2) << baseline.nsPerPosition / best.nsPerPosition
+                  << "x the untuned default)\n" << std::defaultfloat;
+        if (args.has("dry-run")) {
+            return 0;
+        }
+        config.save(path);
+        std::cout << "Wrote " << path << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
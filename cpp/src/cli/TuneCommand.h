@@ -0,0 +1,10 @@
+#ifndef TUNE_COMMAND_H
+#define TUNE_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp tune [--out PATH] [options]
+int runTuneCommand(const std::vector<std::string>& args);
+
+#endif // TUNE_COMMAND_H
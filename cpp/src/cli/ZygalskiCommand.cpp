@@ -0,0 +1,108 @@
+#include "ZygalskiCommand.h"
+#include "CommandArgs.h"
+#include "core/ZygalskiSheets.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+void printZygalskiUsage() {
+    std::cout << "Usage:\n";
+    std::cout << "  EnigmaSimulatorCpp zygalski build <sheets> [--rotors I,II,III,IV,V] [--reflector B]\n";
+    std::cout << "  EnigmaSimulatorCpp zygalski search <sheets> <indicators.txt> [--limit N]\n\n";
+    std::cout << "The indicators file holds one message per line: the ground setting sent\n";
+    std::cout << "in clear (3 letters) followed by the doubled indicator (6 letters).\n";
+}
+
+int buildSheets(const CommandArgs& args) {
+    if (args.positional().size() < 2) {
+        printZygalskiUsage();
+        return 2;
+    }
+
+    auto rotors = args.getList("rotors", {"I", "II", "III", "IV", "V"});
+    std::string reflector = args.get("reflector", "B");
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    ZygalskiSheets sheets(rotors, reflector,
+        [](const std::string& message) { std::cout << message << "\n"; });
+    sheets.save(args.positional()[1]);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Saved sheets for " << sheets.getOrderCount() << " rotor orders in "
+              << elapsed.count() << " ms\n";
+    return 0;
+}
+
+int searchSheets(const CommandArgs& args) {
+    if (args.positional().size() < 3) {
+        printZygalskiUsage();
+        return 2;
+    }
+
+    std::ifstream file(args.positional()[2]);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << args.positional()[2] << "\n";
+        return 1;
+    }
+    std::vector<ZygalskiIndicator> indicators;
+    ZygalskiIndicator entry;
+    while (file >> entry.ground >> entry.indicator) {
+        indicators.push_back(entry);
+    }
+
+    ZygalskiSheets sheets(args.positional()[1]);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto candidates = sheets.search(indicators,
+        [](const std::string& message) { std::cout << message << "\n"; });
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    std::cout << "Indicators: " << indicators.size() << ", reflector " << sheets.getReflectorType()
+              << ", " << elapsed.count() / 1000.0 << " ms\n";
+
+    size_t limit = static_cast<size_t>(args.getInt("limit", 100));
+    for (size_t i = 0; i < candidates.size() && i < limit; i++) {
+        std::cout << "  " << candidates[i].getRotorString()
+                  << " rings " << candidates[i].getRingString() << "\n";
+    }
+    if (candidates.size() > limit) {
+        std::cout << "  ... " << candidates.size() - limit << " more\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int runZygalskiCommand(const std::vector<std::string>& rawArgs) {
+    CommandArgs args(rawArgs);
+    if (!args.error().empty()) {
+        std::cerr << "Error: " << args.error() << "\n";
+        return 2;
+    }
+    if (args.positional().empty()) {
+        printZygalskiUsage();
+        return 2;
+    }
+
+    try {
+        const std::string& action = args.positional()[0];
+        if (action == "build") {
+            return buildSheets(args);
+        } else if (action == "search") {
+            return searchSheets(args);
+        }
+    } catch (const UsageError& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    printZygalskiUsage();
+    return 2;
+}
@@ -0,0 +1,10 @@
+#ifndef ZYGALSKI_COMMAND_H
+#define ZYGALSKI_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// EnigmaSimulatorCpp zygalski build|search ...
+int runZygalskiCommand(const std::vector<std::string>& args);
+
+#endif // ZYGALSKI_COMMAND_H
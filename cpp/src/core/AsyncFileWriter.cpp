@@ -0,0 +1,129 @@
+#include "AsyncFileWriter.h"
+#include <algorithm>
+#include <stdexcept>
+
+AsyncFileWriter::AsyncFileWriter(const std::string& path,
+                                 bool append,
+                                 size_t bufferSize,
+                                 size_t maxPending)
+    : bufferSize_((std::max)(bufferSize, size_t(4096))),
+      maxPending_((std::max)(maxPending, size_t(1))) {
+    file_.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (!file_) {
+        throw std::runtime_error("出力ファイルを開けません: " + path);
+    }
+    current_.reserve(bufferSize_);
+    worker_ = std::thread(&AsyncFileWriter::run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    try {
+        close();
+    } catch (...) {
+        // デストラクタからは例外を投げない（確認したい場合は先にclose()を呼ぶ）
+    }
+}
+
+void AsyncFileWriter::checkFailedLocked() const {
+    if (failed_) {
+        throw std::runtime_error("ファイルへの書き込みに失敗しました");
+    }
+}
+
+void AsyncFileWriter::submitLocked() {
+    if (current_.empty()) {
+        return;
+    }
+    pending_.push_back(std::move(current_));
+    current_ = std::vector<char>();
+    current_.reserve(bufferSize_);
+    hasWork_.notify_one();
+}
+
+void AsyncFileWriter::write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    std::unique_lock<std::mutex> lock(mutex_);
+    checkFailedLocked();
+    if (closing_) {
+        throw std::runtime_error("閉じたファイルには書き込めません");
+    }
+
+    // 1回のwrite()の内容は分割せず同じバッファに入れる（並行書き込みでも混ざらない）
+    auto waitForRoom = [&] {
+        hasRoom_.wait(lock, [this] { return pending_.size() < maxPending_ || failed_; });
+        checkFailedLocked();
+    };
+    if (!current_.empty() && current_.size() + size > bufferSize_) {
+        waitForRoom();
+        submitLocked();
+    }
+    current_.insert(current_.end(), bytes, bytes + size);
+    if (current_.size() >= bufferSize_) {
+        waitForRoom();
+        submitLocked();
+    }
+}
+
+void AsyncFileWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    submitLocked();
+    hasRoom_.wait(lock, [this] { return (pending_.empty() && !writing_) || failed_; });
+    checkFailedLocked();
+}
+
+void AsyncFileWriter::close() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!worker_.joinable()) {
+            return;
+        }
+        submitLocked();
+        closing_ = true;
+        hasWork_.notify_one();
+    }
+    worker_.join();
+    file_.close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkFailedLocked();
+}
+
+uint64_t AsyncFileWriter::bytesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesWritten_;
+}
+
+void AsyncFileWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        hasWork_.wait(lock, [this] { return !pending_.empty() || closing_; });
+        if (pending_.empty()) {
+            break;  // closing_かつ書くものがない
+        }
+
+        std::vector<char> buffer = std::move(pending_.front());
+        pending_.pop_front();
+        writing_ = true;
+        bool ok = !failed_;
+        bool flushAfter = pending_.empty();  // 待ちがなければOSへ渡しておく
+        hasRoom_.notify_all();
+
+        // 書き込み中はロックを外し、呼び出し側は次のバッファを埋められるようにする
+        lock.unlock();
+        if (ok) {
+            ok = static_cast<bool>(file_.write(buffer.data(), buffer.size()));
+        }
+        if (ok && flushAfter) {
+            ok = static_cast<bool>(file_.flush());
+        }
+        lock.lock();
+
+        writing_ = false;
+        if (ok) {
+            bytesWritten_ += buffer.size();
+        } else {
+            failed_ = true;
+        }
+        hasRoom_.notify_all();
+    }
+}
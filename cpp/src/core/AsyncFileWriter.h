@@ -0,0 +1,60 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 書き込みを専用スレッドに任せるバッファ付きファイル出力
+// bufferSizeごとにまとめて書き込みスレッドへ渡し、未書き込みのバッファが
+// maxPending個に達したら呼び出し側を待たせる（メモリ使用量に上限を設ける）。
+// write()は複数スレッドから呼んでよい
+class AsyncFileWriter {
+public:
+    AsyncFileWriter(const std::string& path,
+                    bool append = false,
+                    size_t bufferSize = 1 << 20,
+                    size_t maxPending = 4);
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    void write(const void* data, size_t size);
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    // ここまでに渡したデータがファイルへ書かれるまで待つ
+    void flush();
+
+    // 残りを書き出してファイルを閉じる。書き込みエラーがあれば例外を投げる
+    void close();
+
+    uint64_t bytesWritten() const;
+
+private:
+    std::ofstream file_;
+    size_t bufferSize_;
+    size_t maxPending_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable hasWork_;
+    std::condition_variable hasRoom_;
+    std::vector<char> current_;
+    std::deque<std::vector<char>> pending_;
+    bool writing_ = false;
+    bool closing_ = false;
+    bool failed_ = false;
+    uint64_t bytesWritten_ = 0;
+    std::thread worker_;
+
+    void run();
+    void submitLocked();
+    void checkFailedLocked() const;
+};
+
+#endif // ASYNC_FILE_WRITER_H
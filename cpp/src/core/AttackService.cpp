@@ -0,0 +1,460 @@
+#include "AttackService.h"
+#include "Logger.h"
+#include "PlugboardHillClimber.h"
+#include "ResultSink.h"
+#include "RotorConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// 見つかった候補をその場でResult通知としてジョブのリスナーへ送る。
+// write()は探索スレッドから並行して呼ばれる
+class ListenerResultSink : public ResultSink {
+public:
+    ListenerResultSink(uint64_t jobId, AttackService::Listener listener)
+        : jobId_(jobId), listener_(std::move(listener)) {}
+
+    void write(const CandidateResult& candidate) override {
+        AttackJobResult result;
+        result.candidate = candidate;
+        AttackJobEvent event{AttackJobEvent::Result, jobId_};
+        event.result = &result;
+        listener_(event);
+        count_++;
+    }
+
+private:
+    uint64_t jobId_;
+    AttackService::Listener listener_;
+};
+
+} // namespace
+
+AttackService::AttackService(int workers, int threadsPerJob)
+    : threadsPerJob_(threadsPerJob),
+      scorer_(std::make_shared<NgramScorer>()) {
+    workers = (std::max)(workers, 1);
+    for (int i = 0; i < workers; i++) {
+        workers_.emplace_back(&AttackService::workerLoop, this);
+    }
+}
+
+AttackService::~AttackService() {
+    shutdown();
+    if (metrics_) {
+        metrics_->removeCollector(metricsCollector_);
+    }
+}
+
+void AttackService::setMetrics(std::shared_ptr<MetricsRegistry> metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (metrics_) {
+        metrics_->removeCollector(metricsCollector_);
+    }
+    metrics_ = metrics;
+    if (!metrics_) {
+        return;
+    }
+    // 件数は出力の直前にstatus()から取る
+    metricsCollector_ = metrics_->addCollector([this](MetricsRegistry& registry) {
+        Status current = status();
+        registry.gauge("enigma_jobs_queued", "Jobs waiting in the queue.").set(static_cast<double>(current.queued));
+        registry.gauge("enigma_jobs_running", "Jobs currently running.").set(static_cast<double>(current.running));
+        registry.gauge("enigma_table_cache_entries", "Scrambler tables held in the service cache.")
+            .set(static_cast<double>(current.cachedTables));
+    });
+}
+
+void AttackService::setScorer(const NgramScorer& scorer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scorer_ = std::make_shared<NgramScorer>(scorer);
+}
+
+void AttackService::setShadowValidator(std::shared_ptr<ShadowValidator> validator) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shadow_ = validator;
+}
+
+void AttackService::setTableCacheLimit(size_t limit) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    tableCacheLimit_ = limit;
+    while (tableCache_.size() > tableCacheLimit_) {
+        tableCache_.pop_back();
+    }
+}
+
+bool AttackService::runsAfter(const QueuedJob& a, const QueuedJob& b) {
+    // ヒープの先頭に最も優先度の高い（同じなら最も古い）ジョブが来るようにする
+    if (a.job.priority != b.job.priority) {
+        return a.job.priority < b.job.priority;
+    }
+    return a.sequence > b.sequence;
+}
+
+uint64_t AttackService::submit(const AttackJob& job, Listener listener) {
+    if (job.cribs.empty() || job.cipherText.empty()) {
+        throw std::invalid_argument("クリブと暗号文が必要です");
+    }
+    if (job.rotorTypes.size() < 3) {
+        throw std::invalid_argument("ローターは3枚以上必要です");
+    }
+    for (const auto& type : job.rotorTypes) {
+        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
+            throw std::invalid_argument("無効なローター: " + type);
+        }
+    }
+    if (enigma::REFLECTOR_DEFINITIONS.find(job.reflectorType) == enigma::REFLECTOR_DEFINITIONS.end()) {
+        throw std::invalid_argument("無効なリフレクター: " + job.reflectorType);
+    }
+
+    AttackJobEvent event{AttackJobEvent::Queued, 0};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            throw std::runtime_error("サービスは停止中です");
+        }
+        event.jobId = nextId_++;
+        queue_.push_back(QueuedJob{event.jobId, nextSequence_++, job, listener});
+        std::push_heap(queue_.begin(), queue_.end(), runsAfter);
+        event.queuePosition = queue_.size();
+    }
+    hasJob_.notify_one();
+
+    if (listener) {
+        listener(event);
+    }
+    return event.jobId;
+}
+
+bool AttackService::cancel(uint64_t jobId) {
+    Listener listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto running = running_.find(jobId);
+        if (running != running_.end()) {
+            cancelled_.insert(jobId);
+            if (running->second) {
+                running->second->stop();
+            }
+            return true;
+        }
+
+        auto queued = std::find_if(queue_.begin(), queue_.end(),
+                                   [jobId](const QueuedJob& q) { return q.id == jobId; });
+        if (queued == queue_.end()) {
+            return false;
+        }
+        listener = queued->listener;
+        queue_.erase(queued);
+        std::make_heap(queue_.begin(), queue_.end(), runsAfter);
+    }
+
+    if (listener) {
+        AttackJobEvent event{AttackJobEvent::Finished, jobId};
+        event.status = "cancelled";
+        listener(event);
+    }
+    return true;
+}
+
+AttackService::Status AttackService::status() const {
+    Status status;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status.queued = queue_.size();
+        status.running = running_.size();
+        status.completed = completed_;
+        if (shadow_) {
+            status.shadowEnabled = true;
+            status.shadowChecked = shadow_->checked();
+            status.shadowMismatches = shadow_->mismatchCount();
+            status.shadowDropped = shadow_->dropped();
+        }
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    status.cachedTables = tableCache_.size();
+    return status;
+}
+
+void AttackService::shutdown() {
+    std::vector<QueuedJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ && workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+        dropped.swap(queue_);
+        for (auto& [id, attack] : running_) {
+            cancelled_.insert(id);
+            if (attack) {
+                attack->stop();
+            }
+        }
+    }
+    hasJob_.notify_all();
+
+    for (auto& queued : dropped) {
+        if (queued.listener) {
+            AttackJobEvent event{AttackJobEvent::Finished, queued.id};
+            event.status = "cancelled";
+            queued.listener(event);
+        }
+    }
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    workers_.clear();
+}
+
+void AttackService::workerLoop() {
+    while (true) {
+        QueuedJob queued;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            hasJob_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            std::pop_heap(queue_.begin(), queue_.end(), runsAfter);
+            queued = std::move(queue_.back());
+            queue_.pop_back();
+            running_[queued.id] = nullptr;  // 取り消し要求を受けられるよう先に登録する
+        }
+
+        AttackJobEvent finished = runJob(queued);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.erase(queued.id);
+            cancelled_.erase(queued.id);
+            completed_++;
+        }
+        // 完了通知を受けた時点でstatus()にも反映されているようにする
+        if (queued.listener) {
+            queued.listener(finished);
+        }
+    }
+}
+
+void AttackService::countTableLookup(bool hit) {
+    std::shared_ptr<MetricsRegistry> metrics;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics = metrics_;
+    }
+    if (metrics) {
+        metrics->counter(hit ? "enigma_table_cache_hits_total" : "enigma_table_cache_misses_total",
+                         hit ? "Scrambler table lookups served from the service cache."
+                             : "Scrambler table lookups that had to load or build the table.")
+            .add(1);
+    }
+}
+
+std::shared_ptr<const ScramblerTable> AttackService::pinTable(const std::vector<std::string>& rotorOrder,
+                                                              const std::string& reflectorType) {
+    std::string key = reflectorType;
+    for (const auto& type : rotorOrder) {
+        key += "/" + type;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        for (auto it = tableCache_.begin(); it != tableCache_.end(); ++it) {
+            if (it->first == key) {
+                tableCache_.splice(tableCache_.begin(), tableCache_, it);
+                countTableLookup(true);
+                return it->second;
+            }
+        }
+    }
+    countTableLookup(false);
+
+    // 作成中はロックを外す（同時に作られた場合もScramblerTable::getが同じ表を返す）
+    auto table = ScramblerTable::get(rotorOrder, reflectorType);
+
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    auto existing = std::find_if(tableCache_.begin(), tableCache_.end(),
+                                 [&key](const auto& entry) { return entry.first == key; });
+    if (existing == tableCache_.end() && tableCacheLimit_ > 0) {
+        tableCache_.emplace_front(key, table);
+        while (tableCache_.size() > tableCacheLimit_) {
+            tableCache_.pop_back();
+        }
+    }
+    return table;
+}
+
+AttackJobEvent AttackService::runJob(QueuedJob& queued) {
+    const AttackJob& job = queued.job;
+    auto notify = [&queued](const AttackJobEvent& event) {
+        if (queued.listener) {
+            queued.listener(event);
+        }
+    };
+
+    notify(AttackJobEvent{AttackJobEvent::Started, queued.id});
+    ENIGMA_LOG(LogLevel::Info, "job.start")
+        .kv("job", queued.id)
+        .kv("priority", job.priority)
+        .kv("rotors", job.rotorTypes.size())
+        .kv("allOrders", job.testAllOrders);
+
+    std::shared_ptr<MetricsRegistry> metrics;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics = metrics_;
+    }
+    const MetricsRegistry::Labels jobLabels = {{"job", std::to_string(queued.id)}};
+    MetricValue* progressRatio = nullptr;
+    MetricValue* positionsTested = nullptr;
+    if (metrics) {
+        progressRatio = &metrics->gauge("enigma_job_progress_ratio",
+                                        "Fraction of the positions of a running job already tested.", jobLabels);
+        positionsTested = &metrics->counter("enigma_positions_tested_total",
+                                            "Start positions times crib offsets tested by all jobs.");
+    }
+
+    AttackJobEvent finished{AttackJobEvent::Finished, queued.id};
+    try {
+        BombeAttack attack(job.cribs.front().text, job.cipherText, job.rotorTypes, job.reflectorType,
+                           job.testAllOrders, job.searchWithoutPlugboard);
+        if (threadsPerJob_ > 0) {
+            attack.setMaxThreads(threadsPerJob_);
+        }
+        attack.setMergeEquivalent(job.mergeEquivalent);
+        attack.setResultLimit(job.topResults);
+        if (queued.listener) {
+            attack.setResultSink(std::make_shared<ListenerResultSink>(queued.id, queued.listener));
+        }
+
+        // 進捗は0.2秒に1回まで（終了時の1回は必ず送る）
+        auto lastProgress = std::make_shared<std::atomic<long long>>(0);
+        auto lastDone = std::make_shared<std::atomic<long long>>(0);
+        attack.setProgressHandler([&queued, lastProgress, lastDone, progressRatio, positionsTested](
+                                      long long done, long long total) {
+            if (progressRatio) {
+                // 探索スレッドから順不同で呼ばれるので、増えた分だけを加える
+                long long previous = lastDone->load();
+                while (done > previous && !lastDone->compare_exchange_weak(previous, done)) {
+                }
+                if (done > previous) {
+                    positionsTested->add(static_cast<double>(done - previous));
+                }
+                progressRatio->set(total > 0 ? static_cast<double>(lastDone->load()) / total : 1.0);
+            }
+
+            long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            long long last = lastProgress->load();
+            if (done < total && (now - last < 200 || !lastProgress->compare_exchange_strong(last, now))) {
+                return;
+            }
+            if (queued.listener) {
+                AttackJobEvent event{AttackJobEvent::Progress, queued.id};
+                event.done = done;
+                event.total = total;
+                queued.listener(event);
+            }
+        });
+
+        // 使うローター順の表を保持しておき、次のジョブでも再利用する
+        std::vector<std::shared_ptr<const ScramblerTable>> tables;
+        for (const auto& order : ScramblerTable::buildRotorOrders(job.rotorTypes, job.testAllOrders)) {
+            tables.push_back(pinTable(order, job.reflectorType));
+        }
+
+        std::shared_ptr<const NgramScorer> scorer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            scorer = scorer_;
+            attack.setShadowValidator(shadow_);
+            running_[queued.id] = &attack;
+            if (cancelled_.count(queued.id)) {
+                attack.stop();
+            }
+        }
+
+        std::vector<CandidateResult> results;
+        try {
+            results = attack.attack(job.cribs, [&](const std::string& message) {
+                if (message.compare(0, 9, "Progress:") != 0) {
+                    AttackJobEvent event{AttackJobEvent::Log, queued.id};
+                    event.message = message;
+                    notify(event);
+                }
+            });
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_[queued.id] = nullptr;
+            throw;
+        }
+
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_[queued.id] = nullptr;
+            cancelled = cancelled_.count(queued.id) > 0;
+        }
+
+        std::string cipher = job.cipherText;
+        std::transform(cipher.begin(), cipher.end(), cipher.begin(), ::toupper);
+        cipher.erase(std::remove_if(cipher.begin(), cipher.end(),
+                                    [](char c) { return c < 'A' || c > 'Z'; }),
+                     cipher.end());
+
+        for (const auto& candidate : results) {
+            AttackJobResult result;
+            result.candidate = candidate;
+            if (job.hillClimb && !cancelled) {
+                auto table = pinTable(candidate.rotorOrder, job.reflectorType);
+                PlugboardHillClimber climber(cipher, *table,
+                                             ScramblerTable::stateIndex(candidate.positions), *scorer);
+                climber.setPlugboard(candidate.plugboard);
+                result.plaintextScore = climber.climb();
+                result.climbedPlugboard = climber.getPlugboardPairs();
+                result.plaintext = climber.getPlaintext();
+                result.climbed = true;
+            }
+
+            AttackJobEvent event{AttackJobEvent::Ranked, queued.id};
+            event.result = &result;
+            notify(event);
+        }
+
+        finished.status = cancelled ? "cancelled" : "completed";
+        finished.candidates = attack.getPackedResults().size();
+        finished.stats = attack.getStats();
+    } catch (const std::exception& e) {
+        finished.status = "failed";
+        finished.message = e.what();
+    }
+    if (metrics) {
+        metrics->remove("enigma_job_progress_ratio", jobLabels);
+        metrics->counter("enigma_jobs_finished_total", "Jobs finished, by final status.",
+                         {{"status", finished.status}}).add(1);
+        metrics->counter("enigma_candidates_total", "Candidates found by all jobs (after merging).")
+            .add(static_cast<double>(finished.candidates));
+        if (AttackStats::enabled()) {
+            for (int stage = 0; stage < AttackStats::STAGE_COUNT; stage++) {
+                metrics->counter("enigma_stage_cpu_seconds_total",
+                                 "CPU time per search stage, summed over threads (deduceWiring includes steckerSearch).",
+                                 {{"stage", AttackStats::stageName(stage)}})
+                    .add(finished.stats.stageNanos[stage] / 1e9);
+            }
+        }
+    }
+    ENIGMA_LOG(LogLevel::Info, "job.done")
+        .kv("job", queued.id)
+        .kv("status", finished.status)
+        .kv("candidates", finished.candidates);
+    return finished;
+}
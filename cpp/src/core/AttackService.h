@@ -0,0 +1,145 @@
+#ifndef ATTACK_SERVICE_H
+#define ATTACK_SERVICE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BombeAttack.h"
+#include "MetricsRegistry.h"
+#include "NgramScorer.h"
+#include "ScramblerTable.h"
+
+// 常駐プロセスで受け付けるBombe攻撃ジョブ
+struct AttackJob {
+    int priority = 0;                     // 大きいほど先に実行（同じなら投入順）
+    std::vector<CribEntry> cribs;
+    std::string cipherText;
+    std::vector<std::string> rotorTypes = {"I", "II", "III"};
+    std::string reflectorType = "B";
+    bool testAllOrders = false;
+    bool searchWithoutPlugboard = false;
+    bool mergeEquivalent = true;
+    size_t topResults = 10;               // 返す上位候補数（0なら全件）
+    bool hillClimb = false;               // 上位候補のプラグボードをn-gramで山登りする
+};
+
+// 候補1件（Rankedでは、hillClimbなら山登り後のプラグボードと平文を含む）
+struct AttackJobResult {
+    CandidateResult candidate;
+    bool climbed = false;
+    std::vector<std::pair<char, char>> climbedPlugboard;
+    double plaintextScore = 0.0;
+    std::string plaintext;
+};
+
+struct AttackJobEvent {
+    // Resultは探索中に見つかった順、Rankedは終了後の統合済み上位候補（スコア順）
+    enum Type { Queued, Started, Log, Progress, Result, Ranked, Finished };
+
+    // {type, jobId}だけで作成するので、全メンバーに既定値を持たせる
+    Type type = Queued;
+    uint64_t jobId = 0;
+    std::string message{};                // Log: 進捗メッセージ / Finished: 失敗理由
+    std::string status{};                 // Finished: "completed" | "cancelled" | "failed"
+    long long done = 0;                   // Progress
+    long long total = 0;
+    size_t queuePosition = 0;             // Queued
+    size_t candidates = 0;                // Finished: 統合後の候補数
+    AttackStats stats{};                  // Finished: 段階別カウンタ
+    const AttackJobResult* result = nullptr;  // Result / Ranked（コールバック中のみ有効）
+};
+
+// ジョブを優先度付きキューに積み、共有のワーカーで順に実行する。
+// スクランブラ表は最近使ったものをLRUで保持し、n-gram統計は一度だけ読み込んで
+// ジョブ間で共有するので、2件目以降のジョブは準備処理を払わない
+class AttackService {
+public:
+    using Listener = std::function<void(const AttackJobEvent&)>;
+
+    // workers: 同時に実行するジョブ数、threadsPerJob: 1ジョブのスレッド数（0なら既定）
+    explicit AttackService(int workers = 1, int threadsPerJob = 0);
+    ~AttackService();
+
+    AttackService(const AttackService&) = delete;
+    AttackService& operator=(const AttackService&) = delete;
+
+    void setScorer(const NgramScorer& scorer);
+    void setTableCacheLimit(size_t limit);
+
+    // キューの長さ・実行中のジョブ数・ジョブごとの進捗・処理した位置数・候補数・
+    // 段階別のCPU時間・表キャッシュのヒット数をmetricsに記録する（ジョブを投入する前に呼ぶ）
+    void setMetrics(std::shared_ptr<MetricsRegistry> metrics);
+
+    // 以後に始まるジョブの高速経路を照合する（nullptrで無効）
+    void setShadowValidator(std::shared_ptr<ShadowValidator> validator);
+
+    // ジョブを検証してキューに積み、IDを返す。listenerはワーカースレッドから呼ばれる
+    uint64_t submit(const AttackJob& job, Listener listener);
+
+    // 待機中なら取り除き、実行中なら停止を要求する。該当ジョブがなければfalse
+    bool cancel(uint64_t jobId);
+
+    struct Status {
+        size_t queued;
+        size_t running;
+        size_t cachedTables;
+        uint64_t completed;
+        bool shadowEnabled = false;       // setShadowValidatorで照合中
+        uint64_t shadowChecked = 0;
+        uint64_t shadowMismatches = 0;
+        uint64_t shadowDropped = 0;
+    };
+    Status status() const;
+
+    // 待機中のジョブを取り消し、実行中のジョブを止めてワーカーを終了する
+    void shutdown();
+
+private:
+    struct QueuedJob {
+        uint64_t id;
+        uint64_t sequence;
+        AttackJob job;
+        Listener listener;
+    };
+
+    int threadsPerJob_;
+    size_t tableCacheLimit_ = 64;
+
+    mutable std::mutex mutex_;
+    std::condition_variable hasJob_;
+    std::vector<QueuedJob> queue_;        // std::push_heap/pop_heapで管理
+    std::map<uint64_t, BombeAttack*> running_;
+    std::set<uint64_t> cancelled_;        // 実行中に取り消しを要求されたジョブ
+    uint64_t nextId_ = 1;
+    uint64_t nextSequence_ = 0;
+    uint64_t completed_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    std::shared_ptr<const NgramScorer> scorer_;
+    std::shared_ptr<ShadowValidator> shadow_;
+    std::shared_ptr<MetricsRegistry> metrics_;
+    int metricsCollector_ = 0;
+
+    // 保持中のスクランブラ表（先頭が最近使ったもの）
+    mutable std::mutex cacheMutex_;
+    std::list<std::pair<std::string, std::shared_ptr<const ScramblerTable>>> tableCache_;
+
+    static bool runsAfter(const QueuedJob& a, const QueuedJob& b);
+
+    void workerLoop();
+    AttackJobEvent runJob(QueuedJob& queued);  // 完了イベントを返す
+    void countTableLookup(bool hit);
+    std::shared_ptr<const ScramblerTable> pinTable(const std::vector<std::string>& rotorOrder,
+                                                   const std::string& reflectorType);
+};
+
+#endif // ATTACK_SERVICE_H
@@ -0,0 +1,93 @@
+#include "AttackStats.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+void AttackStats::merge(const AttackStats& other) {
+    positionsTested += other.positionsTested;
+    noPlugboardMatches += other.noPlugboardMatches;
+    propagationConflicts += other.propagationConflicts;
+    steckerHypotheses += other.steckerHypotheses;
+    diagonalBoardRejections += other.diagonalBoardRejections;
+    verificationEncryptions += other.verificationEncryptions;
+    candidatesEmitted += other.candidatesEmitted;
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        stageNanos[stage] += other.stageNanos[stage];
+    }
+}
+
+const char* AttackStats::stageName(int stage) {
+    switch (stage) {
+        case DeduceWiring: return "deduceWiring";
+        case SteckerSearch: return "steckerSearch";
+        case Verification: return "verification";
+        case Emit: return "emit";
+        case Finalize: return "finalize";
+        default: return "unknown";
+    }
+}
+
+std::vector<std::pair<std::string, uint64_t>> AttackStats::fields() const {
+    std::vector<std::pair<std::string, uint64_t>> values = {
+        {"positionsTested", positionsTested},
+        {"noPlugboardMatches", noPlugboardMatches},
+        {"propagationConflicts", propagationConflicts},
+        {"steckerHypotheses", steckerHypotheses},
+        {"diagonalBoardRejections", diagonalBoardRejections},
+        {"verificationEncryptions", verificationEncryptions},
+        {"candidatesEmitted", candidatesEmitted},
+    };
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        values.emplace_back(std::string(stageName(stage)) + "Nanos", stageNanos[stage]);
+    }
+    return values;
+}
+
+std::string AttackStats::summary() const {
+    std::ostringstream oss;
+    oss << "Counters: positions=" << positionsTested
+        << " noPlugboardMatches=" << noPlugboardMatches
+        << " conflicts=" << propagationConflicts
+        << " hypotheses=" << steckerHypotheses
+        << " diagonalRejections=" << diagonalBoardRejections
+        << " verifications=" << verificationEncryptions
+        << " candidates=" << candidatesEmitted;
+    // 段階の時間はスレッドの合計（CPU時間に近い）
+    oss << std::fixed << std::setprecision(3) << " | cpu seconds:";
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        oss << " " << stageName(stage) << "=" << stageNanos[stage] / 1e9;
+    }
+    return oss.str();
+}
+
+const char* AttackHardwareCounters::stageName(int stage) {
+    switch (stage) {
+        case TableBuild: return "tableBuild";
+        case Search: return "search";
+        case Finalize: return "finalize";
+        default: return "unknown";
+    }
+}
+
+std::string AttackHardwareCounters::summary() const {
+    if (!available) {
+        return "Hardware counters unavailable: " + reason;
+    }
+    const PerfReading& search = stages[Search];
+    if (search.empty()) {
+        return "Hardware counters returned no samples";
+    }
+    std::ostringstream oss;
+    oss << "Hardware counters (search, per position):";
+    double positions = static_cast<double>((std::max)(positionsTested, static_cast<uint64_t>(1)));
+    oss << std::fixed << std::setprecision(1);
+    for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+        if (search.has(event)) {
+            oss << " " << PerfCounters::eventName(event) << "=" << search.values[event] / positions;
+        }
+    }
+    if (search.ipc() > 0) {
+        oss << std::setprecision(2) << " ipc=" << search.ipc();
+    }
+    return oss.str();
+}
@@ -0,0 +1,108 @@
+#ifndef ATTACK_STATS_H
+#define ATTACK_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PerfCounters.h"
+
+// Bombe攻撃の各段階のカウンタ。探索スレッドごとに1つ持ち、終了時に合算する。
+// ENIGMA_ENABLE_COUNTERSが未定義のビルドでは計測マクロが空になり、値はすべて0のまま
+struct alignas(64) AttackStats {
+    // 処理時間を計る段階（deduceWiringはsteckerSearchを含む）
+    enum Stage {
+        DeduceWiring,     // deducePlugboardWiring全体
+        SteckerSearch,    // ステッカー仮説の総当たり（Diagonal Board・検証を含む）
+        Verification,     // testPositionの最終検証
+        Emit,             // 候補のsinkへの書き出し・保存
+        Finalize,         // 整列と同値統合
+        STAGE_COUNT
+    };
+
+    uint64_t positionsTested = 0;          // testPositionの呼び出し数
+    uint64_t noPlugboardMatches = 0;       // プラグボードなしで一致した位置
+    uint64_t propagationConflicts = 0;     // propagateConstraintsの矛盾
+    uint64_t steckerHypotheses = 0;        // 試したステッカー仮説
+    uint64_t diagonalBoardRejections = 0;  // Diagonal Boardで棄却した仮説
+    uint64_t verificationEncryptions = 0;  // 検証のための暗号化
+    uint64_t candidatesEmitted = 0;        // 候補として出力した数
+    uint64_t stageNanos[STAGE_COUNT] = {};
+
+    static constexpr bool enabled() {
+#ifdef ENIGMA_ENABLE_COUNTERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void merge(const AttackStats& other);
+
+    static const char* stageName(int stage);
+
+    // 名前と値の組（JSONなどへの出力用。段階の時間は"<stage>Nanos"）
+    std::vector<std::pair<std::string, uint64_t>> fields() const;
+
+    // 進捗ログ用の1行
+    std::string summary() const;
+};
+
+// BombeAttack::setHardwareCounters(true)のときの段階ごとのハードウェアカウンタ。
+// 計測はsyscallを伴うので段階の境目でだけ読み、位置ごとの値はSearchを位置数で割って求める
+struct AttackHardwareCounters {
+    enum Stage {
+        TableBuild,   // スクランブラ表の作成・読み込み
+        Search,       // 並列探索（全スレッドの合計）
+        Finalize,     // 整列と同値統合
+        STAGE_COUNT
+    };
+
+    bool requested = false;
+    bool available = false;
+    std::string reason;            // 開けなかったイベントがあればその理由
+    PerfReading stages[STAGE_COUNT];
+    uint64_t positionsTested = 0;  // 開始位置×クリブ×オフセットの数
+
+    static const char* stageName(int stage);
+
+    // 進捗ログ用の1行（Searchの位置あたりの値とIPC）
+    std::string summary() const;
+};
+
+#ifdef ENIGMA_ENABLE_COUNTERS
+
+// スコープを抜けるときに経過時間を段階に加算する
+class AttackStageTimer {
+public:
+    AttackStageTimer(AttackStats& stats, AttackStats::Stage stage)
+        : stats_(stats), stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~AttackStageTimer() {
+        stats_.stageNanos[stage_] += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+    }
+
+private:
+    AttackStats& stats_;
+    AttackStats::Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define ENIGMA_STATS_CONCAT_(a, b) a##b
+#define ENIGMA_STATS_CONCAT(a, b) ENIGMA_STATS_CONCAT_(a, b)
+#define ENIGMA_COUNT(stats, field) ((stats).field++)
+#define ENIGMA_COUNT_ADD(stats, field, n) ((stats).field += (n))
+#define ENIGMA_STAGE_TIMER(stats, stage) \
+    AttackStageTimer ENIGMA_STATS_CONCAT(attackStageTimer_, __LINE__)((stats), AttackStats::stage)
+
+#else
+
+#define ENIGMA_COUNT(stats, field) ((void)0)
+#define ENIGMA_COUNT_ADD(stats, field, n) ((void)0)
+#define ENIGMA_STAGE_TIMER(stats, stage) ((void)0)
+
+#endif
+
+#endif // ATTACK_STATS_H
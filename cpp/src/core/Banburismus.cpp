@@ -0,0 +1,399 @@
+#include "Banburismus.h"
+#include "RotorConfig.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENIGMA_BANBURISMUS_SSE2 1
+#endif
+
+namespace {
+
+// 同じ状態で暗号化された2文字が一致する確率（ドイツ語の平文）と偶然の一致確率
+const double DEPTH_REPEAT_RATE = 1.0 / 17.0;
+const double RANDOM_REPEAT_RATE = 1.0 / 26.0;
+
+// これより短い重なりは評価しない
+const int MIN_OVERLAP = 20;
+
+std::vector<uint8_t> normalizeText(const std::string& text) {
+    std::vector<uint8_t> result;
+    result.reserve(text.size());
+    for (char c : text) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (c >= 'A' && c <= 'Z') result.push_back(static_cast<uint8_t>(c - 'A'));
+    }
+    return result;
+}
+
+// 右ローター側の指標の文字を鍵の相対位置でつなぐ重み付きUnion-Find
+struct OffsetUnionFind {
+    std::array<int, 26> parent;
+    std::array<int, 26> weight;   // 鍵(x) = 鍵(parent[x]) + weight[x]
+
+    OffsetUnionFind() {
+        for (int i = 0; i < 26; i++) {
+            parent[i] = i;
+            weight[i] = 0;
+        }
+    }
+
+    int find(int x, int& offset) {
+        offset = 0;
+        while (parent[x] != x) {
+            offset += weight[x];
+            x = parent[x];
+        }
+        offset %= 26;
+        return x;
+    }
+
+    // 鍵(y) = 鍵(x) + d を追加する。既存の鎖と矛盾すればfalse
+    bool unite(int x, int y, int d) {
+        int wx, wy;
+        int rx = find(x, wx);
+        int ry = find(y, wy);
+        if (rx == ry) {
+            return ((wy - wx - d) % 26 + 26) % 26 == 0;
+        }
+        parent[ry] = rx;
+        weight[ry] = ((wx + d - wy) % 26 + 26) % 26;
+        return true;
+    }
+};
+
+} // namespace
+
+std::string BanburismusChain::toString() const {
+    // 鍵の相対位置の順に並べ、空きは'-'で表す
+    std::string line(26, '-');
+    for (size_t i = 0; i < letters.size(); i++) {
+        line[keyOffsets[i]] = letters[i];
+    }
+    while (!line.empty() && line.back() == '-') {
+        line.pop_back();
+    }
+    return line;
+}
+
+bool BanburismusResult::allowsRotorOrder(const std::vector<std::string>& order) const {
+    if (order.empty()) return false;
+    return std::find(rightRotorCandidates.begin(), rightRotorCandidates.end(), order[0]) !=
+           rightRotorCandidates.end();
+}
+
+bool BanburismusResult::allowsStart(const std::vector<std::string>& order,
+                                    char indicatorLetter,
+                                    int rightPosition) const {
+    if (order.empty()) return false;
+    auto it = rightKeyMasks.find(order[0]);
+    if (it == rightKeyMasks.end()) return false;
+
+    int letter = std::toupper(static_cast<unsigned char>(indicatorLetter)) - 'A';
+    if (letter < 0 || letter >= 26) return true;
+    return (it->second[letter] >> rightPosition) & 1;
+}
+
+std::function<bool(const std::vector<std::string>&)> BanburismusResult::rotorOrderFilter() const {
+    auto result = std::make_shared<BanburismusResult>();
+    result->rightRotorCandidates = rightRotorCandidates;
+    return [result](const std::vector<std::string>& order) { return result->allowsRotorOrder(order); };
+}
+
+std::function<bool(const std::vector<std::string>&, const std::vector<int>&)>
+BanburismusResult::startPositionFilter(const std::string& indicator) const {
+    if (indicator.empty()) {
+        throw std::invalid_argument("指標が空です");
+    }
+    auto result = std::make_shared<BanburismusResult>();
+    result->rightKeyMasks = rightKeyMasks;
+    char letter = indicator[0];
+    return [result, letter](const std::vector<std::string>& order, const std::vector<int>& positions) {
+        return !positions.empty() && result->allowsStart(order, letter, positions[0]);
+    };
+}
+
+int BanburismusResult::countAllowedKeys(const std::string& rightRotor, char indicatorLetter) const {
+    auto it = rightKeyMasks.find(rightRotor);
+    if (it == rightKeyMasks.end()) return 0;
+
+    int letter = std::toupper(static_cast<unsigned char>(indicatorLetter)) - 'A';
+    if (letter < 0 || letter >= 26) return 26;
+    uint32_t mask = it->second[letter];
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) count++;
+    return count;
+}
+
+Banburismus::Banburismus(const std::vector<BanburismusMessage>& messages,
+                         const std::vector<std::string>& rotorTypes)
+    : rotorTypes_(rotorTypes) {
+    for (const auto& type : rotorTypes_) {
+        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
+            throw std::invalid_argument("無効なローター: " + type);
+        }
+    }
+
+    for (const auto& message : messages) {
+        std::vector<uint8_t> indicator = normalizeText(message.indicator);
+        if (indicator.size() != 3) {
+            throw std::invalid_argument("指標は3文字である必要があります: " + message.indicator);
+        }
+        std::string letters;
+        for (uint8_t c : indicator) letters += static_cast<char>('A' + c);
+        indicators_.push_back(letters);
+        texts_.push_back(normalizeText(message.cipherText));
+    }
+}
+
+double Banburismus::repeatWeight() {
+    return 10.0 * std::log10(DEPTH_REPEAT_RATE / RANDOM_REPEAT_RATE);
+}
+
+double Banburismus::blankWeight() {
+    return 10.0 * std::log10((1.0 - DEPTH_REPEAT_RATE) / (1.0 - RANDOM_REPEAT_RATE));
+}
+
+int Banburismus::countRepeats(const uint8_t* a, const uint8_t* b, int length) {
+    int count = 0;
+    int i = 0;
+#ifdef ENIGMA_BANBURISMUS_SSE2
+    // 一致したバイトは0xFF(-1)になるので、引き算でバイトごとに数え、
+    // 255ブロックごとにSADで横方向に合計する
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= length) {
+        __m128i counts = zero;
+        int blocks = 0;
+        for (; i + 16 <= length && blocks < 255; i += 16, blocks++) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(va, vb));
+        }
+        __m128i sums = _mm_sad_epu8(counts, zero);
+        count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+    for (; i < length; i++) {
+        count += a[i] == b[i];
+    }
+    return count;
+}
+
+BanburismusResult Banburismus::analyze(std::function<void(const std::string&)> progressCallback) {
+    stopFlag_ = false;
+    BanburismusResult result;
+
+    const int numMessages = static_cast<int>(texts_.size());
+    const double repeat = repeatWeight();
+    const double blank = blankWeight();
+    std::mutex resultsMutex;
+    long long pairsCompared = 0;
+    long long offsetsCompared = 0;
+
+    // 指標の右側の文字の組(x, y)ごとに「鍵(y) - 鍵(x) = d」のデシバンを合計する
+    // （中・左が同じ組はすべて同じ換字を通るので、証拠を足し合わせられる）
+    std::vector<double> evidence(26 * 26 * 26, 0.0);
+
+    if (progressCallback) {
+        progressCallback("Comparing " + std::to_string(static_cast<long long>(numMessages) * (numMessages - 1) / 2) +
+                         " message pairs at offsets up to " + std::to_string(maxOffset_));
+    }
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:pairsCompared, offsetsCompared)
+    for (int i = 0; i < numMessages; i++) {
+        if (stopFlag_) continue;
+
+        std::vector<BanburismusAlignment> local;
+        std::vector<double> localEvidence;
+        const auto& a = texts_[i];
+        for (int j = i + 1; j < numMessages; j++) {
+            const auto& b = texts_[j];
+            bool sameWheels = indicators_[i][1] == indicators_[j][1] &&
+                              indicators_[i][2] == indicators_[j][2];
+            BanburismusAlignment best{};
+            best.decibans = -1e9;
+            std::array<double, 26> residueBest;
+            residueBest.fill(-1e9);
+
+            for (int d = -maxOffset_; d <= maxOffset_; d++) {
+                // d >= 0: bの先頭がaのd文字目に重なる / d < 0: aの先頭がbの-d文字目に重なる
+                const uint8_t* pa = a.data() + (d > 0 ? d : 0);
+                const uint8_t* pb = b.data() + (d < 0 ? -d : 0);
+                int overlap = (std::min)(static_cast<int>(a.size()) - (d > 0 ? d : 0),
+                                         static_cast<int>(b.size()) - (d < 0 ? -d : 0));
+                if (overlap < MIN_OVERLAP) continue;
+
+                int repeats = countRepeats(pa, pb, overlap);
+                double score = repeats * repeat + (overlap - repeats) * blank;
+                offsetsCompared++;
+                if (score > best.decibans) {
+                    best = {static_cast<size_t>(i), static_cast<size_t>(j), d, overlap, repeats, score, sameWheels};
+                }
+                int residue = ((d % 26) + 26) % 26;
+                residueBest[residue] = (std::max)(residueBest[residue], score);
+            }
+            pairsCompared++;
+
+            if (best.decibans >= threshold_) {
+                local.push_back(best);
+            }
+
+            int x = indicators_[i][0] - 'A';
+            int y = indicators_[j][0] - 'A';
+            if (sameWheels && x != y) {
+                if (localEvidence.empty()) localEvidence.assign(evidence.size(), 0.0);
+                for (int residue = 0; residue < 26; residue++) {
+                    if (residueBest[residue] > -1e9) {
+                        localEvidence[(x * 26 + y) * 26 + residue] += residueBest[residue];
+                    }
+                }
+            }
+        }
+
+        if (!local.empty() || !localEvidence.empty()) {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            result.alignments.insert(result.alignments.end(), local.begin(), local.end());
+            for (size_t k = 0; k < localEvidence.size(); k++) {
+                evidence[k] += localEvidence[k];
+            }
+        }
+    }
+
+    std::sort(result.alignments.begin(), result.alignments.end());
+    result.pairsCompared = pairsCompared;
+    result.offsetsCompared = offsetsCompared;
+
+    buildChains(evidence, result);
+
+    if (progressCallback) {
+        progressCallback("Banburismus complete: " + std::to_string(result.alignments.size()) +
+                         " alignments, " + std::to_string(result.chains.size()) + " chains, " +
+                         std::to_string(result.conflicts) + " conflicts");
+    }
+    return result;
+}
+
+void Banburismus::buildChains(const std::vector<double>& evidence, BanburismusResult& result) const {
+    // 文字の組ごとに最も確からしいずれを選ぶ（(x, y)のdと(y, x)の-dは同じ仮説）
+    struct Link {
+        int x;
+        int y;
+        int offset;
+        double decibans;
+    };
+    std::vector<Link> links;
+    for (int x = 0; x < 26; x++) {
+        for (int y = x + 1; y < 26; y++) {
+            Link best{x, y, 0, -1e9};
+            for (int d = 0; d < 26; d++) {
+                double score = evidence[(x * 26 + y) * 26 + d] + evidence[(y * 26 + x) * 26 + (26 - d) % 26];
+                if (score > best.decibans) {
+                    best.offset = d;
+                    best.decibans = score;
+                }
+            }
+            if (best.decibans >= threshold_) {
+                links.push_back(best);
+            }
+        }
+    }
+    std::sort(links.begin(), links.end(), [](const Link& a, const Link& b) {
+        return a.decibans > b.decibans;
+    });
+
+    // スコアの高い組から鎖につなぎ、矛盾する組は捨てる
+    OffsetUnionFind chains;
+    for (const auto& link : links) {
+        if (!chains.unite(link.x, link.y, link.offset)) {
+            result.conflicts++;
+        }
+    }
+
+    for (int root = 0; root < 26; root++) {
+        BanburismusChain chain;
+        for (int c = 0; c < 26; c++) {
+            int offset;
+            if (chains.find(c, offset) == root) {
+                chain.letters.push_back(static_cast<char>('A' + c));
+                chain.keyOffsets.push_back(offset);
+            }
+        }
+        if (chain.letters.size() < 2) continue;
+
+        // 最初の文字を基準に並べ直す
+        int base = chain.keyOffsets[0];
+        for (auto& offset : chain.keyOffsets) {
+            offset = ((offset - base) % 26 + 26) % 26;
+        }
+        result.chains.push_back(chain);
+    }
+
+    // 鎖と一致する重なりでは中ローターが進んでいない
+    // 先に始まる側の右ローターの鍵をstartとすると、ノッチは(start, start + length]にない
+    struct NotchConstraint {
+        int root;
+        int start;    // 鎖の基準からのずれ
+        int length;
+    };
+    std::vector<NotchConstraint> constraints;
+    for (const auto& alignment : result.alignments) {
+        if (!alignment.sameWheels || alignment.offset == 0 || std::abs(alignment.offset) >= 26) continue;
+
+        int x = indicators_[alignment.first][0] - 'A';
+        int y = indicators_[alignment.second][0] - 'A';
+        int wx, wy;
+        int rx = chains.find(x, wx);
+        int ry = chains.find(y, wy);
+        if (rx != ry || ((wy - wx - alignment.offset) % 26 + 26) % 26 != 0) continue;
+
+        if (alignment.offset > 0) {
+            constraints.push_back({rx, wx, alignment.offset});
+        } else {
+            constraints.push_back({rx, wy, -alignment.offset});
+        }
+    }
+
+    // 右ローターごとに、各鎖の基準の鍵を26通り試してノッチの制約を満たすか調べる
+    // ノッチの位置はローターごとに異なるので、ローターを仮定すると鍵の絶対位置が絞られる
+    const uint32_t allKeys = (1u << 26) - 1;
+    for (const auto& type : rotorTypes_) {
+        int notch = enigma::ROTOR_DEFINITIONS.at(type).getFirstNotch();
+        std::array<uint32_t, 26> rootMasks;
+        rootMasks.fill(allKeys);
+        bool allowed = true;
+
+        for (const auto& constraint : constraints) {
+            for (int key = 0; key < 26; key++) {
+                int start = (key + constraint.start) % 26;
+                int distance = ((notch - start) % 26 + 26) % 26;
+                if (distance >= 1 && distance <= constraint.length) {
+                    rootMasks[constraint.root] &= ~(1u << key);
+                }
+            }
+        }
+
+        std::array<uint32_t, 26> letterMasks;
+        for (int c = 0; c < 26; c++) {
+            int offset;
+            int root = chains.find(c, offset);
+            uint32_t mask = 0;
+            for (int key = 0; key < 26; key++) {
+                if (rootMasks[root] & (1u << key)) {
+                    mask |= 1u << ((key + offset) % 26);
+                }
+            }
+            letterMasks[c] = mask;
+            allowed = allowed && mask != 0;
+        }
+
+        if (allowed) {
+            result.rightRotorCandidates.push_back(type);
+            result.rightKeyMasks[type] = letterMasks;
+        }
+    }
+}
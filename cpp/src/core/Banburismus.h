@@ -0,0 +1,105 @@
+#ifndef BANBURISMUS_H
+#define BANBURISMUS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// 同じ日の1通。indicatorは基本位置で暗号化されたメッセージ鍵（3文字、
+// EnigmaMachine::setRotorPositionsと同じ並び）で、文字ごとに固定の換字になる
+struct BanburismusMessage {
+    std::string indicator;
+    std::string cipherText;
+};
+
+// 2通を重ねたときの最良のずらし（secondの先頭がfirstのoffset文字目に重なる）
+struct BanburismusAlignment {
+    size_t first;
+    size_t second;
+    int offset;
+    int overlap;
+    int repeats;
+    double decibans;
+    bool sameWheels;   // 指標の中・左の文字が同じ（右ローターのずれとして解釈できる）
+
+    bool operator<(const BanburismusAlignment& other) const {
+        return decibans > other.decibans; // Descending order
+    }
+};
+
+// 指標の右ローター側の文字を、鍵の相対位置でつないだ鎖
+// 組ごとのずれの証拠を文字の組ごとに合計し、スコアの高い順につなぐ
+struct BanburismusChain {
+    std::vector<char> letters;
+    std::vector<int> keyOffsets;   // letters[0]の鍵の文字からのずれ
+    std::string toString() const;
+};
+
+struct BanburismusResult {
+    std::vector<BanburismusAlignment> alignments;   // しきい値以上の組（降順）
+    std::vector<BanburismusChain> chains;
+    int conflicts = 0;                               // 鎖と矛盾して捨てた文字の組
+    std::vector<std::string> rightRotorCandidates;   // ノッチ位置が矛盾しない右ローター
+    // 右ローターごと・指標の右側の文字ごとに、ありうる右ローターの鍵（26ビット）
+    std::map<std::string, std::array<uint32_t, 26>> rightKeyMasks;
+    long long pairsCompared = 0;
+    long long offsetsCompared = 0;
+
+    // BombeAttack::setRotorOrderFilterに渡す判定（order[0]が右ローター）
+    bool allowsRotorOrder(const std::vector<std::string>& order) const;
+
+    // 指標の右側がindicatorLetterのメッセージが、右ローターの鍵rightPositionで
+    // 始まりうるか（BombeAttack::setStartPositionFilterに渡す）
+    bool allowsStart(const std::vector<std::string>& order, char indicatorLetter, int rightPosition) const;
+    int countAllowedKeys(const std::string& rightRotor, char indicatorLetter) const;
+
+    // BombeAttack::setRotorOrderFilter / setStartPositionFilterにそのまま渡せる判定。
+    // 必要な結果を複製して持つので、このオブジェクトより長く使ってよい
+    std::function<bool(const std::vector<std::string>&)> rotorOrderFilter() const;
+    // indicatorはBombeで解くメッセージの指標（先頭が右側の文字）。positions[0]を右ローターの鍵とみなす
+    std::function<bool(const std::vector<std::string>&, const std::vector<int>&)>
+        startPositionFilter(const std::string& indicator) const;
+};
+
+// Banburismus: 同じ日の通信を2通ずつずらして重ね、同じ文字の一致（repeat）を数える。
+// 同じ状態で暗号化された部分では平文の一致率（約1/17）がそのまま現れ、
+// ずれていればほぼ1/26になるので、一致数をデシバンで評価する。
+// 中・左の指標が同じ組のずれは右ローターの鍵の差なので、鎖につないで
+// 指標の換字の相対位置を求め、さらに「重なっている区間で中ローターが
+// 進んでいない」ことから、右ローターを仮定したときの鍵の位置を絞り込む
+class Banburismus {
+public:
+    Banburismus(const std::vector<BanburismusMessage>& messages,
+                const std::vector<std::string>& rotorTypes);
+
+    // 試すずらしの範囲（±maxOffset）と採用するしきい値（デシバン）
+    void setMaxOffset(int maxOffset) { maxOffset_ = maxOffset; }
+    void setThreshold(double decibans) { threshold_ = decibans; }
+
+    BanburismusResult analyze(std::function<void(const std::string&)> progressCallback = nullptr);
+
+    void stop() { stopFlag_ = true; }
+
+    // 一致1つ・不一致1つあたりのデシバン
+    static double repeatWeight();
+    static double blankWeight();
+
+    // aとbの先頭lengthバイトのうち等しいものの数（SIMDで比較）
+    static int countRepeats(const uint8_t* a, const uint8_t* b, int length);
+
+private:
+    std::vector<std::string> indicators_;
+    std::vector<std::vector<uint8_t>> texts_;
+    std::vector<std::string> rotorTypes_;
+    int maxOffset_ = 25;
+    double threshold_ = 20.0;
+    std::atomic<bool> stopFlag_{false};
+
+    void buildChains(const std::vector<double>& evidence, BanburismusResult& result) const;
+};
+
+#endif // BANBURISMUS_H
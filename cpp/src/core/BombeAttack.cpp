@@ -4,6 +4,8 @@
 #include "Reflector.h"
 #include "Plugboard.h"
 #include "RotorConfig.h"
+#include "Logger.h"
+#include "TuningConfig.h"
 #include <algorithm>
 #include <cctype>
 #include <thread>
@@ -20,6 +22,9 @@
 #include <mutex>
 #include <iomanip>
 #include <cmath>
+#include <array>
+#include <exception>
+#include <stdexcept>
 
 #ifdef _WIN32
 #define NOMINMAX  // Windowsのmin/maxマクロを無効化
@@ -35,23 +40,6 @@
 #include <CL/cl.h>
 #endif
 
-// デバッグログファイル
-static std::ofstream debugLog;
-static std::mutex debugLogMutex;
-
-void writeDebugLog(const std::string& message) {
-    std::lock_guard<std::mutex> lock(debugLogMutex);
-    if (!debugLog.is_open()) {
-        debugLog.open("bombe_debug.log", std::ios::app);
-        debugLog << "\n=== New Debug Session ===" << std::endl;
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
-        debugLog << "Time: " << std::put_time(&tm, "%d-%m-%Y %H:%M:%S") << std::endl;
-    }
-    debugLog << message << std::endl;
-    debugLog.flush();
-}
-
 BombeAttack::BombeAttack(const std::string& cribText, 
                          const std::string& cipherText,
                          const std::vector<std::string>& rotorTypes,
@@ -65,63 +53,339 @@ BombeAttack::BombeAttack(const std::string& cribText,
     std::transform(cribText_.begin(), cribText_.end(), cribText_.begin(), ::toupper);
     std::transform(cipherText_.begin(), cipherText_.end(), cipherText_.begin(), ::toupper);
     
+    // A-Z以外の文字は除去（スクランブラ表の添字として使うため）
+    auto notLetter = [](char c) { return c < 'A' || c > 'Z'; };
+    cribText_.erase(std::remove_if(cribText_.begin(), cribText_.end(), notLetter), cribText_.end());
+    cipherText_.erase(std::remove_if(cipherText_.begin(), cipherText_.end(), notLetter), cipherText_.end());
+    
     // CPU数に基づいてスレッド数を設定（ただし最大でCPU数の75%）
     unsigned int hwThreads = std::thread::hardware_concurrency();
     maxThreads_ = static_cast<int>((std::max)(1u, (hwThreads * 3) / 4));
     
+    // このホストで測定済みならその設定を使う（EnigmaSimulatorCpp tune）
+    if (auto tuning = TuningConfig::getDefault()) {
+        if (tuning->threads > 0) {
+            maxThreads_ = tuning->threads;
+        }
+        chunkSize_ = tuning->chunkSize;
+    }
+    
     // GPU初期化を試みる
     useGPU_ = initializeGPU();
 }
 
 BombeAttack::~BombeAttack() {
     cleanupGPU();
-    
-    // ログファイルを閉じる
-    std::lock_guard<std::mutex> lock(debugLogMutex);
-    if (debugLog.is_open()) {
-        debugLog.close();
+}
+
+namespace {
+
+// ペアの並びから対合の配列を作る
+std::array<char, 26> makePlugboardArray(const std::vector<std::pair<char, char>>& pairs) {
+    std::array<char, 26> plug;
+    for (int i = 0; i < 26; i++) {
+        plug[i] = static_cast<char>('A' + i);
+    }
+    for (const auto& [a, b] : pairs) {
+        plug[a - 'A'] = b;
+        plug[b - 'A'] = a;
+    }
+    return plug;
+}
+
+// 状態列（暗号化時の各文字位置の状態）を使ってクリブを暗号化する
+std::string encryptWithTable(const ScramblerTable& table,
+                             const std::vector<int>& states,
+                             int offset,
+                             const std::string& crib,
+                             const std::array<char, 26>& plug) {
+    std::string result(crib.length(), 'A');
+    for (size_t i = 0; i < crib.length(); i++) {
+        const uint8_t* perm = table.perm(states[offset + i]);
+        char c = plug[crib[i] - 'A'];
+        c = static_cast<char>('A' + perm[c - 'A']);
+        result[i] = plug[c - 'A'];
     }
+    return result;
 }
 
+} // namespace
+
 std::vector<CandidateResult> BombeAttack::attack(
     std::function<void(const std::string&)> progressCallback) {
+    return attack(std::vector<CribEntry>{CribEntry{cribText_, -1}}, progressCallback);
+}
+
+long long BombeAttack::resolveCribOffsets(
+    const std::vector<CribEntry>& cribs,
+    std::vector<std::string>& cribTexts,
+    std::vector<std::vector<int>>& cribOffsets) const {
+    
+    long long offsetsPerPosition = 0;
+    for (const auto& entry : cribs) {
+        std::string text = entry.text;
+        std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+        text.erase(std::remove_if(text.begin(), text.end(),
+                                  [](char c) { return c < 'A' || c > 'Z'; }),
+                   text.end());
+        // 一致数は候補レコードのフィールドに収まる長さまで（黙って切り詰めると結果のクリブが変わる）
+        if (text.length() > static_cast<size_t>(PackedCandidate::MAX_CRIB_LENGTH)) {
+            throw std::invalid_argument("クリブが長すぎます（" + std::to_string(text.length()) + "文字、最大" +
+                                        std::to_string(PackedCandidate::MAX_CRIB_LENGTH) + "文字）");
+        }
+        
+        std::vector<int> offsets;
+        if (!text.empty() && text.length() <= cipherText_.length()) {
+            int maxOffset = static_cast<int>(cipherText_.length() - text.length() + 1);
+            if (entry.position >= 0) {
+                if (entry.position < maxOffset) {
+                    offsets.push_back(entry.position);
+                }
+            } else {
+                for (int offset = 0; offset < maxOffset; offset++) {
+                    offsets.push_back(offset);
+                }
+            }
+        }
+        
+        offsetsPerPosition += offsets.size();
+        cribTexts.push_back(text);
+        cribOffsets.push_back(offsets);
+    }
+    return offsetsPerPosition;
+}
+
+int BombeAttack::resolveThreadCount() const {
+    return explicitThreads_ ? maxThreads_
+                            : (std::min)(maxThreads_, static_cast<int>(omp_get_max_threads()));
+}
+
+int BombeAttack::menuClosures(const std::string& crib, const std::string& cipherPart) {
+    // 素集合で連結成分を数える
+    int parent[26];
+    bool used[26] = {};
+    for (int i = 0; i < 26; i++) {
+        parent[i] = i;
+    }
+    auto find = [&parent](int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    
+    int links = 0;
+    size_t length = (std::min)(crib.length(), cipherPart.length());
+    for (size_t i = 0; i < length; i++) {
+        int a = crib[i] - 'A';
+        int b = cipherPart[i] - 'A';
+        used[a] = used[b] = true;
+        parent[find(a)] = find(b);
+        links++;
+    }
+    int letters = 0;
+    int components = 0;
+    for (int i = 0; i < 26; i++) {
+        if (used[i]) {
+            letters++;
+            if (find(i) == i) {
+                components++;
+            }
+        }
+    }
+    return links - letters + components;
+}
+
+AttackEstimate BombeAttack::estimate(const std::vector<CribEntry>& cribs, int sampleStates) {
+    AttackEstimate estimate;
+    
+    std::vector<std::vector<std::string>> rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes_, testAllOrders_);
+    if (rotorOrderFilter_) {
+        rotorOrders.erase(std::remove_if(rotorOrders.begin(), rotorOrders.end(),
+            [this](const std::vector<std::string>& order) { return !rotorOrderFilter_(order); }),
+            rotorOrders.end());
+    }
     
-    progressCallback_ = progressCallback;
+    std::vector<std::string> cribTexts;
+    std::vector<std::vector<int>> cribOffsets;
+    estimate.offsetsPerPosition = resolveCribOffsets(cribs, cribTexts, cribOffsets);
+    estimate.rotorOrders = rotorOrders.size();
+    estimate.threads = resolveThreadCount();
+    
+    // 攻撃と同じ開始位置フィルタを通った位置だけを数え、標本もそこから選ぶ
+    std::vector<std::vector<int>> allowedStates(rotorOrders.size());
+    long long startStates = 0;
+    for (size_t orderIdx = 0; orderIdx < rotorOrders.size(); orderIdx++) {
+        if (!startPositionFilter_) {
+            startStates += ScramblerTable::NUM_STATES;
+            continue;
+        }
+        for (int state = 0; state < ScramblerTable::NUM_STATES; state++) {
+            if (startPositionFilter_(rotorOrders[orderIdx], ScramblerTable::statePositions(state))) {
+                allowedStates[orderIdx].push_back(state);
+            }
+        }
+        startStates += static_cast<long long>(allowedStates[orderIdx].size());
+    }
+    estimate.totalPositions = startStates * estimate.offsetsPerPosition;
+    
+    // メニューの統計。エニグマは文字を自分自身に暗号化しないので、
+    // クリブと暗号文の文字が一致するオフセットは決して正解にならない
+    double stopsPerOrder = 0.0;
+    bool firstMenu = true;
+    for (size_t cribIdx = 0; cribIdx < cribTexts.size(); cribIdx++) {
+        const std::string& crib = cribTexts[cribIdx];
+        int impossible = 0;
+        for (int offset : cribOffsets[cribIdx]) {
+            std::string cipherPart = cipherText_.substr(offset, crib.length());
+            bool selfEncrypted = false;
+            for (size_t i = 0; i < crib.length(); i++) {
+                selfEncrypted = selfEncrypted || crib[i] == cipherPart[i];
+            }
+            if (selfEncrypted) {
+                impossible++;
+            }
+            int closures = menuClosures(crib, cipherPart);
+            estimate.minClosures = firstMenu ? closures : (std::min)(estimate.minClosures, closures);
+            estimate.maxClosures = firstMenu ? closures : (std::max)(estimate.maxClosures, closures);
+            firstMenu = false;
+            stopsPerOrder += ScramblerTable::NUM_STATES * std::pow(26.0, 1 - (std::min)(closures, 8));
+        }
+        if (cribOffsets[cribIdx].empty()) {
+            estimate.warnings.push_back("Crib " + crib + " does not fit into the cipher text");
+        } else if (impossible == static_cast<int>(cribOffsets[cribIdx].size())) {
+            estimate.warnings.push_back("Crib " + crib + " encrypts a letter to itself at every offset tried");
+        } else if (impossible > 0) {
+            estimate.warnings.push_back("Crib " + crib + " is impossible at " + std::to_string(impossible) +
+                                        " of " + std::to_string(cribOffsets[cribIdx].size()) + " offsets");
+        }
+    }
+    estimate.menuStops = stopsPerOrder * startStates / ScramblerTable::NUM_STATES;
+    if (!firstMenu && estimate.maxClosures == 0) {
+        estimate.warnings.push_back("The menu has no closures; expect many false stops");
+    }
     
-    std::vector<std::vector<std::string>> rotorOrders;
-    if (testAllOrders_) {
-        // 全ローターから3つを選び、その順列を生成
-        if (rotorTypes_.size() > 3) {
-            // 組み合わせを生成
-            for (size_t i = 0; i < rotorTypes_.size(); i++) {
-                for (size_t j = 0; j < rotorTypes_.size(); j++) {
-                    if (j == i) continue;
-                    for (size_t k = 0; k < rotorTypes_.size(); k++) {
-                        if (k == i || k == j) continue;
-                        std::vector<std::string> combination = {
-                            rotorTypes_[i], rotorTypes_[j], rotorTypes_[k]
-                        };
-                        rotorOrders.push_back(combination);
-                    }
+    if (rotorOrders.empty() || estimate.totalPositions == 0) {
+        if (startPositionFilter_ && !rotorOrders.empty()) {
+            estimate.warnings.push_back("The start position filter rejects every start position");
+        }
+        return estimate;
+    }
+    
+    // フィルタで位置が残るローター順だけを標本にする
+    if (startPositionFilter_) {
+        std::vector<std::vector<std::string>> sampleable;
+        std::vector<std::vector<int>> sampleableStates;
+        for (size_t orderIdx = 0; orderIdx < rotorOrders.size(); orderIdx++) {
+            if (!allowedStates[orderIdx].empty()) {
+                sampleable.push_back(rotorOrders[orderIdx]);
+                sampleableStates.push_back(std::move(allowedStates[orderIdx]));
+            }
+        }
+        rotorOrders.swap(sampleable);
+        allowedStates.swap(sampleableStates);
+    }
+    
+    // 先頭の数個のローター順で、開始位置を散らして実測する
+    const size_t sampleOrders = (std::min)(rotorOrders.size(), static_cast<size_t>(4));
+    sampleStates = (std::max)(sampleStates, static_cast<int>(sampleOrders));
+    const int cipherLength = static_cast<int>(cipherText_.length());
+    AttackStats stats;
+    std::vector<PackedCandidate> candidates;
+    double tableNanos = 0.0;
+    double searchNanos = 0.0;
+    size_t tablesBuilt = 0;
+    
+    for (size_t orderIdx = 0; orderIdx < sampleOrders; orderIdx++) {
+        auto tableStart = std::chrono::steady_clock::now();
+        std::shared_ptr<const ScramblerTable> table;
+        try {
+            table = ScramblerTable::get(rotorOrders[orderIdx], reflectorType_);
+        } catch (const std::invalid_argument& e) {
+            estimate.warnings.push_back(e.what());
+            continue;
+        }
+        auto searchStart = std::chrono::steady_clock::now();
+        tableNanos += std::chrono::duration<double, std::nano>(searchStart - tableStart).count();
+        tablesBuilt++;
+        
+        int statesForOrder = sampleStates / static_cast<int>(sampleOrders);
+        for (int i = 0; i < statesForOrder; i++) {
+            long long pick = static_cast<long long>(i) * 7919 + orderIdx * 104729;
+            int startState = startPositionFilter_
+                ? allowedStates[orderIdx][pick % allowedStates[orderIdx].size()]
+                : static_cast<int>(pick % ScramblerTable::NUM_STATES);
+            std::vector<int> states = table->stateSequence(startState, cipherLength);
+            for (size_t cribIdx = 0; cribIdx < cribTexts.size(); cribIdx++) {
+                for (int offset : cribOffsets[cribIdx]) {
+                    testPosition(*table, states, cribTexts[cribIdx], offset, startState, 0, candidates, stats);
+                    estimate.samplePositions++;
                 }
             }
-        } else {
-            // 3個以下の場合は全順列を生成
-            rotorOrders = generatePermutations(rotorTypes_);
         }
-    } else {
-        rotorOrders.push_back(rotorTypes_);
+        searchNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - searchStart).count();
+    }
+    
+    if (tablesBuilt > 0) {
+        estimate.tableSeconds = tableNanos / tablesBuilt / 1e9;
+    }
+    if (estimate.samplePositions > 0) {
+        estimate.sampleCandidates = static_cast<long long>(candidates.size());
+        estimate.nsPerPosition = searchNanos / estimate.samplePositions;
+        double candidateRate = static_cast<double>(candidates.size()) / estimate.samplePositions;
+        estimate.expectedCandidates = candidateRate * estimate.totalPositions;
+        estimate.expectedResultBytes = estimate.expectedCandidates * sizeof(PackedCandidate);
+    }
+    estimate.predictedSeconds = estimate.tableSeconds * estimate.rotorOrders +
+                                estimate.nsPerPosition * estimate.totalPositions / 1e9 / estimate.threads;
+    return estimate;
+}
+
+std::vector<CandidateResult> BombeAttack::attack(
+    const std::vector<CribEntry>& cribs,
+    std::function<void(const std::string&)> progressCallback) {
+    
+    progressCallback_ = progressCallback;
+    results_.clear();
+    stats_ = AttackStats();
+    
+    std::vector<std::vector<std::string>> rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes_, testAllOrders_);
+    if (rotorOrderFilter_) {
+        size_t totalOrders = rotorOrders.size();
+        rotorOrders.erase(std::remove_if(rotorOrders.begin(), rotorOrders.end(),
+            [this](const std::vector<std::string>& order) { return !rotorOrderFilter_(order); }),
+            rotorOrders.end());
+        if (progressCallback) {
+            progressCallback("Rotor orders after filter: " + std::to_string(rotorOrders.size()) +
+                             "/" + std::to_string(totalOrders));
+        }
     }
     
-    int maxOffset = (std::max)(0, static_cast<int>(cipherText_.length() - cribText_.length() + 1));
-    int totalTasks = 26 * 26 * 26 * rotorOrders.size() * maxOffset;
+    // クリブごとに試すオフセットを決める
+    std::vector<std::string> cribTexts;
+    std::vector<std::vector<int>> cribOffsets;
+    long long offsetsPerPosition = resolveCribOffsets(cribs, cribTexts, cribOffsets);
+    
+    long long totalTasks = static_cast<long long>(ScramblerTable::NUM_STATES) *
+                           rotorOrders.size() * offsetsPerPosition;
     
     // 処理開始時刻を記録
     auto startTime = std::chrono::high_resolution_clock::now();
     
     if (progressCallback) {
         progressCallback("Starting Bombe attack...");
-        progressCallback("Crib: " + cribText_);
+        if (cribTexts.size() == 1) {
+            progressCallback("Crib: " + cribTexts[0]);
+        } else {
+            progressCallback("Cribs: " + std::to_string(cribTexts.size()));
+            for (size_t i = 0; i < cribTexts.size(); i++) {
+                std::string hint = cribs[i].position >= 0
+                    ? " (position " + std::to_string(cribs[i].position) + ")"
+                    : " (all offsets)";
+                progressCallback("  " + cribTexts[i] + hint);
+            }
+        }
         progressCallback("Cipher: " + cipherText_);
         if (testAllOrders_ && rotorTypes_.size() > 3) {
             int combinations = rotorTypes_.size() * (rotorTypes_.size() - 1) * (rotorTypes_.size() - 2);
@@ -135,7 +399,8 @@ std::vector<CandidateResult> BombeAttack::attack(
     }
     
     // OpenMP設定を調整して負荷を制御
-    int numThreads = (std::min)(maxThreads_, static_cast<int>(omp_get_max_threads()));
+    int numThreads = resolveThreadCount();
+    int chunkSize = chunkSize_;
     omp_set_num_threads(numThreads);
     
     // スレッドの優先度を下げる
@@ -143,6 +408,53 @@ std::vector<CandidateResult> BombeAttack::attack(
     SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
     #endif
     
+    TraceRecorder* trace = trace_.get();
+    if (trace) {
+        trace->ensureThreads(numThreads);
+        for (int thread = 0; thread < numThreads; thread++) {
+            trace->setThreadName(thread, "OpenMP thread " + std::to_string(thread));
+        }
+        for (size_t orderIdx = 0; orderIdx < rotorOrders.size(); orderIdx++) {
+            std::string label;
+            for (const auto& rotor : rotorOrders[orderIdx]) {
+                label += (label.empty() ? "" : "-") + rotor;
+            }
+            trace->addMetadata("order " + std::to_string(orderIdx), label);
+        }
+    }
+    TraceScope attackSpan(trace, 0, "attack", "attack", "orders", static_cast<int64_t>(rotorOrders.size()));
+    
+    // 各スレッドが連続して処理した開始位置の区間（動的スケジュールのチャンク）を1スパンにまとめる
+    // 検証は位置ごとに記録するとリングバッファが溢れるので、区間内の合計時間を
+    // 区間の先頭から始まる1スパンとして記録する
+    struct alignas(64) TraceRun {
+        int first = -1;
+        int next = -1;
+        int64_t startNs = 0;
+        int64_t endNs = 0;
+        int64_t verifyNs = 0;
+    };
+    std::vector<TraceRun> traceRuns(trace ? numThreads : 0);
+    auto flushTraceRun = [trace](int thread, TraceRun& run, size_t orderIdx) {
+        if (run.first >= 0) {
+            trace->record(thread, "positions", "search", run.startNs, run.endNs,
+                          "order", static_cast<int64_t>(orderIdx), "count", run.next - run.first);
+            if (run.verifyNs > 0) {
+                trace->record(thread, "verify", "search", run.startNs, run.startNs + run.verifyNs,
+                              "order", static_cast<int64_t>(orderIdx), "count", run.next - run.first);
+            }
+        }
+        run = TraceRun();
+    };
+    
+    ENIGMA_LOG(LogLevel::Info, "attack.start")
+        .kv("orders", rotorOrders.size())
+        .kv("cribs", cribTexts.size())
+        .kv("tasks", totalTasks)
+        .kv("threads", numThreads)
+        .kv("chunkSize", chunkSize)
+        .kv("reflector", reflectorType_);
+    
     if (progressCallback) {
         progressCallback("Using " + std::to_string(numThreads) + " threads");
         if (useGPU_) {
@@ -150,48 +462,232 @@ std::vector<CandidateResult> BombeAttack::attack(
         }
     }
     
-    std::atomic<int> processedCount(0);
+    std::atomic<long long> processedCount(0);
+    const long long reportInterval = 5000;
+    const int cipherLength = static_cast<int>(cipherText_.length());
+    std::exception_ptr sinkError;
+    
+    // カウンタはスレッドごとに持ち（alignasで別キャッシュラインに置く）、最後に合算する
+    std::vector<AttackStats> threadStats(AttackStats::enabled() ? numThreads : 0);
+    
+    // ハードウェアカウンタは呼び出しスレッド（OpenMPの0番）の分を段階の前後の差で、
+    // 他のスレッドの分は各スレッドが最初の開始位置で開いたカウンタの累計で数える
+    bool countersRequested = hardwareCounters_.requested;
+    hardwareCounters_ = AttackHardwareCounters();
+    hardwareCounters_.requested = countersRequested;
+    std::unique_ptr<PerfCounters> mainPerf;
+    std::vector<std::unique_ptr<PerfCounters>> threadPerf;
+    if (hardwareCounters_.requested) {
+        mainPerf = std::make_unique<PerfCounters>();
+        hardwareCounters_.available = mainPerf->available();
+        hardwareCounters_.reason = mainPerf->unavailableReason();
+        if (!mainPerf->available()) {
+            mainPerf.reset();
+        } else {
+            threadPerf.resize(numThreads);
+        }
+        if (progressCallback && !hardwareCounters_.available) {
+            progressCallback(hardwareCounters_.summary());
+        }
+    }
+    auto perfReading = [&mainPerf]() { return mainPerf ? mainPerf->read() : PerfReading(); };
     
-    #pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads)
-    for (int orderIdx = 0; orderIdx < static_cast<int>(rotorOrders.size()); orderIdx++) {
-        for (int offset = 0; offset < maxOffset; offset++) {
-            for (int pos1 = 0; pos1 < 26; pos1++) {
-                for (int pos2 = 0; pos2 < 26; pos2++) {
-                    for (int pos3 = 0; pos3 < 26; pos3++) {
-                        if (stopFlag_) continue;
-                        
-                        // CPU負荷制御
-                        if (threadDelay_.count() > 0) {
-                            std::this_thread::sleep_for(threadDelay_);
+    for (size_t orderIdx = 0; orderIdx < rotorOrders.size() && !stopFlag_; orderIdx++) {
+        // このローター順の全位置の置換を一度だけ計算する
+        std::shared_ptr<const ScramblerTable> table;
+        PerfReading tableBefore = perfReading();
+        try {
+            TraceScope tableSpan(trace, 0, "tableBuild", "setup", "order", static_cast<int64_t>(orderIdx));
+            table = ScramblerTable::get(rotorOrders[orderIdx], reflectorType_);
+        } catch (const std::invalid_argument& e) {
+            ENIGMA_LOG(LogLevel::Warn, "attack.orderSkipped").kv("order", orderIdx).kv("reason", e.what());
+            continue;  // 無効なローターまたはリフレクター
+        }
+        hardwareCounters_.stages[AttackHardwareCounters::TableBuild] += perfReading() - tableBefore;
+        TraceScope orderSpan(trace, 0, "rotorOrder", "search", "order", static_cast<int64_t>(orderIdx));
+        
+        // クリブ・オフセット上位ごとのコンテキストIDを並列処理の前に登録する
+        std::vector<std::vector<uint16_t>> contextIds(cribTexts.size());
+        for (size_t cribIdx = 0; cribIdx < cribTexts.size(); cribIdx++) {
+            for (int offset : cribOffsets[cribIdx]) {
+                size_t block = static_cast<size_t>(offset / PackedCandidate::OFFSET_BLOCK);
+                if (contextIds[cribIdx].size() <= block) {
+                    contextIds[cribIdx].resize(block + 1);
+                }
+                contextIds[cribIdx][block] = results_.internContext(rotorOrders[orderIdx],
+                                                                    cribTexts[cribIdx],
+                                                                    static_cast<int>(block));
+            }
+        }
+        
+        PerfReading searchBefore = perfReading();
+        
+        #pragma omp parallel for schedule(dynamic, chunkSize) num_threads(numThreads)
+        for (int startState = 0; startState < ScramblerTable::NUM_STATES; startState++) {
+            if (stopFlag_) continue;
+            
+            if (!threadPerf.empty()) {
+                int thread = omp_get_thread_num();
+                if (thread != 0 && !threadPerf[thread]) {
+                    threadPerf[thread] = std::make_unique<PerfCounters>();
+                }
+            }
+            
+            if (startPositionFilter_ &&
+                !startPositionFilter_(rotorOrders[orderIdx], ScramblerTable::statePositions(startState))) {
+                processedCount.fetch_add(offsetsPerPosition);
+                continue;
+            }
+            
+            // CPU負荷制御
+            if (threadDelay_.count() > 0) {
+                std::this_thread::sleep_for(threadDelay_);
+            }
+            
+            TraceRun* traceRun = nullptr;
+            int traceThread = 0;
+            if (trace) {
+                traceThread = omp_get_thread_num();
+                traceRun = &traceRuns[traceThread];
+                if (startState != traceRun->next) {
+                    flushTraceRun(traceThread, *traceRun, orderIdx);
+                    traceRun->first = startState;
+                    traceRun->startNs = trace->now();
+                }
+                traceRun->next = startState + 1;
+            }
+            
+            // 開始位置ごとの状態列は全クリブ・全オフセットで共有する
+            std::vector<int> states = table->stateSequence(startState, cipherLength);
+            std::vector<PackedCandidate> localResults;
+#ifdef ENIGMA_ENABLE_COUNTERS
+            AttackStats& stats = threadStats[omp_get_thread_num()];
+#else
+            AttackStats stats;
+#endif
+            
+            for (size_t cribIdx = 0; cribIdx < cribTexts.size(); cribIdx++) {
+                for (int offset : cribOffsets[cribIdx]) {
+                    testPosition(*table, states, cribTexts[cribIdx], offset, startState,
+                                 contextIds[cribIdx][offset / PackedCandidate::OFFSET_BLOCK],
+                                 localResults, stats, traceRun ? &traceRun->verifyNs : nullptr);
+                }
+            }
+            
+            if (!localResults.empty()) {
+                ENIGMA_STAGE_TIMER(stats, Emit);
+                TraceScope emitSpan(trace, traceThread, "emit", "results",
+                                    "candidates", static_cast<int64_t>(localResults.size()));
+                ENIGMA_COUNT_ADD(stats, candidatesEmitted, localResults.size());
+                ENIGMA_LOG(LogLevel::Debug, "attack.candidates")
+                    .kv("order", orderIdx)
+                    .kv("state", startState)
+                    .kv("count", localResults.size());
+                if (resultSink_) {
+                    // 並列領域から例外を出さず、探索を止めて終了後に投げ直す
+                    try {
+                        for (const auto& candidate : localResults) {
+                            resultSink_->write(results_.unpack(candidate));
                         }
-                        
-                        std::vector<int> positions = {pos1, pos2, pos3};
-                        testPosition(positions, rotorOrders[orderIdx], offset);
-                        
-                        int count = processedCount.fetch_add(1);
-                        if (count % 5000 == 0) {
-                            // 定期的にCPU使用率をチェックして調整
-                            adjustThreadCount();
-                            
-                            if (progressCallback) {
-                                double progress = (count * 100.0) / totalTasks;
-                                progressCallback("Progress: " + std::to_string(count) + "/" + 
-                                               std::to_string(totalTasks) + " (" + 
-                                               std::to_string(static_cast<int>(progress)) + "%)");
-                            }
+                    } catch (...) {
+                        ENIGMA_LOG(LogLevel::Error, "attack.sinkError").kv("order", orderIdx);
+                        std::lock_guard<std::mutex> lock(resultsMutex_);
+                        if (!sinkError) {
+                            sinkError = std::current_exception();
                         }
+                        stopFlag_ = true;
                     }
                 }
+                if (keepResults_) {
+                    std::lock_guard<std::mutex> lock(resultsMutex_);
+                    results_.append(localResults);
+                }
+            }
+            
+            if (traceRun) {
+                traceRun->endNs = trace->now();
+            }
+            
+            long long before = processedCount.fetch_add(offsetsPerPosition);
+            if (before / reportInterval != (before + offsetsPerPosition) / reportInterval) {
+                TraceScope progressSpan(trace, traceThread, "progress", "report",
+                                        "done", before + offsetsPerPosition);
+                // 定期的にCPU使用率をチェックして調整
+                adjustThreadCount();
+                
+                if (progressHandler_) {
+                    progressHandler_(before + offsetsPerPosition, totalTasks);
+                }
+                if (progressCallback) {
+                    long long count = before + offsetsPerPosition;
+                    double progress = (count * 100.0) / totalTasks;
+                    progressCallback("Progress: " + std::to_string(count) + "/" + 
+                                   std::to_string(totalTasks) + " (" + 
+                                   std::to_string(static_cast<int>(progress)) + "%)");
+                }
             }
         }
+        
+        hardwareCounters_.stages[AttackHardwareCounters::Search] += perfReading() - searchBefore;
+        ENIGMA_LOG(LogLevel::Debug, "attack.orderDone")
+            .kv("order", orderIdx)
+            .kv("processed", processedCount.load())
+            .kv("stopped", stopFlag_.load());
+        
+        // 並列領域の終了後なので、各スレッドのバッファに書いてよい
+        for (size_t thread = 0; thread < traceRuns.size(); thread++) {
+            flushTraceRun(static_cast<int>(thread), traceRuns[thread], orderIdx);
+        }
     }
     
-    // スコアで結果をソート
-    std::sort(results_.begin(), results_.end());
+    for (const auto& stats : threadStats) {
+        stats_.merge(stats);
+    }
+    for (const auto& perf : threadPerf) {
+        if (perf) {
+            hardwareCounters_.stages[AttackHardwareCounters::Search] += perf->read();
+        }
+    }
+    threadPerf.clear();
+    hardwareCounters_.positionsTested = static_cast<uint64_t>(processedCount.load());
+    
+    if (sinkError) {
+        std::rethrow_exception(sinkError);
+    }
+    if (progressHandler_) {
+        progressHandler_(processedCount.load(), totalTasks);
+    }
+    if (resultSink_) {
+        TraceScope flushSpan(trace, 0, "sinkFlush", "results");
+        resultSink_->flush();
+        if (progressCallback) {
+            progressCallback("Streamed " + std::to_string(resultSink_->count()) + " candidates to result sink.");
+        }
+    }
+    
+    // スコアで結果をソートし、同じスクランブラ列の候補をまとめる
+    {
+        ENIGMA_STAGE_TIMER(stats_, Finalize);
+        PerfReading finalizeBefore = perfReading();
+        TraceScope mergeSpan(trace, 0, "sortMerge", "results",
+                             "candidates", static_cast<int64_t>(results_.size()));
+        results_.sort();
+        if (mergeEquivalent_) {
+            size_t merged = results_.mergeEquivalent(reflectorType_);
+            if (progressCallback && merged > 0) {
+                progressCallback("Merged " + std::to_string(merged) + " equivalent candidates.");
+            }
+        }
+        hardwareCounters_.stages[AttackHardwareCounters::Finalize] += perfReading() - finalizeBefore;
+    }
     
     // 処理時間を計算
     auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsedTime = endTime - startTime;
+    ENIGMA_LOG(LogLevel::Info, "attack.done")
+        .kv("candidates", results_.size())
+        .kv("seconds", elapsedTime.count())
+        .kv("stopped", stopFlag_.load());
     
     if (progressCallback) {
         progressCallback("Bombe attack completed. Found " + 
@@ -209,73 +705,71 @@ std::vector<CandidateResult> BombeAttack::attack(
             oss << "Processing time: " << minutes << " minutes " << std::fixed << std::setprecision(2) << seconds << " seconds";
             progressCallback(oss.str());
         }
+        if (AttackStats::enabled()) {
+            progressCallback(stats_.summary());
+        }
+        if (hardwareCounters_.available) {
+            progressCallback(hardwareCounters_.summary());
+        }
     }
     
-    return results_;
+    return results_.unpackAll(resultLimit_);
 }
 
-void BombeAttack::testPosition(const std::vector<int>& positions,
-                               const std::vector<std::string>& rotorOrder,
-                               int offset) {
+void BombeAttack::testPosition(const ScramblerTable& table,
+                               const std::vector<int>& states,
+                               const std::string& crib,
+                               int offset,
+                               int startState,
+                               uint16_t contextId,
+                               std::vector<PackedCandidate>& results,
+                               AttackStats& stats,
+                               int64_t* verifyNs) {
     // クリブがこのオフセットに適合するかチェック
-    if (offset + cribText_.length() > cipherText_.length()) {
+    if (offset + crib.length() > cipherText_.length()) {
         return;
     }
     
-    // 暗号文の該当部分を取得
-    std::string cipherPart = cipherText_.substr(offset, cribText_.length());
+    ENIGMA_COUNT(stats, positionsTested);
     
-    // 電気経路追跡を使用してプラグボード配線を推定
-    auto plugboardHypothesis = deducePlugboardWiring(positions, rotorOrder, offset);
+    // 暗号文の該当部分を取得
+    std::string cipherPart = cipherText_.substr(offset, crib.length());
     
-    if (plugboardHypothesis.empty() && hasPlugboardConflict_) {
-        return;
+    // 選ばれた位置だけ、置換表と状態列による暗号化を参照実装での照合に回す
+    if (shadow_ && shadow_->shouldSample()) {
+        submitShadow("position", table, startState, offset, crib, {},
+                     encryptWithTable(table, states, offset, crib, makePlugboardArray({})));
     }
     
-    // 推定されたプラグボードでエニグマを作成
-    auto rotors = std::vector<std::unique_ptr<Rotor>>();
-    for (const auto& type : rotorOrder) {
-        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
-            return;  // 無効なローター
-        }
-        auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-    }
+    // 電気経路追跡を使用してプラグボード配線を推定
+    bool hasConflict = false;
+    auto plugboardHypothesis = deducePlugboardWiring(table, states, crib, offset, hasConflict, stats);
     
-    if (enigma::REFLECTOR_DEFINITIONS.find(reflectorType_) == enigma::REFLECTOR_DEFINITIONS.end()) {
-        return;  // 無効なリフレクター
+    if (plugboardHypothesis.empty() && hasConflict) {
+        return;
     }
-    auto& refDef = enigma::REFLECTOR_DEFINITIONS.at(reflectorType_);
-    auto reflector = std::make_unique<Reflector>(refDef.wiring);
-    
-    auto plugboard = std::make_unique<Plugboard>(plugboardHypothesis);
-    
-    EnigmaMachine enigma(std::move(rotors), std::move(reflector), std::move(plugboard));
-    enigma.setRotorPositions(positions);
     
-    // オフセットまでローターを進める
-    for (int i = 0; i < offset; i++) {
-        enigma.stepRotors();
+    // 推定されたプラグボードで暗号化をテスト
+    ENIGMA_STAGE_TIMER(stats, Verification);
+    int64_t verifyStart = verifyNs ? trace_->now() : 0;
+    ENIGMA_COUNT(stats, verificationEncryptions);
+    std::string testResult = encryptWithTable(table, states, offset, crib,
+                                              makePlugboardArray(plugboardHypothesis));
+    if (verifyNs) {
+        *verifyNs += trace_->now() - verifyStart;
     }
     
-    // 暗号化をテスト
-    std::string testResult = enigma.encrypt(cribText_);
-    
     // 完全一致をチェック
+    // スコアと一致率は一致文字数とプラグ数から再計算できるので、レコードには持たない
+    int offsetLow = offset % PackedCandidate::OFFSET_BLOCK;
     if (testResult == cipherPart) {
-        CandidateResult result;
-        result.score = 100.0 - plugboardHypothesis.size() * 2;
-        result.positions = positions;
-        result.rotorOrder = rotorOrder;
-        result.plugboard = plugboardHypothesis;
-        result.matchRate = 1.0;
-        result.plugboardPairs = plugboardHypothesis.size();
-        result.offset = offset;
-        
-        std::lock_guard<std::mutex> lock(resultsMutex_);
-        results_.push_back(result);
-        
-    } else if (!hasPlugboardConflict_ && plugboardHypothesis.empty()) {
+        results.push_back(PackedCandidate::make(contextId, startState, offsetLow,
+                                                static_cast<int>(crib.length()), plugboardHypothesis));
+        if (shadow_ && !plugboardHypothesis.empty() && shadow_->shouldSample()) {
+            submitShadow("candidate", table, startState, offset, crib, plugboardHypothesis, testResult);
+        }
+        
+    } else if (!hasConflict && plugboardHypothesis.empty()) {
         // プラグボードが推定されない場合の部分一致をチェック
         int matches = 0;
         for (size_t i = 0; i < testResult.length(); i++) {
@@ -284,59 +778,49 @@ void BombeAttack::testPosition(const std::vector<int>& positions,
             }
         }
         
-        double matchRate = static_cast<double>(matches) / cribText_.length();
+        double matchRate = static_cast<double>(matches) / crib.length();
         if (matchRate >= 0.5) {
-            CandidateResult result;
-            result.score = matchRate * 100;
-            result.positions = positions;
-            result.rotorOrder = rotorOrder;
-            result.plugboard = plugboardHypothesis;
-            result.matchRate = matchRate;
-            result.plugboardPairs = 0;
-            result.offset = offset;
-            
-            std::lock_guard<std::mutex> lock(resultsMutex_);
-            results_.push_back(result);
+            results.push_back(PackedCandidate::make(contextId, startState, offsetLow, matches,
+                                                    plugboardHypothesis));
         }
     }
 }
 
+void BombeAttack::submitShadow(const char* kind,
+                               const ScramblerTable& table,
+                               int startState,
+                               int offset,
+                               const std::string& crib,
+                               const std::vector<std::pair<char, char>>& plugboard,
+                               const std::string& output) {
+    ShadowSample sample;
+    sample.kind = kind;
+    sample.rotorOrder = table.getRotorOrder();
+    sample.reflector = table.getReflectorType();
+    sample.positions = ScramblerTable::statePositions(startState);
+    sample.plugboard = plugboard;
+    sample.offset = offset;
+    sample.input = crib;
+    sample.output = output;
+    shadow_->submit(std::move(sample));
+}
+
 std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
-    const std::vector<int>& positions,
-    const std::vector<std::string>& rotorOrder,
-    int offset) {
-    
-    hasPlugboardConflict_ = false;
-    std::string cipherPart = cipherText_.substr(offset, cribText_.length());
-    
-    // まずプラグボードなしでエニグマを作成
-    auto rotors = std::vector<std::unique_ptr<Rotor>>();
-    for (const auto& type : rotorOrder) {
-        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
-            return {};
-        }
-        auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-    }
-    
-    if (enigma::REFLECTOR_DEFINITIONS.find(reflectorType_) == enigma::REFLECTOR_DEFINITIONS.end()) {
-        return {};
-    }
-    auto& refDef = enigma::REFLECTOR_DEFINITIONS.at(reflectorType_);
-    auto reflector = std::make_unique<Reflector>(refDef.wiring);
-    auto plugboard = std::make_unique<Plugboard>(std::vector<std::string>{});
+    const ScramblerTable& table,
+    const std::vector<int>& states,
+    const std::string& crib,
+    int offset,
+    bool& hasConflict,
+    AttackStats& stats) {
     
-    EnigmaMachine enigma(std::move(rotors), std::move(reflector), std::move(plugboard));
-    enigma.setRotorPositions(positions);
-    
-    // オフセットまでローターを進める
-    for (int i = 0; i < offset; i++) {
-        enigma.stepRotors();
-    }
+    ENIGMA_STAGE_TIMER(stats, DeduceWiring);
+    hasConflict = false;
+    std::string cipherPart = cipherText_.substr(offset, crib.length());
     
     // プラグボードなしでテスト
-    std::string testResult = enigma.encrypt(cribText_);
+    std::string testResult = encryptWithTable(table, states, offset, crib, makePlugboardArray({}));
     if (testResult == cipherPart) {
+        ENIGMA_COUNT(stats, noPlugboardMatches);
         return {};  // プラグボードなしで一致
     }
     
@@ -351,7 +835,7 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
     // まず簡単な方法を試す
     std::map<char, char> requiredMappings;
     
-    for (size_t i = 0; i < cribText_.length(); i++) {
+    for (size_t i = 0; i < crib.length(); i++) {
         char cipherChar = cipherPart[i];
         char noPlugChar = noPlugboardResult[i];
         
@@ -359,7 +843,8 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
         if (noPlugChar != cipherChar) {
             // noPlugCharをcipherCharに変換する必要がある
             if (!propagateConstraints(requiredMappings, noPlugChar, cipherChar)) {
-                hasPlugboardConflict_ = true;
+                ENIGMA_COUNT(stats, propagationConflicts);
+                hasConflict = true;
                 return {};
             }
         }
@@ -367,15 +852,6 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
     
     // 推定されたマッピングから有効なプラグボード設定を生成
     if (!requiredMappings.empty()) {
-        // 検証
-        auto verifyRotors = std::vector<std::unique_ptr<Rotor>>();
-        for (const auto& type : rotorOrder) {
-            auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-            verifyRotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-        }
-        auto& verifyRefDef = enigma::REFLECTOR_DEFINITIONS.at(reflectorType_);
-        auto verifyReflector = std::make_unique<Reflector>(verifyRefDef.wiring);
-        
         std::vector<std::pair<char, char>> plugboardPairs;
         std::set<char> used;
         
@@ -384,7 +860,7 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
                 used.find(pair.second) == used.end() &&
                 pair.first != pair.second) {
                 // 最大10組の制限をチェック
-                if (plugboardPairs.size() >= 10) {
+                if (plugboardPairs.size() >= Plugboard::MAX_PAIRS) {
                     break;
                 }
                 
@@ -398,20 +874,10 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
             }
         }
         
-        std::vector<std::string> pbStrings;
-        for (const auto& pair : plugboardPairs) {
-            pbStrings.push_back(std::string(1, pair.first) + std::string(1, pair.second));
-        }
-        auto verifyPlugboard = std::make_unique<Plugboard>(pbStrings);
-        
-        EnigmaMachine verifyMachine(std::move(verifyRotors), std::move(verifyReflector), std::move(verifyPlugboard));
-        verifyMachine.setRotorPositions(positions);
-        
-        for (int i = 0; i < offset; i++) {
-            verifyMachine.stepRotors();
-        }
-        
-        std::string verifyResult = verifyMachine.encrypt(cribText_);
+        // 検証
+        ENIGMA_COUNT(stats, verificationEncryptions);
+        std::string verifyResult = encryptWithTable(table, states, offset, crib,
+                                                    makePlugboardArray(plugboardPairs));
         if (verifyResult == cipherPart) {
             return plugboardPairs;
         }
@@ -419,15 +885,17 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
     
     // 史実のBombeアルゴリズムを使用
     // 各文字（A-Z）を仮定のステッカーとしてテスト
+    ENIGMA_STAGE_TIMER(stats, SteckerSearch);
     for (char assumedStecker = 'A'; assumedStecker <= 'Z'; assumedStecker++) {
         std::map<char, char> deducedSteckers;
         
         // クリブの最初の文字から開始（Turingの方法）
-        if (cribText_[0] == assumedStecker) {
+        if (crib[0] == assumedStecker) {
             continue;  // 自己ステッカーは不可能
         }
         
-        if (testPlugboardHypothesis(positions, rotorOrder, offset, assumedStecker, deducedSteckers)) {
+        ENIGMA_COUNT(stats, steckerHypotheses);
+        if (testPlugboardHypothesis(table, states, crib, offset, assumedStecker, deducedSteckers)) {
             // 有効なステッカー設定が見つかった
             std::vector<std::pair<char, char>> plugboardPairs;
             std::set<char> used;
@@ -446,6 +914,11 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
                 }
             }
             
+            // 実機のプラグボードは最大10組
+            if (plugboardPairs.size() > Plugboard::MAX_PAIRS) {
+                continue;
+            }
+            
             // プラグボード仮説をdiagonal boardでテスト
             bool hasContradiction = false;
             try {
@@ -459,39 +932,21 @@ std::vector<std::pair<char, char>> BombeAttack::deducePlugboardWiring(
             }
             
             if (hasContradiction) {
+                ENIGMA_COUNT(stats, diagonalBoardRejections);
                 continue;  // 矛盾があればスキップ
             }
             
             // 検証
-            auto verifyRotors = std::vector<std::unique_ptr<Rotor>>();
-            for (const auto& type : rotorOrder) {
-                auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-                verifyRotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-            }
-            auto& verifyRefDef = enigma::REFLECTOR_DEFINITIONS.at(reflectorType_);
-            auto verifyReflector = std::make_unique<Reflector>(verifyRefDef.wiring);
-            
-            std::vector<std::string> pbStrings;
-            for (const auto& pair : plugboardPairs) {
-                pbStrings.push_back(std::string(1, pair.first) + std::string(1, pair.second));
-            }
-            auto verifyPlugboard = std::make_unique<Plugboard>(pbStrings);
-            
-            EnigmaMachine verifyMachine(std::move(verifyRotors), std::move(verifyReflector), std::move(verifyPlugboard));
-            verifyMachine.setRotorPositions(positions);
-            
-            for (int i = 0; i < offset; i++) {
-                verifyMachine.stepRotors();
-            }
-            
-            std::string verifyResult = verifyMachine.encrypt(cribText_);
+            ENIGMA_COUNT(stats, verificationEncryptions);
+            std::string verifyResult = encryptWithTable(table, states, offset, crib,
+                                                        makePlugboardArray(plugboardPairs));
             if (verifyResult == cipherPart) {
                 return plugboardPairs;
             }
         }
     }
     
-    hasPlugboardConflict_ = true;
+    hasConflict = true;
     return {};
 }
 
@@ -576,21 +1031,6 @@ std::vector<char> BombeAttack::traceThroughEnigma(
     return result;
 }
 
-std::vector<std::vector<std::string>> BombeAttack::generatePermutations(
-    const std::vector<std::string>& items) {
-    std::vector<std::vector<std::string>> result;
-    std::vector<std::string> current = items;
-    
-    // std::next_permutationは入力がソートされている必要がある
-    std::sort(current.begin(), current.end());
-    
-    do {
-        result.push_back(current);
-    } while (std::next_permutation(current.begin(), current.end()));
-    
-    return result;
-}
-
 // 史実のBombeアルゴリズムの実装
 std::vector<BombeAttack::MenuLink> BombeAttack::createMenu() {
     std::vector<MenuLink> menu;
@@ -620,75 +1060,34 @@ std::map<char, std::set<char>> BombeAttack::findLoops(const std::vector<MenuLink
 }
 
 bool BombeAttack::testPlugboardHypothesis(
-    const std::vector<int>& positions,
-    const std::vector<std::string>& rotorOrder,
+    const ScramblerTable& table,
+    const std::vector<int>& states,
+    const std::string& crib,
     int offset,
     char assumedStecker,
     std::map<char, char>& deducedSteckers) {
     
-    std::string cipherPart = cipherText_.substr(offset, cribText_.length());
+    std::string cipherPart = cipherText_.substr(offset, crib.length());
     
     // 初期仮定：クリブの最初の文字が assumedStecker にステッカーされる
     deducedSteckers.clear();
-    deducedSteckers[cribText_[0]] = assumedStecker;
-    deducedSteckers[assumedStecker] = cribText_[0];
-    
-    // エニグママシンを作成（プラグボードなし）
-    auto rotors = std::vector<std::unique_ptr<Rotor>>();
-    for (const auto& type : rotorOrder) {
-        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
-            return false;
-        }
-        auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-    }
-    
-    if (enigma::REFLECTOR_DEFINITIONS.find(reflectorType_) == enigma::REFLECTOR_DEFINITIONS.end()) {
-        return false;
-    }
-    auto& refDef = enigma::REFLECTOR_DEFINITIONS.at(reflectorType_);
+    deducedSteckers[crib[0]] = assumedStecker;
+    deducedSteckers[assumedStecker] = crib[0];
     
     // Bombeの各ドラムユニットをシミュレート
     std::vector<std::pair<char, char>> implications;  // 推定されたステッカーペア
     
-    // エニグママシンを一度だけ作成
-    auto testReflector = std::make_unique<Reflector>(refDef.wiring);
-    auto testPlugboard = std::make_unique<Plugboard>(std::vector<std::string>{});
-    
-    // ローターをコピー
-    auto testRotors = std::vector<std::unique_ptr<Rotor>>();
-    for (const auto& type : rotorOrder) {
-        auto& def = enigma::ROTOR_DEFINITIONS.at(type);
-        testRotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
-    }
-    
-    EnigmaMachine testMachine(std::move(testRotors), std::move(testReflector), std::move(testPlugboard));
-    
-    for (size_t i = 0; i < cribText_.length(); i++) {
-        // ローター位置を設定
-        testMachine.setRotorPositions(positions);
-        
-        // この位置まで進める
-        for (int j = 0; j < offset + static_cast<int>(i); j++) {
-            testMachine.stepRotors();
-        }
-        
+    for (size_t i = 0; i < crib.length(); i++) {
         // 入力文字（プラグボード適用後）
-        char inputChar = cribText_[i];
+        char inputChar = crib[i];
         char steckeredInput = inputChar;
         if (deducedSteckers.find(inputChar) != deducedSteckers.end()) {
             steckeredInput = deducedSteckers[inputChar];
         }
         
-        // エニグマを通す（ステップなし）
-        char outputBeforePlugboard;
-        try {
-            outputBeforePlugboard = testMachine.encryptCharNoStep(steckeredInput);
-        } catch (const std::exception& e) {
-            return false;
-        } catch (...) {
-            return false;
-        }
+        // スクランブラを通す（ステップ済みの状態を使用）
+        const uint8_t* perm = table.perm(states[offset + i]);
+        char outputBeforePlugboard = static_cast<char>('A' + perm[steckeredInput - 'A']);
         
         // 出力側のステッカーを推定
         char expectedOutput = cipherPart[i];
@@ -901,9 +1300,34 @@ bool BombeAttack::processOnGPU(const std::vector<std::vector<int>>& positionBatc
         
         // 有望な候補のみCPUで詳細検証
         float threshold = 0.3f;
+        auto sharedTable = ScramblerTable::get(rotorOrder, reflectorType_);
+        const ScramblerTable& table = *sharedTable;
+        uint16_t contextId;
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex_);
+            contextId = results_.internContext(rotorOrder, cribText_,
+                                               offset / PackedCandidate::OFFSET_BLOCK);
+        }
+        std::vector<PackedCandidate> batchResults;
+        AttackStats batchStats;
         for (size_t i = 0; i < batchSize; i++) {
             if (scores[i] >= threshold) {
-                testPosition(positionBatch[i], rotorOrder, offset);
+                int startState = ScramblerTable::stateIndex(positionBatch[i]);
+                auto states = table.stateSequence(startState, static_cast<int>(cipherText_.length()));
+                testPosition(table, states, cribText_, offset, startState, contextId, batchResults, batchStats);
+            }
+        }
+        if (resultSink_) {
+            for (const auto& candidate : batchResults) {
+                resultSink_->write(results_.unpack(candidate));
+            }
+        }
+        ENIGMA_COUNT_ADD(batchStats, candidatesEmitted, batchResults.size());
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex_);
+            stats_.merge(batchStats);
+            if (keepResults_) {
+                results_.append(batchResults);
             }
         }
         
@@ -9,7 +9,13 @@
 #include <set>
 #include <thread>
 #include <chrono>
+#include "AttackStats.h"
 #include "DiagonalBoard.h"
+#include "PackedCandidate.h"
+#include "ResultSink.h"
+#include "ScramblerTable.h"
+#include "ShadowValidator.h"
+#include "TraceRecorder.h"
 
 #ifdef USE_OPENCL
 #include <CL/cl.h>
@@ -19,6 +25,12 @@
 #include <cuda_runtime.h>
 #endif
 
+// クリブ辞書の1項目（positionが-1なら全オフセットを試す）
+struct CribEntry {
+    std::string text;
+    int position = -1;
+};
+
 struct CandidateResult {
     double score;
     std::vector<int> positions;
@@ -27,6 +39,8 @@ struct CandidateResult {
     double matchRate;
     int plugboardPairs;
     int offset;
+    std::string crib;   // この候補を生んだクリブ
+    int equivalentCount = 1;  // 同じスクランブラ列に統合された候補数（自分を含む）
     
     bool operator<(const CandidateResult& other) const {
         return score > other.score; // Descending order
@@ -36,6 +50,25 @@ struct CandidateResult {
     std::string getRotorString() const;
 };
 
+// attack()の前に見積もった探索量・所要時間・候補数（BombeAttack::estimate）
+struct AttackEstimate {
+    size_t rotorOrders = 0;
+    long long offsetsPerPosition = 0;     // 全クリブのオフセット数の合計
+    long long totalPositions = 0;         // 開始位置×ローター順×オフセット（開始位置フィルタを通るもの）
+    int minClosures = 0;                  // メニュー（クリブと暗号文の文字のグラフ）の閉路数
+    int maxClosures = 0;
+    double menuStops = 0.0;               // 閉路数から見た史実のBombeの停止数（1閉路ごとに1/26）
+    long long samplePositions = 0;        // 実測に使った位置数
+    long long sampleCandidates = 0;       // そのうち候補になった数
+    double nsPerPosition = 0.0;           // 1スレッドでの1位置あたりの時間（このホストで実測）
+    double tableSeconds = 0.0;            // スクランブラ表1つの準備時間（実測）
+    int threads = 1;
+    double predictedSeconds = 0.0;
+    double expectedCandidates = 0.0;      // 同値統合前の候補数（標本の候補率から）
+    double expectedResultBytes = 0.0;     // 候補をメモリに保持する場合の大きさ
+    std::vector<std::string> warnings;    // クリブが使えないオフセットなど
+};
+
 class BombeAttack {
 public:
     BombeAttack(const std::string& cribText, 
@@ -50,9 +83,79 @@ public:
     std::vector<CandidateResult> attack(
         std::function<void(const std::string&)> progressCallback = nullptr);
     
+    // 複数のクリブを同時に試す。各ローター順・開始位置のスクランブラ列は
+    // 一度だけ計算し、全クリブ・全オフセットで共有する。
+    // 英字だけにしたクリブがPackedCandidate::MAX_CRIB_LENGTH文字を超えればstd::invalid_argument
+    std::vector<CandidateResult> attack(
+        const std::vector<CribEntry>& cribs,
+        std::function<void(const std::string&)> progressCallback = nullptr);
+    
+    // 探索せずに量と所要時間を見積もる。sampleStates個の開始位置で実際にtestPositionを
+    // 1スレッドで実行し、その時間と候補率を全体に広げる（数百ms程度）
+    AttackEstimate estimate(const std::vector<CribEntry>& cribs, int sampleStates = 256);
+    
+    // 探索前にローター順を絞り込む（Banburismusの結果など）。falseを返した順は試さない
+    void setRotorOrderFilter(std::function<bool(const std::vector<std::string>&)> filter) {
+        rotorOrderFilter_ = filter;
+    }
+    
+    // 開始位置（メッセージ鍵）の絞り込み。falseを返した位置は試さない
+    void setStartPositionFilter(
+        std::function<bool(const std::vector<std::string>&, const std::vector<int>&)> filter) {
+        startPositionFilter_ = filter;
+    }
+    
+    // クリブ区間で同じスクランブラ列になる候補を1つにまとめる（既定で有効）
+    void setMergeEquivalent(bool merge) { mergeEquivalent_ = merge; }
+    
+    // attack()が展開して返す候補数の上限（0なら全件）
+    void setResultLimit(size_t limit) { resultLimit_ = limit; }
+    
+    // 見つかった候補を逐次sinkへ書き出す（同値統合・整列の前の生の候補）。
+    // keepResultsがfalseならメモリには残さず、attack()は空を返す
+    void setResultSink(std::shared_ptr<ResultSink> sink, bool keepResults = true) {
+        resultSink_ = sink;
+        keepResults_ = keepResults;
+    }
+    
+    // 使用スレッド数を指定する（既定はチューニングファイルの値、なければCPU数の75%）
+    void setMaxThreads(int threads) {
+        maxThreads_ = threads > 0 ? threads : 1;
+        explicitThreads_ = true;
+    }
+    
+    // 並列探索で各スレッドが一度に取る開始位置の数（既定はチューニングファイルの値、なければ64）
+    void setChunkSize(int chunkSize) { chunkSize_ = chunkSize > 0 ? chunkSize : 1; }
+    
+    // 進捗を数値（処理済み数, 総数）で受け取る。progressCallbackと同じ間隔で探索スレッドから呼ばれる
+    void setProgressHandler(std::function<void(long long, long long)> handler) {
+        progressHandler_ = handler;
+    }
+    
+    // 直前のattack()の全候補（スコア順の固定長レコード）
+    const PackedCandidateSet& getPackedResults() const { return results_; }
+    
+    // 攻撃の各段階をタイムラインとして記録する（nullptrで無効）。
+    // スレッド番号はOpenMPのスレッド番号で、attack()を呼んだスレッドが0番になる
+    void setTraceRecorder(std::shared_ptr<TraceRecorder> recorder) { trace_ = recorder; }
+    
+    // 段階ごとのハードウェアカウンタ（perf_event_open、Linuxのみ）を取る
+    void setHardwareCounters(bool enabled) { hardwareCounters_.requested = enabled; }
+    const AttackHardwareCounters& getHardwareCounters() const { return hardwareCounters_; }
+    
+    // 置換表による暗号化の一部をvalidatorの割合で参照実装と照合する（nullptrで無効）。
+    // 対象は各開始位置・オフセットでのプラグボードなしの暗号化と、出力するプラグボード付き候補の検証
+    void setShadowValidator(std::shared_ptr<ShadowValidator> validator) { shadow_ = validator; }
+    
+    // 直前のattack()の段階別カウンタ（全スレッドの合計。カウンタ無効のビルドではすべて0）
+    const AttackStats& getStats() const { return stats_; }
+    
     void stop() { stopFlag_ = true; }
     
 private:
+    // enigma_bench（src/main_bench.cpp）が内部のカーネルを直接計測する
+    friend class BombeBench;
+    
     std::string cribText_;
     std::string cipherText_;
     std::vector<std::string> rotorTypes_;
@@ -62,9 +165,18 @@ private:
     
     std::atomic<bool> stopFlag_{false};
     std::mutex resultsMutex_;
-    std::vector<CandidateResult> results_;
-    bool hasPlugboardConflict_ = false;
+    PackedCandidateSet results_;
+    AttackStats stats_;
+    AttackHardwareCounters hardwareCounters_;
+    std::shared_ptr<TraceRecorder> trace_;
+    std::shared_ptr<ShadowValidator> shadow_;
+    bool mergeEquivalent_ = true;
+    size_t resultLimit_ = 0;
+    std::shared_ptr<ResultSink> resultSink_;
+    bool keepResults_ = true;
     std::function<void(const std::string&)> progressCallback_;
+    std::function<bool(const std::vector<std::string>&)> rotorOrderFilter_;
+    std::function<bool(const std::vector<std::string>&, const std::vector<int>&)> startPositionFilter_;
     mutable std::mutex diagonalBoardMutex_;
     DiagonalBoard diagonalBoard_;
     
@@ -72,20 +184,42 @@ private:
     std::atomic<double> cpuUsage_{0.0};
     std::atomic<int> activeThreads_{0};
     int maxThreads_;
+    bool explicitThreads_ = false;
+    int chunkSize_ = 64;
+    std::function<void(long long, long long)> progressHandler_;
     std::chrono::milliseconds threadDelay_{0};
     
     // GPU処理用
     bool useGPU_ = false;
     void* gpuContext_ = nullptr;
     
-    void testPosition(const std::vector<int>& positions,
-                     const std::vector<std::string>& rotorOrder,
-                     int offset);
+    // verifyNsを渡すと（トレース記録時）、検証にかかった時間をそこに足す
+    void testPosition(const ScramblerTable& table,
+                     const std::vector<int>& states,
+                     const std::string& crib,
+                     int offset,
+                     int startState,
+                     uint16_t contextId,
+                     std::vector<PackedCandidate>& results,
+                     AttackStats& stats,
+                     int64_t* verifyNs = nullptr);
+    
+    // 高速経路の暗号化結果をshadow_の照合待ちに積む
+    void submitShadow(const char* kind,
+                      const ScramblerTable& table,
+                      int startState,
+                      int offset,
+                      const std::string& crib,
+                      const std::vector<std::pair<char, char>>& plugboard,
+                      const std::string& output);
     
     std::vector<std::pair<char, char>> deducePlugboardWiring(
-        const std::vector<int>& positions,
-        const std::vector<std::string>& rotorOrder,
-        int offset);
+        const ScramblerTable& table,
+        const std::vector<int>& states,
+        const std::string& crib,
+        int offset,
+        bool& hasConflict,
+        AttackStats& stats);
     
     bool propagateConstraints(
         std::map<char, char>& wiring,
@@ -98,9 +232,6 @@ private:
         int startOffset,
         const std::string& input);
     
-    std::vector<std::vector<std::string>> generatePermutations(
-        const std::vector<std::string>& items);
-    
     // 史実のBombeアルゴリズム用の追加メソッド
     struct MenuLink {
         int position;     // クリブ内の位置
@@ -113,12 +244,25 @@ private:
     std::map<char, std::set<char>> findLoops(const std::vector<MenuLink>& menu);
     
     bool testPlugboardHypothesis(
-        const std::vector<int>& positions,
-        const std::vector<std::string>& rotorOrder,
+        const ScramblerTable& table,
+        const std::vector<int>& states,
+        const std::string& crib,
         int offset,
         char assumedStecker,
         std::map<char, char>& deducedSteckers);
     
+    // setMaxThreadsとOpenMPの設定から使うスレッド数を決める
+    int resolveThreadCount() const;
+    
+    // クリブ区間の文字をつないだグラフの閉路数（リンク数−文字数＋連結成分数）
+    static int menuClosures(const std::string& crib, const std::string& cipherPart);
+    
+    // クリブを正規化し、それぞれ試すオフセットを決める
+    long long resolveCribOffsets(
+        const std::vector<CribEntry>& cribs,
+        std::vector<std::string>& cribTexts,
+        std::vector<std::vector<int>>& cribOffsets) const;
+    
     void propagateStecker(
         char letter,
         char stecker,
@@ -0,0 +1,392 @@
+#include "CribIndex.h"
+#include "EnigmaMachine.h"
+#include "RotorConfig.h"
+#include "ScramblerTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+// 索引ファイルの形式（リトルエンディアン、ネイティブ配置）
+//   FileHeader | (SegmentHeader | OrderRecord × orderCount | Entry × entryCount) × segmentCount
+// クリブの追加は末尾へのセグメントの追記とsegmentCountの更新だけで行う
+struct CribIndex::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t segmentCount;
+};
+
+struct CribIndex::SegmentHeader {
+    char crib[64];
+    uint32_t cribLength;
+    uint32_t orderCount;
+    uint32_t reflectorCount;
+    uint32_t reserved;
+    uint64_t entryCount;
+    char reflectors[4][8];
+};
+
+struct CribIndex::OrderRecord {
+    char rotors[3][8];
+};
+
+// settingはreflectorIndex * orderCount + order
+struct CribIndex::Entry {
+    uint32_t key;
+    uint16_t setting;
+    uint16_t state;
+};
+
+namespace {
+
+const char INDEX_MAGIC[8] = {'E', 'N', 'I', 'G', 'C', 'R', 'I', 'B'};
+const uint32_t INDEX_VERSION = 1;
+
+std::string normalizeLetters(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (c >= 'A' && c <= 'Z') result += c;
+    }
+    return result;
+}
+
+uint32_t prefixKey(const std::string& text) {
+    uint32_t key = 0;
+    for (int i = 0; i < CribIndex::PREFIX_LENGTH; i++) {
+        key = key * 26 + static_cast<uint32_t>(text[i] - 'A');
+    }
+    return key;
+}
+
+std::unique_ptr<EnigmaMachine> createMachine(const std::vector<std::string>& rotorOrder,
+                                             const std::string& reflectorType) {
+    auto rotors = std::vector<std::unique_ptr<Rotor>>();
+    for (const auto& type : rotorOrder) {
+        auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+    }
+    auto reflector = std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at(reflectorType).wiring);
+    return std::make_unique<EnigmaMachine>(std::move(rotors), std::move(reflector), std::make_unique<Plugboard>());
+}
+
+std::string fixedString(const char* data, size_t size) {
+    return std::string(data, strnlen(data, size));
+}
+
+} // namespace
+
+std::string CribIndexMatch::getPositionString() const {
+    std::string result;
+    for (int pos : positions) {
+        result += static_cast<char>('A' + pos);
+    }
+    return result;
+}
+
+std::string CribIndexMatch::getRotorString() const {
+    std::string result;
+    for (size_t i = 0; i < rotorOrder.size(); i++) {
+        result += rotorOrder[i];
+        if (i < rotorOrder.size() - 1) {
+            result += "-";
+        }
+    }
+    return result;
+}
+
+CribIndex::CribIndex(const std::string& path) : path_(path) {
+    load();
+}
+
+void CribIndex::load() {
+    segments_.clear();
+    validEnd_ = 0;
+    file_.close();
+
+    if (!std::ifstream(path_, std::ios::binary).good()) {
+        return;  // まだ作成されていない
+    }
+
+    file_.open(path_);
+    const uint8_t* data = file_.data();
+    size_t size = file_.size();
+
+    if (size < sizeof(FileHeader)) {
+        throw std::runtime_error("索引ファイルが壊れています: " + path_);
+    }
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+    if (std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        header->version != INDEX_VERSION) {
+        throw std::runtime_error("索引ファイルの形式が異なります: " + path_);
+    }
+
+    size_t offset = sizeof(FileHeader);
+    for (uint32_t s = 0; s < header->segmentCount; s++) {
+        if (offset + sizeof(SegmentHeader) > size) {
+            throw std::runtime_error("索引ファイルが壊れています: " + path_);
+        }
+        Segment segment;
+        segment.header = reinterpret_cast<const SegmentHeader*>(data + offset);
+        offset += sizeof(SegmentHeader);
+        if (segment.header->orderCount == 0 || segment.header->reflectorCount == 0 ||
+            segment.header->reflectorCount > 4) {
+            throw std::runtime_error("索引ファイルが壊れています: " + path_);
+        }
+
+        if (segment.header->entryCount > size / sizeof(Entry)) {
+            throw std::runtime_error("索引ファイルが壊れています: " + path_);
+        }
+        size_t ordersSize = segment.header->orderCount * sizeof(OrderRecord);
+        size_t entriesSize = static_cast<size_t>(segment.header->entryCount) * sizeof(Entry);
+        if (offset + ordersSize + entriesSize > size) {
+            throw std::runtime_error("索引ファイルが壊れています: " + path_);
+        }
+        segment.orders = reinterpret_cast<const OrderRecord*>(data + offset);
+        offset += ordersSize;
+        segment.entries = reinterpret_cast<const Entry*>(data + offset);
+        offset += entriesSize;
+
+        // queryはsettingからローター順とリフレクターの添字を求めるので、範囲外のエントリを拒否する
+        const size_t settingCount =
+            static_cast<size_t>(segment.header->orderCount) * segment.header->reflectorCount;
+        for (uint64_t i = 0; i < segment.header->entryCount; i++) {
+            if (segment.entries[i].setting >= settingCount ||
+                segment.entries[i].state >= ScramblerTable::NUM_STATES) {
+                throw std::runtime_error("索引ファイルのエントリが範囲外です: " + path_);
+            }
+        }
+
+        segments_.push_back(segment);
+    }
+    validEnd_ = offset;
+}
+
+size_t CribIndex::addCrib(const std::string& cribText,
+                          const std::vector<std::string>& rotorTypes,
+                          const std::vector<std::string>& reflectorTypes,
+                          std::function<void(const std::string&)> progressCallback) {
+    std::string crib = normalizeLetters(cribText);
+    if (crib.length() < static_cast<size_t>(PREFIX_LENGTH) || crib.length() >= sizeof(SegmentHeader::crib)) {
+        throw std::invalid_argument("クリブは" + std::to_string(PREFIX_LENGTH) + "〜" +
+                                    std::to_string(sizeof(SegmentHeader::crib) - 1) + "文字である必要があります");
+    }
+    if (reflectorTypes.empty() || reflectorTypes.size() > 4) {
+        throw std::invalid_argument("リフレクターは1〜4種類で指定してください");
+    }
+    for (const auto& type : rotorTypes) {
+        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end() ||
+            type.size() >= sizeof(OrderRecord::rotors[0])) {
+            throw std::invalid_argument("無効なローター: " + type);
+        }
+    }
+    for (const auto& type : reflectorTypes) {
+        if (enigma::REFLECTOR_DEFINITIONS.find(type) == enigma::REFLECTOR_DEFINITIONS.end() ||
+            type.size() >= sizeof(SegmentHeader::reflectors[0])) {
+            throw std::invalid_argument("無効なリフレクター: " + type);
+        }
+    }
+
+    auto rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes, true);
+    const size_t settingCount = rotorOrders.size() * reflectorTypes.size();
+    if (settingCount > 0xFFFF) {
+        throw std::invalid_argument("ローター順とリフレクターの組み合わせが多すぎます");
+    }
+
+    // 同じ設定の組（ローター順×リフレクター、並びは問わない）が既にあれば重複とする
+    std::vector<std::string> settingKeys;
+    for (const auto& reflector : reflectorTypes) {
+        for (const auto& order : rotorOrders) {
+            settingKeys.push_back(reflector + "/" + order[0] + "/" + order[1] + "/" + order[2]);
+        }
+    }
+    std::sort(settingKeys.begin(), settingKeys.end());
+    for (const auto& segment : segments_) {
+        const SegmentHeader& header = *segment.header;
+        if (fixedString(header.crib, sizeof(header.crib)) != crib ||
+            static_cast<size_t>(header.orderCount) * header.reflectorCount != settingKeys.size()) {
+            continue;
+        }
+        std::vector<std::string> existing;
+        for (uint32_t r = 0; r < header.reflectorCount; r++) {
+            std::string reflector = fixedString(header.reflectors[r], sizeof(header.reflectors[r]));
+            for (uint32_t o = 0; o < header.orderCount; o++) {
+                const OrderRecord& order = segment.orders[o];
+                existing.push_back(reflector + "/" + fixedString(order.rotors[0], sizeof(order.rotors[0])) +
+                                   "/" + fixedString(order.rotors[1], sizeof(order.rotors[1])) +
+                                   "/" + fixedString(order.rotors[2], sizeof(order.rotors[2])));
+            }
+        }
+        std::sort(existing.begin(), existing.end());
+        if (existing == settingKeys) {
+            throw std::invalid_argument("このクリブは既に登録されています: " + crib);
+        }
+    }
+
+    const size_t numStates = ScramblerTable::NUM_STATES;
+    std::vector<Entry> entries(settingCount * numStates);
+    std::vector<uint8_t> cribLetters(crib.begin(), crib.begin() + PREFIX_LENGTH);
+    for (auto& c : cribLetters) c = static_cast<uint8_t>(c - 'A');
+
+    for (size_t r = 0; r < reflectorTypes.size(); r++) {
+        for (size_t o = 0; o < rotorOrders.size(); o++) {
+            auto sharedTable = ScramblerTable::get(rotorOrders[o], reflectorTypes[r]);
+            const ScramblerTable& table = *sharedTable;
+            const size_t setting = r * rotorOrders.size() + o;
+
+            #pragma omp parallel for schedule(static)
+            for (int state = 0; state < ScramblerTable::NUM_STATES; state++) {
+                // 先頭PREFIX_LENGTH文字の暗号文を26進数にする
+                uint32_t key = 0;
+                int current = state;
+                for (int i = 0; i < PREFIX_LENGTH; i++) {
+                    current = table.next(current);
+                    key = key * 26 + table.perm(current)[cribLetters[i]];
+                }
+                Entry& entry = entries[setting * numStates + state];
+                entry.key = key;
+                entry.setting = static_cast<uint16_t>(setting);
+                entry.state = static_cast<uint16_t>(state);
+            }
+        }
+
+        if (progressCallback) {
+            progressCallback("Indexed reflector " + reflectorTypes[r] + " (" +
+                             std::to_string(rotorOrders.size()) + " rotor orders)");
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.key != b.key) return a.key < b.key;
+        if (a.setting != b.setting) return a.setting < b.setting;
+        return a.state < b.state;
+    });
+
+    SegmentHeader segment{};
+    std::strncpy(segment.crib, crib.c_str(), sizeof(segment.crib) - 1);
+    segment.cribLength = static_cast<uint32_t>(crib.length());
+    segment.orderCount = static_cast<uint32_t>(rotorOrders.size());
+    segment.reflectorCount = static_cast<uint32_t>(reflectorTypes.size());
+    segment.entryCount = entries.size();
+    for (size_t r = 0; r < reflectorTypes.size(); r++) {
+        std::strncpy(segment.reflectors[r], reflectorTypes[r].c_str(), sizeof(segment.reflectors[r]) - 1);
+    }
+
+    std::vector<OrderRecord> orders(rotorOrders.size());
+    for (size_t o = 0; o < rotorOrders.size(); o++) {
+        std::memset(&orders[o], 0, sizeof(OrderRecord));
+        for (int i = 0; i < 3; i++) {
+            std::strncpy(orders[o].rotors[i], rotorOrders[o][i].c_str(), sizeof(orders[o].rotors[i]) - 1);
+        }
+    }
+
+    // 書き込み中はマップを外す（Windowsではマップ中のファイルを伸ばせない）
+    uint32_t segmentCount = static_cast<uint32_t>(segments_.size());
+    uint64_t validEnd = validEnd_;
+    segments_.clear();
+    file_.close();
+
+    if (segmentCount == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+        header.version = INDEX_VERSION;
+        std::ofstream create(path_, std::ios::binary | std::ios::trunc);
+        create.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!create) {
+            throw std::runtime_error("索引ファイルを作成できません: " + path_);
+        }
+        validEnd = sizeof(FileHeader);
+    }
+
+    // 以前に中断した追記の残りを切り捨て、最後の完全なセグメントの直後に書く
+    std::error_code error;
+    std::filesystem::resize_file(path_, validEnd, error);
+    bool written = !error;
+    if (written) {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(validEnd));
+        file.write(reinterpret_cast<const char*>(&segment), sizeof(segment));
+        file.write(reinterpret_cast<const char*>(orders.data()), orders.size() * sizeof(OrderRecord));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+        file.flush();
+
+        // 追記が終わってからセグメント数を更新する（ここまで来なければ追記は無かったことになる）
+        if (file) {
+            segmentCount++;
+            file.seekp(offsetof(FileHeader, segmentCount));
+            file.write(reinterpret_cast<const char*>(&segmentCount), sizeof(segmentCount));
+            file.flush();
+        }
+        written = static_cast<bool>(file);
+    }
+    if (!written) {
+        std::filesystem::resize_file(path_, validEnd, error);
+        load();
+        throw std::runtime_error("索引ファイルの書き込みに失敗しました: " + path_);
+    }
+
+    load();
+    return entries.size();
+}
+
+std::vector<CribIndexMatch> CribIndex::query(const std::string& cipherText) const {
+    std::vector<CribIndexMatch> matches;
+    std::string cipher = normalizeLetters(cipherText);
+    if (cipher.length() < static_cast<size_t>(PREFIX_LENGTH)) {
+        return matches;
+    }
+    const uint32_t key = prefixKey(cipher);
+
+    struct ByKey {
+        bool operator()(const Entry& e, uint32_t k) const { return e.key < k; }
+        bool operator()(uint32_t k, const Entry& e) const { return k < e.key; }
+    };
+
+    for (const auto& segment : segments_) {
+        const SegmentHeader& header = *segment.header;
+        std::string crib = fixedString(header.crib, sizeof(header.crib));
+        // クリブ全体を確認できる長さが必要
+        if (cipher.length() < crib.length()) continue;
+
+        auto range = std::equal_range(segment.entries, segment.entries + header.entryCount, key, ByKey());
+        for (const Entry* e = range.first; e != range.second; ++e) {
+            CribIndexMatch match;
+            match.crib = crib;
+            const OrderRecord& order = segment.orders[e->setting % header.orderCount];
+            for (int i = 0; i < 3; i++) {
+                match.rotorOrder.push_back(fixedString(order.rotors[i], sizeof(order.rotors[i])));
+            }
+            const char* reflector = header.reflectors[e->setting / header.orderCount];
+            match.reflectorType = fixedString(reflector, sizeof(header.reflectors[0]));
+            match.positions = ScramblerTable::statePositions(e->state);
+
+            // 先頭PREFIX_LENGTH文字以降も一致するか確認する
+            auto machine = createMachine(match.rotorOrder, match.reflectorType);
+            machine->setRotorPositions(match.positions);
+            if (machine->encrypt(crib) == cipher.substr(0, crib.length())) {
+                matches.push_back(std::move(match));
+            }
+        }
+    }
+    return matches;
+}
+
+std::vector<CribIndex::SegmentInfo> CribIndex::getSegments() const {
+    std::vector<SegmentInfo> infos;
+    for (const auto& segment : segments_) {
+        const SegmentHeader& header = *segment.header;
+        SegmentInfo info;
+        info.crib = fixedString(header.crib, sizeof(header.crib));
+        for (uint32_t r = 0; r < header.reflectorCount && r < 4; r++) {
+            info.reflectorTypes.push_back(fixedString(header.reflectors[r], sizeof(header.reflectors[r])));
+        }
+        info.orderCount = header.orderCount;
+        info.entryCount = static_cast<size_t>(header.entryCount);
+        infos.push_back(info);
+    }
+    return infos;
+}
@@ -0,0 +1,71 @@
+#ifndef CRIB_INDEX_H
+#define CRIB_INDEX_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+struct CribIndexMatch {
+    std::string crib;
+    std::vector<std::string> rotorOrder;
+    std::string reflectorType;
+    std::vector<int> positions;   // メッセージの開始位置（EnigmaMachine::setRotorPositionsと同じ並び）
+
+    std::string getPositionString() const;
+    std::string getRotorString() const;
+};
+
+// プラグボードのない機械で、決まった書き出し（オフセット0のクリブ）の暗号文から
+// 設定を直接引くための索引
+// 登録したクリブごとに全ローター順×全位置×リフレクターで暗号化し、
+// 暗号文の先頭PREFIX_LENGTH文字（26進数）で並べたセグメントとしてファイルに追記する。
+// ファイルは読み取り専用でマップし、問い合わせはセグメントごとの二分探索で答える
+class CribIndex {
+public:
+    static constexpr int PREFIX_LENGTH = 6;
+
+    // 索引ファイルをマップする（存在しない場合は空の索引）
+    explicit CribIndex(const std::string& path);
+
+    // クリブを1つ登録してファイルに追記し、追加した項目数を返す
+    // 同じクリブ・同じローター順とリフレクターの組が既にある場合はstd::invalid_argumentを投げる
+    // 追記に失敗してもファイルは最後の完全なセグメントまでに戻す
+    size_t addCrib(const std::string& crib,
+                   const std::vector<std::string>& rotorTypes,
+                   const std::vector<std::string>& reflectorTypes,
+                   std::function<void(const std::string&)> progressCallback = nullptr);
+
+    // 暗号文の先頭が登録済みクリブの暗号文と一致する設定を返す（全文字を再暗号化して確認）
+    std::vector<CribIndexMatch> query(const std::string& cipherText) const;
+
+    struct SegmentInfo {
+        std::string crib;
+        std::vector<std::string> reflectorTypes;
+        size_t orderCount;
+        size_t entryCount;
+    };
+    std::vector<SegmentInfo> getSegments() const;
+
+private:
+    struct FileHeader;
+    struct SegmentHeader;
+    struct OrderRecord;
+    struct Entry;
+
+    struct Segment {
+        const SegmentHeader* header;
+        const OrderRecord* orders;
+        const Entry* entries;
+    };
+
+    std::string path_;
+    MappedFile file_;
+    std::vector<Segment> segments_;
+    uint64_t validEnd_ = 0;   // 最後の完全なセグメントの終端（これ以降は中断した追記の残り）
+
+    void load();
+};
+
+#endif // CRIB_INDEX_H
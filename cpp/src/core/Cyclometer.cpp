@@ -0,0 +1,376 @@
+#include "Cyclometer.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// カタログファイルの形式（リトルエンディアン、ネイティブ配置）
+//   Header | OrderRecord × orderCount | Entry × entryCount（特性・ローター順・状態の昇順）
+struct Cyclometer::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t orderCount;
+    uint64_t entryCount;
+    char reflector[8];
+};
+
+struct Cyclometer::OrderRecord {
+    char rotors[3][8];
+};
+
+struct Cyclometer::Entry {
+    Characteristic characteristic;
+    uint16_t order;
+    uint16_t state;
+};
+
+namespace {
+
+const char CATALOG_MAGIC[8] = {'E', 'N', 'I', 'G', 'C', 'Y', 'C', 'L'};
+const uint32_t CATALOG_VERSION = 1;
+
+// 13の分割を「長さごとの個数（4ビットずつ）」で符号化し、昇順に並べた表
+const std::vector<uint64_t>& partitionCodes() {
+    static const std::vector<uint64_t> codes = [] {
+        std::vector<uint64_t> result;
+        // 各長さの個数を再帰的に決める
+        std::function<void(int, int, uint64_t)> generate = [&](int length, int remaining, uint64_t code) {
+            if (remaining == 0) {
+                result.push_back(code);
+                return;
+            }
+            if (length > 13) return;
+            for (int count = 0; count * length <= remaining; count++) {
+                generate(length + 1, remaining - count * length,
+                         code | (static_cast<uint64_t>(count) << (4 * (length - 1))));
+            }
+        };
+        generate(1, 13, 0);
+        std::sort(result.begin(), result.end());
+        return result;
+    }();
+    return codes;
+}
+
+// 置換（26文字）の巡回構造を分割番号に変換する。対にならない場合は-1
+int partitionIndex(const std::array<uint8_t, 26>& product) {
+    std::array<int, 27> lengthCounts{};
+    std::array<bool, 26> visited{};
+    for (int start = 0; start < 26; start++) {
+        if (visited[start]) continue;
+        int length = 0;
+        int c = start;
+        while (!visited[c]) {
+            visited[c] = true;
+            c = product[c];
+            length++;
+        }
+        lengthCounts[length]++;
+    }
+
+    uint64_t code = 0;
+    for (int length = 1; length <= 13; length++) {
+        if (lengthCounts[length] % 2 != 0) return -1;
+        code |= static_cast<uint64_t>(lengthCounts[length] / 2) << (4 * (length - 1));
+    }
+    if (lengthCounts[26] != 0) return -1;
+
+    const auto& codes = partitionCodes();
+    auto it = std::lower_bound(codes.begin(), codes.end(), code);
+    if (it == codes.end() || *it != code) return -1;
+    return static_cast<int>(it - codes.begin());
+}
+
+Cyclometer::Characteristic combine(const int parts[3]) {
+    return static_cast<Cyclometer::Characteristic>(
+        (parts[0] * Cyclometer::PARTITION_COUNT + parts[1]) * Cyclometer::PARTITION_COUNT + parts[2]);
+}
+
+std::string normalizeIndicator(const std::string& indicator) {
+    std::string result;
+    for (char c : indicator) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (c >= 'A' && c <= 'Z') result += c;
+    }
+    return result;
+}
+
+} // namespace
+
+std::string CyclometerMatch::getPositionString() const {
+    std::string result;
+    for (int pos : positions) {
+        result += static_cast<char>('A' + pos);
+    }
+    return result;
+}
+
+std::string CyclometerMatch::getRotorString() const {
+    std::string result;
+    for (size_t i = 0; i < rotorOrder.size(); i++) {
+        result += rotorOrder[i];
+        if (i < rotorOrder.size() - 1) {
+            result += "-";
+        }
+    }
+    return result;
+}
+
+Cyclometer::Characteristic Cyclometer::characteristicAt(const ScramblerTable& table, int groundState) {
+    // 指標の6文字は基本位置から1〜6ステップ後の状態で暗号化される
+    std::vector<int> states = table.stateSequence(groundState, 6);
+
+    int parts[3];
+    for (int k = 0; k < 3; k++) {
+        const uint8_t* first = table.perm(states[k]);
+        const uint8_t* second = table.perm(states[k + 3]);
+        std::array<uint8_t, 26> product;
+        for (int c = 0; c < 26; c++) {
+            product[c] = second[first[c]];
+        }
+        parts[k] = partitionIndex(product);
+    }
+    return combine(parts);
+}
+
+Cyclometer::Characteristic Cyclometer::characteristicFromIndicators(
+    const std::vector<std::string>& indicators) {
+    std::array<std::array<int, 26>, 3> mapping;
+    for (auto& m : mapping) m.fill(-1);
+
+    for (const auto& raw : indicators) {
+        std::string indicator = normalizeIndicator(raw);
+        if (indicator.length() != 6) {
+            throw std::invalid_argument("指標は6文字である必要があります: " + raw);
+        }
+        for (int k = 0; k < 3; k++) {
+            int from = indicator[k] - 'A';
+            int to = indicator[k + 3] - 'A';
+            if (mapping[k][from] >= 0 && mapping[k][from] != to) {
+                throw std::invalid_argument("指標が矛盾しています: " + raw);
+            }
+            mapping[k][from] = to;
+        }
+    }
+
+    int parts[3];
+    for (int k = 0; k < 3; k++) {
+        std::array<uint8_t, 26> product;
+        std::array<bool, 26> used{};
+        int missing = 0;
+        for (int c = 0; c < 26; c++) {
+            if (mapping[k][c] < 0) {
+                missing++;
+                continue;
+            }
+            if (used[mapping[k][c]]) {
+                throw std::invalid_argument("指標が矛盾しています（置換が全単射になりません）");
+            }
+            used[mapping[k][c]] = true;
+            product[c] = static_cast<uint8_t>(mapping[k][c]);
+        }
+        // 未確定が1文字だけなら、残った1文字に決まる
+        if (missing == 1) {
+            int from = static_cast<int>(std::find(mapping[k].begin(), mapping[k].end(), -1) - mapping[k].begin());
+            int to = static_cast<int>(std::find(used.begin(), used.end(), false) - used.begin());
+            product[from] = static_cast<uint8_t>(to);
+            missing = 0;
+        }
+        if (missing > 0) {
+            static const char* names[3] = {"AD", "BE", "CF"};
+            throw std::invalid_argument(std::string("指標が不足しています: ") + names[k] +
+                                        " の未確定文字数 " + std::to_string(missing));
+        }
+        parts[k] = partitionIndex(product);
+        if (parts[k] < 0) {
+            throw std::invalid_argument("指標が矛盾しています（巡回が対になりません）");
+        }
+    }
+    return combine(parts);
+}
+
+std::string Cyclometer::describe(Characteristic characteristic) {
+    static const char* names[3] = {"AD", "BE", "CF"};
+    int parts[3] = {
+        static_cast<int>(characteristic / (PARTITION_COUNT * PARTITION_COUNT)),
+        static_cast<int>((characteristic / PARTITION_COUNT) % PARTITION_COUNT),
+        static_cast<int>(characteristic % PARTITION_COUNT)
+    };
+
+    const auto& codes = partitionCodes();
+    std::ostringstream oss;
+    for (int k = 0; k < 3; k++) {
+        if (k > 0) oss << " | ";
+        oss << names[k] << ":";
+        if (parts[k] < 0 || parts[k] >= PARTITION_COUNT) {
+            oss << " ?";
+            continue;
+        }
+        uint64_t code = codes[parts[k]];
+        // 長い巡回から順に、対の両方を表示する
+        for (int length = 13; length >= 1; length--) {
+            int count = static_cast<int>((code >> (4 * (length - 1))) & 0xF);
+            for (int i = 0; i < count * 2; i++) {
+                oss << " " << length;
+            }
+        }
+    }
+    return oss.str();
+}
+
+size_t Cyclometer::buildCatalog(const std::string& path,
+                                const std::vector<std::string>& rotorTypes,
+                                const std::string& reflectorType,
+                                std::function<void(const std::string&)> progressCallback) {
+    auto rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes, true);
+    if (rotorOrders.empty() || rotorOrders.size() > 0xFFFF) {
+        throw std::invalid_argument("ローター順の数が不正です");
+    }
+    for (const auto& type : rotorTypes) {
+        if (type.size() >= sizeof(OrderRecord::rotors[0])) {
+            throw std::invalid_argument("ローター名が長すぎます: " + type);
+        }
+    }
+    if (reflectorType.size() >= sizeof(Header::reflector)) {
+        throw std::invalid_argument("リフレクター名が長すぎます: " + reflectorType);
+    }
+
+    const size_t numStates = ScramblerTable::NUM_STATES;
+    std::vector<Entry> entries(rotorOrders.size() * numStates);
+
+    for (size_t o = 0; o < rotorOrders.size(); o++) {
+        auto sharedTable = ScramblerTable::get(rotorOrders[o], reflectorType);
+        const ScramblerTable& table = *sharedTable;
+
+        #pragma omp parallel for schedule(static)
+        for (int state = 0; state < ScramblerTable::NUM_STATES; state++) {
+            Entry& entry = entries[o * numStates + state];
+            entry.characteristic = characteristicAt(table, state);
+            entry.order = static_cast<uint16_t>(o);
+            entry.state = static_cast<uint16_t>(state);
+        }
+
+        if (progressCallback) {
+            progressCallback("Cataloged rotor order " + std::to_string(o + 1) + "/" +
+                             std::to_string(rotorOrders.size()));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.characteristic != b.characteristic) return a.characteristic < b.characteristic;
+        if (a.order != b.order) return a.order < b.order;
+        return a.state < b.state;
+    });
+
+    Header header{};
+    std::memcpy(header.magic, CATALOG_MAGIC, sizeof(header.magic));
+    header.version = CATALOG_VERSION;
+    header.orderCount = static_cast<uint32_t>(rotorOrders.size());
+    header.entryCount = entries.size();
+    std::strncpy(header.reflector, reflectorType.c_str(), sizeof(header.reflector) - 1);
+
+    std::vector<OrderRecord> orders(rotorOrders.size());
+    for (size_t o = 0; o < rotorOrders.size(); o++) {
+        std::memset(&orders[o], 0, sizeof(OrderRecord));
+        for (int r = 0; r < 3; r++) {
+            std::strncpy(orders[o].rotors[r], rotorOrders[o][r].c_str(), sizeof(orders[o].rotors[r]) - 1);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("カタログファイルを作成できません: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(orders.data()), orders.size() * sizeof(OrderRecord));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    if (!file) {
+        throw std::runtime_error("カタログファイルの書き込みに失敗しました: " + path);
+    }
+
+    if (progressCallback) {
+        progressCallback("Catalog written: " + std::to_string(entries.size()) + " entries");
+    }
+    return entries.size();
+}
+
+Cyclometer::Cyclometer(const std::string& catalogPath) : file_(catalogPath) {
+    if (file_.size() < sizeof(Header)) {
+        throw std::runtime_error("カタログファイルが壊れています: " + catalogPath);
+    }
+    header_ = reinterpret_cast<const Header*>(file_.data());
+    if (std::memcmp(header_->magic, CATALOG_MAGIC, sizeof(CATALOG_MAGIC)) != 0 ||
+        header_->version != CATALOG_VERSION) {
+        throw std::runtime_error("カタログファイルの形式が異なります: " + catalogPath);
+    }
+
+    if (header_->entryCount > file_.size() / sizeof(Entry)) {
+        throw std::runtime_error("カタログファイルが壊れています: " + catalogPath);
+    }
+    size_t expected = sizeof(Header) + header_->orderCount * sizeof(OrderRecord) +
+                      header_->entryCount * sizeof(Entry);
+    if (file_.size() != expected) {
+        throw std::runtime_error("カタログファイルが壊れています: " + catalogPath);
+    }
+
+    orders_ = reinterpret_cast<const OrderRecord*>(file_.data() + sizeof(Header));
+    entries_ = reinterpret_cast<const Entry*>(
+        file_.data() + sizeof(Header) + header_->orderCount * sizeof(OrderRecord));
+
+    // lookupはローター順・状態をそのまま添字に使うので、範囲外のエントリを拒否する
+    for (uint32_t o = 0; o < header_->orderCount; o++) {
+        for (int r = 0; r < 3; r++) {
+            if (orders_[o].rotors[r][sizeof(orders_[o].rotors[r]) - 1] != '\0') {
+                throw std::runtime_error("カタログファイルのローター名が不正です: " + catalogPath);
+            }
+        }
+    }
+    for (uint64_t i = 0; i < header_->entryCount; i++) {
+        if (entries_[i].order >= header_->orderCount || entries_[i].state >= ScramblerTable::NUM_STATES) {
+            throw std::runtime_error("カタログファイルのエントリが範囲外です: " + catalogPath +
+                                     " (" + std::to_string(i) + ")");
+        }
+    }
+}
+
+std::vector<CyclometerMatch> Cyclometer::lookup(Characteristic characteristic) const {
+    const Entry* begin = entries_;
+    const Entry* end = entries_ + header_->entryCount;
+    struct ByCharacteristic {
+        bool operator()(const Entry& e, Characteristic c) const { return e.characteristic < c; }
+        bool operator()(Characteristic c, const Entry& e) const { return c < e.characteristic; }
+    };
+    auto range = std::equal_range(begin, end, characteristic, ByCharacteristic());
+
+    std::vector<CyclometerMatch> matches;
+    matches.reserve(range.second - range.first);
+    for (const Entry* e = range.first; e != range.second; ++e) {
+        CyclometerMatch match;
+        const OrderRecord& order = orders_[e->order];
+        for (int r = 0; r < 3; r++) {
+            match.rotorOrder.emplace_back(order.rotors[r]);
+        }
+        match.positions = ScramblerTable::statePositions(e->state);
+        matches.push_back(std::move(match));
+    }
+    return matches;
+}
+
+std::vector<CyclometerMatch> Cyclometer::match(const std::vector<std::string>& indicators) const {
+    return lookup(characteristicFromIndicators(indicators));
+}
+
+size_t Cyclometer::getEntryCount() const {
+    return static_cast<size_t>(header_->entryCount);
+}
+
+size_t Cyclometer::getOrderCount() const {
+    return header_->orderCount;
+}
+
+std::string Cyclometer::getReflectorType() const {
+    return std::string(header_->reflector);
+}
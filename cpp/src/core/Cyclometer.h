@@ -0,0 +1,66 @@
+#ifndef CYCLOMETER_H
+#define CYCLOMETER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "ScramblerTable.h"
+
+struct CyclometerMatch {
+    std::vector<std::string> rotorOrder;
+    std::vector<int> positions;   // 基本位置（EnigmaMachine::setRotorPositionsと同じ並び）
+
+    std::string getPositionString() const;
+    std::string getRotorString() const;
+};
+
+// Rejewskiのサイクロメーターによる特性カタログ
+// 基本位置で二重に暗号化された指標（6文字）では、1文字目と4文字目・2文字目と5文字目・
+// 3文字目と6文字目の置換の積AD/BE/CFの巡回構造がプラグボードに依存しない。
+// 全ローター順×17,576位置の特性を事前計算し、特性でソートしたインデックスとして保存する
+class Cyclometer {
+public:
+    // 積の巡回は同じ長さが対で現れるため、片側の長さは13の分割で表せる（101通り）
+    static constexpr int PARTITION_COUNT = 101;
+    using Characteristic = uint32_t;
+
+    // カタログファイルを読み取り専用でマップする
+    explicit Cyclometer(const std::string& catalogPath);
+
+    // 基本位置groundStateでの特性（AD/BE/CFの分割番号を合成した値）
+    static Characteristic characteristicAt(const ScramblerTable& table, int groundState);
+
+    // 同じ基本位置で暗号化された指標群から特性を求める
+    // 置換が確定しない（指標が足りない）場合や矛盾がある場合はstd::invalid_argumentを投げる
+    static Characteristic characteristicFromIndicators(const std::vector<std::string>& indicators);
+
+    // "AD: 13 13 | BE: ... | CF: ..." の形式
+    static std::string describe(Characteristic characteristic);
+
+    // 全ローター順（rotorTypesから3枚を選ぶ順列）のカタログを作成してpathに書き込む
+    static size_t buildCatalog(const std::string& path,
+                               const std::vector<std::string>& rotorTypes,
+                               const std::string& reflectorType,
+                               std::function<void(const std::string&)> progressCallback = nullptr);
+
+    std::vector<CyclometerMatch> lookup(Characteristic characteristic) const;
+    std::vector<CyclometerMatch> match(const std::vector<std::string>& indicators) const;
+
+    size_t getEntryCount() const;
+    size_t getOrderCount() const;
+    std::string getReflectorType() const;
+
+private:
+    struct Header;
+    struct OrderRecord;
+    struct Entry;
+
+    MappedFile file_;
+    const Header* header_ = nullptr;
+    const OrderRecord* orders_ = nullptr;
+    const Entry* entries_ = nullptr;
+};
+
+#endif // CYCLOMETER_H
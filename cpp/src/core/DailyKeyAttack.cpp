@@ -0,0 +1,510 @@
+#include "DailyKeyAttack.h"
+#include "Plugboard.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string normalize(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        char u = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (u >= 'A' && u <= 'Z') {
+            result += u;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+DailyKeyAttack::DailyKeyAttack(const std::vector<TrafficMessage>& messages,
+                               const std::vector<std::string>& rotorTypes,
+                               const std::string& reflectorType,
+                               bool testAllOrders)
+    : rotorTypes_(rotorTypes), reflectorType_(reflectorType), testAllOrders_(testAllOrders) {
+    for (const auto& message : messages) {
+        TrafficMessage normalized;
+        normalized.cipherText = normalize(message.cipherText);
+        normalized.crib = normalize(message.crib);
+        normalized.cribPosition = message.cribPosition;
+        messages_.push_back(normalized);
+    }
+}
+
+std::vector<int> DailyKeyAttack::offsetsFor(size_t messageIdx) const {
+    const auto& message = messages_[messageIdx];
+    std::vector<int> offsets;
+    if (message.crib.empty() || message.crib.length() > message.cipherText.length()) {
+        return offsets;
+    }
+
+    int maxOffset = static_cast<int>(message.cipherText.length() - message.crib.length() + 1);
+    if (message.cribPosition >= 0) {
+        if (message.cribPosition < maxOffset) {
+            offsets.push_back(message.cribPosition);
+        }
+    } else {
+        for (int offset = 0; offset < maxOffset; offset++) {
+            offsets.push_back(offset);
+        }
+    }
+    return offsets;
+}
+
+bool DailyKeyAttack::extendSteckers(const ScramblerTable& table,
+                                    const std::vector<int>& states,
+                                    size_t messageIdx,
+                                    int offset,
+                                    Steckers& steckers,
+                                    int& pairCount) const {
+    const auto& crib = messages_[messageIdx].crib;
+    const auto& cipher = messages_[messageIdx].cipherText;
+
+    auto connect = [&](int a, int b) {
+        if (steckers[a] >= 0 && steckers[a] != b) return false;
+        if (steckers[b] >= 0 && steckers[b] != a) return false;
+        if (steckers[a] < 0) {
+            steckers[a] = static_cast<int8_t>(b);
+            steckers[b] = static_cast<int8_t>(a);
+            if (a != b && ++pairCount > Plugboard::MAX_PAIRS) return false;
+        }
+        return true;
+    };
+
+    // メニューの各リンク（クリブ文字⇔暗号文字）について、どちらかの側の
+    // ステッカーが確定していれば、スクランブラ（対合）を通して反対側が決まる
+    std::vector<bool> done(crib.length(), false);
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < crib.length(); i++) {
+            if (done[i]) continue;
+
+            int plain = crib[i] - 'A';
+            int enc = cipher[offset + i] - 'A';
+            const uint8_t* perm = table.perm(states[offset + i]);
+
+            if (steckers[plain] >= 0) {
+                if (!connect(perm[steckers[plain]], enc)) return false;
+            } else if (steckers[enc] >= 0) {
+                if (!connect(perm[steckers[enc]], plain)) return false;
+            } else {
+                continue;
+            }
+            done[i] = true;
+            progress = true;
+        }
+    }
+    return true;
+}
+
+DailyKeyAttack::PlacementTable DailyKeyAttack::buildPlacementTable(
+    const ScramblerTable& table,
+    size_t messageIdx,
+    size_t limit) const {
+
+    const auto& message = messages_[messageIdx];
+    int length = static_cast<int>(message.cipherText.length());
+
+    PlacementTable placements;
+    for (int offset : offsetsFor(messageIdx)) {
+        int linkCount[26] = {0};
+        for (size_t i = 0; i < message.crib.length(); i++) {
+            linkCount[message.crib[i] - 'A']++;
+            linkCount[message.cipherText[offset + i] - 'A']++;
+        }
+        OffsetPlacements block;
+        block.offset = offset;
+        block.centre = static_cast<int>(std::max_element(linkCount, linkCount + 26) - linkCount);
+        placements.offsets.push_back(std::move(block));
+    }
+
+    std::mutex placementsMutex;
+    std::atomic<bool> overflow{false};
+
+    // 起点文字のステッカーを26通り仮定し、メニュー全体に伝播して矛盾しないものを残す
+    #pragma omp parallel
+    {
+        std::vector<std::pair<size_t, Placement>> local;  // （オフセットの添字, 配置）
+
+        auto flush = [&]() {
+            std::lock_guard<std::mutex> lock(placementsMutex);
+            for (const auto& [block, placement] : local) {
+                auto& offsetPlacements = placements.offsets[block];
+                offsetPlacements.byPartner[placement.steckers[offsetPlacements.centre]].push_back(placement);
+            }
+            placements.entries += local.size();
+            if (placements.entries > limit) {
+                overflow = true;
+            }
+            local.clear();
+        };
+
+        #pragma omp for schedule(dynamic, 64)
+        for (int startState = 0; startState < ScramblerTable::NUM_STATES; startState++) {
+            if (overflow || stopFlag_) continue;
+
+            std::vector<int> states = table.stateSequence(startState, length);
+            for (size_t block = 0; block < placements.offsets.size(); block++) {
+                int offset = placements.offsets[block].offset;
+                int centre = placements.offsets[block].centre;
+                for (int assumed = 0; assumed < 26; assumed++) {
+                    Placement placement{startState, offset, {}, assumed == centre ? 0 : 1};
+                    placement.steckers.fill(-1);
+                    placement.steckers[centre] = static_cast<int8_t>(assumed);
+                    placement.steckers[assumed] = static_cast<int8_t>(centre);
+                    if (extendSteckers(table, states, messageIdx, offset,
+                                       placement.steckers, placement.pairCount)) {
+                        local.emplace_back(block, placement);
+                    }
+                }
+            }
+            if (local.size() >= 1024) {
+                flush();
+            }
+        }
+        flush();
+    }
+
+    placements.overflow = overflow;
+    for (auto& block : placements.offsets) {
+        for (auto& bucket : block.byPartner) {
+            if (placements.overflow) {
+                std::vector<Placement>().swap(bucket);
+                continue;
+            }
+            // スレッドの実行順によらず同じ順序にする
+            std::sort(bucket.begin(), bucket.end(), [](const Placement& a, const Placement& b) {
+                return a.startState < b.startState;
+            });
+        }
+    }
+    return placements;
+}
+
+std::vector<DailyKeyAttack::Placement> DailyKeyAttack::placeMessage(
+    const ScramblerTable& table,
+    size_t messageIdx,
+    const PlacementTable& placements,
+    const Steckers& steckers,
+    size_t limit) const {
+
+    int length = static_cast<int>(messages_[messageIdx].cipherText.length());
+    std::vector<Placement> result;
+
+    for (const auto& block : placements.offsets) {
+        // 仮説で起点文字の相手が決まっていれば、その仮定の配置だけを見ればよい
+        int known = steckers[block.centre];
+        int first = known >= 0 ? known : 0;
+        int last = known >= 0 ? known : 25;
+
+        for (int partner = first; partner <= last; partner++) {
+            for (const auto& entry : block.byPartner[partner]) {
+                if (stopFlag_) return result;
+
+                // 両方とも対合なので、確定済みの文字が食い違わなければ和を取れる
+                Placement merged{entry.startState, entry.offset, steckers, 0};
+                bool compatible = true;
+                for (int i = 0; i < 26 && compatible; i++) {
+                    int other = entry.steckers[i];
+                    if (other < 0) continue;
+                    if (merged.steckers[i] >= 0 && merged.steckers[i] != other) {
+                        compatible = false;
+                    }
+                    merged.steckers[i] = static_cast<int8_t>(other);
+                }
+                if (!compatible) continue;
+
+                for (int i = 0; i < 26; i++) {
+                    if (merged.steckers[i] > i) merged.pairCount++;
+                }
+                if (merged.pairCount > Plugboard::MAX_PAIRS) continue;
+
+                // 和から両方のメニューをもう一度伝播させる
+                std::vector<int> states = table.stateSequence(entry.startState, length);
+                if (!extendSteckers(table, states, messageIdx, entry.offset,
+                                    merged.steckers, merged.pairCount)) {
+                    continue;
+                }
+                result.push_back(merged);
+                if (result.size() >= limit) {
+                    return result;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+int DailyKeyAttack::bestStartByScore(const ScramblerTable& table,
+                                     size_t messageIdx,
+                                     const Steckers& steckers,
+                                     double& bestScore) const {
+    const auto& cipher = messages_[messageIdx].cipherText;
+    int length = static_cast<int>(cipher.length());
+    int n = scorer_.order();
+
+    // 未確定の文字は自己ステッカーとみなす
+    std::array<uint8_t, 26> plug;
+    for (int i = 0; i < 26; i++) {
+        plug[i] = static_cast<uint8_t>(steckers[i] >= 0 ? steckers[i] : i);
+    }
+
+    int bestState = -1;
+    bestScore = -std::numeric_limits<double>::infinity();
+    std::mutex bestMutex;
+
+    #pragma omp parallel
+    {
+        int localState = -1;
+        double localScore = -std::numeric_limits<double>::infinity();
+        std::vector<uint8_t> plain(length);
+
+        #pragma omp for schedule(static)
+        for (int startState = 0; startState < ScramblerTable::NUM_STATES; startState++) {
+            int state = startState;
+            for (int i = 0; i < length; i++) {
+                state = table.next(state);
+                plain[i] = plug[table.perm(state)[plug[cipher[i] - 'A']]];
+            }
+
+            double score = 0.0;
+            for (int i = 0; i + n <= length; i++) {
+                score += scorer_.score(&plain[i]);
+            }
+            if (score > localScore) {
+                localScore = score;
+                localState = startState;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(bestMutex);
+        if (localScore > bestScore || (localScore == bestScore && localState < bestState)) {
+            bestScore = localScore;
+            bestState = localState;
+        }
+    }
+    return bestState;
+}
+
+std::vector<DailyKeyCandidate> DailyKeyAttack::attack(
+    std::function<void(const std::string&)> progressCallback) {
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // クリブ付きメッセージを長いクリブ順に並べる（最初のものでBombe探索を行う）
+    std::vector<size_t> cribMessages;
+    for (size_t i = 0; i < messages_.size(); i++) {
+        if (!offsetsFor(i).empty()) {
+            cribMessages.push_back(i);
+        }
+    }
+    std::stable_sort(cribMessages.begin(), cribMessages.end(), [this](size_t a, size_t b) {
+        return messages_[a].crib.length() > messages_[b].crib.length();
+    });
+
+    if (cribMessages.empty()) {
+        if (progressCallback) {
+            progressCallback("No message has a usable crib - daily key attack needs at least one.");
+        }
+        return {};
+    }
+
+    size_t primary = cribMessages[0];
+    auto rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes_, testAllOrders_);
+
+    if (progressCallback) {
+        progressCallback("Starting daily key attack...");
+        progressCallback("Messages: " + std::to_string(messages_.size()) +
+                         " (" + std::to_string(cribMessages.size()) + " with cribs)");
+        progressCallback("Primary crib: " + messages_[primary].crib +
+                         " (message " + std::to_string(primary + 1) + ")");
+        progressCallback("Rotor orders to test: " + std::to_string(rotorOrders.size()));
+    }
+
+    std::vector<DailyKeyCandidate> candidates;
+    int ruledOutOrders = 0;
+    int truncatedOrders = 0;
+    size_t droppedHits = 0;
+
+    for (size_t orderIdx = 0; orderIdx < rotorOrders.size() && !stopFlag_; orderIdx++) {
+        // このローター順のスクランブラ表を全メッセージで共有する
+        std::shared_ptr<const ScramblerTable> table;
+        try {
+            table = ScramblerTable::get(rotorOrders[orderIdx], reflectorType_);
+        } catch (const std::invalid_argument&) {
+            continue;  // 無効なローターまたはリフレクター
+        }
+
+        // 主メッセージのBombe探索（配置表のすべてがヒット）。プラグ数の少ないものから
+        // maxPrimaryHits_件だけを照合に回す。配置表は副メッセージと同じ上限で打ち切る
+        std::vector<Placement> hits;
+        bool primaryTruncated = false;
+        {
+            PlacementTable primaryTable = buildPlacementTable(*table, primary, placementTableLimit_);
+            primaryTruncated = primaryTable.overflow;
+            for (const auto& block : primaryTable.offsets) {
+                for (const auto& bucket : block.byPartner) {
+                    hits.insert(hits.end(), bucket.begin(), bucket.end());
+                }
+            }
+        }
+        std::sort(hits.begin(), hits.end(), [](const Placement& a, const Placement& b) {
+            if (a.pairCount != b.pairCount) return a.pairCount < b.pairCount;
+            return a.startState != b.startState ? a.startState < b.startState : a.offset < b.offset;
+        });
+        size_t totalHits = hits.size();
+        if (primaryTruncated) {
+            truncatedOrders++;
+        }
+        if (hits.size() > maxPrimaryHits_) {
+            droppedHits += hits.size() - maxPrimaryHits_;
+            hits.resize(maxPrimaryHits_);
+        }
+
+        // 残りのクリブ付きメッセージの配置表は、ヒットの数によらずこのローター順で1回だけ作る
+        std::vector<PlacementTable> tables(messages_.size());
+        std::vector<size_t> jointMessages;
+        size_t weakMessages = 0;
+        for (size_t i = 1; i < cribMessages.size() && !stopFlag_ && !hits.empty(); i++) {
+            size_t m = cribMessages[i];
+            tables[m] = buildPlacementTable(*table, m, placementTableLimit_);
+            if (tables[m].overflow) {
+                weakMessages++;
+            } else {
+                jointMessages.push_back(m);
+            }
+        }
+
+        // 平文スコアによる推定はメッセージとステッカー仮説だけで決まるので、
+        // 同じ仮説に行き着いたヒットでは結果を使い回す（開始状態, スコア）
+        std::map<std::pair<size_t, Steckers>, std::pair<int, double>> scoredStarts;
+
+        std::vector<DailyKeyCandidate> orderCandidates;
+        for (const auto& hit : hits) {
+            if (stopFlag_) break;
+
+            Steckers steckers = hit.steckers;
+
+            DailyKeyCandidate candidate;
+            candidate.rotorOrder = rotorOrders[orderIdx];
+            candidate.startPositions.assign(messages_.size(), {});
+            candidate.cribOffsets.assign(messages_.size(), -1);
+            candidate.ngramScores.assign(messages_.size(), 0.0);
+            candidate.startPositions[primary] = ScramblerTable::statePositions(hit.startState);
+            candidate.cribOffsets[primary] = hit.offset;
+            candidate.constrainedMessages = 1;
+
+            // 残りのクリブ付きメッセージで一意に配置できるものから順に制約を追加する
+            std::vector<size_t> pending = jointMessages;
+            bool rejected = false;
+            bool progress = true;
+            while (progress && !rejected && !pending.empty()) {
+                progress = false;
+                for (auto it = pending.begin(); it != pending.end();) {
+                    // 2件見つかれば曖昧と分かる
+                    auto placements = placeMessage(*table, *it, tables[*it], steckers, 2);
+                    if (placements.empty()) {
+                        rejected = true;
+                        break;
+                    }
+                    if (placements.size() == 1) {
+                        steckers = placements[0].steckers;
+                        candidate.startPositions[*it] = ScramblerTable::statePositions(placements[0].startState);
+                        candidate.cribOffsets[*it] = placements[0].offset;
+                        candidate.constrainedMessages++;
+                        it = pending.erase(it);
+                        progress = true;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            if (rejected) {
+                continue;
+            }
+            // 曖昧なまま残ったクリブ付きメッセージも矛盾はないので制約済みとして数える
+            candidate.constrainedMessages += static_cast<int>(pending.size());
+
+            for (int i = 0; i < 26; i++) {
+                if (steckers[i] > i) {
+                    candidate.plugboard.push_back({static_cast<char>('A' + i),
+                                                   static_cast<char>('A' + steckers[i])});
+                }
+            }
+
+            // クリブなし（または未確定）のメッセージは平文スコアで開始位置を推定する
+            for (size_t m = 0; m < messages_.size(); m++) {
+                if (!candidate.startPositions[m].empty() || messages_[m].cipherText.empty()) {
+                    continue;
+                }
+                auto scored = scoredStarts.find({m, steckers});
+                if (scored == scoredStarts.end()) {
+                    double score = 0.0;
+                    int state = bestStartByScore(*table, m, steckers, score);
+                    scored = scoredStarts.emplace(std::make_pair(m, steckers), std::make_pair(state, score)).first;
+                }
+                if (scored->second.first >= 0) {
+                    candidate.startPositions[m] = ScramblerTable::statePositions(scored->second.first);
+                    candidate.ngramScores[m] = scored->second.second;
+                }
+            }
+
+            candidate.score = candidate.constrainedMessages * 100.0 - candidate.plugboard.size() * 2.0;
+            orderCandidates.push_back(candidate);
+        }
+
+        if (orderCandidates.empty()) {
+            ruledOutOrders++;
+        }
+        candidates.insert(candidates.end(), orderCandidates.begin(), orderCandidates.end());
+
+        if (progressCallback) {
+            progressCallback("Rotor order " + std::to_string(orderIdx + 1) + "/" +
+                             std::to_string(rotorOrders.size()) + " (" +
+                             rotorOrders[orderIdx][0] + "-" + rotorOrders[orderIdx][1] + "-" +
+                             rotorOrders[orderIdx][2] + "): " +
+                             std::to_string(totalHits) + " primary hits" +
+                             (primaryTruncated ? " (placement table truncated)" : "") +
+                             (totalHits > hits.size() ? " (best " + std::to_string(hits.size()) + " checked)" : "") +
+                             (weakMessages > 0 ? ", " + std::to_string(weakMessages) + " cribs too weak to place" : "") +
+                             ", " +
+                             std::to_string(orderCandidates.size()) + " consistent keys");
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsedTime = endTime - startTime;
+
+    if (progressCallback) {
+        progressCallback("Rotor orders ruled out: " + std::to_string(ruledOutOrders) + "/" +
+                         std::to_string(rotorOrders.size()));
+        if (truncatedOrders > 0) {
+            progressCallback("Rotor orders whose primary placement table hit the limit (" +
+                             std::to_string(placementTableLimit_) + " entries, hits incomplete): " +
+                             std::to_string(truncatedOrders));
+        }
+        if (droppedHits > 0) {
+            progressCallback("Primary hits not checked (over the per-order limit): " +
+                             std::to_string(droppedHits));
+        }
+        progressCallback("Daily key attack completed. Found " +
+                         std::to_string(candidates.size()) + " candidate keys.");
+        std::ostringstream oss;
+        oss << "Processing time: " << std::fixed << std::setprecision(2) << elapsedTime.count() << " seconds";
+        progressCallback(oss.str());
+    }
+
+    return candidates;
+}
@@ -0,0 +1,123 @@
+#ifndef DAILY_KEY_ATTACK_H
+#define DAILY_KEY_ATTACK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "NgramScorer.h"
+#include "ScramblerTable.h"
+
+// 同じ日の鍵（ローター順・プラグボード共通、開始位置のみ異なる）で送られた1通
+struct TrafficMessage {
+    std::string cipherText;
+    std::string crib;        // 空ならクリブなし
+    int cribPosition = -1;   // -1なら全オフセットを試す
+};
+
+struct DailyKeyCandidate {
+    double score;
+    std::vector<std::string> rotorOrder;
+    std::vector<std::pair<char, char>> plugboard;
+    std::vector<std::vector<int>> startPositions;  // メッセージごと（未確定は空）
+    std::vector<int> cribOffsets;                  // メッセージごと（クリブなし・未確定は-1）
+    std::vector<double> ngramScores;               // クリブなしメッセージの平文スコア
+    int constrainedMessages;                       // クリブが矛盾なく配置できたメッセージ数
+
+    bool operator<(const DailyKeyCandidate& other) const {
+        return score > other.score; // Descending order
+    }
+};
+
+// 1日分の通信をまとめて攻撃する
+// 最も長いクリブを持つメッセージでBombe探索を行い、そのステッカー仮説を
+// 残りのクリブ付きメッセージの制約で拡張・棄却する。スクランブラ表と
+// 各メッセージの配置表（自分のメニューだけで矛盾しない開始状態・オフセット・
+// ステッカー）はローター順ごとに1回だけ作り、主メッセージのヒットごとには
+// 配置表を引いて照合するだけにする
+class DailyKeyAttack {
+public:
+    DailyKeyAttack(const std::vector<TrafficMessage>& messages,
+                   const std::vector<std::string>& rotorTypes,
+                   const std::string& reflectorType,
+                   bool testAllOrders = false);
+
+    // クリブなしメッセージの開始位置推定に使う統計（既定はドイツ語の単字頻度）
+    void setScorer(const NgramScorer& scorer) { scorer_ = scorer; }
+
+    std::vector<DailyKeyCandidate> attack(
+        std::function<void(const std::string&)> progressCallback = nullptr);
+
+    void stop() { stopFlag_ = true; }
+
+    // ローター順ごとに照合へ回す主メッセージのヒット数の上限（プラグ数の少ない順に残す）
+    void setMaxPrimaryHits(size_t limit) { maxPrimaryHits_ = limit; }
+
+    // 配置表の上限。超えた副メッセージは判別に使えないので照合から外し、
+    // クリブなしと同じく平文スコアで開始位置を推定する。主メッセージの表が
+    // 超えた場合はそこまでのヒットだけを照合し、打ち切ったことを報告する
+    void setPlacementTableLimit(size_t limit) { placementTableLimit_ = limit; }
+
+private:
+    // 未確定は-1、確定済みは相手の文字（自己ステッカーは自分自身）
+    using Steckers = std::array<int8_t, 26>;
+
+    struct Placement {
+        int startState;
+        int offset;
+        Steckers steckers;
+        int pairCount;
+    };
+
+    // あるオフセットでの配置。起点文字（メニューで最も多くのリンクを持つ文字）の
+    // 相手の仮定ごとに分けて持つ
+    struct OffsetPlacements {
+        int offset;
+        int centre;
+        std::array<std::vector<Placement>, 26> byPartner;
+    };
+
+    struct PlacementTable {
+        std::vector<OffsetPlacements> offsets;
+        size_t entries = 0;
+        bool overflow = false;
+    };
+
+    std::vector<TrafficMessage> messages_;
+    std::vector<std::string> rotorTypes_;
+    std::string reflectorType_;
+    bool testAllOrders_;
+    NgramScorer scorer_;
+    std::atomic<bool> stopFlag_{false};
+    size_t maxPrimaryHits_ = 4096;
+    size_t placementTableLimit_ = 1 << 18;
+
+    std::vector<int> offsetsFor(size_t messageIdx) const;
+
+    bool extendSteckers(const ScramblerTable& table,
+                        const std::vector<int>& states,
+                        size_t messageIdx,
+                        int offset,
+                        Steckers& steckers,
+                        int& pairCount) const;
+
+    PlacementTable buildPlacementTable(const ScramblerTable& table,
+                                       size_t messageIdx,
+                                       size_t limit) const;
+
+    // 配置表のうち、stecker仮説と両立するものを仮説ごと拡張して返す（limit件で打ち切り）
+    std::vector<Placement> placeMessage(const ScramblerTable& table,
+                                        size_t messageIdx,
+                                        const PlacementTable& placements,
+                                        const Steckers& steckers,
+                                        size_t limit) const;
+
+    int bestStartByScore(const ScramblerTable& table,
+                         size_t messageIdx,
+                         const Steckers& steckers,
+                         double& bestScore) const;
+};
+
+#endif // DAILY_KEY_ATTACK_H
@@ -1,4 +1,5 @@
 #include "DiagonalBoard.h"
+#include "Logger.h"
 #include <algorithm>
 #include <functional>
 #include <fstream>
@@ -6,24 +7,6 @@
 #include <string>
 #include <sstream>
 
-// デバッグログ用（簡易実装）
-static void writeDebugLog(const std::string& message) {
-    // デバッグビルドの場合のみログ出力
-#ifdef _DEBUG
-    static std::ofstream logFile("diagonal_board_debug.log", std::ios::app);
-    static std::mutex logMutex;
-    
-    std::lock_guard<std::mutex> lock(logMutex);
-    if (logFile.is_open()) {
-        logFile << message << std::endl;
-        logFile.flush();
-    }
-#else
-    // リリースビルドでは何もしない（パフォーマンスのため）
-    (void)message;
-#endif
-}
-
 DiagonalBoard::DiagonalBoard() : connections_(26) {
 }
 
@@ -77,7 +60,11 @@ bool DiagonalBoard::hasContradiction(const std::map<char, char>& wiring) {
     }
     
     // 推移的閉包をチェック
-    return checkTransitiveClosure(wiring);
+    bool contradiction = checkTransitiveClosure(wiring);
+    if (contradiction) {
+        ENIGMA_LOG(LogLevel::Trace, "diagonalBoard.contradiction").kv("pairs", wiring.size());
+    }
+    return contradiction;
 }
 
 bool DiagonalBoard::checkTransitiveClosure(const std::map<char, char>& wiring) {
@@ -0,0 +1,302 @@
+#include "Logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+std::atomic<int> Logger::runtimeLevel_{static_cast<int>(LogLevel::Off)};
+
+namespace {
+
+// 1スレッド専用のリングバッファ（書き込みは所有スレッド、読み出しは書き込みスレッドのみ）
+struct ThreadBuffer {
+    static constexpr size_t CAPACITY = 1024;
+
+    std::string slots[CAPACITY];
+    alignas(64) std::atomic<size_t> head{0};  // 所有スレッドが進める
+    alignas(64) std::atomic<size_t> tail{0};  // 書き込みスレッドが進める
+    std::atomic<bool> retired{false};         // 所有スレッドが終了した
+    int threadId = 0;
+};
+
+struct LoggerState {
+    std::mutex mutex;                          // バッファの登録と開始・停止だけに使う
+    std::condition_variable wake;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    bool stopping = false;
+    std::atomic<uint64_t> generation{0};       // start()ごとに増やし、古いバッファを登録し直させる
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reportedDropped = 0;
+    int nextThreadId = 0;
+    std::ofstream file;
+    std::ostream* out = nullptr;
+
+    ~LoggerState() {
+        Logger::stop();
+    }
+};
+
+LoggerState& state() {
+    static LoggerState instance;
+    return instance;
+}
+
+struct ThreadSlot {
+    std::shared_ptr<ThreadBuffer> buffer;
+    uint64_t generation = 0;
+
+    ~ThreadSlot() {
+        if (buffer) {
+            buffer->retired = true;
+        }
+    }
+};
+
+thread_local ThreadSlot threadSlot;
+
+ThreadBuffer& currentBuffer() {
+    LoggerState& s = state();
+    uint64_t generation = s.generation.load(std::memory_order_acquire);
+    if (!threadSlot.buffer || threadSlot.generation != generation) {
+        // スレッドごとに最初の1回だけロックを取る
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        buffer->threadId = s.nextThreadId++;
+        s.buffers.push_back(buffer);
+        threadSlot.buffer = buffer;
+        threadSlot.generation = generation;
+    }
+    return *threadSlot.buffer;
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// 全バッファの中身を書き出し、終了したスレッドのバッファを外す
+void drain(LoggerState& s) {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        buffers = s.buffers;
+    }
+    bool wrote = false;
+    for (const auto& buffer : buffers) {
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        size_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            std::string& slot = buffer->slots[tail % ThreadBuffer::CAPACITY];
+            *s.out << slot << '\n';
+            slot.clear();
+            wrote = true;
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+    }
+
+    uint64_t dropped = s.dropped.load();
+    if (dropped != s.reportedDropped) {
+        *s.out << "{\"level\":\"warn\",\"event\":\"log.dropped\",\"records\":"
+               << dropped - s.reportedDropped << "}\n";
+        s.reportedDropped = dropped;
+        wrote = true;
+    }
+    if (wrote) {
+        s.out->flush();
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto it = s.buffers.begin(); it != s.buffers.end();) {
+        ThreadBuffer& buffer = **it;
+        bool empty = buffer.tail.load() == buffer.head.load();
+        it = (buffer.retired && empty) ? s.buffers.erase(it) : it + 1;
+    }
+}
+
+void writerLoop() {
+    LoggerState& s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (!s.stopping) {
+        // 探索スレッドからは起こさない（通知のsyscallを避ける）ので一定間隔で回収する
+        s.wake.wait_for(lock, std::chrono::milliseconds(100));
+        lock.unlock();
+        drain(s);
+        lock.lock();
+    }
+    lock.unlock();
+    drain(s);
+}
+
+} // namespace
+
+void Logger::start(const std::string& path, LogLevel level) {
+    stop();
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (path == "-") {
+        s.out = &std::cerr;
+    } else {
+        s.file.open(path, std::ios::app);
+        if (!s.file.is_open()) {
+            throw std::runtime_error("ログファイルを開けません: " + path);
+        }
+        s.out = &s.file;
+    }
+    s.buffers.clear();
+    s.generation++;
+    s.stopping = false;
+    s.dropped = 0;
+    s.reportedDropped = 0;
+    s.running = true;
+    s.writer = std::thread(writerLoop);
+    runtimeLevel_ = static_cast<int>(level);
+}
+
+void Logger::stop() {
+    LoggerState& s = state();
+    runtimeLevel_ = static_cast<int>(LogLevel::Off);
+    std::thread writer;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.running) {
+            return;
+        }
+        s.running = false;
+        s.stopping = true;
+        writer.swap(s.writer);
+    }
+    s.wake.notify_all();
+    writer.join();
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.file.is_open()) {
+        s.file.close();
+    }
+    s.out = nullptr;
+}
+
+void Logger::setLevel(LogLevel level) {
+    if (state().running) {
+        runtimeLevel_ = static_cast<int>(level);
+    }
+}
+
+LogLevel Logger::level() {
+    return static_cast<LogLevel>(runtimeLevel_.load());
+}
+
+uint64_t Logger::dropped() {
+    return state().dropped.load();
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "trace";
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warn: return "warn";
+        case LogLevel::Error: return "error";
+        default: return "off";
+    }
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (int i = 0; i <= static_cast<int>(LogLevel::Off); i++) {
+        if (name == levelName(static_cast<LogLevel>(i))) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::submit(std::string&& line) {
+    LoggerState& s = state();
+    if (!s.running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadBuffer& buffer = currentBuffer();
+    size_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= ThreadBuffer::CAPACITY) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);  // 待たずに捨てる
+        return;
+    }
+    buffer.slots[head % ThreadBuffer::CAPACITY] = std::move(line);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+int Logger::threadId() {
+    return currentBuffer().threadId;
+}
+
+LogRecord::LogRecord(LogLevel level, const char* event) {
+    double seconds = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char timestamp[32];
+    std::snprintf(timestamp, sizeof(timestamp), "%.6f", seconds);
+    text_.reserve(128);
+    text_ += "{\"ts\":";
+    text_ += timestamp;
+    text_ += ",\"level\":\"";
+    text_ += Logger::levelName(level);
+    text_ += "\",\"thread\":";
+    text_ += std::to_string(Logger::threadId());
+    text_ += ",\"event\":";
+    appendJsonString(text_, event);
+}
+
+LogRecord::~LogRecord() {
+    text_ += '}';
+    Logger::submit(std::move(text_));
+}
+
+void LogRecord::appendKey(const char* key) {
+    text_ += ',';
+    appendJsonString(text_, key);
+    text_ += ':';
+}
+
+LogRecord& LogRecord::kv(const char* key, const std::string& value) {
+    appendKey(key);
+    appendJsonString(text_, value);
+    return *this;
+}
+
+LogRecord& LogRecord::kv(const char* key, bool value) {
+    appendKey(key);
+    text_ += value ? "true" : "false";
+    return *this;
+}
+
+LogRecord& LogRecord::kv(const char* key, double value) {
+    appendKey(key);
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.6g", value);
+    text_ += number;
+    return *this;
+}
@@ -0,0 +1,89 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// ログの重要度。ENIGMA_LOG_MIN_LEVEL（CMakeのENIGMA_LOG_MIN_LEVEL）より低いものは
+// コンパイル時に取り除かれ、それ以上のものも実行時のレベルで絞り込む
+enum class LogLevel { Trace = 0, Debug = 1, Info = 2, Warn = 3, Error = 4, Off = 5 };
+
+#ifndef ENIGMA_LOG_MIN_LEVEL
+#define ENIGMA_LOG_MIN_LEVEL 1
+#endif
+
+// 構造化ログ（1レコード1行のJSON）。
+// 各スレッドは自分専用の固定長リングバッファへレコードを積むだけで、ロックも待ちもしない
+// （満杯なら捨てて数える）。書き出しはバックグラウンドのスレッドがまとめて行う。
+// start()するまではレベルがOffなので、ログ呼び出しは判定1回だけで終わる
+class Logger {
+public:
+    // path: 出力先（"-"なら標準エラー、それ以外は追記）。開けなければstd::runtime_error
+    static void start(const std::string& path, LogLevel level);
+
+    // 残りを書き出して書き込みスレッドを止める（以後のログは捨てる）
+    static void stop();
+
+    static void setLevel(LogLevel level);
+    static LogLevel level();
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= runtimeLevel_.load(std::memory_order_relaxed);
+    }
+
+    // バッファ満杯で捨てたレコード数
+    static uint64_t dropped();
+
+    // "trace" / "debug" / "info" / "warn" / "error" / "off"
+    static const char* levelName(LogLevel level);
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+    // 書式済みの1行を呼び出しスレッドのバッファに積む（LogRecordから呼ばれる）
+    static void submit(std::string&& line);
+
+    // 呼び出しスレッドのログ上の番号（最初のログで振られる）
+    static int threadId();
+
+private:
+    static std::atomic<int> runtimeLevel_;
+};
+
+// 1レコードを組み立て、破棄時にLoggerへ渡す。直接使わずENIGMA_LOGマクロを使う
+class LogRecord {
+public:
+    LogRecord(LogLevel level, const char* event);
+    ~LogRecord();
+
+    LogRecord(const LogRecord&) = delete;
+    LogRecord& operator=(const LogRecord&) = delete;
+
+    LogRecord& kv(const char* key, const std::string& value);
+    LogRecord& kv(const char* key, const char* value) { return kv(key, std::string(value)); }
+    LogRecord& kv(const char* key, bool value);
+    LogRecord& kv(const char* key, double value);
+
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, LogRecord&>
+    kv(const char* key, T value) {
+        appendKey(key);
+        text_ += std::to_string(value);
+        return *this;
+    }
+
+private:
+    std::string text_;
+
+    void appendKey(const char* key);
+};
+
+// 例: ENIGMA_LOG(LogLevel::Info, "attack.start").kv("orders", 60).kv("threads", 8);
+// 無効なレベルでは引数も評価されない
+#define ENIGMA_LOG(level, event)                                              \
+    if constexpr (static_cast<int>(level) < ENIGMA_LOG_MIN_LEVEL) {           \
+    } else if (!Logger::enabled(level)) {                                     \
+    } else                                                                    \
+        LogRecord((level), (event))
+
+#endif // LOGGER_H
@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 読み取り専用のメモリマップドファイル（POSIXはmmap、WindowsはCreateFileMapping）
+// 事前計算したカタログ類をコピーせずに参照するために使う
+class MappedFile {
+public:
+    MappedFile() = default;
+    // hugePagesはヒント（対応していない環境では無視する）
+    explicit MappedFile(const std::string& path, bool hugePages = false);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 開けない場合はstd::runtime_errorを投げる
+    void open(const std::string& path, bool hugePages = false);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
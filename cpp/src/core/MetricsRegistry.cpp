@@ -0,0 +1,194 @@
+#include "MetricsRegistry.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string escapeLabelValue(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string formatValue(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.16g", value);
+    return buffer;
+}
+
+// プロセスのユーザー＋カーネルCPU時間（秒）と常駐メモリ（バイト、取得できなければ負）
+void readProcessUsage(double& cpuSeconds, double& residentBytes) {
+    cpuSeconds = 0.0;
+    residentBytes = -1.0;
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        auto toSeconds = [](const FILETIME& time) {
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = time.dwLowDateTime;
+            ticks.HighPart = time.dwHighDateTime;
+            return ticks.QuadPart / 1e7;  // 100ns単位
+        };
+        cpuSeconds = toSeconds(kernel) + toSeconds(user);
+    }
+    PROCESS_MEMORY_COUNTERS memory;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+        residentBytes = static_cast<double>(memory.WorkingSetSize);
+    }
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        cpuSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                     usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    }
+    // Linuxのみ（statmの2番目が常駐ページ数）
+    std::ifstream statm("/proc/self/statm");
+    long long sizePages = 0, residentPages = 0;
+    if (statm >> sizePages >> residentPages) {
+        residentBytes = static_cast<double>(residentPages) * sysconf(_SC_PAGESIZE);
+    }
+#endif
+}
+
+} // namespace
+
+MetricValue& MetricsRegistry::counter(const std::string& name, const std::string& help, const Labels& labels) {
+    return lookup(Type::Counter, name, help, labels);
+}
+
+MetricValue& MetricsRegistry::gauge(const std::string& name, const std::string& help, const Labels& labels) {
+    return lookup(Type::Gauge, name, help, labels);
+}
+
+MetricValue& MetricsRegistry::lookup(Type type, const std::string& name, const std::string& help,
+                                     const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [familyIt, inserted] = families_.try_emplace(name);
+    Family& family = familyIt->second;
+    if (inserted) {
+        family.type = type;
+        family.help = help;
+    } else if (family.type != type) {
+        throw std::invalid_argument("メトリクスの種類が登録済みのものと異なります: " + name);
+    }
+
+    auto& series = family.series[formatLabels(labels)];
+    if (!series) {
+        series = std::make_unique<Series>();
+        series->labels = labels;
+    }
+    return series->value;
+}
+
+void MetricsRegistry::remove(const std::string& name, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = families_.find(name);
+    if (it != families_.end()) {
+        it->second.series.erase(formatLabels(labels));
+    }
+}
+
+int MetricsRegistry::addCollector(std::function<void(MetricsRegistry&)> collector) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = nextCollectorId_++;
+    collectors_[id] = collector;
+    return id;
+}
+
+void MetricsRegistry::removeCollector(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectors_.erase(id);
+}
+
+void MetricsRegistry::addProcessMetrics() {
+    addCollector([](MetricsRegistry& registry) {
+        double cpuSeconds, residentBytes;
+        readProcessUsage(cpuSeconds, residentBytes);
+        // CPU時間はOSが積算した値をそのまま写す
+        registry.counter("process_cpu_seconds_total", "Total user and system CPU time spent in seconds.")
+            .set(cpuSeconds);
+        if (residentBytes >= 0) {
+            registry.gauge("process_resident_memory_bytes", "Resident memory size in bytes.").set(residentBytes);
+        }
+    });
+}
+
+std::string MetricsRegistry::formatLabels(const Labels& labels) {
+    if (labels.empty()) {
+        return "";
+    }
+    std::string text = "{";
+    for (size_t i = 0; i < labels.size(); i++) {
+        text += (i > 0 ? "," : "") + labels[i].first + "=\"" + escapeLabelValue(labels[i].second) + "\"";
+    }
+    return text + "}";
+}
+
+std::string MetricsRegistry::render() {
+    // 収集関数はcounter()/gauge()を呼ぶので、ロックの外で実行する
+    std::vector<std::function<void(MetricsRegistry&)>> collectors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [id, collector] : collectors_) {
+            collectors.push_back(collector);
+        }
+    }
+    for (const auto& collector : collectors) {
+        collector(*this);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string text;
+    for (const auto& [name, family] : families_) {
+        if (family.series.empty()) {
+            continue;
+        }
+        text += "# HELP " + name + " " + family.help + "\n";
+        text += "# TYPE " + name + (family.type == Type::Counter ? " counter\n" : " gauge\n");
+        for (const auto& [labels, series] : family.series) {
+            text += name + labels + " " + formatValue(series->value.get()) + "\n";
+        }
+    }
+    return text;
+}
+
+void MetricsRegistry::writeFile(const std::string& path) {
+    std::string text = render();
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out || !(out << text) || !out.flush()) {
+            throw std::runtime_error("メトリクスファイルを書き込めません: " + temporary);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        throw std::runtime_error("メトリクスファイルを置き換えられません: " + path);
+    }
+}
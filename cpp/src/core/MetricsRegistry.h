@@ -0,0 +1,76 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 1つの時系列（名前＋ラベルの組）の値。加算・設定はロックなしで行える
+class MetricValue {
+public:
+    void add(double delta) {
+        double current = value_.load(std::memory_order_relaxed);
+        while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+        }
+    }
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double get() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// 監視用のメトリクス（Prometheusのテキスト形式で出力する）。
+// counter()/gauge()で得た参照は、remove()されるまでロックなしで更新できる
+class MetricsRegistry {
+public:
+    enum class Type { Counter, Gauge };
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    // 同じ名前・ラベルなら同じ値を返す。名前が既に別の種類で登録されていればstd::invalid_argument
+    MetricValue& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+    MetricValue& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    // ジョブごとの系列など、不要になった時系列を取り除く
+    void remove(const std::string& name, const Labels& labels);
+
+    // render()の直前に呼ばれ、ゲージを最新の値にする。戻り値はremoveCollectorに渡すID
+    int addCollector(std::function<void(MetricsRegistry&)> collector);
+    void removeCollector(int id);
+
+    // プロセス全体のCPU時間と常駐メモリ（process_cpu_seconds_total、process_resident_memory_bytes）
+    void addProcessMetrics();
+
+    // text exposition format (version 0.0.4)
+    std::string render();
+
+    // 一時ファイルに書いてから置き換える（node_exporterのtextfile collectorが途中の内容を読まないように）。
+    // 書けなければstd::runtime_error
+    void writeFile(const std::string& path);
+
+private:
+    struct Series {
+        Labels labels;
+        MetricValue value;
+    };
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Series>> series;  // キーは書式済みのラベル
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, Family> families_;
+    std::map<int, std::function<void(MetricsRegistry&)>> collectors_;
+    int nextCollectorId_ = 1;
+
+    MetricValue& lookup(Type type, const std::string& name, const std::string& help, const Labels& labels);
+    static std::string formatLabels(const Labels& labels);
+};
+
+#endif // METRICS_REGISTRY_H
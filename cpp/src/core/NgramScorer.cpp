@@ -0,0 +1,134 @@
+#include "NgramScorer.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// ドイツ語の文字頻度（%）
+const double GERMAN_FREQUENCIES[26] = {
+    6.51, 1.89, 3.06, 5.08, 17.40, 1.66, 3.01, 4.76, 7.55, 0.27, 1.21, 3.44, 2.53,
+    9.78, 2.51, 0.79, 0.02, 7.00, 7.27, 6.15, 4.35, 0.67, 1.89, 0.03, 0.04, 1.13
+};
+
+std::vector<uint8_t> toIndices(const std::string& text) {
+    std::vector<uint8_t> letters;
+    letters.reserve(text.size());
+    for (char c : text) {
+        if (c >= 'A' && c <= 'Z') {
+            letters.push_back(static_cast<uint8_t>(c - 'A'));
+        } else if (c >= 'a' && c <= 'z') {
+            letters.push_back(static_cast<uint8_t>(c - 'a'));
+        }
+    }
+    return letters;
+}
+
+size_t tableSize(int n) {
+    size_t size = 1;
+    for (int i = 0; i < n; i++) {
+        size *= 26;
+    }
+    return size;
+}
+
+} // namespace
+
+NgramScorer::NgramScorer() : NgramScorer(1) {
+    setFromCounts(std::vector<double>(GERMAN_FREQUENCIES, GERMAN_FREQUENCIES + 26));
+}
+
+NgramScorer::NgramScorer(int n) : n_(n), logProb_(tableSize(n)) {
+    if (n < 1 || n > MAX_ORDER) {
+        throw std::invalid_argument("n-gramの次数は1〜" + std::to_string(MAX_ORDER) + "です");
+    }
+}
+
+NgramScorer NgramScorer::fromCorpus(const std::string& text, int n) {
+    NgramScorer scorer(n);
+    auto letters = toIndices(text);
+
+    std::vector<double> counts(scorer.logProb_.size(), 0.0);
+    for (size_t i = 0; i + n <= letters.size(); i++) {
+        int idx = 0;
+        for (int j = 0; j < n; j++) {
+            idx = idx * 26 + letters[i + j];
+        }
+        counts[idx] += 1.0;
+    }
+
+    scorer.setFromCounts(counts);
+    return scorer;
+}
+
+NgramScorer NgramScorer::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("n-gramファイルを開けません: " + path);
+    }
+
+    std::vector<std::pair<std::string, double>> entries;
+    int n = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string gram;
+        double count = 0.0;
+        if (!(iss >> gram >> count)) {
+            continue;
+        }
+        if (n == 0) {
+            n = static_cast<int>(gram.length());
+        } else if (static_cast<int>(gram.length()) != n) {
+            throw std::runtime_error("n-gramの長さが一致しません: " + gram);
+        }
+        entries.push_back({gram, count});
+    }
+
+    if (n == 0) {
+        throw std::runtime_error("n-gramファイルが空です: " + path);
+    }
+
+    NgramScorer scorer(n);
+    std::vector<double> counts(scorer.logProb_.size(), 0.0);
+    for (const auto& [gram, count] : entries) {
+        auto letters = toIndices(gram);
+        if (static_cast<int>(letters.size()) != n) {
+            continue;
+        }
+        int idx = 0;
+        for (uint8_t l : letters) {
+            idx = idx * 26 + l;
+        }
+        counts[idx] += count;
+    }
+
+    scorer.setFromCounts(counts);
+    return scorer;
+}
+
+double NgramScorer::scoreText(const std::string& text) const {
+    auto letters = toIndices(text);
+    double total = 0.0;
+    for (size_t i = 0; i + n_ <= letters.size(); i++) {
+        total += score(&letters[i]);
+    }
+    return total;
+}
+
+void NgramScorer::setFromCounts(const std::vector<double>& counts) {
+    double total = 0.0;
+    for (double c : counts) {
+        total += c;
+    }
+    if (total <= 0.0) {
+        throw std::runtime_error("n-gram統計が空です");
+    }
+
+    // 未出現のn-gramには出現数0.01相当の下限値を与える
+    double floor = std::log10(0.01 / total);
+    for (size_t i = 0; i < counts.size(); i++) {
+        logProb_[i] = static_cast<float>(counts[i] > 0.0 ? std::log10(counts[i] / total) : floor);
+    }
+}
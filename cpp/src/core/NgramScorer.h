@@ -0,0 +1,45 @@
+#ifndef NGRAM_SCORER_H
+#define NGRAM_SCORER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// n-gramの対数確率（log10）による平文らしさの評価
+// 既定ではドイツ語の単字頻度を使い、コーパスや頻度ファイルからn=1〜4を構築できる
+class NgramScorer {
+public:
+    static constexpr int MAX_ORDER = 4;
+
+    NgramScorer();
+
+    // コーパス（A-Z以外は無視）からn-gram統計を構築する
+    static NgramScorer fromCorpus(const std::string& text, int n);
+
+    // "ABC 1234" 形式（n-gramと出現数）の頻度ファイルを読み込む
+    static NgramScorer loadFromFile(const std::string& path);
+
+    int order() const { return n_; }
+
+    // letters[0..n-1]（0-25のインデックス）のn-gramの対数確率
+    double score(const uint8_t* letters) const {
+        int idx = 0;
+        for (int i = 0; i < n_; i++) {
+            idx = idx * 26 + letters[i];
+        }
+        return logProb_[idx];
+    }
+
+    // 文字列全体のスコア（全n-gramの和）
+    double scoreText(const std::string& text) const;
+
+private:
+    explicit NgramScorer(int n);
+
+    void setFromCounts(const std::vector<double>& counts);
+
+    int n_;
+    std::vector<float> logProb_;
+};
+
+#endif // NGRAM_SCORER_H
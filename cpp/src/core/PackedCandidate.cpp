@@ -0,0 +1,364 @@
+#include "PackedCandidate.h"
+#include "BombeAttack.h"
+#include "ScramblerTable.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+PackedCandidate PackedCandidate::make(uint16_t contextId, int state, int offsetLow, int matches,
+                                      const std::vector<std::pair<char, char>>& plugboard) {
+    if (state < 0 || state >= ScramblerTable::NUM_STATES ||
+        offsetLow < 0 || offsetLow >= OFFSET_BLOCK ||
+        matches < 0 || matches > MAX_CRIB_LENGTH) {
+        throw std::invalid_argument("候補レコードに収まらない値です");
+    }
+
+    PackedCandidate candidate;
+    candidate.bits = static_cast<uint32_t>(state) |
+                     (static_cast<uint32_t>(offsetLow) << STATE_BITS) |
+                     (static_cast<uint32_t>(matches) << (STATE_BITS + OFFSET_BITS));
+    candidate.contextId = contextId;
+    for (int i = 0; i < 26; i++) {
+        candidate.stecker[i] = static_cast<uint8_t>(i);
+    }
+    for (const auto& [a, b] : plugboard) {
+        candidate.stecker[a - 'A'] = static_cast<uint8_t>(b - 'A');
+        candidate.stecker[b - 'A'] = static_cast<uint8_t>(a - 'A');
+    }
+    return candidate;
+}
+
+int PackedCandidate::pairCount() const {
+    int count = 0;
+    for (int i = 0; i < 26; i++) {
+        if (stecker[i] > i) count++;
+    }
+    return count;
+}
+
+namespace {
+
+// キーの下位から16ビットずつ安定に振り分ける（全要素で同じ桁は飛ばす）
+template <typename T, typename KeyOf>
+void radixSort(std::vector<T>& items, KeyOf keyOf) {
+    constexpr int DIGIT_BITS = 16;
+    constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+
+    std::vector<T> buffer(items.size());
+    std::vector<size_t> counts(BUCKETS);
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (const auto& item : items) {
+            counts[(keyOf(item) >> shift) & (BUCKETS - 1)]++;
+        }
+        if (items.empty() || counts[(keyOf(items[0]) >> shift) & (BUCKETS - 1)] == items.size()) {
+            continue;
+        }
+
+        size_t sum = 0;
+        for (auto& count : counts) {
+            size_t c = count;
+            count = sum;
+            sum += c;
+        }
+        for (const auto& item : items) {
+            buffer[counts[(keyOf(item) >> shift) & (BUCKETS - 1)]++] = item;
+        }
+        items.swap(buffer);
+    }
+}
+
+} // namespace
+
+uint16_t PackedCandidateSet::internContext(const std::vector<std::string>& rotorOrder,
+                                           const std::string& crib,
+                                           int offsetBlock) {
+    if (crib.length() > static_cast<size_t>(PackedCandidate::MAX_CRIB_LENGTH)) {
+        throw std::invalid_argument("クリブが長すぎます（最大" +
+                                    std::to_string(PackedCandidate::MAX_CRIB_LENGTH) + "文字）");
+    }
+
+    auto orderIt = std::find(orders_.begin(), orders_.end(), rotorOrder);
+    uint16_t orderId = static_cast<uint16_t>(orderIt - orders_.begin());
+    if (orderIt == orders_.end()) {
+        orders_.push_back(rotorOrder);
+    }
+
+    auto cribIt = std::find(cribs_.begin(), cribs_.end(), crib);
+    uint16_t cribId = static_cast<uint16_t>(cribIt - cribs_.begin());
+    if (cribIt == cribs_.end()) {
+        cribs_.push_back(crib);
+    }
+
+    for (size_t i = 0; i < contexts_.size(); i++) {
+        const Context& context = contexts_[i];
+        if (context.orderId == orderId && context.cribId == cribId && context.offsetBlock == offsetBlock) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    if (contexts_.size() > 0xFFFF) {
+        throw std::runtime_error("候補コンテキストが多すぎます");
+    }
+    contexts_.push_back(Context{orderId, cribId, offsetBlock});
+    return static_cast<uint16_t>(contexts_.size() - 1);
+}
+
+void PackedCandidateSet::append(const std::vector<PackedCandidate>& candidates) {
+    records_.insert(records_.end(), candidates.begin(), candidates.end());
+    if (!counts_.empty()) {
+        counts_.resize(records_.size(), 1);
+    }
+}
+
+void PackedCandidateSet::clear() {
+    orders_.clear();
+    cribs_.clear();
+    contexts_.clear();
+    records_.clear();
+    counts_.clear();
+}
+
+double PackedCandidateSet::score(const PackedCandidate& candidate) const {
+    // BombeAttack::testPositionと同じ式（完全一致はプラグ数で減点、部分一致は一致率）
+    size_t cribLength = cribs_[contexts_[candidate.contextId].cribId].length();
+    if (static_cast<size_t>(candidate.matches()) == cribLength) {
+        return 100.0 - candidate.pairCount() * 2;
+    }
+    double matchRate = static_cast<double>(candidate.matches()) / cribLength;
+    return matchRate * 100;
+}
+
+int PackedCandidateSet::offset(const PackedCandidate& candidate) const {
+    return contexts_[candidate.contextId].offsetBlock * PackedCandidate::OFFSET_BLOCK +
+           candidate.offsetLow();
+}
+
+const std::vector<std::string>& PackedCandidateSet::rotorOrder(const PackedCandidate& candidate) const {
+    return orders_[contexts_[candidate.contextId].orderId];
+}
+
+const std::string& PackedCandidateSet::crib(const PackedCandidate& candidate) const {
+    return cribs_[contexts_[candidate.contextId].cribId];
+}
+
+void PackedCandidateSet::sort() {
+    // スコアの取りうる値はクリブ長・一致数・プラグ数で決まるので、先に順位表を作り
+    // 「順位 | コンテキスト | 開始状態 | オフセット下位」の64ビットキーで整列する
+    std::vector<double> distinct;
+    for (int pairs = 0; pairs <= 13; pairs++) {
+        distinct.push_back(100.0 - pairs * 2);
+    }
+    for (const auto& crib : cribs_) {
+        for (size_t matches = 0; matches < crib.length(); matches++) {
+            distinct.push_back(static_cast<double>(matches) / crib.length() * 100);
+        }
+    }
+    std::sort(distinct.begin(), distinct.end(), std::greater<double>());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    auto rankOf = [&distinct](double value) {
+        return static_cast<uint64_t>(std::lower_bound(distinct.begin(), distinct.end(), value,
+                                                      std::greater<double>()) - distinct.begin());
+    };
+
+    std::vector<uint64_t> fullRanks(14);
+    for (int pairs = 0; pairs <= 13; pairs++) {
+        fullRanks[pairs] = rankOf(100.0 - pairs * 2);
+    }
+    std::vector<std::vector<uint64_t>> partialRanks(cribs_.size());
+    for (size_t i = 0; i < cribs_.size(); i++) {
+        for (size_t matches = 0; matches < cribs_[i].length(); matches++) {
+            partialRanks[i].push_back(rankOf(static_cast<double>(matches) / cribs_[i].length() * 100));
+        }
+    }
+
+    auto keyOf = [&](const PackedCandidate& candidate) {
+        uint16_t cribId = contexts_[candidate.contextId].cribId;
+        size_t matches = static_cast<size_t>(candidate.matches());
+        uint64_t rank = matches == cribs_[cribId].length()
+            ? fullRanks[candidate.pairCount()]
+            : partialRanks[cribId][matches];
+        return (rank << 48) |
+               (static_cast<uint64_t>(candidate.contextId) << 32) |
+               (static_cast<uint64_t>(candidate.state()) << PackedCandidate::OFFSET_BITS) |
+               static_cast<uint64_t>(candidate.offsetLow());
+    };
+
+    if (counts_.empty()) {
+        radixSort(records_, keyOf);
+        return;
+    }
+
+    // 統合数を持っている場合は添字付きのキーで並べ、両方を入れ替える
+    std::vector<std::pair<uint64_t, uint32_t>> keys(records_.size());
+    for (size_t i = 0; i < records_.size(); i++) {
+        keys[i] = {keyOf(records_[i]), static_cast<uint32_t>(i)};
+    }
+    radixSort(keys, [](const std::pair<uint64_t, uint32_t>& key) { return key.first; });
+
+    std::vector<PackedCandidate> sorted(records_.size());
+    std::vector<uint32_t> counts(counts_.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        sorted[i] = records_[keys[i].second];
+        counts[i] = counts_[keys[i].second];
+    }
+    records_.swap(sorted);
+    counts_.swap(counts);
+}
+
+uint64_t PackedCandidateSet::windowHash(const PackedCandidate& candidate,
+                                        const ScramblerTable& table) const {
+    // 64ビット単位で混ぜる（置換26バイトは8+8+8+2バイトに分けて読む）
+    auto mix = [](uint64_t h, uint64_t v) {
+        h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        return h * 0xFF51AFD7ED558CCDULL;
+    };
+
+    const Context& context = contexts_[candidate.contextId];
+    size_t cribLength = cribs_[context.cribId].length();
+
+    uint64_t h = mix(0, context.cribId);
+    h = mix(h, static_cast<uint64_t>(offset(candidate)));
+    uint64_t words[4] = {};
+    std::memcpy(words, candidate.stecker, 26);
+    for (uint64_t word : words) {
+        h = mix(h, word);
+    }
+
+    int state = table.advance(candidate.state(), offset(candidate));
+    for (size_t i = 0; i < cribLength; i++) {
+        state = table.next(state);
+        uint64_t permWords[4] = {};
+        std::memcpy(permWords, table.perm(state), 26);
+        for (uint64_t word : permWords) {
+            h = mix(h, word);
+        }
+    }
+    return h;
+}
+
+bool PackedCandidateSet::sameWindow(const PackedCandidate& a, const ScramblerTable& tableA,
+                                    const PackedCandidate& b, const ScramblerTable& tableB) const {
+    const Context& contextA = contexts_[a.contextId];
+    const Context& contextB = contexts_[b.contextId];
+    if (contextA.cribId != contextB.cribId || offset(a) != offset(b) ||
+        std::memcmp(a.stecker, b.stecker, 26) != 0) {
+        return false;
+    }
+
+    size_t cribLength = cribs_[contextA.cribId].length();
+    int stateA = tableA.advance(a.state(), offset(a));
+    int stateB = tableB.advance(b.state(), offset(b));
+    for (size_t i = 0; i < cribLength; i++) {
+        stateA = tableA.next(stateA);
+        stateB = tableB.next(stateB);
+        if (std::memcmp(tableA.perm(stateA), tableB.perm(stateB), 26) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PackedCandidateSet::mergeEquivalent(const std::string& reflectorType) {
+    const size_t n = records_.size();
+    if (n < 2) {
+        return 0;
+    }
+
+    // ローター順ごとの表（キャッシュ済みなら共有される）
+    std::vector<std::shared_ptr<const ScramblerTable>> tables(orders_.size());
+    for (size_t i = 0; i < orders_.size(); i++) {
+        tables[i] = ScramblerTable::get(orders_[i], reflectorType);
+    }
+    auto tableOf = [&](const PackedCandidate& candidate) -> const ScramblerTable& {
+        return *tables[contexts_[candidate.contextId].orderId];
+    };
+
+    std::vector<uint64_t> hashes(n);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < static_cast<long long>(n); i++) {
+        hashes[i] = windowHash(records_[i], tableOf(records_[i]));
+    }
+
+    // ハッシュ順に並べ、同じハッシュの中で実際の置換列を比べる（添字の小さい方を残す）
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : a < b;
+    });
+
+    std::vector<uint32_t> counts = counts_.empty() ? std::vector<uint32_t>(n, 1) : counts_;
+    std::vector<bool> removed(n, false);
+    std::vector<uint32_t> representatives;
+    for (size_t begin = 0; begin < n; ) {
+        size_t end = begin + 1;
+        while (end < n && hashes[order[end]] == hashes[order[begin]]) end++;
+
+        representatives.clear();
+        for (size_t k = begin; k < end; k++) {
+            uint32_t index = order[k];
+            const PackedCandidate& candidate = records_[index];
+            bool merged = false;
+            for (uint32_t rep : representatives) {
+                if (sameWindow(records_[rep], tableOf(records_[rep]), candidate, tableOf(candidate))) {
+                    counts[rep] += counts[index];
+                    removed[index] = true;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                representatives.push_back(index);
+            }
+        }
+        begin = end;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (removed[i]) continue;
+        records_[kept] = records_[i];
+        counts[kept] = counts[i];
+        kept++;
+    }
+    records_.resize(kept);
+    counts.resize(kept);
+    records_.shrink_to_fit();
+    counts_.swap(counts);
+    return n - kept;
+}
+
+CandidateResult PackedCandidateSet::unpack(size_t index) const {
+    return unpack(records_[index], equivalentCount(index));
+}
+
+CandidateResult PackedCandidateSet::unpack(const PackedCandidate& candidate, uint32_t equivalents) const {
+    CandidateResult result;
+    result.score = score(candidate);
+    result.positions = ScramblerTable::statePositions(candidate.state());
+    result.rotorOrder = rotorOrder(candidate);
+    for (int i = 0; i < 26; i++) {
+        if (candidate.stecker[i] > i) {
+            result.plugboard.emplace_back(static_cast<char>('A' + i),
+                                          static_cast<char>('A' + candidate.stecker[i]));
+        }
+    }
+    result.crib = crib(candidate);
+    result.matchRate = static_cast<double>(candidate.matches()) / result.crib.length();
+    result.plugboardPairs = static_cast<int>(result.plugboard.size());
+    result.offset = offset(candidate);
+    result.equivalentCount = static_cast<int>(equivalents);
+    return result;
+}
+
+std::vector<CandidateResult> PackedCandidateSet::unpackAll(size_t limit) const {
+    size_t count = limit > 0 ? (std::min)(limit, records_.size()) : records_.size();
+    std::vector<CandidateResult> results;
+    results.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        results.push_back(unpack(i));
+    }
+    return results;
+}
@@ -0,0 +1,94 @@
+#ifndef PACKED_CANDIDATE_H
+#define PACKED_CANDIDATE_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct CandidateResult;
+class ScramblerTable;
+
+// Bombe候補の固定長レコード（32バイト）
+// ローター順とクリブはコンテキストIDに集約し、プラグボードは26文字の対応表で持つ。
+// bitsは 開始状態(15) | オフセット下位(10) | 一致文字数(7)
+struct PackedCandidate {
+    static constexpr int STATE_BITS = 15;
+    static constexpr int OFFSET_BITS = 10;
+    static constexpr int MATCH_BITS = 7;
+    static constexpr int OFFSET_BLOCK = 1 << OFFSET_BITS;          // オフセット上位はコンテキスト側
+    static constexpr int MAX_CRIB_LENGTH = (1 << MATCH_BITS) - 1;
+
+    uint32_t bits;
+    uint16_t contextId;
+    uint8_t stecker[26];   // 各文字の相手（未接続は自分自身）
+
+    static PackedCandidate make(uint16_t contextId, int state, int offsetLow, int matches,
+                                const std::vector<std::pair<char, char>>& plugboard);
+
+    int state() const { return static_cast<int>(bits & ((1u << STATE_BITS) - 1)); }
+    int offsetLow() const { return static_cast<int>((bits >> STATE_BITS) & ((1u << OFFSET_BITS) - 1)); }
+    int matches() const { return static_cast<int>(bits >> (STATE_BITS + OFFSET_BITS)); }
+    int pairCount() const;
+};
+
+static_assert(sizeof(PackedCandidate) == 32, "PackedCandidateは32バイトに収める");
+
+// 固定長候補の集合。コンテキスト（ローター順・クリブ・オフセット上位）を
+// 登録してから候補を追加し、整列・同値統合したあとで必要な分だけ展開する
+class PackedCandidateSet {
+public:
+    // コンテキストを登録してIDを返す（登録済みなら同じID）。スレッド安全ではない
+    uint16_t internContext(const std::vector<std::string>& rotorOrder,
+                           const std::string& crib,
+                           int offsetBlock);
+
+    void append(const std::vector<PackedCandidate>& candidates);
+    void clear();
+
+    size_t size() const { return records_.size(); }
+    bool empty() const { return records_.empty(); }
+    const PackedCandidate& operator[](size_t index) const { return records_[index]; }
+
+    double score(const PackedCandidate& candidate) const;
+    int offset(const PackedCandidate& candidate) const;
+    const std::vector<std::string>& rotorOrder(const PackedCandidate& candidate) const;
+    const std::string& crib(const PackedCandidate& candidate) const;
+
+    // スコアの降順（同点はコンテキスト・開始状態・オフセット順）に並べる
+    void sort();
+
+    // クリブ区間のスクランブラ置換列・プラグボード・オフセット・クリブがすべて
+    // 一致する候補（ノッチ送りで同じ状態列に合流する開始位置など）を1つにまとめる。
+    // 各同値類では先頭の候補を残すので、sort()のあとに呼べば順序は保たれる。
+    // 取り除いた件数を返す
+    size_t mergeEquivalent(const std::string& reflectorType);
+
+    // 統合された候補数（自分を含む）。mergeEquivalent前は1
+    uint32_t equivalentCount(size_t index) const {
+        return index < counts_.size() ? counts_[index] : 1;
+    }
+
+    CandidateResult unpack(size_t index) const;
+    CandidateResult unpack(const PackedCandidate& candidate, uint32_t equivalents = 1) const;
+    std::vector<CandidateResult> unpackAll(size_t limit = 0) const;
+
+private:
+    struct Context {
+        uint16_t orderId;
+        uint16_t cribId;
+        int offsetBlock;
+    };
+
+    std::vector<std::vector<std::string>> orders_;
+    std::vector<std::string> cribs_;
+    std::vector<Context> contexts_;
+    std::vector<PackedCandidate> records_;
+    std::vector<uint32_t> counts_;
+
+    uint64_t windowHash(const PackedCandidate& candidate, const ScramblerTable& table) const;
+    bool sameWindow(const PackedCandidate& a, const ScramblerTable& tableA,
+                    const PackedCandidate& b, const ScramblerTable& tableB) const;
+};
+
+#endif // PACKED_CANDIDATE_H
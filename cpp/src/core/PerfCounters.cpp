@@ -0,0 +1,140 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+PerfReading PerfReading::operator-(const PerfReading& earlier) const {
+    PerfReading delta;
+    delta.validMask = validMask & earlier.validMask;
+    for (int event = 0; event < EVENT_COUNT; event++) {
+        if (delta.has(event)) {
+            delta.values[event] = values[event] - earlier.values[event];
+        }
+    }
+    return delta;
+}
+
+PerfReading& PerfReading::operator+=(const PerfReading& other) {
+    for (int event = 0; event < EVENT_COUNT; event++) {
+        if (other.has(event)) {
+            values[event] += other.values[event];
+        }
+    }
+    validMask |= other.validMask;
+    return *this;
+}
+
+double PerfReading::ipc() const {
+    if (!has(PerfCounters::Cycles) || !has(PerfCounters::Instructions) ||
+        values[PerfCounters::Cycles] == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(values[PerfCounters::Instructions]) / values[PerfCounters::Cycles];
+}
+
+const char* PerfCounters::eventName(int event) {
+    switch (event) {
+        case Cycles: return "cycles";
+        case Instructions: return "instructions";
+        case L1DMisses: return "l1dMisses";
+        case LLCMisses: return "llcMisses";
+        case BranchMisses: return "branchMisses";
+        default: return "unknown";
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventConfig EVENT_CONFIGS[PerfReading::EVENT_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENT_CONFIGS[event].type;
+        attr.config = EVENT_CONFIGS[event].config;
+        attr.exclude_kernel = 1;  // perf_event_paranoid=2でも開けるようにする
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // pid=0, cpu=-1: 呼び出したスレッドを、どのCPUで動いても数える
+        fds_[event] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds_[event] >= 0) {
+            opened_ |= 1u << event;
+        } else if (reason_.empty()) {
+            reason_ = std::string(eventName(event)) + ": " + std::strerror(errno);
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+        if (fds_[event] >= 0) {
+            close(fds_[event]);
+        }
+    }
+}
+
+PerfReading PerfCounters::read() const {
+    PerfReading reading;
+    for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+        if (fds_[event] < 0) {
+            continue;
+        }
+        uint64_t data[3];  // value, time_enabled, time_running
+        if (::read(fds_[event], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+            continue;
+        }
+        if (data[2] == 0) {
+            continue;  // 一度も計測されていない（カウンタを模倣するだけの環境もある）
+        }
+        uint64_t value = data[0];
+        if (data[2] < data[1]) {
+            value = static_cast<uint64_t>(static_cast<double>(value) * data[1] / data[2]);
+        }
+        reading.values[event] = value;
+        reading.validMask |= 1u << event;
+    }
+    return reading;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+        fds_[event] = -1;
+    }
+    reason_ = "perf_event_openはLinuxでのみ利用できます";
+}
+
+PerfCounters::~PerfCounters() = default;
+
+PerfReading PerfCounters::read() const {
+    return PerfReading();
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+
+// ハードウェア性能カウンタの読み取り値（PerfCounters::Event順）
+struct PerfReading {
+    static constexpr int EVENT_COUNT = 5;
+
+    uint64_t values[EVENT_COUNT] = {};
+    uint32_t validMask = 0;  // 取得できたイベントのビット
+
+    bool has(int event) const { return (validMask >> event) & 1u; }
+    bool empty() const { return validMask == 0; }
+
+    // 両方で取得できたイベントだけを残す
+    PerfReading operator-(const PerfReading& earlier) const;
+
+    // 未取得の側があれば、取得できた側の値を使う（スレッドごとの合算用）
+    PerfReading& operator+=(const PerfReading& other);
+
+    // 命令数/サイクル数（どちらかがなければ0）
+    double ipc() const;
+};
+
+// Linuxのperf_event_openで、呼び出したスレッドのサイクル数・命令数・L1Dミス・
+// LLCミス・分岐予測ミスを数える（ユーザー空間のみ）。
+// コンテナやperf_event_paranoidの制限で開けないイベントは除いて動作し、
+// 1つも開けなければavailable()がfalseになる。Linux以外では常に利用できない
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return opened_ != 0; }
+
+    // 開けなかった最初のイベントとそのエラー
+    const std::string& unavailableReason() const { return reason_; }
+
+    // 作成時からの累積値（多重化で計測時間が削られた分は補正する）。
+    // 対象スレッドは作成したスレッドだが、読み取りはどのスレッドからでもよい
+    PerfReading read() const;
+
+    static const char* eventName(int event);
+
+private:
+    int fds_[PerfReading::EVENT_COUNT];
+    uint32_t opened_ = 0;
+    std::string reason_;
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,364 @@
+#include "PlugboardHillClimber.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+PlugboardHillClimber::PlugboardHillClimber(const std::string& cipherText,
+                                           const ScramblerTable& table,
+                                           int startState,
+                                           const NgramScorer& scorer)
+    : scorer_(scorer), n_(scorer.order()) {
+    for (char c : cipherText) {
+        if (c >= 'A' && c <= 'Z') {
+            cipher_.push_back(static_cast<uint8_t>(c - 'A'));
+        } else if (c >= 'a' && c <= 'z') {
+            cipher_.push_back(static_cast<uint8_t>(c - 'a'));
+        }
+    }
+
+    auto states = table.stateSequence(startState, static_cast<int>(cipher_.size()));
+    perms_.reserve(states.size());
+    for (int state : states) {
+        perms_.push_back(table.perm(state));
+    }
+
+    size_t len = cipher_.size();
+    mid_.resize(len);
+    plain_.resize(len);
+    midSlot_.resize(len);
+    posStamp_.assign(len, 0);
+    windowStamp_.assign(len, 0);
+
+    for (size_t i = 0; i < len; i++) {
+        byCipher_[cipher_[i]].push_back(static_cast<int>(i));
+    }
+
+    for (int i = 0; i < 26; i++) {
+        plug_[i] = static_cast<uint8_t>(i);
+    }
+    rebuild();
+}
+
+void PlugboardHillClimber::setPlugboard(const std::vector<std::pair<char, char>>& pairs) {
+    if (pairs.size() > static_cast<size_t>(Plugboard::MAX_PAIRS)) {
+        throw std::invalid_argument("プラグボード接続数は最大" + std::to_string(Plugboard::MAX_PAIRS) +
+                                    "組までです。");
+    }
+
+    for (int i = 0; i < 26; i++) {
+        plug_[i] = static_cast<uint8_t>(i);
+    }
+    pairCount_ = 0;
+
+    // Plugboard::addPairと同じく、既に接続済みの文字を含むペアは無視する
+    for (const auto& [first, second] : pairs) {
+        int a = std::toupper(static_cast<unsigned char>(first)) - 'A';
+        int b = std::toupper(static_cast<unsigned char>(second)) - 'A';
+        if (a < 0 || a >= 26 || b < 0 || b >= 26 || a == b) continue;
+        if (plug_[a] != a || plug_[b] != b) continue;
+        plug_[a] = static_cast<uint8_t>(b);
+        plug_[b] = static_cast<uint8_t>(a);
+        pairCount_++;
+    }
+    rebuild();
+}
+
+void PlugboardHillClimber::setPlugboard(const Plugboard& plugboard) {
+    std::vector<std::pair<char, char>> pairs;
+    for (const auto& pair : plugboard.getPairs()) {
+        pairs.push_back({pair[0], pair[1]});
+    }
+    setPlugboard(pairs);
+}
+
+void PlugboardHillClimber::rebuild() {
+    for (auto& list : byMid_) {
+        list.clear();
+    }
+
+    for (size_t i = 0; i < cipher_.size(); i++) {
+        mid_[i] = perms_[i][plug_[cipher_[i]]];
+        plain_[i] = plug_[mid_[i]];
+        midSlot_[i] = static_cast<int>(byMid_[mid_[i]].size());
+        byMid_[mid_[i]].push_back(static_cast<int>(i));
+    }
+
+    score_ = 0.0;
+    for (size_t i = 0; i + n_ <= plain_.size(); i++) {
+        score_ += scorer_.score(&plain_[i]);
+    }
+}
+
+double PlugboardHillClimber::windowSum(const std::vector<int>& windows) const {
+    double sum = 0.0;
+    for (int w : windows) {
+        sum += scorer_.score(&plain_[w]);
+    }
+    return sum;
+}
+
+void PlugboardHillClimber::moveMid(int pos, uint8_t newMid) {
+    // 旧リストから末尾との入れ替えで削除
+    auto& oldList = byMid_[mid_[pos]];
+    int slot = midSlot_[pos];
+    int last = oldList.back();
+    oldList[slot] = last;
+    midSlot_[last] = slot;
+    oldList.pop_back();
+
+    mid_[pos] = newMid;
+    midSlot_[pos] = static_cast<int>(byMid_[newMid].size());
+    byMid_[newMid].push_back(pos);
+}
+
+double PlugboardHillClimber::delta(const std::array<uint8_t, 26>& newPlug,
+                                   const uint8_t* changed, int changedCount,
+                                   bool commit) {
+    if (++stamp_ == 0) {
+        std::fill(posStamp_.begin(), posStamp_.end(), 0);
+        std::fill(windowStamp_.begin(), windowStamp_.end(), 0);
+        stamp_ = 1;
+    }
+
+    // 影響を受ける位置：暗号文字かスクランブラ出力が変更された文字である位置
+    affected_.clear();
+    for (int k = 0; k < changedCount; k++) {
+        for (int pos : byCipher_[changed[k]]) {
+            if (posStamp_[pos] != stamp_) {
+                posStamp_[pos] = stamp_;
+                affected_.push_back(pos);
+            }
+        }
+        for (int pos : byMid_[changed[k]]) {
+            if (posStamp_[pos] != stamp_) {
+                posStamp_[pos] = stamp_;
+                affected_.push_back(pos);
+            }
+        }
+    }
+
+    // 影響を受ける位置を含むn-gramの窓
+    windows_.clear();
+    int lastWindow = static_cast<int>(plain_.size()) - n_;
+    for (int pos : affected_) {
+        int from = (std::max)(0, pos - n_ + 1);
+        int to = (std::min)(pos, lastWindow);
+        for (int w = from; w <= to; w++) {
+            if (windowStamp_[w] != stamp_) {
+                windowStamp_[w] = stamp_;
+                windows_.push_back(w);
+            }
+        }
+    }
+
+    double before = windowSum(windows_);
+
+    // 影響を受ける位置の平文を一時的に置き換えて再評価
+    newMid_.resize(affected_.size());
+    oldPlain_.resize(affected_.size());
+    for (size_t k = 0; k < affected_.size(); k++) {
+        int pos = affected_[k];
+        uint8_t c = cipher_[pos];
+        newMid_[k] = (newPlug[c] != plug_[c]) ? perms_[pos][newPlug[c]] : mid_[pos];
+        oldPlain_[k] = plain_[pos];
+        plain_[pos] = newPlug[newMid_[k]];
+    }
+
+    double after = windowSum(windows_);
+    double diff = after - before;
+
+    if (commit) {
+        for (size_t k = 0; k < affected_.size(); k++) {
+            if (newMid_[k] != mid_[affected_[k]]) {
+                moveMid(affected_[k], newMid_[k]);
+            }
+        }
+        plug_ = newPlug;
+        score_ += diff;
+    } else {
+        for (size_t k = 0; k < affected_.size(); k++) {
+            plain_[affected_[k]] = oldPlain_[k];
+        }
+    }
+
+    return diff;
+}
+
+bool PlugboardHillClimber::buildMove(const Move& move, std::array<uint8_t, 26>& newPlug,
+                                     uint8_t* changed, int& changedCount) const {
+    int a = move.first - 'A';
+    int x = move.second - 'A';
+    if (a < 0 || a >= 26) return false;
+
+    newPlug = plug_;
+    changedCount = 0;
+
+    switch (move.type) {
+    case Move::Add:
+        if (x < 0 || x >= 26 || a == x) return false;
+        if (plug_[a] != a || plug_[x] != x) return false;
+        if (pairCount_ >= Plugboard::MAX_PAIRS) return false;
+        newPlug[a] = static_cast<uint8_t>(x);
+        newPlug[x] = static_cast<uint8_t>(a);
+        changed[changedCount++] = static_cast<uint8_t>(a);
+        changed[changedCount++] = static_cast<uint8_t>(x);
+        return true;
+
+    case Move::Remove: {
+        int b = plug_[a];
+        if (b == a) return false;
+        newPlug[a] = static_cast<uint8_t>(a);
+        newPlug[b] = static_cast<uint8_t>(b);
+        changed[changedCount++] = static_cast<uint8_t>(a);
+        changed[changedCount++] = static_cast<uint8_t>(b);
+        return true;
+    }
+
+    case Move::Swap: {
+        int b = plug_[a];
+        if (x < 0 || x >= 26 || b == a || x == a || x == b) return false;
+        int d = plug_[x];
+        newPlug[a] = static_cast<uint8_t>(x);
+        newPlug[x] = static_cast<uint8_t>(a);
+        changed[changedCount++] = static_cast<uint8_t>(a);
+        changed[changedCount++] = static_cast<uint8_t>(b);
+        changed[changedCount++] = static_cast<uint8_t>(x);
+        if (d == x) {
+            // xが未接続：bは未接続になる
+            newPlug[b] = static_cast<uint8_t>(b);
+        } else {
+            // xが接続済み：bとxの元の相手dを接続
+            newPlug[b] = static_cast<uint8_t>(d);
+            newPlug[d] = static_cast<uint8_t>(b);
+            changed[changedCount++] = static_cast<uint8_t>(d);
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+double PlugboardHillClimber::evaluateAdd(char a, char b) {
+    Move move{Move::Add, a, b, 0.0};
+    std::array<uint8_t, 26> newPlug;
+    uint8_t changed[4];
+    int changedCount = 0;
+    if (!buildMove(move, newPlug, changed, changedCount)) {
+        throw std::invalid_argument("無効なプラグボード操作です");
+    }
+    return delta(newPlug, changed, changedCount, false);
+}
+
+double PlugboardHillClimber::evaluateRemove(char a) {
+    Move move{Move::Remove, a, a, 0.0};
+    std::array<uint8_t, 26> newPlug;
+    uint8_t changed[4];
+    int changedCount = 0;
+    if (!buildMove(move, newPlug, changed, changedCount)) {
+        throw std::invalid_argument("無効なプラグボード操作です");
+    }
+    return delta(newPlug, changed, changedCount, false);
+}
+
+double PlugboardHillClimber::evaluateSwap(char a, char c) {
+    Move move{Move::Swap, a, c, 0.0};
+    std::array<uint8_t, 26> newPlug;
+    uint8_t changed[4];
+    int changedCount = 0;
+    if (!buildMove(move, newPlug, changed, changedCount)) {
+        throw std::invalid_argument("無効なプラグボード操作です");
+    }
+    return delta(newPlug, changed, changedCount, false);
+}
+
+void PlugboardHillClimber::apply(const Move& move) {
+    std::array<uint8_t, 26> newPlug;
+    uint8_t changed[4];
+    int changedCount = 0;
+    if (!buildMove(move, newPlug, changed, changedCount)) {
+        throw std::invalid_argument("無効なプラグボード操作です");
+    }
+    delta(newPlug, changed, changedCount, true);
+
+    if (move.type == Move::Add) {
+        pairCount_++;
+    } else if (move.type == Move::Remove) {
+        pairCount_--;
+    }
+    // 付け替えではペア数は変わらない
+}
+
+double PlugboardHillClimber::climb(int maxIterations) {
+    const double epsilon = 1e-9;
+
+    for (int iter = 0; iter < maxIterations; iter++) {
+        Move best{Move::Add, 'A', 'A', epsilon};
+        bool found = false;
+
+        auto consider = [&](Move::Type type, int a, int b) {
+            Move move{type, static_cast<char>('A' + a), static_cast<char>('A' + b), 0.0};
+            std::array<uint8_t, 26> newPlug;
+            uint8_t changed[4];
+            int changedCount = 0;
+            if (!buildMove(move, newPlug, changed, changedCount)) {
+                return;
+            }
+            move.delta = delta(newPlug, changed, changedCount, false);
+            if (move.delta > best.delta) {
+                best = move;
+                found = true;
+            }
+        };
+
+        for (int a = 0; a < 26; a++) {
+            if (plug_[a] == a) {
+                // 追加：未接続の2文字
+                if (pairCount_ < Plugboard::MAX_PAIRS) {
+                    for (int b = a + 1; b < 26; b++) {
+                        if (plug_[b] == b) {
+                            consider(Move::Add, a, b);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            // 削除：各ペアにつき1回
+            if (a < plug_[a]) {
+                consider(Move::Remove, a, a);
+            }
+
+            // 付け替え：接続済み同士の交換は片側からのみ評価
+            for (int c = 0; c < 26; c++) {
+                if (c == a || c == plug_[a]) continue;
+                if (plug_[c] != c && c < a) continue;
+                consider(Move::Swap, a, c);
+            }
+        }
+
+        if (!found) {
+            break;
+        }
+        apply(best);
+    }
+
+    return score_;
+}
+
+std::string PlugboardHillClimber::getPlaintext() const {
+    std::string text(plain_.size(), 'A');
+    for (size_t i = 0; i < plain_.size(); i++) {
+        text[i] = static_cast<char>('A' + plain_[i]);
+    }
+    return text;
+}
+
+std::vector<std::pair<char, char>> PlugboardHillClimber::getPlugboardPairs() const {
+    std::vector<std::pair<char, char>> pairs;
+    for (int i = 0; i < 26; i++) {
+        if (plug_[i] > i) {
+            pairs.push_back({static_cast<char>('A' + i), static_cast<char>('A' + plug_[i])});
+        }
+    }
+    return pairs;
+}
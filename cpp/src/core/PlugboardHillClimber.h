@@ -0,0 +1,87 @@
+#ifndef PLUGBOARD_HILL_CLIMBER_H
+#define PLUGBOARD_HILL_CLIMBER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "NgramScorer.h"
+#include "Plugboard.h"
+#include "ScramblerTable.h"
+
+// ローター順と開始位置が既知（Bombeの候補など）のときにプラグボードを山登り法で復元する
+// 平文 p_i = P(S_i(P(c_i))) のうち、1回の変更で影響を受けるのは
+// 変更した文字が暗号文側かスクランブラ出力側に現れる位置だけなので、
+// 文字ごとの位置リストを保持してn-gramスコアを差分更新する
+class PlugboardHillClimber {
+public:
+    // Add: 未接続のfirstとsecondを接続
+    // Remove: firstとその相手を切断
+    // Swap: firstの相手をsecondに付け替える（secondの元の相手はfirstの元の相手と接続）
+    struct Move {
+        enum Type { Add, Remove, Swap };
+        Type type;
+        char first;
+        char second;
+        double delta;
+    };
+
+    PlugboardHillClimber(const std::string& cipherText,
+                         const ScramblerTable& table,
+                         int startState,
+                         const NgramScorer& scorer);
+
+    // 初期プラグボード（Bombeが推定した配線など）を設定する
+    void setPlugboard(const std::vector<std::pair<char, char>>& pairs);
+    void setPlugboard(const Plugboard& plugboard);
+
+    // 改善がなくなるまで最良の手を適用し、最終スコアを返す
+    double climb(int maxIterations = 1000);
+
+    // 1手を評価（適用しない）/ 適用
+    double evaluateAdd(char a, char b);
+    double evaluateRemove(char a);
+    double evaluateSwap(char a, char c);
+    void apply(const Move& move);
+
+    double getScore() const { return score_; }
+    int getPairCount() const { return pairCount_; }
+    std::string getPlaintext() const;
+    std::vector<std::pair<char, char>> getPlugboardPairs() const;
+
+private:
+    const NgramScorer& scorer_;
+    int n_;
+
+    std::vector<uint8_t> cipher_;
+    std::vector<const uint8_t*> perms_;   // 各文字位置のスクランブラ置換
+    std::vector<uint8_t> mid_;            // スクランブラ出力（出力側プラグボード適用前）
+    std::vector<uint8_t> plain_;
+    std::array<uint8_t, 26> plug_;
+    int pairCount_ = 0;
+    double score_ = 0.0;
+
+    // 暗号文字ごとの位置（不変）とスクランブラ出力文字ごとの位置（可変）
+    std::array<std::vector<int>, 26> byCipher_;
+    std::array<std::vector<int>, 26> byMid_;
+    std::vector<int> midSlot_;            // byMid_内での各位置のインデックス
+
+    // 差分計算用の作業領域
+    std::vector<uint32_t> posStamp_;
+    std::vector<uint32_t> windowStamp_;
+    uint32_t stamp_ = 0;
+    std::vector<int> affected_;
+    std::vector<int> windows_;
+    std::vector<uint8_t> newMid_;
+    std::vector<uint8_t> oldPlain_;
+
+    void rebuild();
+    double windowSum(const std::vector<int>& windows) const;
+    double delta(const std::array<uint8_t, 26>& newPlug, const uint8_t* changed, int changedCount,
+                 bool commit);
+    bool buildMove(const Move& move, std::array<uint8_t, 26>& newPlug,
+                   uint8_t* changed, int& changedCount) const;
+    void moveMid(int pos, uint8_t newMid);
+};
+
+#endif // PLUGBOARD_HILL_CLIMBER_H
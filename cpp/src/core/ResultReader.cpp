@@ -0,0 +1,379 @@
+#include "ResultReader.h"
+#include "ResultSink.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+// NDJSONの1行（平らなオブジェクト）を読む最小限のパーサー
+class JsonLineParser {
+public:
+    explicit JsonLineParser(const std::string& text) : text_(text) {}
+
+    bool parse(CandidateResult& result) {
+        result = CandidateResult();
+        result.score = 0.0;
+        result.matchRate = 0.0;
+        result.plugboardPairs = 0;
+        result.offset = 0;
+
+        if (!expect('{')) return false;
+        if (peek() == '}') {
+            pos_++;
+            return atEnd();
+        }
+        while (true) {
+            std::string key;
+            if (!parseString(key) || !expect(':')) return false;
+            if (!parseField(key, result)) return false;
+
+            char c = peek();
+            pos_++;
+            if (c == '}') break;
+            if (c != ',') return false;
+        }
+        return atEnd();
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_ = 0;
+
+    void skipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) pos_++;
+    }
+
+    char peek() {
+        skipSpace();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool expect(char c) {
+        if (peek() != c) return false;
+        pos_++;
+        return true;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return pos_ == text_.size();
+    }
+
+    bool parseString(std::string& out) {
+        if (!expect('"')) return false;
+        out.clear();
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c == '\\') {
+                if (pos_ >= text_.size()) return false;
+                char e = text_[pos_++];
+                switch (e) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u':
+                        // 結果ファイルではASCIIの制御文字にしか使わない
+                        if (pos_ + 4 > text_.size()) return false;
+                        out += static_cast<char>(std::strtol(text_.substr(pos_, 4).c_str(), nullptr, 16));
+                        pos_ += 4;
+                        break;
+                    default: out += e; break;
+                }
+            } else {
+                out += c;
+            }
+        }
+        return false;
+    }
+
+    bool parseNumber(double& value) {
+        skipSpace();
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        value = std::strtod(begin, &end);
+        if (end == begin) return false;
+        pos_ += end - begin;
+        return true;
+    }
+
+    bool parseStringArray(std::vector<std::string>& values) {
+        if (!expect('[')) return false;
+        values.clear();
+        if (peek() == ']') {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            std::string value;
+            if (!parseString(value)) return false;
+            values.push_back(value);
+            char c = peek();
+            pos_++;
+            if (c == ']') return true;
+            if (c != ',') return false;
+        }
+    }
+
+    // 未知のキーの値（文字列・数値・真偽値・null・文字列配列）を読み飛ばす
+    bool skipValue() {
+        char c = peek();
+        if (c == '"') {
+            std::string ignored;
+            return parseString(ignored);
+        }
+        if (c == '[') {
+            std::vector<std::string> ignored;
+            return parseStringArray(ignored);
+        }
+        for (const char* literal : {"true", "false", "null"}) {
+            size_t length = std::strlen(literal);
+            if (text_.compare(pos_, length, literal) == 0) {
+                pos_ += length;
+                return true;
+            }
+        }
+        double ignored;
+        return parseNumber(ignored);
+    }
+
+    bool parseField(const std::string& key, CandidateResult& result) {
+        double number;
+        std::string text;
+        if (key == "score") return parseNumber(result.score);
+        if (key == "matchRate") return parseNumber(result.matchRate);
+        if (key == "plugboardPairs" || key == "offset" || key == "equivalents") {
+            if (!parseNumber(number)) return false;
+            int value = static_cast<int>(number);
+            if (key == "plugboardPairs") result.plugboardPairs = value;
+            else if (key == "offset") result.offset = value;
+            else result.equivalentCount = value;
+            return true;
+        }
+        if (key == "position") {
+            if (!parseString(text)) return false;
+            result.positions.clear();
+            for (char c : text) {
+                if (c < 'A' || c > 'Z') return false;
+                result.positions.push_back(c - 'A');
+            }
+            return true;
+        }
+        if (key == "rotors") {
+            if (!parseString(text)) return false;
+            result.rotorOrder.clear();
+            size_t start = 0;
+            while (start <= text.size() && !text.empty()) {
+                size_t dash = text.find('-', start);
+                if (dash == std::string::npos) dash = text.size();
+                result.rotorOrder.push_back(text.substr(start, dash - start));
+                start = dash + 1;
+            }
+            return true;
+        }
+        if (key == "crib") return parseString(result.crib);
+        if (key == "plugboard") {
+            std::vector<std::string> pairs;
+            if (!parseStringArray(pairs)) return false;
+            result.plugboard.clear();
+            for (const auto& pair : pairs) {
+                if (pair.size() != 2) return false;
+                result.plugboard.emplace_back(pair[0], pair[1]);
+            }
+            return true;
+        }
+        return skipValue();
+    }
+};
+
+// ヒープ用（先頭が最も順位の低い候補になる）
+struct RanksBefore {
+    bool operator()(const CandidateResult& a, const CandidateResult& b) const {
+        return ResultMerger::ranksBefore(a, b);
+    }
+};
+
+} // namespace
+
+ResultReader::ResultReader(const std::string& path)
+    : path_(path), file_(path, std::ios::binary) {
+    if (!file_) {
+        throw std::runtime_error("結果ファイルを開けません: " + path);
+    }
+
+    char magic[sizeof(BinaryResultSink::MAGIC)] = {};
+    file_.read(magic, sizeof(magic));
+    if (file_.gcount() == static_cast<std::streamsize>(sizeof(magic)) &&
+        std::memcmp(magic, BinaryResultSink::MAGIC, sizeof(magic)) == 0) {
+        uint32_t version = 0;
+        file_.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (!file_ || version != BinaryResultSink::VERSION) {
+            throw std::runtime_error("未対応の結果ファイルのバージョンです: " + path);
+        }
+        binary_ = true;
+    } else {
+        file_.clear();
+        file_.seekg(0);
+    }
+}
+
+bool ResultReader::next(CandidateResult& result) {
+    if (binary_) {
+        uint32_t length;
+        if (!file_.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            if (file_.gcount() == 0) return false;
+            throw std::runtime_error("結果ファイルの末尾が壊れています: " + path_);
+        }
+        record_.resize(length);
+        if (!file_.read(record_.data(), length) ||
+            !BinaryResultSink::decode(record_.data(), length, result)) {
+            throw std::runtime_error("結果ファイルのレコードが壊れています: " + path_);
+        }
+        return true;
+    }
+
+    while (std::getline(file_, line_)) {
+        lineNumber_++;
+        if (!line_.empty() && line_.back() == '\r') line_.pop_back();
+        if (line_.find_first_not_of(" \t") == std::string::npos) continue;
+        if (!parseJsonLine(line_, result)) {
+            throw std::runtime_error(path_ + ":" + std::to_string(lineNumber_) +
+                                     ": 結果の行を解析できません");
+        }
+        return true;
+    }
+    return false;
+}
+
+bool ResultReader::parseJsonLine(const std::string& line, CandidateResult& result) {
+    return JsonLineParser(line).parse(result);
+}
+
+bool ResultMerger::ranksBefore(const CandidateResult& a, const CandidateResult& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return std::tie(a.rotorOrder, a.positions, a.offset, a.crib, a.plugboard) <
+           std::tie(b.rotorOrder, b.positions, b.offset, b.crib, b.plugboard);
+}
+
+std::vector<CandidateResult> ResultMerger::topK(const std::vector<std::string>& inputs, size_t k) {
+    std::priority_queue<CandidateResult, std::vector<CandidateResult>, RanksBefore> heap;
+    if (k == 0) {
+        return {};
+    }
+
+    CandidateResult result;
+    for (const auto& input : inputs) {
+        ResultReader reader(input);
+        while (reader.next(result)) {
+            if (heap.size() < k) {
+                heap.push(result);
+            } else if (ranksBefore(result, heap.top())) {
+                heap.pop();
+                heap.push(result);
+            }
+        }
+    }
+
+    std::vector<CandidateResult> top;
+    top.reserve(heap.size());
+    while (!heap.empty()) {
+        top.push_back(heap.top());
+        heap.pop();
+    }
+    std::reverse(top.begin(), top.end());
+    return top;
+}
+
+uint64_t ResultMerger::sortFiles(const std::vector<std::string>& inputs,
+                                 const std::string& output,
+                                 size_t runSize,
+                                 std::function<void(const std::string&)> progressCallback) {
+    runSize = (std::max)(runSize, size_t(1));
+
+    // 1. 各入力をrunSize件ずつ整列して一時ファイルへ
+    std::vector<std::string> runPaths;
+    std::vector<CandidateResult> chunk;
+    uint64_t total = 0;
+
+    auto writeRun = [&]() {
+        if (chunk.empty()) return;
+        std::sort(chunk.begin(), chunk.end(), ranksBefore);
+        std::string runPath = output + ".run" + std::to_string(runPaths.size()) + ".tmp";
+        {
+            BinaryResultSink sink(runPath);
+            for (const auto& result : chunk) {
+                sink.write(result);
+            }
+            sink.flush();
+        }
+        runPaths.push_back(runPath);
+        chunk.clear();
+        if (progressCallback) {
+            progressCallback("Sorted run " + std::to_string(runPaths.size()) + " (" +
+                             std::to_string(total) + " results read)");
+        }
+    };
+
+    auto removeRuns = [&runPaths]() {
+        for (const auto& runPath : runPaths) {
+            std::remove(runPath.c_str());
+        }
+    };
+
+    try {
+        CandidateResult result;
+        for (const auto& input : inputs) {
+            ResultReader reader(input);
+            while (reader.next(result)) {
+                chunk.push_back(std::move(result));
+                total++;
+                if (chunk.size() >= runSize) {
+                    writeRun();
+                }
+            }
+        }
+        writeRun();
+        chunk.shrink_to_fit();
+
+        // 2. 各一時ファイルの先頭をヒープに入れてk-wayマージ
+        std::vector<std::unique_ptr<ResultReader>> readers;
+        std::vector<CandidateResult> heads(runPaths.size());
+        auto worse = [&heads](size_t a, size_t b) { return ranksBefore(heads[b], heads[a]); };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(worse)> heap(worse);
+        for (size_t i = 0; i < runPaths.size(); i++) {
+            readers.push_back(std::make_unique<ResultReader>(runPaths[i]));
+            if (readers[i]->next(heads[i])) {
+                heap.push(i);
+            }
+        }
+
+        auto sink = ResultSink::open(output);
+        while (!heap.empty()) {
+            size_t run = heap.top();
+            heap.pop();
+            sink->write(heads[run]);
+            if (readers[run]->next(heads[run])) {
+                heap.push(run);
+            }
+        }
+        sink->flush();
+    } catch (...) {
+        removeRuns();
+        throw;
+    }
+
+    removeRuns();
+    if (progressCallback) {
+        progressCallback("Merged " + std::to_string(runPaths.size()) + " runs into " + output);
+    }
+    return total;
+}
@@ -0,0 +1,49 @@
+#ifndef RESULT_READER_H
+#define RESULT_READER_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "BombeAttack.h"
+
+// ResultSinkが書いた結果ファイルを1候補ずつ読む（形式は先頭のマジックで判定）
+class ResultReader {
+public:
+    explicit ResultReader(const std::string& path);
+
+    // 次の候補を読む。ファイル末尾ならfalse、壊れたレコードは例外
+    bool next(CandidateResult& result);
+
+    bool isBinary() const { return binary_; }
+
+    static bool parseJsonLine(const std::string& line, CandidateResult& result);
+
+private:
+    std::string path_;
+    std::ifstream file_;
+    bool binary_ = false;
+    uint64_t lineNumber_ = 0;
+    std::string line_;
+    std::vector<char> record_;
+};
+
+// 複数の結果ファイルを全体を読み込まずに集計する
+class ResultMerger {
+public:
+    // スコア降順、同点はローター順・位置・オフセット・クリブ・プラグボードの順
+    static bool ranksBefore(const CandidateResult& a, const CandidateResult& b);
+
+    // 上位k件だけをヒープに保持しながら全ファイルを走査する
+    static std::vector<CandidateResult> topK(const std::vector<std::string>& inputs, size_t k);
+
+    // 外部ソート：runSize件ずつ整列した一時ファイル（output + ".runN.tmp"）を作り、
+    // それらをマージしてoutputに書く（形式はResultSink::openと同じく拡張子で決まる）
+    static uint64_t sortFiles(const std::vector<std::string>& inputs,
+                              const std::string& output,
+                              size_t runSize = 1000000,
+                              std::function<void(const std::string&)> progressCallback = nullptr);
+};
+
+#endif // RESULT_READER_H
@@ -0,0 +1,201 @@
+#include "ResultSink.h"
+#include "BombeAttack.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+constexpr char BinaryResultSink::MAGIC[8];
+constexpr uint32_t BinaryResultSink::VERSION;
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendJsonNumber(std::string& out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out += buffer;
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendShortString(std::string& out, const std::string& text) {
+    if (text.size() > 0xFF) {
+        throw std::invalid_argument("文字列が長すぎます: " + text);
+    }
+    appendValue<uint8_t>(out, static_cast<uint8_t>(text.size()));
+    out += text;
+}
+
+// 長さを確認しながら読み進める
+class RecordCursor {
+public:
+    RecordCursor(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (size_ - pos_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool readBytes(std::string& text, size_t length) {
+        if (size_ - pos_ < length) return false;
+        text.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    bool readShortString(std::string& text) {
+        uint8_t length;
+        return read(length) && readBytes(text, length);
+    }
+
+    bool atEnd() const { return pos_ == size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+std::unique_ptr<ResultSink> ResultSink::open(const std::string& path) {
+    if (endsWith(path, ".bin")) {
+        return std::make_unique<BinaryResultSink>(path);
+    }
+    return std::make_unique<NdjsonResultSink>(path);
+}
+
+NdjsonResultSink::NdjsonResultSink(const std::string& path)
+    : writer_(path) {
+}
+
+std::string NdjsonResultSink::toJson(const CandidateResult& result) {
+    std::string line = "{\"score\":";
+    appendJsonNumber(line, result.score);
+    line += ",\"position\":";
+    appendJsonString(line, result.getPositionString());
+    line += ",\"rotors\":";
+    appendJsonString(line, result.getRotorString());
+    line += ",\"matchRate\":";
+    appendJsonNumber(line, result.matchRate);
+    line += ",\"plugboardPairs\":" + std::to_string(result.plugboardPairs);
+    line += ",\"offset\":" + std::to_string(result.offset);
+    line += ",\"plugboard\":[";
+    for (size_t i = 0; i < result.plugboard.size(); i++) {
+        if (i > 0) line += ',';
+        appendJsonString(line, std::string{result.plugboard[i].first, result.plugboard[i].second});
+    }
+    line += "],\"crib\":";
+    appendJsonString(line, result.crib);
+    line += ",\"equivalents\":" + std::to_string(result.equivalentCount);
+    line += '}';
+    return line;
+}
+
+void NdjsonResultSink::write(const CandidateResult& result) {
+    writer_.write(toJson(result) + "\n");
+    count_++;
+}
+
+BinaryResultSink::BinaryResultSink(const std::string& path)
+    : writer_(path) {
+    writer_.write(MAGIC, sizeof(MAGIC));
+    writer_.write(&VERSION, sizeof(VERSION));
+}
+
+std::string BinaryResultSink::encode(const CandidateResult& result) {
+    std::string record;
+    appendValue<double>(record, result.score);
+    appendValue<double>(record, result.matchRate);
+    appendValue<int32_t>(record, result.offset);
+    appendValue<int32_t>(record, result.plugboardPairs);
+    appendValue<int32_t>(record, result.equivalentCount);
+
+    appendValue<uint8_t>(record, static_cast<uint8_t>(result.positions.size()));
+    for (int position : result.positions) {
+        appendValue<uint8_t>(record, static_cast<uint8_t>(position));
+    }
+    appendValue<uint8_t>(record, static_cast<uint8_t>(result.rotorOrder.size()));
+    for (const auto& rotor : result.rotorOrder) {
+        appendShortString(record, rotor);
+    }
+    appendShortString(record, result.crib);
+    appendValue<uint8_t>(record, static_cast<uint8_t>(result.plugboard.size()));
+    for (const auto& [a, b] : result.plugboard) {
+        record += a;
+        record += b;
+    }
+    return record;
+}
+
+bool BinaryResultSink::decode(const char* data, size_t size, CandidateResult& result) {
+    RecordCursor cursor(data, size);
+    int32_t offset, pairs, equivalents;
+    if (!cursor.read(result.score) || !cursor.read(result.matchRate) ||
+        !cursor.read(offset) || !cursor.read(pairs) || !cursor.read(equivalents)) {
+        return false;
+    }
+    result.offset = offset;
+    result.plugboardPairs = pairs;
+    result.equivalentCount = equivalents;
+
+    uint8_t count;
+    if (!cursor.read(count)) return false;
+    result.positions.assign(count, 0);
+    for (auto& position : result.positions) {
+        uint8_t value;
+        if (!cursor.read(value)) return false;
+        position = value;
+    }
+
+    if (!cursor.read(count)) return false;
+    result.rotorOrder.assign(count, std::string());
+    for (auto& rotor : result.rotorOrder) {
+        if (!cursor.readShortString(rotor)) return false;
+    }
+    if (!cursor.readShortString(result.crib)) return false;
+
+    if (!cursor.read(count)) return false;
+    result.plugboard.clear();
+    std::string pair;
+    for (int i = 0; i < count; i++) {
+        if (!cursor.readBytes(pair, 2)) return false;
+        result.plugboard.emplace_back(pair[0], pair[1]);
+    }
+    return cursor.atEnd();
+}
+
+void BinaryResultSink::write(const CandidateResult& result) {
+    std::string record = encode(result);
+    uint32_t length = static_cast<uint32_t>(record.size());
+    record.insert(0, reinterpret_cast<const char*>(&length), sizeof(length));
+    writer_.write(record);  // 長さと本体を1回で渡し、並行書き込みでも混ざらないようにする
+    count_++;
+}
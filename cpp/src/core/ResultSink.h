@@ -0,0 +1,64 @@
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "AsyncFileWriter.h"
+
+struct CandidateResult;
+
+// 攻撃中に見つかった候補を逐次受け取る出力先
+// write()は探索スレッドから並行して呼ばれる
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+
+    virtual void write(const CandidateResult& result) = 0;
+
+    // ここまでの候補を出力先へ確実に渡す
+    virtual void flush() {}
+
+    uint64_t count() const { return count_; }
+
+    // 拡張子で形式を選ぶ（.binは長さ付きバイナリ、それ以外はNDJSON）
+    static std::unique_ptr<ResultSink> open(const std::string& path);
+
+protected:
+    std::atomic<uint64_t> count_{0};
+};
+
+// 1行1候補のJSON（BombeWindowのエクスポートと同じキー名）
+class NdjsonResultSink : public ResultSink {
+public:
+    explicit NdjsonResultSink(const std::string& path);
+
+    void write(const CandidateResult& result) override;
+    void flush() override { writer_.flush(); }
+
+    static std::string toJson(const CandidateResult& result);
+
+private:
+    AsyncFileWriter writer_;
+};
+
+// ヘッダ（"ENIGRSLT" + バージョン）のあとに uint32長さ + レコード本体 が続くバイナリ
+class BinaryResultSink : public ResultSink {
+public:
+    static constexpr char MAGIC[8] = {'E', 'N', 'I', 'G', 'R', 'S', 'L', 'T'};
+    static constexpr uint32_t VERSION = 1;
+
+    explicit BinaryResultSink(const std::string& path);
+
+    void write(const CandidateResult& result) override;
+    void flush() override { writer_.flush(); }
+
+    static std::string encode(const CandidateResult& result);
+    static bool decode(const char* data, size_t size, CandidateResult& result);
+
+private:
+    AsyncFileWriter writer_;
+};
+
+#endif // RESULT_SINK_H
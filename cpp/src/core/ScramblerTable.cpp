@@ -0,0 +1,176 @@
+#include "ScramblerTable.h"
+#include "EnigmaMachine.h"
+#include "RotorConfig.h"
+#include "ScramblerTableStore.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+ScramblerTable::ScramblerTable(const std::vector<std::string>& rotorOrder,
+                               const std::string& reflectorType)
+    : rotorOrder_(rotorOrder), reflectorType_(reflectorType),
+      ownPerms_(static_cast<size_t>(NUM_STATES) * 26), ownNext_(NUM_STATES),
+      perms_(ownPerms_.data()), next_(ownNext_.data()) {
+    validate();
+
+    // 参照実装のEnigmaMachineで全状態を列挙する（スレッドごとにマシンを作成）
+    #pragma omp parallel
+    {
+        auto rotors = std::vector<std::unique_ptr<Rotor>>();
+        for (const auto& type : rotorOrder_) {
+            auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+            rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+        }
+        auto reflector = std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at(reflectorType_).wiring);
+        EnigmaMachine machine(std::move(rotors), std::move(reflector), std::make_unique<Plugboard>());
+
+        #pragma omp for schedule(static)
+        for (int state = 0; state < NUM_STATES; state++) {
+            machine.setRotorPositions(statePositions(state));
+
+            uint8_t* p = &ownPerms_[static_cast<size_t>(state) * 26];
+            for (int c = 0; c < 26; c++) {
+                p[c] = static_cast<uint8_t>(machine.encryptCharNoPlugboard('A' + c) - 'A');
+            }
+
+            machine.stepRotors();
+            ownNext_[state] = static_cast<uint16_t>(stateIndex(machine.getRotorPositions()));
+        }
+    }
+}
+
+ScramblerTable::ScramblerTable(const std::vector<std::string>& rotorOrder,
+                               const std::string& reflectorType,
+                               const uint8_t* perms,
+                               const uint16_t* nextStates,
+                               std::shared_ptr<const void> owner)
+    : rotorOrder_(rotorOrder), reflectorType_(reflectorType),
+      owner_(std::move(owner)), perms_(perms), next_(nextStates) {
+    validate();
+    checkStates();
+}
+
+void ScramblerTable::validate() const {
+    if (rotorOrder_.size() != 3) {
+        throw std::invalid_argument("ScramblerTableには3枚のローターが必要です");
+    }
+
+    for (const auto& type : rotorOrder_) {
+        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
+            throw std::invalid_argument("無効なローター: " + type);
+        }
+    }
+    if (enigma::REFLECTOR_DEFINITIONS.find(reflectorType_) == enigma::REFLECTOR_DEFINITIONS.end()) {
+        throw std::invalid_argument("無効なリフレクター: " + reflectorType_);
+    }
+}
+
+void ScramblerTable::checkStates() const {
+    // 外部の表は信頼せず、perm()/next()の利用者が範囲外を読まないことをここで保証する
+    for (int state = 0; state < NUM_STATES; state++) {
+        const uint8_t* p = perm(state);
+        for (int c = 0; c < 26; c++) {
+            if (p[c] >= 26 || p[c] == c || p[p[c]] != c) {
+                throw std::runtime_error("置換表が壊れています（状態 " + std::to_string(state) + "）");
+            }
+        }
+        if (next_[state] >= NUM_STATES) {
+            throw std::runtime_error("状態遷移表が壊れています（状態 " + std::to_string(state) + "）");
+        }
+    }
+}
+
+std::shared_ptr<const ScramblerTable> ScramblerTable::get(const std::vector<std::string>& rotorOrder,
+                                                         const std::string& reflectorType) {
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::weak_ptr<const ScramblerTable>> cache;
+
+    std::string key = reflectorType;
+    for (const auto& type : rotorOrder) {
+        key += "/" + type;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (auto table = cache[key].lock()) {
+            return table;
+        }
+    }
+
+    // 作成中はロックを外し、別のローター順の表を並行して作れるようにする
+    std::shared_ptr<const ScramblerTable> table;
+    if (auto store = ScramblerTableStore::getDefault()) {
+        table = store->load(rotorOrder, reflectorType);
+    }
+    if (!table) {
+        table = std::make_shared<ScramblerTable>(rotorOrder, reflectorType);
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (auto existing = cache[key].lock()) {
+        return existing;  // 同時に作成された表があればそちらを共有する
+    }
+    cache[key] = table;
+    return table;
+}
+
+std::vector<std::vector<std::string>> ScramblerTable::buildRotorOrders(
+    const std::vector<std::string>& rotorTypes,
+    bool testAllOrders) {
+    std::vector<std::vector<std::string>> rotorOrders;
+    if (!testAllOrders) {
+        rotorOrders.push_back(rotorTypes);
+        return rotorOrders;
+    }
+
+    if (rotorTypes.size() > 3) {
+        // 全ローターから3つを選び、その順列を生成
+        for (size_t i = 0; i < rotorTypes.size(); i++) {
+            for (size_t j = 0; j < rotorTypes.size(); j++) {
+                if (j == i) continue;
+                for (size_t k = 0; k < rotorTypes.size(); k++) {
+                    if (k == i || k == j) continue;
+                    rotorOrders.push_back({rotorTypes[i], rotorTypes[j], rotorTypes[k]});
+                }
+            }
+        }
+    } else {
+        // 3個以下の場合は全順列を生成（std::next_permutationはソート済みの入力から始める）
+        std::vector<std::string> current = rotorTypes;
+        std::sort(current.begin(), current.end());
+        do {
+            rotorOrders.push_back(current);
+        } while (std::next_permutation(current.begin(), current.end()));
+    }
+    return rotorOrders;
+}
+
+int ScramblerTable::stateIndex(const std::vector<int>& positions) {
+    return (positions[0] * 26 + positions[1]) * 26 + positions[2];
+}
+
+std::vector<int> ScramblerTable::statePositions(int state) {
+    return {state / 676, (state / 26) % 26, state % 26};
+}
+
+int ScramblerTable::advance(int state, int steps) const {
+    for (int i = 0; i < steps; i++) {
+        state = next_[state];
+    }
+    return state;
+}
+
+std::vector<int> ScramblerTable::stateSequence(int startState, int length) const {
+    std::vector<int> states;
+    states.reserve(length);
+
+    int state = startState;
+    for (int i = 0; i < length; i++) {
+        state = next_[state];
+        states.push_back(state);
+    }
+    return states;
+}
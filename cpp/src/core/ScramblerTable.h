@@ -0,0 +1,73 @@
+#ifndef SCRAMBLER_TABLE_H
+#define SCRAMBLER_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// プラグボードを除いたスクランブラ（ローター＋リフレクター）の置換表
+// 3枚のローター位置の全17,576状態について、置換と次の状態を事前計算する
+// リング設定は0（EnigmaMachineの既定）を前提とする
+class ScramblerTable {
+public:
+    static constexpr int NUM_STATES = 26 * 26 * 26;
+
+    ScramblerTable(const std::vector<std::string>& rotorOrder,
+                   const std::string& reflectorType);
+
+    // 外部のメモリ（ScramblerTableStoreのマップ）上の表をコピーせずに使う
+    // perms は NUM_STATES × 26 バイト、nextStates は NUM_STATES 個。ownerが表の寿命を保つ
+    // 不動点のない対合でない置換や範囲外の状態があればstd::runtime_errorを投げる
+    ScramblerTable(const std::vector<std::string>& rotorOrder,
+                   const std::string& reflectorType,
+                   const uint8_t* perms,
+                   const uint16_t* nextStates,
+                   std::shared_ptr<const void> owner);
+
+    // 表は自身のバッファを指すのでコピーしない（共有はgetのshared_ptrで行う）
+    ScramblerTable(const ScramblerTable&) = delete;
+    ScramblerTable& operator=(const ScramblerTable&) = delete;
+
+    // プロセス内で共有する表を返す（使用中の表は再作成しない）
+    // 既定のScramblerTableStoreにあればそこから読み込み、なければ作成する
+    static std::shared_ptr<const ScramblerTable> get(const std::vector<std::string>& rotorOrder,
+                                                     const std::string& reflectorType);
+
+    // testAllOrdersならrotorTypesから3枚を選ぶ全順列、そうでなければrotorTypesそのものを返す
+    static std::vector<std::vector<std::string>> buildRotorOrders(
+        const std::vector<std::string>& rotorTypes,
+        bool testAllOrders);
+
+    // ローター位置（EnigmaMachine::setRotorPositionsと同じ並び）と状態番号の変換
+    static int stateIndex(const std::vector<int>& positions);
+    static std::vector<int> statePositions(int state);
+
+    // stepRotors()を1回行った後の状態
+    int next(int state) const { return next_[state]; }
+    int advance(int state, int steps) const;
+
+    // 状態stateでの置換（0-25のインデックス、対合）
+    const uint8_t* perm(int state) const { return perms_ + static_cast<size_t>(state) * 26; }
+
+    // 開始状態から暗号化した場合の各文字位置での状態列
+    // （encryptCharは暗号化前にステップするため、1文字目は1ステップ後の状態）
+    std::vector<int> stateSequence(int startState, int length) const;
+
+    const std::vector<std::string>& getRotorOrder() const { return rotorOrder_; }
+    const std::string& getReflectorType() const { return reflectorType_; }
+
+private:
+    void validate() const;
+    void checkStates() const;
+
+    std::vector<std::string> rotorOrder_;
+    std::string reflectorType_;
+    std::vector<uint8_t> ownPerms_;    // 自分で作成した表（マップ上の表では空）
+    std::vector<uint16_t> ownNext_;
+    std::shared_ptr<const void> owner_;
+    const uint8_t* perms_;
+    const uint16_t* next_;
+};
+
+#endif // SCRAMBLER_TABLE_H
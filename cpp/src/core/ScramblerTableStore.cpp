@@ -0,0 +1,247 @@
+#include "ScramblerTableStore.h"
+#include "ScramblerTable.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+
+// ストアファイルの形式（リトルエンディアン、ネイティブ配置）
+//   Header | TableRecord × tableCount | 各表（ページ境界から）
+//   表: 置換 NUM_STATES × 26 バイト | 次の状態 NUM_STATES × uint16
+struct ScramblerTableStore::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t tableCount;
+    uint32_t numStates;
+    uint32_t tableSize;
+};
+
+struct ScramblerTableStore::TableRecord {
+    char rotors[3][8];
+    char reflector[8];
+    uint64_t offset;
+    uint64_t checksum;  // 表全体のFNV-1a
+};
+
+namespace {
+
+const char STORE_MAGIC[8] = {'E', 'N', 'I', 'G', 'T', 'B', 'L', 'S'};
+const uint64_t PAGE_SIZE = 4096;
+
+std::mutex defaultMutex;
+std::string defaultPath;
+bool defaultHugePages = false;
+bool defaultPathSet = false;
+bool defaultLoaded = false;
+std::shared_ptr<ScramblerTableStore> defaultStore;
+
+const uint64_t PERMS_SIZE = static_cast<uint64_t>(ScramblerTable::NUM_STATES) * 26;
+const uint64_t TABLE_SIZE = PERMS_SIZE + static_cast<uint64_t>(ScramblerTable::NUM_STATES) * sizeof(uint16_t);
+
+uint64_t alignToPage(uint64_t offset) {
+    return (offset + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+std::string ScramblerTableStore::tableKey(const std::vector<std::string>& rotorOrder,
+                                          const std::string& reflectorType) {
+    std::string key = reflectorType;
+    for (const auto& type : rotorOrder) {
+        key += "/" + type;
+    }
+    return key;
+}
+
+ScramblerTableStore::ScramblerTableStore(const std::string& path, bool hugePages)
+    : file_(std::make_shared<MappedFile>(path, hugePages)), path_(path) {
+    if (file_->size() < sizeof(Header)) {
+        throw std::runtime_error("表ストアが壊れています: " + path);
+    }
+    const Header* header = reinterpret_cast<const Header*>(file_->data());
+    if (std::memcmp(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 ||
+        header->version != VERSION ||
+        header->numStates != static_cast<uint32_t>(ScramblerTable::NUM_STATES) ||
+        header->tableSize != TABLE_SIZE) {
+        throw std::runtime_error("表ストアの形式またはバージョンが異なります: " + path);
+    }
+
+    if (sizeof(Header) + static_cast<uint64_t>(header->tableCount) * sizeof(TableRecord) > file_->size()) {
+        throw std::runtime_error("表ストアが壊れています: " + path);
+    }
+    const TableRecord* records = reinterpret_cast<const TableRecord*>(file_->data() + sizeof(Header));
+    for (uint32_t i = 0; i < header->tableCount; i++) {
+        const TableRecord& record = records[i];
+        // 置換はバイト単位、次の状態はuint16で直接読むので、ページ境界に揃っていることも確かめる
+        if (record.offset % PAGE_SIZE != 0 || record.offset > file_->size() ||
+            file_->size() - record.offset < TABLE_SIZE) {
+            throw std::runtime_error("表ストアが壊れています: " + path);
+        }
+        std::vector<std::string> order;
+        for (const auto& name : record.rotors) {
+            order.emplace_back(name, strnlen(name, sizeof(name)));
+        }
+        std::string reflector(record.reflector, strnlen(record.reflector, sizeof(record.reflector)));
+        records_[tableKey(order, reflector)] = &record;
+    }
+}
+
+size_t ScramblerTableStore::build(const std::string& path,
+                                  const std::vector<std::string>& rotorTypes,
+                                  const std::vector<std::string>& reflectorTypes,
+                                  std::function<void(const std::string&)> progressCallback) {
+    auto rotorOrders = ScramblerTable::buildRotorOrders(rotorTypes, true);
+    for (const auto& type : rotorTypes) {
+        if (type.size() >= sizeof(TableRecord::rotors[0])) {
+            throw std::invalid_argument("ローター名が長すぎます: " + type);
+        }
+    }
+    for (const auto& type : reflectorTypes) {
+        if (type.size() >= sizeof(TableRecord::reflector)) {
+            throw std::invalid_argument("リフレクター名が長すぎます: " + type);
+        }
+    }
+
+    const size_t tableCount = rotorOrders.size() * reflectorTypes.size();
+
+    Header header{};
+    std::memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.tableCount = static_cast<uint32_t>(tableCount);
+    header.numStates = ScramblerTable::NUM_STATES;
+    header.tableSize = static_cast<uint32_t>(TABLE_SIZE);
+
+    // 表の配置を先に決めてディレクトリを書く
+    std::vector<TableRecord> records(tableCount);
+    uint64_t offset = alignToPage(sizeof(Header) + tableCount * sizeof(TableRecord));
+    for (size_t r = 0; r < reflectorTypes.size(); r++) {
+        for (size_t o = 0; o < rotorOrders.size(); o++) {
+            TableRecord& record = records[r * rotorOrders.size() + o];
+            std::memset(&record, 0, sizeof(record));
+            for (int i = 0; i < 3; i++) {
+                std::strncpy(record.rotors[i], rotorOrders[o][i].c_str(), sizeof(record.rotors[i]) - 1);
+            }
+            std::strncpy(record.reflector, reflectorTypes[r].c_str(), sizeof(record.reflector) - 1);
+            record.offset = offset;
+            offset = alignToPage(offset + TABLE_SIZE);
+        }
+    }
+
+    // 一時ファイルに書いてから置き換える
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("表ストアを作成できません: " + temporary);
+    }
+    // ディレクトリは表のチェックサムが揃ってから書き直す
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TableRecord));
+
+    std::vector<uint8_t> data(TABLE_SIZE);
+    std::vector<char> padding(PAGE_SIZE, 0);
+    for (size_t i = 0; i < tableCount; i++) {
+        size_t r = i / rotorOrders.size();
+        size_t o = i % rotorOrders.size();
+        ScramblerTable table(rotorOrders[o], reflectorTypes[r]);
+
+        std::memcpy(data.data(), table.perm(0), PERMS_SIZE);
+        uint16_t* nextStates = reinterpret_cast<uint16_t*>(data.data() + PERMS_SIZE);
+        for (int state = 0; state < ScramblerTable::NUM_STATES; state++) {
+            nextStates[state] = static_cast<uint16_t>(table.next(state));
+        }
+        records[i].checksum = fnv1a(data.data(), data.size());
+
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding.data(), static_cast<std::streamsize>(records[i].offset - position));
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        if (progressCallback && ((i + 1) % 10 == 0 || i + 1 == tableCount)) {
+            progressCallback("Stored " + std::to_string(i + 1) + "/" + std::to_string(tableCount) + " tables");
+        }
+    }
+
+    file.seekp(sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TableRecord));
+    file.close();
+
+    if (!file) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("表ストアの書き込みに失敗しました: " + temporary);
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("表ストアを置き換えられません: " + path);
+    }
+    return tableCount;
+}
+
+bool ScramblerTableStore::contains(const std::vector<std::string>& rotorOrder,
+                                   const std::string& reflectorType) const {
+    return records_.count(tableKey(rotorOrder, reflectorType)) > 0;
+}
+
+std::shared_ptr<ScramblerTable> ScramblerTableStore::load(const std::vector<std::string>& rotorOrder,
+                                                          const std::string& reflectorType) const {
+    auto it = records_.find(tableKey(rotorOrder, reflectorType));
+    if (it == records_.end()) {
+        return nullptr;
+    }
+
+    const uint8_t* data = file_->data() + it->second->offset;
+    if (fnv1a(data, TABLE_SIZE) != it->second->checksum) {
+        throw std::runtime_error("表ストアの表が壊れています: " + path_ + " (" +
+                                 tableKey(rotorOrder, reflectorType) + ")");
+    }
+    // 表はマップを直接参照する（ScramblerTableが不正な置換・状態を拒否する）
+    return std::make_shared<ScramblerTable>(rotorOrder, reflectorType, data,
+                                            reinterpret_cast<const uint16_t*>(data + PERMS_SIZE), file_);
+}
+
+void ScramblerTableStore::setDefaultPath(const std::string& path, bool hugePages) {
+    std::lock_guard<std::mutex> lock(defaultMutex);
+    defaultPath = path;
+    defaultHugePages = hugePages;
+    defaultPathSet = true;
+    defaultLoaded = false;
+    defaultStore.reset();
+}
+
+std::shared_ptr<ScramblerTableStore> ScramblerTableStore::getDefault() {
+    std::lock_guard<std::mutex> lock(defaultMutex);
+    if (defaultLoaded) {
+        return defaultStore;
+    }
+    defaultLoaded = true;
+
+    if (!defaultPathSet) {
+        const char* env = std::getenv("ENIGMA_TABLE_STORE");
+        if (env) defaultPath = env;
+        const char* huge = std::getenv("ENIGMA_TABLE_STORE_HUGEPAGES");
+        defaultHugePages = huge && std::string(huge) == "1";
+    }
+    if (defaultPath.empty()) {
+        return nullptr;
+    }
+
+    try {
+        defaultStore = std::make_shared<ScramblerTableStore>(defaultPath, defaultHugePages);
+    } catch (const std::exception&) {
+        // 開けないストアは使わず、表を都度作成する
+        defaultStore.reset();
+    }
+    return defaultStore;
+}
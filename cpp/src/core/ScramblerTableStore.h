@@ -0,0 +1,57 @@
+#ifndef SCRAMBLER_TABLE_STORE_H
+#define SCRAMBLER_TABLE_STORE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+class ScramblerTable;
+
+// 事前計算したScramblerTableをまとめたファイル（enigma_tablegenで作成）
+// 各表は置換（状態ごとに26バイト）と次の状態をそのままの形でページ境界から配置する。
+// loadした表はマップ上を直接参照するので、複数のプロセスが同じページを共有し、
+// 攻撃の開始時には表の再計算もコピーも行われない
+class ScramblerTableStore {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    explicit ScramblerTableStore(const std::string& path, bool hugePages = false);
+
+    // rotorTypesから3枚を選ぶ全ローター順×reflectorTypesの表を作成してpathに書き込む。
+    // path + ".tmp" に書いてから置き換えるので、既存のストアをマップ中のプロセスは影響を受けない
+    static size_t build(const std::string& path,
+                        const std::vector<std::string>& rotorTypes,
+                        const std::vector<std::string>& reflectorTypes,
+                        std::function<void(const std::string&)> progressCallback = nullptr);
+
+    bool contains(const std::vector<std::string>& rotorOrder, const std::string& reflectorType) const;
+
+    // 見つからなければnullptr。表が壊れていればstd::runtime_error
+    // 返した表はマップを参照し続けるので、ストアより長く使ってよい
+    std::shared_ptr<ScramblerTable> load(const std::vector<std::string>& rotorOrder,
+                                         const std::string& reflectorType) const;
+
+    size_t getTableCount() const { return records_.size(); }
+
+    // ScramblerTable::getが参照する既定のストア
+    // setDefaultPathが呼ばれていなければ環境変数ENIGMA_TABLE_STORE
+    // （ENIGMA_TABLE_STORE_HUGEPAGES=1でヒュージページを要求）を使う。開けなければnullptr
+    static void setDefaultPath(const std::string& path, bool hugePages = false);
+    static std::shared_ptr<ScramblerTableStore> getDefault();
+
+private:
+    struct Header;
+    struct TableRecord;
+
+    std::shared_ptr<MappedFile> file_;
+    std::string path_;
+    std::map<std::string, const TableRecord*> records_;
+
+    static std::string tableKey(const std::vector<std::string>& rotorOrder, const std::string& reflectorType);
+};
+
+#endif // SCRAMBLER_TABLE_STORE_H
@@ -0,0 +1,147 @@
+#include "ShadowValidator.h"
+#include "EnigmaMachine.h"
+#include "Logger.h"
+#include "RotorConfig.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+std::string ShadowSample::keyString() const {
+    std::string key = reflector + " ";
+    for (size_t i = 0; i < rotorOrder.size(); i++) {
+        key += (i > 0 ? "-" : "") + rotorOrder[i];
+    }
+    key += " ";
+    for (int position : positions) {
+        key += static_cast<char>('A' + position);
+    }
+    key += " plugs";
+    if (plugboard.empty()) {
+        key += " -";
+    }
+    for (const auto& [a, b] : plugboard) {
+        key += std::string(" ") + a + b;
+    }
+    key += " offset " + std::to_string(offset);
+    return key;
+}
+
+ShadowValidator::ShadowValidator(double rate, size_t queueLimit)
+    : rate_(rate), period_(0), queueLimit_(queueLimit) {
+    if (!(rate >= 0.0 && rate <= 1.0)) {
+        throw std::invalid_argument("照合の割合は0から1の範囲で指定してください");
+    }
+    if (rate > 0.0) {
+        period_ = static_cast<uint64_t>((std::max)(1.0, std::round(1.0 / rate)));
+        worker_ = std::thread(&ShadowValidator::run, this);
+    }
+}
+
+ShadowValidator::~ShadowValidator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ShadowValidator::submit(ShadowSample&& sample) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!worker_.joinable() || queue_.size() >= queueLimit_) {
+            dropped_++;
+            return;
+        }
+        queue_.push_back(std::move(sample));
+    }
+    submitted_++;
+    wake_.notify_one();
+}
+
+void ShadowValidator::setMismatchHandler(std::function<void(const ShadowMismatch&)> handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mismatchHandler_ = handler;
+}
+
+void ShadowValidator::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+std::vector<ShadowMismatch> ShadowValidator::getMismatches() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mismatches_;
+}
+
+std::string ShadowValidator::reference(const ShadowSample& sample) {
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : sample.rotorOrder) {
+        const auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+    }
+    EnigmaMachine machine(std::move(rotors),
+                          std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at(sample.reflector).wiring),
+                          std::make_unique<Plugboard>(sample.plugboard));
+    machine.setRotorPositions(sample.positions);
+    for (int i = 0; i < sample.offset; i++) {
+        machine.stepRotors();
+    }
+    return machine.encrypt(sample.input);
+}
+
+void ShadowValidator::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            // stopping_で、残りはすべて照合済み
+            return;
+        }
+        ShadowSample sample = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        ShadowMismatch mismatch;
+        bool failed = false;
+        try {
+            mismatch.expected = reference(sample);
+            failed = mismatch.expected != sample.output;
+        } catch (const std::exception& e) {
+            // 参照実装が受け付けない鍵も高速経路の誤り
+            mismatch.expected = std::string("error: ") + e.what();
+            failed = true;
+        }
+        checked_++;
+
+        std::function<void(const ShadowMismatch&)> handler;
+        if (failed) {
+            mismatchCount_++;
+            ENIGMA_LOG(LogLevel::Error, "shadow.mismatch")
+                .kv("kind", sample.kind)
+                .kv("key", sample.keyString())
+                .kv("input", sample.input)
+                .kv("fast", sample.output)
+                .kv("reference", mismatch.expected);
+            mismatch.sample = std::move(sample);
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (mismatches_.size() < MAX_KEPT_MISMATCHES) {
+                mismatches_.push_back(mismatch);
+            }
+            handler = mismatchHandler_;
+        }
+        if (handler) {
+            handler(mismatch);
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (queue_.empty()) {
+            idle_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef SHADOW_VALIDATOR_H
+#define SHADOW_VALIDATOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 高速経路（ScramblerTableの置換表・状態列など）が出した1回分の暗号化結果と、その鍵
+struct ShadowSample {
+    std::string kind;                              // どの経路の結果か（"position"、"candidate"など）
+    std::vector<std::string> rotorOrder;
+    std::string reflector;
+    std::vector<int> positions;                    // 開始位置（EnigmaMachine::setRotorPositionsと同じ並び）
+    std::vector<std::pair<char, char>> plugboard;
+    int offset = 0;                                // 開始位置からこの文字数だけ進めた所から暗号化する
+    std::string input;
+    std::string output;                            // 高速経路の出力
+
+    // "B I-II-III AAA plugs AB CD offset 5" の形式（リング設定は常に0）
+    std::string keyString() const;
+};
+
+struct ShadowMismatch {
+    ShadowSample sample;
+    std::string expected;                          // 参照実装（EnigmaMachine）の出力
+};
+
+// 高速経路の結果の一部を、バックグラウンドのスレッドで参照実装のEnigmaMachineと照合する。
+// 探索スレッドはshouldSample()（スレッドごとの呼び出し回数の剰余）で選ばれたときだけ
+// submit()するので、rateを小さくすれば本番で有効にしたままでもほぼ無償になる。
+// 待ち行列が満杯なら標本は捨てて数える（探索は待たない）
+class ShadowValidator {
+public:
+    // rate: 照合する割合（0〜1、0なら無効）。queueLimit: 未照合の標本の上限
+    explicit ShadowValidator(double rate, size_t queueLimit = 4096);
+    ~ShadowValidator();
+
+    ShadowValidator(const ShadowValidator&) = delete;
+    ShadowValidator& operator=(const ShadowValidator&) = delete;
+
+    double getRate() const { return rate_; }
+
+    bool shouldSample() const {
+        if (period_ == 0) return false;
+        thread_local uint64_t calls = 0;
+        return ++calls % period_ == 0;
+    }
+
+    void submit(ShadowSample&& sample);
+
+    // 不一致ごとに照合スレッドから呼ばれる（既定ではログに出すだけ）
+    void setMismatchHandler(std::function<void(const ShadowMismatch&)> handler);
+
+    // 待ち行列が空になるまで待つ
+    void flush();
+
+    uint64_t submitted() const { return submitted_.load(); }
+    uint64_t checked() const { return checked_.load(); }
+    uint64_t mismatchCount() const { return mismatchCount_.load(); }
+    uint64_t dropped() const { return dropped_.load(); }
+
+    // 最初のMAX_KEPT_MISMATCHES件の不一致
+    static constexpr size_t MAX_KEPT_MISMATCHES = 16;
+    std::vector<ShadowMismatch> getMismatches() const;
+
+    // 参照実装で暗号化した結果
+    static std::string reference(const ShadowSample& sample);
+
+private:
+    double rate_;
+    uint64_t period_;
+    size_t queueLimit_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<ShadowSample> queue_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::function<void(const ShadowMismatch&)> mismatchHandler_;
+    std::vector<ShadowMismatch> mismatches_;
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> checked_{0};
+    std::atomic<uint64_t> mismatchCount_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::thread worker_;
+
+    void run();
+};
+
+#endif // SHADOW_VALIDATOR_H
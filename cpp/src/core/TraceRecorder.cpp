@@ -0,0 +1,156 @@
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+// trace eventの時刻はマイクロ秒（小数可）
+void writeMicros(std::ostream& out, int64_t nanos) {
+    out << nanos / 1000 << '.' << std::setw(3) << std::setfill('0') << nanos % 1000 << std::setfill(' ');
+}
+
+} // namespace
+
+TraceRecorder::TraceRecorder(size_t spansPerThread)
+    : spansPerThread_((std::max)(spansPerThread, static_cast<size_t>(1))),
+      epoch_(std::chrono::steady_clock::now()) {
+}
+
+void TraceRecorder::ensureThreads(int count) {
+    while (static_cast<int>(threads_.size()) < count) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->spans.resize(spansPerThread_);
+        threads_.push_back(std::move(buffer));
+    }
+}
+
+void TraceRecorder::setThreadName(int thread, const std::string& name) {
+    ensureThreads(thread + 1);
+    threads_[thread]->name = name;
+}
+
+void TraceRecorder::addMetadata(const std::string& key, const std::string& value) {
+    metadata_.emplace_back(key, value);
+}
+
+void TraceRecorder::record(int thread, const char* name, const char* category, int64_t startNs, int64_t endNs,
+                           const char* argName0, int64_t arg0,
+                           const char* argName1, int64_t arg1) {
+    if (thread < 0 || thread >= static_cast<int>(threads_.size())) {
+        return;  // ensureThreads()で用意していないスレッド
+    }
+    ThreadBuffer& buffer = *threads_[thread];
+    Span& span = buffer.spans[buffer.written % buffer.spans.size()];
+    span.name = name;
+    span.category = category;
+    span.startNs = startNs;
+    span.durationNs = endNs - startNs;
+    span.argNames[0] = argName0;
+    span.argNames[1] = argName1;
+    span.args[0] = arg0;
+    span.args[1] = arg1;
+    buffer.written++;
+}
+
+uint64_t TraceRecorder::droppedSpans() const {
+    uint64_t dropped = 0;
+    for (const auto& buffer : threads_) {
+        if (buffer->written > buffer->spans.size()) {
+            dropped += buffer->written - buffer->spans.size();
+        }
+    }
+    return dropped;
+}
+
+void TraceRecorder::writeJson(std::ostream& out) const {
+    std::vector<std::pair<int, const Span*>> spans;
+    for (size_t thread = 0; thread < threads_.size(); thread++) {
+        const ThreadBuffer& buffer = *threads_[thread];
+        uint64_t count = (std::min)(buffer.written, static_cast<uint64_t>(buffer.spans.size()));
+        for (uint64_t i = 0; i < count; i++) {
+            spans.emplace_back(static_cast<int>(thread), &buffer.spans[i]);
+        }
+    }
+    std::stable_sort(spans.begin(), spans.end(), [](const auto& a, const auto& b) {
+        return a.second->startNs < b.second->startNs;
+    });
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t thread = 0; thread < threads_.size(); thread++) {
+        std::string name = threads_[thread]->name.empty() ? "thread " + std::to_string(thread)
+                                                           : threads_[thread]->name;
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << thread << ",\"args\":{\"name\":";
+        writeJsonString(out, name);
+        out << "}}";
+        first = false;
+    }
+    for (const auto& [thread, span] : spans) {
+        out << (first ? "" : ",\n") << "{\"name\":";
+        writeJsonString(out, span->name);
+        out << ",\"cat\":";
+        writeJsonString(out, span->category);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":";
+        writeMicros(out, span->startNs);
+        out << ",\"dur\":";
+        writeMicros(out, (std::max)(span->durationNs, static_cast<int64_t>(0)));
+        if (span->argNames[0] || span->argNames[1]) {
+            out << ",\"args\":{";
+            bool firstArg = true;
+            for (int i = 0; i < 2; i++) {
+                if (span->argNames[i]) {
+                    out << (firstArg ? "" : ",");
+                    writeJsonString(out, span->argNames[i]);
+                    out << ":" << span->args[i];
+                    firstArg = false;
+                }
+            }
+            out << "}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n],\"otherData\":{\"droppedSpans\":\"" << droppedSpans() << "\"";
+    for (const auto& [key, value] : metadata_) {
+        out << ",";
+        writeJsonString(out, key);
+        out << ":";
+        writeJsonString(out, value);
+    }
+    out << "}}\n";
+}
+
+void TraceRecorder::writeJson(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("トレースファイルを開けません: " + path);
+    }
+    writeJson(file);
+    if (!file) {
+        throw std::runtime_error("トレースファイルの書き込みに失敗しました: " + path);
+    }
+}
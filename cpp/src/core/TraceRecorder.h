@@ -0,0 +1,100 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Chromeのtrace event形式（chrome://tracing、Perfetto UIで開ける）のタイムライン記録。
+// スレッドごとにリングバッファを持ち、各バッファには担当スレッドだけが書き込むので
+// 記録時にロックもアトミック操作も使わない。満杯になると古いスパンから上書きする。
+// ensureThreads()とwriteJson()は記録中のスレッドがいないときに呼ぶこと
+class TraceRecorder {
+public:
+    // スパンの名前・カテゴリ・引数名は文字列リテラル（寿命が記録より長いもの）を渡す
+    struct Span {
+        const char* name;
+        const char* category;
+        int64_t startNs;          // レコーダー作成時からの経過時間
+        int64_t durationNs;
+        const char* argNames[2];  // 使わない引数はnullptr
+        int64_t args[2];
+    };
+
+    explicit TraceRecorder(size_t spansPerThread = 1 << 16);
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // スレッド番号0..count-1のバッファを用意する
+    void ensureThreads(int count);
+
+    // スレッド番号の表示名（Perfettoのトラック名）
+    void setThreadName(int thread, const std::string& name);
+
+    // trace全体に付ける文字列（otherDataとして出力）
+    void addMetadata(const std::string& key, const std::string& value);
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+    void record(int thread, const char* name, const char* category, int64_t startNs, int64_t endNs,
+                const char* argName0 = nullptr, int64_t arg0 = 0,
+                const char* argName1 = nullptr, int64_t arg1 = 0);
+
+    // 上書きで失われたスパン数
+    uint64_t droppedSpans() const;
+
+    // 全スレッドのスパンを開始時刻順に書き出す
+    void writeJson(std::ostream& out) const;
+    void writeJson(const std::string& path) const;  // 開けなければstd::runtime_error
+
+private:
+    struct alignas(64) ThreadBuffer {
+        std::vector<Span> spans;
+        uint64_t written = 0;     // これまでに記録した数（spans.size()を超えたら上書き）
+        std::string name;
+    };
+
+    size_t spansPerThread_;
+    std::chrono::steady_clock::time_point epoch_;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+    std::vector<std::pair<std::string, std::string>> metadata_;
+};
+
+// スコープの開始から終了までを1スパンとして記録する。recorderがnullptrなら何もしない
+class TraceScope {
+public:
+    TraceScope(TraceRecorder* recorder, int thread, const char* name, const char* category,
+               const char* argName0 = nullptr, int64_t arg0 = 0,
+               const char* argName1 = nullptr, int64_t arg1 = 0)
+        : recorder_(recorder), thread_(thread), name_(name), category_(category),
+          argNames_{argName0, argName1}, args_{arg0, arg1},
+          start_(recorder ? recorder->now() : 0) {}
+
+    ~TraceScope() {
+        if (recorder_) {
+            recorder_->record(thread_, name_, category_, start_, recorder_->now(),
+                              argNames_[0], args_[0], argNames_[1], args_[1]);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceRecorder* recorder_;
+    int thread_;
+    const char* name_;
+    const char* category_;
+    const char* argNames_[2];
+    int64_t args_[2];
+    int64_t start_;
+};
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,212 @@
+#include "TuningConfig.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+namespace {
+
+std::mutex defaultMutex;
+std::string overridePath;
+bool overridePathSet = false;
+bool defaultLoaded = false;
+std::shared_ptr<const TuningConfig> defaultConfig;
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+int parseInt(const std::string& key, const std::string& value) {
+    try {
+        size_t used = 0;
+        int number = std::stoi(value, &used);
+        if (used == value.size()) return number;
+    } catch (const std::exception&) {
+    }
+    throw std::runtime_error("チューニングファイルの値が不正です: " + key + "=" + value);
+}
+
+std::string utcTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
+} // namespace
+
+TuningConfig TuningConfig::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("チューニングファイルを開けません: " + path);
+    }
+
+    TuningConfig config;
+    int version = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error("チューニングファイルの行が不正です: " + line);
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        if (key == "version") {
+            version = parseInt(key, value);
+        } else if (key == "threads") {
+            config.threads = parseInt(key, value);
+        } else if (key == "chunkSize") {
+            config.chunkSize = parseInt(key, value);
+        } else if (key == "nsPerPosition") {
+            config.nsPerPosition = std::atof(value.c_str());
+        } else if (key == "cpu") {
+            config.cpu = value;
+        } else if (key == "hardwareThreads") {
+            config.hardwareThreads = static_cast<unsigned>(parseInt(key, value));
+        } else if (key == "created") {
+            config.created = value;
+        }
+        // 知らないキーは新しい版の項目として読み飛ばす
+    }
+
+    if (version != VERSION) {
+        throw std::runtime_error("対応していないチューニングファイルの版です: " + path);
+    }
+    if (config.threads < 0 || config.chunkSize < 1) {
+        throw std::runtime_error("チューニングファイルの値が範囲外です: " + path);
+    }
+    return config;
+}
+
+void TuningConfig::save(const std::string& path) const {
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::error_code ignored;
+        std::filesystem::create_directories(target.parent_path(), ignored);
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("チューニングファイルを書き込めません: " + path);
+    }
+    out << "# EnigmaSimulatorCpp tuning (written by \"EnigmaSimulatorCpp tune\")\n";
+    out << "version=" << VERSION << "\n";
+    out << "cpu=" << cpu << "\n";
+    out << "hardwareThreads=" << hardwareThreads << "\n";
+    out << "created=" << (created.empty() ? utcTimestamp() : created) << "\n";
+    out << "threads=" << threads << "\n";
+    out << "chunkSize=" << chunkSize << "\n";
+    out << "nsPerPosition=" << nsPerPosition << "\n";
+    if (!out) {
+        throw std::runtime_error("チューニングファイルを書き込めません: " + path);
+    }
+}
+
+bool TuningConfig::matchesHost() const {
+    return cpu == hostCpu() && hardwareThreads == std::thread::hardware_concurrency();
+}
+
+std::string TuningConfig::hostCpu() {
+#if defined(_WIN32)
+    const char* identifier = std::getenv("PROCESSOR_IDENTIFIER");
+    return identifier ? trim(identifier) : "";
+#elif defined(__APPLE__)
+    char brand[256];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0) {
+        return trim(std::string(brand));
+    }
+    return "";
+#else
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) return trim(line.substr(colon + 1));
+        }
+    }
+    return "";
+#endif
+}
+
+std::string TuningConfig::defaultPath() {
+    if (const char* env = std::getenv("ENIGMA_TUNING_FILE")) {
+        return env;
+    }
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA")) {
+        return std::string(localAppData) + "\\EnigmaSimulator\\tuning.ini";
+    }
+#else
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME")) {
+        if (*cacheHome) return std::string(cacheHome) + "/enigma-simulator/tuning.ini";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        return std::string(home) + "/.cache/enigma-simulator/tuning.ini";
+    }
+#endif
+    return "";
+}
+
+void TuningConfig::setDefaultPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(defaultMutex);
+    overridePath = path;
+    overridePathSet = true;
+    defaultLoaded = false;
+    defaultConfig.reset();
+}
+
+std::shared_ptr<const TuningConfig> TuningConfig::getDefault() {
+    std::lock_guard<std::mutex> lock(defaultMutex);
+    if (defaultLoaded) {
+        return defaultConfig;
+    }
+    defaultLoaded = true;
+
+    std::string path = overridePathSet ? overridePath : TuningConfig::defaultPath();
+    if (path.empty() || !std::filesystem::exists(path)) {
+        return nullptr;
+    }
+
+    try {
+        auto config = std::make_shared<TuningConfig>(load(path));
+        if (!config->matchesHost()) {
+            // 別のマシンからコピーされた（またはCPUが変わった）設定は使わない
+            ENIGMA_LOG(LogLevel::Warn, "tuning.hostMismatch")
+                .kv("path", path)
+                .kv("cpu", config->cpu)
+                .kv("hardwareThreads", config->hardwareThreads);
+            return nullptr;
+        }
+        ENIGMA_LOG(LogLevel::Info, "tuning.loaded")
+            .kv("path", path)
+            .kv("threads", config->threads)
+            .kv("chunkSize", config->chunkSize);
+        defaultConfig = config;
+    } catch (const std::exception& e) {
+        // 読めない設定は使わず、既定値で動かす
+        ENIGMA_LOG(LogLevel::Warn, "tuning.invalid").kv("path", path).kv("error", std::string(e.what()));
+    }
+    return defaultConfig;
+}
@@ -0,0 +1,42 @@
+#ifndef TUNING_CONFIG_H
+#define TUNING_CONFIG_H
+
+#include <memory>
+#include <string>
+
+// このホストで実測して選んだ実行時パラメータ（EnigmaSimulatorCpp tuneで作成）。
+// 1行1項目の「キー=値」形式のテキストファイルに保存する。
+// BombeAttackは既定のファイルを起動時に一度だけ読み、スレッド数とチャンクの大きさの既定値にする
+struct TuningConfig {
+    static constexpr int VERSION = 1;
+
+    int threads = 0;              // 探索スレッド数（0なら既定のCPU数の75%）
+    int chunkSize = 64;           // OpenMPのdynamicスケジュールで一度に取る開始位置の数
+    double nsPerPosition = 0.0;   // 選んだ設定での1位置あたりの時間（全スレッドの実時間）
+    std::string cpu;              // 測定したホストのCPU名
+    unsigned hardwareThreads = 0; // 測定したホストの論理CPU数
+    std::string created;          // 作成日時（UTC、ISO 8601）
+
+    // 読めない・形式が違う場合はstd::runtime_error
+    static TuningConfig load(const std::string& path);
+
+    // 親ディレクトリがなければ作成する。書けなければstd::runtime_error
+    void save(const std::string& path) const;
+
+    // 実行中のホストと同じCPUで測定したものか
+    bool matchesHost() const;
+
+    // 実行中のホストのCPU名（取得できなければ空）
+    static std::string hostCpu();
+
+    // 環境変数ENIGMA_TUNING_FILE、なければユーザーごとのキャッシュディレクトリ
+    // （Windowsは%LOCALAPPDATA%\EnigmaSimulator、それ以外は$XDG_CACHE_HOMEか~/.cache/enigma-simulator）
+    static std::string defaultPath();
+
+    // BombeAttackが参照する既定の設定。setDefaultPathが呼ばれていなければdefaultPath()を使う。
+    // ファイルがない・読めない・別のホストで測定したものならnullptr
+    static void setDefaultPath(const std::string& path);
+    static std::shared_ptr<const TuningConfig> getDefault();
+};
+
+#endif // TUNING_CONFIG_H
@@ -0,0 +1,329 @@
+#include "ZygalskiSheets.h"
+#include "RotorConfig.h"
+#include "ScramblerTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENIGMA_ZYGALSKI_SSE2 1
+#endif
+
+namespace {
+
+const char SHEETS_MAGIC[8] = {'E', 'N', 'I', 'G', 'Z', 'Y', 'G', 'S'};
+const uint32_t SHEETS_VERSION = 1;
+const uint64_t ROW_MASK = (uint64_t(1) << 26) - 1;
+
+struct SheetsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t orderCount;
+    char reflector[8];
+};
+
+struct SheetsOrder {
+    char rotors[3][8];
+};
+
+// 重ねたシートにもう1枚をずらして重ねる（acc &= rows >> shift）
+void stackSheet(uint64_t* acc, const uint64_t* rows, int shift) {
+#ifdef ENIGMA_ZYGALSKI_SSE2
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    for (int r = 0; r < ZygalskiSheets::ROWS; r += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + r));
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + r));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + r), _mm_and_si128(a, _mm_srl_epi64(v, count)));
+    }
+#else
+    for (int r = 0; r < ZygalskiSheets::ROWS; r++) {
+        acc[r] &= rows[r] >> shift;
+    }
+#endif
+}
+
+bool anyHole(const uint64_t* acc) {
+    uint64_t bits = 0;
+    for (int r = 0; r < ZygalskiSheets::ROWS; r++) {
+        bits |= acc[r];
+    }
+    return (bits & ROW_MASK) != 0;
+}
+
+std::string normalizeLetters(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (c >= 'A' && c <= 'Z') result += c;
+    }
+    return result;
+}
+
+} // namespace
+
+std::string ZygalskiCandidate::getRingString() const {
+    std::string result;
+    for (int ring : ringSettings) {
+        result += static_cast<char>('A' + ring);
+    }
+    return result;
+}
+
+std::string ZygalskiCandidate::getRotorString() const {
+    std::string result;
+    for (size_t i = 0; i < rotorOrder.size(); i++) {
+        result += rotorOrder[i];
+        if (i < rotorOrder.size() - 1) {
+            result += "-";
+        }
+    }
+    return result;
+}
+
+ZygalskiSheets::ZygalskiSheets(const std::vector<std::string>& rotorTypes,
+                               const std::string& reflectorType,
+                               std::function<void(const std::string&)> progressCallback)
+    : rotorOrders_(ScramblerTable::buildRotorOrders(rotorTypes, true)),
+      reflectorType_(reflectorType) {
+    for (const auto& type : rotorTypes) {
+        if (type.size() >= sizeof(SheetsOrder::rotors[0])) {
+            throw std::invalid_argument("ローター名が長すぎます: " + type);
+        }
+    }
+    if (reflectorType.size() >= sizeof(SheetsHeader::reflector)) {
+        throw std::invalid_argument("リフレクター名が長すぎます: " + reflectorType);
+    }
+
+    sheets_.assign(rotorOrders_.size() * ROWS * STORED_ROWS, 0);
+    const int numOrders = static_cast<int>(rotorOrders_.size());
+    std::mutex progressMutex;
+    int completed = 0;
+    std::string error;
+
+    // ローター順ごとに独立しているので並列に作成する
+    #pragma omp parallel for schedule(dynamic)
+    for (int o = 0; o < numOrders; o++) {
+        try {
+            auto sharedTable = ScramblerTable::get(rotorOrders_[o], reflectorType_);
+            const ScramblerTable& table = *sharedTable;
+
+            for (int left = 0; left < ROWS; left++) {
+                uint64_t* rows = &sheets_[(static_cast<size_t>(o) * ROWS + left) * STORED_ROWS];
+                for (int middle = 0; middle < ROWS; middle++) {
+                    for (int right = 0; right < ROWS; right++) {
+                        // 芯の位置(right, middle, left)から1文字目と4文字目を暗号化したときの積
+                        const uint8_t* first = table.perm(ScramblerTable::stateIndex({(right + 1) % 26, middle, left}));
+                        const uint8_t* fourth = table.perm(ScramblerTable::stateIndex({(right + 4) % 26, middle, left}));
+                        bool female = false;
+                        for (int c = 0; c < 26 && !female; c++) {
+                            female = fourth[first[c]] == c;
+                        }
+                        if (!female) continue;
+
+                        // 探索時のずらしが加算になるよう、行・列とも符号を反転して格納する
+                        int row = (26 - middle) % 26;
+                        int col = (26 - right) % 26;
+                        uint64_t bits = (uint64_t(1) << col) | (uint64_t(1) << (col + 26));
+                        rows[row] |= bits;
+                        rows[row + 26] |= bits;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        completed++;
+        if (progressCallback) {
+            progressCallback("Built sheets for " + std::to_string(completed) + "/" +
+                             std::to_string(numOrders) + " rotor orders");
+        }
+    }
+
+    if (!error.empty()) {
+        throw std::invalid_argument(error);
+    }
+}
+
+ZygalskiSheets::ZygalskiSheets(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("シートファイルを開けません: " + path);
+    }
+
+    SheetsHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SHEETS_MAGIC, sizeof(SHEETS_MAGIC)) != 0 ||
+        header.version != SHEETS_VERSION) {
+        throw std::runtime_error("シートファイルの形式が異なります: " + path);
+    }
+    header.reflector[sizeof(header.reflector) - 1] = '\0';
+    reflectorType_ = header.reflector;
+
+    std::vector<SheetsOrder> orders(header.orderCount);
+    file.read(reinterpret_cast<char*>(orders.data()), orders.size() * sizeof(SheetsOrder));
+    for (auto& order : orders) {
+        std::vector<std::string> rotorOrder;
+        for (auto& name : order.rotors) {
+            name[sizeof(name) - 1] = '\0';
+            rotorOrder.emplace_back(name);
+        }
+        rotorOrders_.push_back(rotorOrder);
+    }
+
+    sheets_.resize(static_cast<size_t>(header.orderCount) * ROWS * STORED_ROWS);
+    file.read(reinterpret_cast<char*>(sheets_.data()), sheets_.size() * sizeof(uint64_t));
+    if (!file) {
+        throw std::runtime_error("シートファイルが壊れています: " + path);
+    }
+}
+
+void ZygalskiSheets::save(const std::string& path) const {
+    SheetsHeader header{};
+    std::memcpy(header.magic, SHEETS_MAGIC, sizeof(header.magic));
+    header.version = SHEETS_VERSION;
+    header.orderCount = static_cast<uint32_t>(rotorOrders_.size());
+    std::strncpy(header.reflector, reflectorType_.c_str(), sizeof(header.reflector) - 1);
+
+    std::vector<SheetsOrder> orders(rotorOrders_.size());
+    for (size_t o = 0; o < rotorOrders_.size(); o++) {
+        std::memset(&orders[o], 0, sizeof(SheetsOrder));
+        for (int r = 0; r < 3; r++) {
+            std::strncpy(orders[o].rotors[r], rotorOrders_[o][r].c_str(), sizeof(orders[o].rotors[r]) - 1);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("シートファイルを作成できません: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(orders.data()), orders.size() * sizeof(SheetsOrder));
+    file.write(reinterpret_cast<const char*>(sheets_.data()), sheets_.size() * sizeof(uint64_t));
+    if (!file) {
+        throw std::runtime_error("シートファイルの書き込みに失敗しました: " + path);
+    }
+}
+
+bool ZygalskiSheets::hasFemale(size_t order, int left, int middle, int right) const {
+    const uint64_t* rows = sheet(order, left);
+    int row = (26 - middle) % 26;
+    int col = (26 - right) % 26;
+    return (rows[row] >> col) & 1;
+}
+
+std::vector<ZygalskiSheets::Female> ZygalskiSheets::extractFemales(
+    const std::vector<ZygalskiIndicator>& indicators) {
+    std::vector<Female> females;
+    for (const auto& entry : indicators) {
+        std::string ground = normalizeLetters(entry.ground);
+        std::string indicator = normalizeLetters(entry.indicator);
+        if (ground.length() != 3 || indicator.length() != 6) {
+            throw std::invalid_argument("基本位置は3文字、指標は6文字である必要があります: " +
+                                        entry.ground + " " + entry.indicator);
+        }
+
+        int right = ground[0] - 'A';
+        int middle = ground[1] - 'A';
+        int left = ground[2] - 'A';
+        for (int k = 0; k < 3; k++) {
+            if (indicator[k] != indicator[k + 3]) continue;
+            // k文字目のfemaleは、右ローターがkだけ進んだ位置での1/4のfemaleと同じ
+            Female female;
+            female.right = right;
+            female.middle = middle;
+            female.left = left;
+            female.letter = k;
+            female.rowOffset = (26 - middle) % 26;
+            female.bitOffset = ((26 - right - k) % 26 + 26) % 26;
+            females.push_back(female);
+        }
+    }
+    return females;
+}
+
+std::vector<ZygalskiCandidate> ZygalskiSheets::search(
+    const std::vector<ZygalskiIndicator>& indicators,
+    std::function<void(const std::string&)> progressCallback) const {
+    stopFlag_ = false;
+    std::vector<Female> females = extractFemales(indicators);
+    if (females.empty()) {
+        throw std::invalid_argument("femaleを含む指標がありません");
+    }
+
+    if (progressCallback) {
+        progressCallback("Stacking " + std::to_string(females.size()) + " females over " +
+                         std::to_string(rotorOrders_.size()) + " rotor orders");
+    }
+
+    // ローター順ごとに、中ローターが進まないfemaleだけを使う
+    std::vector<std::vector<Female>> usableFemales(rotorOrders_.size());
+    for (size_t o = 0; o < rotorOrders_.size(); o++) {
+        int rightNotch = enigma::ROTOR_DEFINITIONS.at(rotorOrders_[o][0]).getFirstNotch();
+        int middleNotch = enigma::ROTOR_DEFINITIONS.at(rotorOrders_[o][1]).getFirstNotch();
+        for (const auto& female : females) {
+            bool steps = female.middle == middleNotch;
+            // EnigmaMachine::stepRotorsは右ローターを進めた後の位置でノッチを判定する
+            for (int j = 1; j <= female.letter + 4 && !steps; j++) {
+                steps = (female.right + j) % 26 == rightNotch;
+            }
+            if (!steps) {
+                usableFemales[o].push_back(female);
+            }
+        }
+    }
+
+    std::vector<ZygalskiCandidate> candidates;
+    std::mutex candidatesMutex;
+    const int numTasks = static_cast<int>(rotorOrders_.size()) * ROWS;
+
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int task = 0; task < numTasks; task++) {
+        if (stopFlag_) continue;
+
+        size_t order = static_cast<size_t>(task / ROWS);
+        int leftRing = task % ROWS;
+
+        alignas(16) uint64_t acc[ROWS];
+        std::fill(acc, acc + ROWS, ROW_MASK);
+        const auto& orderFemales = usableFemales[order];
+        if (orderFemales.empty()) continue;
+        for (const auto& female : orderFemales) {
+            int left = (female.left - leftRing + 26) % 26;
+            stackSheet(acc, sheet(order, left) + female.rowOffset, female.bitOffset);
+            if (!anyHole(acc)) break;
+        }
+
+        std::vector<ZygalskiCandidate> local;
+        for (int middleRing = 0; middleRing < ROWS; middleRing++) {
+            uint64_t holes = acc[middleRing] & ROW_MASK;
+            for (int rightRing = 0; holes != 0; rightRing++, holes >>= 1) {
+                if (holes & 1) {
+                    local.push_back({rotorOrders_[order], {rightRing, middleRing, leftRing}});
+                }
+            }
+        }
+
+        if (!local.empty()) {
+            std::lock_guard<std::mutex> lock(candidatesMutex);
+            candidates.insert(candidates.end(), local.begin(), local.end());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const ZygalskiCandidate& a, const ZygalskiCandidate& b) {
+            if (a.rotorOrder != b.rotorOrder) return a.rotorOrder < b.rotorOrder;
+            return a.ringSettings < b.ringSettings;
+        });
+
+    if (progressCallback) {
+        progressCallback("Zygalski search complete: " + std::to_string(candidates.size()) + " candidates");
+    }
+    return candidates;
+}
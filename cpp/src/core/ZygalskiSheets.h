@@ -0,0 +1,85 @@
+#ifndef ZYGALSKI_SHEETS_H
+#define ZYGALSKI_SHEETS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 平文で送られた基本位置と、それで二重に暗号化した指標（6文字）の組
+struct ZygalskiIndicator {
+    std::string ground;      // 3文字（EnigmaMachine::setRotorPositionsと同じ並び）
+    std::string indicator;   // 6文字
+};
+
+struct ZygalskiCandidate {
+    std::vector<std::string> rotorOrder;
+    std::vector<int> ringSettings;   // ローターごとのリング設定（ローター順と同じ並び）
+
+    std::string getRingString() const;
+    std::string getRotorString() const;
+};
+
+// Zygalskiシートによるリング設定の探索
+// 指標のi文字目とi+3文字目が同じ（female）になるのは、その位置での置換の積に
+// 不動点があるときに限られ、プラグボードには依存しない。ローター順ごとに
+// 左ローターの芯の位置26枚×（中・右ローターの芯の位置26×26）のビットマップを
+// 事前計算し、指標ごとに基本位置の差だけずらしてANDで重ねると、
+// 全シートで穴が開いたままのセルがリング設定の候補になる。
+// 6文字の間に中ローターが進む指標はシートと一致しないが、桁上がりは窓の文字
+// （平文の基本位置）だけで決まるので、ローター順ごとに該当するfemaleを除外する
+class ZygalskiSheets {
+public:
+    static constexpr int ROWS = 26;
+    // 巡回シフトをシフトと読み出しだけで済ませるため、行・列とも2周分保持する
+    static constexpr int STORED_ROWS = 52;
+
+    // rotorTypesから3枚を選ぶ全ローター順のシートを並列に作成する
+    ZygalskiSheets(const std::vector<std::string>& rotorTypes,
+                   const std::string& reflectorType,
+                   std::function<void(const std::string&)> progressCallback = nullptr);
+
+    // saveで保存したシートを読み込む（形式が異なる場合はstd::runtime_errorを投げる）
+    explicit ZygalskiSheets(const std::string& path);
+
+    void save(const std::string& path) const;
+
+    // 全ローター順×左ローターのリング設定を探索し、全femaleと矛盾しない候補を返す
+    std::vector<ZygalskiCandidate> search(
+        const std::vector<ZygalskiIndicator>& indicators,
+        std::function<void(const std::string&)> progressCallback = nullptr) const;
+
+    void stop() { stopFlag_ = true; }
+
+    size_t getOrderCount() const { return rotorOrders_.size(); }
+    const std::string& getReflectorType() const { return reflectorType_; }
+
+    // シートの1セル（左・中・右ローターの芯の位置、femaleの位置は1/4）
+    bool hasFemale(size_t order, int left, int middle, int right) const;
+
+private:
+    // 指標から取り出したfemale 1つ分の制約（基本位置の窓の文字とシートのずらし量）
+    struct Female {
+        int right;
+        int middle;
+        int left;
+        int letter;      // 0: 1/4, 1: 2/5, 2: 3/6
+        int rowOffset;
+        int bitOffset;
+    };
+
+    std::vector<std::vector<std::string>> rotorOrders_;
+    std::string reflectorType_;
+    // [order][left][STORED_ROWS]、各行の下位52ビットに26列を2周分
+    std::vector<uint64_t> sheets_;
+    mutable std::atomic<bool> stopFlag_{false};
+
+    const uint64_t* sheet(size_t order, int left) const {
+        return &sheets_[(order * ROWS + left) * STORED_ROWS];
+    }
+
+    static std::vector<Female> extractFemales(const std::vector<ZygalskiIndicator>& indicators);
+};
+
+#endif // ZYGALSKI_SHEETS_H
@@ -0,0 +1,92 @@
+#include "BombeResultRows.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::string rotorName(const std::vector<std::string>& rotorOrder) {
+    std::string name;
+    for (size_t i = 0; i < rotorOrder.size(); ++i) {
+        if (i > 0) name += "-";
+        name += rotorOrder[i];
+    }
+    return name;
+}
+
+} // namespace
+
+std::vector<uint32_t> buildBombeResultRows(const PackedCandidateSet& set, const BombeRowQuery& query) {
+    std::vector<uint32_t> rows;
+    bool filtered = query.minPairs > 0 || query.maxPairs < 13;
+    if (filtered) {
+        for (size_t i = 0; i < set.size(); i++) {
+            int pairs = set[i].pairCount();
+            if (pairs >= query.minPairs && pairs <= query.maxPairs) {
+                rows.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    } else {
+        rows.resize(set.size());
+        std::iota(rows.begin(), rows.end(), 0u);
+    }
+
+    // The set is already in score order, which is also the rank order
+    if (query.key == BombeRowKey::Rank || query.key == BombeRowKey::Score) {
+        bool reverse = query.key == BombeRowKey::Rank ? query.descending : !query.descending;
+        if (reverse) {
+            std::reverse(rows.begin(), rows.end());
+        }
+        return rows;
+    }
+
+    // Rotor orders are compared by name; rank them once per context instead of per row
+    std::vector<int> contextRank;
+    if (query.key == BombeRowKey::Rotors) {
+        std::vector<std::pair<std::string, int>> names;
+        contextRank.assign(0x10000, -1);
+        for (uint32_t record : rows) {
+            uint16_t context = set[record].contextId;
+            if (contextRank[context] < 0) {
+                contextRank[context] = 0;
+                names.emplace_back(rotorName(set.rotorOrder(set[record])), context);
+            }
+        }
+        std::sort(names.begin(), names.end());
+        int rank = 0;
+        for (size_t i = 0; i < names.size(); i++) {
+            if (i > 0 && names[i].first != names[i - 1].first) rank++;
+            contextRank[names[i].second] = rank;
+        }
+    }
+
+    auto keyOf = [&](uint32_t record) -> uint64_t {
+        const PackedCandidate& candidate = set[record];
+        switch (query.key) {
+        case BombeRowKey::Position: return static_cast<uint64_t>(candidate.state());
+        case BombeRowKey::Rotors: return static_cast<uint64_t>(contextRank[candidate.contextId]);
+        case BombeRowKey::Match:
+            return static_cast<uint64_t>(candidate.matches() * 1000000ull / set.crib(candidate).length());
+        case BombeRowKey::Pairs: return static_cast<uint64_t>(candidate.pairCount());
+        case BombeRowKey::Offset: return static_cast<uint64_t>(set.offset(candidate));
+        default: return 0;
+        }
+    };
+
+    // Stable on the score-ordered rows, so ties stay best-first
+    std::vector<std::pair<uint64_t, uint32_t>> keyed(rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        keyed[i] = {keyOf(rows[i]), rows[i]};
+    }
+    if (query.descending) {
+        std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    } else {
+        std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+    for (size_t i = 0; i < keyed.size(); i++) {
+        rows[i] = keyed[i].second;
+    }
+    return rows;
+}
@@ -0,0 +1,32 @@
+#ifndef BOMBE_RESULT_ROWS_H
+#define BOMBE_RESULT_ROWS_H
+
+#include <cstdint>
+#include <vector>
+#include "../core/PackedCandidate.h"
+
+// Row order of the Bombe results table. Kept free of Qt so the model's
+// background sort/filter can be unit tested without a GUI build.
+enum class BombeRowKey {
+    Rank,       // Position in score order (1 = best)
+    Score,
+    Position,
+    Rotors,     // Rotor order name, e.g. "II-I-III"
+    Match,
+    Pairs,
+    Offset
+};
+
+struct BombeRowQuery {
+    BombeRowKey key = BombeRowKey::Rank;
+    bool descending = false;
+    int minPairs = 0;
+    int maxPairs = 13;
+};
+
+// Indexes into a score-sorted set (BombeAttack::getPackedResults) for the
+// candidates with minPairs..maxPairs plugboard pairs, in the requested order.
+// Other keys sort stably, so ties keep their score order.
+std::vector<uint32_t> buildBombeResultRows(const PackedCandidateSet& set, const BombeRowQuery& query);
+
+#endif // BOMBE_RESULT_ROWS_H
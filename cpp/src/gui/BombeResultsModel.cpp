@@ -0,0 +1,230 @@
+#include "BombeResultsModel.h"
+#include "BombeResultRows.h"
+#include "../core/ScramblerTable.h"
+
+#include <QMetaObject>
+#include <QStringList>
+
+#include <string>
+
+namespace {
+
+QString rotorString(const std::vector<std::string>& rotorOrder) {
+    QString text;
+    for (size_t i = 0; i < rotorOrder.size(); ++i) {
+        if (i > 0) text += "-";
+        text += QString::fromStdString(rotorOrder[i]);
+    }
+    return text;
+}
+
+} // namespace
+
+BombeResultsModel::BombeResultsModel(QObject* parent)
+    : QAbstractTableModel(parent) {}
+
+BombeResultsModel::~BombeResultsModel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (sorter.joinable()) {
+        sorter.join();
+    }
+}
+
+void BombeResultsModel::setResults(std::shared_ptr<const PackedCandidateSet> newResults) {
+    beginResetModel();
+    results = std::move(newResults);
+    rows.clear();
+    endResetModel();
+    requestRows();
+}
+
+void BombeResultsModel::clear() {
+    beginResetModel();
+    results.reset();
+    rows.clear();
+    generation++;  // Drop any rows still being built
+    endResetModel();
+    if (busy) {
+        busy = false;
+        emit busyChanged(false);
+    }
+}
+
+void BombeResultsModel::setPairFilter(int newMinPairs, int newMaxPairs) {
+    if (newMinPairs == minPairs && newMaxPairs == maxPairs) return;
+    minPairs = newMinPairs;
+    maxPairs = newMaxPairs;
+    requestRows();
+}
+
+void BombeResultsModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= ColumnCount) return;
+    if (column == sortColumn && order == sortOrder) return;
+    sortColumn = column;
+    sortOrder = order;
+    requestRows();
+}
+
+CandidateResult BombeResultsModel::resultAt(int row) const {
+    return results->unpack(rows[row]);
+}
+
+int BombeResultsModel::rankAt(int row) const {
+    return static_cast<int>(rows[row]) + 1;
+}
+
+int BombeResultsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+int BombeResultsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant BombeResultsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(rows.size())) {
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        bool numeric = index.column() != RotorsColumn && index.column() != PlugboardColumn &&
+                       index.column() != PositionColumn;
+        return static_cast<int>(numeric ? Qt::AlignRight | Qt::AlignVCenter : Qt::AlignLeft | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    uint32_t record = rows[index.row()];
+    const PackedCandidate& candidate = (*results)[record];
+    switch (index.column()) {
+    case RankColumn:
+        return static_cast<qulonglong>(record) + 1;
+    case PositionColumn: {
+        QString position;
+        for (int pos : ScramblerTable::statePositions(candidate.state())) {
+            position += QChar('A' + pos);
+        }
+        return position;
+    }
+    case RotorsColumn:
+        return rotorString(results->rotorOrder(candidate));
+    case ScoreColumn:
+        return QString::number(results->score(candidate), 'f', 1);
+    case MatchColumn: {
+        double matchRate = static_cast<double>(candidate.matches()) / results->crib(candidate).length();
+        return QString("%1%").arg(matchRate * 100, 0, 'f', 1);
+    }
+    case PairsColumn:
+        return candidate.pairCount();
+    case PlugboardColumn: {
+        QStringList pairs;
+        for (int i = 0; i < 26; i++) {
+            if (candidate.stecker[i] > i) {
+                pairs << QString("%1%2").arg(QChar('A' + i)).arg(QChar('A' + candidate.stecker[i]));
+            }
+        }
+        return pairs.isEmpty() ? QString("なし") : pairs.join(" ");
+    }
+    case OffsetColumn:
+        return results->offset(candidate);
+    default:
+        return QVariant();
+    }
+}
+
+QVariant BombeResultsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case RankColumn: return QString("#");
+    case PositionColumn: return QString("Position");
+    case RotorsColumn: return QString("Rotors");
+    case ScoreColumn: return QString("Score");
+    case MatchColumn: return QString("Match");
+    case PairsColumn: return QString("Pairs");
+    case PlugboardColumn: return QString("Plugboard");
+    case OffsetColumn: return QString("Offset");
+    default: return QVariant();
+    }
+}
+
+void BombeResultsModel::requestRows() {
+    if (!results) return;
+
+    auto request = std::make_unique<Request>();
+    request->generation = ++generation;
+    request->results = results;
+    request->sortColumn = sortColumn;
+    request->sortOrder = sortOrder;
+    request->minPairs = minPairs;
+    request->maxPairs = maxPairs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(request);
+        if (!sorter.joinable()) {
+            sorter = std::thread(&BombeResultsModel::runSorter, this);
+        }
+    }
+    wake.notify_one();
+
+    if (!busy) {
+        busy = true;
+        emit busyChanged(true);
+    }
+}
+
+void BombeResultsModel::applyRows(uint64_t rowsGeneration, std::vector<uint32_t> newRows) {
+    // A later sort/filter/clear has been requested since these rows were built
+    if (rowsGeneration != generation) return;
+
+    beginResetModel();
+    rows.swap(newRows);
+    endResetModel();
+    busy = false;
+    emit busyChanged(false);
+}
+
+void BombeResultsModel::runSorter() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || pending; });
+        if (stopping) return;
+        std::unique_ptr<Request> request = std::move(pending);
+        lock.unlock();
+
+        auto newRows = std::make_shared<std::vector<uint32_t>>(buildRows(*request));
+
+        lock.lock();
+        if (stopping) return;
+        if (pending) continue;  // Superseded while sorting; build the newer request instead
+        uint64_t rowsGeneration = request->generation;
+        // Queued to the UI thread; dropped by Qt if the model is destroyed first
+        QMetaObject::invokeMethod(this, [this, rowsGeneration, newRows]() {
+            applyRows(rowsGeneration, std::move(*newRows));
+        }, Qt::QueuedConnection);
+    }
+}
+
+std::vector<uint32_t> BombeResultsModel::buildRows(const Request& request) {
+    BombeRowQuery query;
+    switch (request.sortColumn) {
+    case ScoreColumn: query.key = BombeRowKey::Score; break;
+    case PositionColumn: query.key = BombeRowKey::Position; break;
+    case RotorsColumn: query.key = BombeRowKey::Rotors; break;
+    case MatchColumn: query.key = BombeRowKey::Match; break;
+    case PairsColumn:
+    case PlugboardColumn: query.key = BombeRowKey::Pairs; break;
+    case OffsetColumn: query.key = BombeRowKey::Offset; break;
+    default: query.key = BombeRowKey::Rank; break;
+    }
+    query.descending = request.sortOrder == Qt::DescendingOrder;
+    query.minPairs = request.minPairs;
+    query.maxPairs = request.maxPairs;
+    return buildBombeResultRows(*request.results, query);
+}
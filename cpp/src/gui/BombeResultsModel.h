@@ -0,0 +1,94 @@
+#ifndef BOMBE_RESULTS_MODEL_H
+#define BOMBE_RESULTS_MODEL_H
+
+#include <QAbstractTableModel>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../core/BombeAttack.h"
+
+// Table model over the packed Bombe candidates (32 bytes each).
+// Only the row index lives in the model; cells are formatted in data() when the
+// view asks for them, so millions of candidates cost no more than the visible rows.
+// Sorting and the plugboard-pair filter rebuild the row index on a background
+// thread and swap it in when done; requests made in the meantime supersede it.
+class BombeResultsModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        RankColumn,        // Position in score order (1 = best)
+        PositionColumn,
+        RotorsColumn,
+        ScoreColumn,
+        MatchColumn,
+        PairsColumn,
+        OffsetColumn,
+        PlugboardColumn,
+        ColumnCount
+    };
+
+    explicit BombeResultsModel(QObject* parent = nullptr);
+    ~BombeResultsModel() override;
+
+    // Takes a score-sorted set (BombeAttack::getPackedResults) and shows all of it
+    void setResults(std::shared_ptr<const PackedCandidateSet> results);
+    void clear();
+
+    // Only candidates with minPairs..maxPairs plugboard pairs are shown
+    void setPairFilter(int minPairs, int maxPairs);
+
+    int totalCount() const { return results ? static_cast<int>(results->size()) : 0; }
+    bool isBusy() const { return busy; }
+
+    // Candidate shown in a view row (same fields as BombeAttack::attack returns)
+    CandidateResult resultAt(int row) const;
+    // 1-based position of the row's candidate in score order
+    int rankAt(int row) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+signals:
+    // true while a sort/filter is running in the background, false once its rows are shown
+    void busyChanged(bool busy);
+
+private:
+    struct Request {
+        uint64_t generation;
+        std::shared_ptr<const PackedCandidateSet> results;
+        int sortColumn;
+        Qt::SortOrder sortOrder;
+        int minPairs;
+        int maxPairs;
+    };
+
+    std::shared_ptr<const PackedCandidateSet> results;
+    std::vector<uint32_t> rows;     // View row -> index into results
+    int sortColumn = RankColumn;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    int minPairs = 0;
+    int maxPairs = 13;
+    bool busy = false;
+    uint64_t generation = 0;        // Last request issued from the UI thread
+
+    // Background row builder
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::unique_ptr<Request> pending;
+    bool stopping = false;
+    std::thread sorter;
+
+    void requestRows();
+    void applyRows(uint64_t rowsGeneration, std::vector<uint32_t> newRows);
+    void runSorter();
+    static std::vector<uint32_t> buildRows(const Request& request);
+};
+
+#endif // BOMBE_RESULTS_MODEL_H
@@ -1,10 +1,13 @@
 #include "BombeWindow.h"
+#include "BombeResultsModel.h"
 #include "../core/EnigmaMachine.h"
 #include "../core/Rotor.h"
 #include "../core/Reflector.h"
 #include "../core/Plugboard.h"
 #include "../core/RotorConfig.h"
 #include "../core/BombeAttack.h"
+#include "../core/ResultSink.h"
+#include "../core/TraceRecorder.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -17,7 +20,9 @@
 #include <QCheckBox>
 #include <QPushButton>
 #include <QProgressBar>
-#include <QListWidget>
+#include <QTableView>
+#include <QHeaderView>
+#include <QSpinBox>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QJsonDocument>
@@ -32,7 +37,7 @@
 #include <chrono>
 
 BombeWindow::BombeWindow(QWidget *parent)
-    : QMainWindow(parent), workerThread(nullptr), worker(nullptr) {
+    : QMainWindow(parent), workerThread(nullptr), worker(nullptr), resultsModel(nullptr) {
     setupUi();
     setWindowTitle("Bombe Machine Simulator - Qt Edition");
     resize(800, 900);
@@ -114,6 +119,8 @@ void BombeWindow::setupUi() {
     auto* buttonLayout = new QHBoxLayout();
     
     startButton = new QPushButton("Start Attack", this);
+    estimateButton = new QPushButton("Estimate", this);
+    estimateButton->setToolTip("Preview positions, expected stops and runtime without attacking");
     stopButton = new QPushButton("Stop", this);
     stopButton->setEnabled(false);
     clearButton = new QPushButton("Clear Log", this);
@@ -123,6 +130,7 @@ void BombeWindow::setupUi() {
     exportButton->setEnabled(false);
     
     buttonLayout->addWidget(startButton);
+    buttonLayout->addWidget(estimateButton);
     buttonLayout->addWidget(stopButton);
     buttonLayout->addWidget(clearButton);
     buttonLayout->addWidget(saveSettingsButton);
@@ -152,22 +160,54 @@ void BombeWindow::setupUi() {
     auto* resultsGroup = new QGroupBox("Results", this);
     auto* resultsLayout = new QVBoxLayout(resultsGroup);
     
+    auto* resultsHeaderLayout = new QHBoxLayout();
     resultLabel = new QLabel("No results yet", this);
-    resultsLayout->addWidget(resultLabel);
-    
-    resultsList = new QListWidget(this);
-    resultsLayout->addWidget(resultsList);
+    resultsHeaderLayout->addWidget(resultLabel, 1);
+    
+    resultsHeaderLayout->addWidget(new QLabel("Plugboard pairs:"));
+    minPairsSpin = new QSpinBox(this);
+    minPairsSpin->setRange(0, 13);
+    minPairsSpin->setValue(0);
+    resultsHeaderLayout->addWidget(minPairsSpin);
+    resultsHeaderLayout->addWidget(new QLabel("-"));
+    maxPairsSpin = new QSpinBox(this);
+    maxPairsSpin->setRange(0, 13);
+    maxPairsSpin->setValue(13);
+    resultsHeaderLayout->addWidget(maxPairsSpin);
+    resultsLayout->addLayout(resultsHeaderLayout);
+    
+    // Fixed row heights let the view work out scrolling without measuring rows,
+    // so millions of candidates scroll as cheaply as fifty
+    resultsModel = new BombeResultsModel(this);
+    resultsView = new QTableView(this);
+    resultsView->setModel(resultsModel);
+    resultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    resultsView->setSelectionMode(QAbstractItemView::SingleSelection);
+    resultsView->setSortingEnabled(true);
+    resultsView->sortByColumn(BombeResultsModel::RankColumn, Qt::AscendingOrder);
+    resultsView->setWordWrap(false);
+    resultsView->verticalHeader()->setVisible(false);
+    resultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    resultsView->verticalHeader()->setDefaultSectionSize(resultsView->fontMetrics().height() + 6);
+    resultsView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    resultsView->horizontalHeader()->setStretchLastSection(true);
+    resultsLayout->addWidget(resultsView);
     
     mainLayout->addWidget(resultsGroup);
     
     // Connect signals
     connect(startButton, &QPushButton::clicked, this, &BombeWindow::onStartAttackClicked);
+    connect(estimateButton, &QPushButton::clicked, this, &BombeWindow::onEstimateClicked);
     connect(stopButton, &QPushButton::clicked, this, &BombeWindow::onStopAttackClicked);
     connect(clearButton, &QPushButton::clicked, this, &BombeWindow::onClearLogClicked);
     connect(saveSettingsButton, &QPushButton::clicked, this, &BombeWindow::onSaveSettingsClicked);
     connect(loadSettingsButton, &QPushButton::clicked, this, &BombeWindow::onLoadSettingsClicked);
     connect(exportButton, &QPushButton::clicked, this, &BombeWindow::onExportResultsClicked);
-    connect(resultsList, &QListWidget::itemSelectionChanged, this, &BombeWindow::onResultSelected);
+    connect(resultsView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &BombeWindow::onResultSelected);
+    connect(resultsModel, &BombeResultsModel::busyChanged, this, &BombeWindow::onResultsBusyChanged);
+    connect(minPairsSpin, &QSpinBox::valueChanged, this, &BombeWindow::onPairFilterChanged);
+    connect(maxPairsSpin, &QSpinBox::valueChanged, this, &BombeWindow::onPairFilterChanged);
 }
 
 void BombeWindow::onStartAttackClicked() {
@@ -190,28 +230,37 @@ void BombeWindow::onStartAttackClicked() {
     
     // Setup UI for attack
     startButton->setEnabled(false);
+    estimateButton->setEnabled(false);
     stopButton->setEnabled(true);
     exportButton->setEnabled(false);
     progressBar->setVisible(true);
     progressBar->setRange(0, 0); // Indeterminate
-    resultsList->clear();
-    allResults.clear();
-    
-    // Create worker thread
-    if (!workerThread) {
-        workerThread = new QThread();
-        worker = new BombeWorker();
-        worker->moveToThread(workerThread);
-        
-        connect(this, &BombeWindow::startAttack, worker, &BombeWorker::doAttack);
-        connect(worker, &BombeWorker::progress, this, &BombeWindow::onAttackProgress);
-        connect(worker, &BombeWorker::finished, this, &BombeWindow::onAttackFinished);
-        connect(worker, &BombeWorker::error, this, &BombeWindow::onAttackError);
-        
-        workerThread->start();
-    }
+    resultsModel->clear();
     
-    // Start attack
+    ensureWorker();
+    emit startAttack(crib, cipher, selectedRotors(), reflectorCombo->currentText(),
+                     testAllOrdersCheck->isChecked(), searchWithoutPlugboardCheck->isChecked());
+}
+
+void BombeWindow::ensureWorker() {
+    if (workerThread) {
+        return;
+    }
+    workerThread = new QThread();
+    worker = new BombeWorker();
+    worker->moveToThread(workerThread);
+
+    connect(this, &BombeWindow::startAttack, worker, &BombeWorker::doAttack);
+    connect(this, &BombeWindow::startEstimate, worker, &BombeWorker::doEstimate);
+    connect(worker, &BombeWorker::progress, this, &BombeWindow::onAttackProgress);
+    connect(worker, &BombeWorker::finished, this, &BombeWindow::onAttackFinished);
+    connect(worker, &BombeWorker::estimated, this, &BombeWindow::onEstimateFinished);
+    connect(worker, &BombeWorker::error, this, &BombeWindow::onAttackError);
+
+    workerThread->start();
+}
+
+QStringList BombeWindow::selectedRotors() const {
     QStringList rotors;
     if (testAllOrdersCheck->isChecked()) {
         // Test all rotor ordersがチェックされている場合、すべてのローターを渡す
@@ -222,9 +271,35 @@ void BombeWindow::onStartAttackClicked() {
                << rotor2Combo->currentText()
                << rotor3Combo->currentText();
     }
-    
-    emit startAttack(crib, cipher, rotors, reflectorCombo->currentText(), 
-                     testAllOrdersCheck->isChecked(), searchWithoutPlugboardCheck->isChecked());
+    return rotors;
+}
+
+void BombeWindow::onEstimateClicked() {
+    QString crib = cribEdit->text().toUpper();
+    QString cipher = cipherEdit->text().toUpper();
+    crib.remove(QRegularExpression("[^A-Z]"));
+    cipher.remove(QRegularExpression("[^A-Z]"));
+    if (crib.isEmpty() || cipher.isEmpty()) {
+        QMessageBox::warning(this, "Error", "Please enter both crib and cipher text");
+        return;
+    }
+
+    // The sample run shares the worker thread with the attack, so the window stays responsive
+    startButton->setEnabled(false);
+    estimateButton->setEnabled(false);
+    logEdit->append("Estimating...");
+
+    ensureWorker();
+    emit startEstimate(crib, cipher, selectedRotors(), reflectorCombo->currentText(),
+                       testAllOrdersCheck->isChecked(), searchWithoutPlugboardCheck->isChecked());
+}
+
+void BombeWindow::onEstimateFinished(const QStringList& report) {
+    for (const auto& line : report) {
+        logEdit->append(line);
+    }
+    startButton->setEnabled(true);
+    estimateButton->setEnabled(true);
 }
 
 void BombeWindow::onStopAttackClicked() {
@@ -236,7 +311,8 @@ void BombeWindow::onStopAttackClicked() {
 
 void BombeWindow::onClearLogClicked() {
     logEdit->clear();
-    resultsList->clear();
+    resultsModel->clear();
+    exportButton->setEnabled(false);
     resultLabel->setText("No results yet");
 }
 
@@ -284,16 +360,36 @@ void BombeWindow::onLoadSettingsClicked() {
 }
 
 void BombeWindow::onExportResultsClicked() {
-    if (allResults.empty()) {
+    if (resultsModel->rowCount() == 0) {
         QMessageBox::warning(this, "Error", "エクスポートする結果がありません");
         return;
     }
     
     QString fileName = QFileDialog::getSaveFileName(this, 
-        "Export Results", "bombe_results.json", "JSON Files (*.json)");
+        "Export Results", "bombe_results.json",
+        "JSON Files (*.json);;NDJSON Files (*.ndjson);;Binary Result Files (*.bin)");
     
     if (fileName.isEmpty()) return;
     
+    // 表示中の順序と絞り込みのまま書き出す
+    int rowCount = resultsModel->rowCount();
+    
+    // NDJSON/バイナリは1件ずつ書き出し、結果全体のJSON文書を組み立てない
+    if (fileName.endsWith(".ndjson", Qt::CaseInsensitive) || fileName.endsWith(".bin", Qt::CaseInsensitive)) {
+        try {
+            auto sink = ResultSink::open(fileName.toLocal8Bit().toStdString());
+            for (int row = 0; row < rowCount; ++row) {
+                sink->write(resultsModel->resultAt(row));
+            }
+            sink->flush();
+            QMessageBox::information(this, "Success", 
+                QString("結果が %1 にエクスポートされました").arg(QFileInfo(fileName).fileName()));
+        } catch (const std::exception& e) {
+            QMessageBox::warning(this, "Error", QString("Failed to save file: %1").arg(e.what()));
+        }
+        return;
+    }
+    
     QJsonObject root;
     
     // Settings
@@ -310,7 +406,8 @@ void BombeWindow::onExportResultsClicked() {
     
     // Results
     QJsonArray resultsArray;
-    for (const auto& result : allResults) {
+    for (int row = 0; row < rowCount; ++row) {
+        CandidateResult result = resultsModel->resultAt(row);
         QJsonObject resultObj;
         resultObj["position"] = QString::fromStdString(result.getPositionString());
         resultObj["rotors"] = QString::fromStdString(result.getRotorString());
@@ -332,7 +429,7 @@ void BombeWindow::onExportResultsClicked() {
         resultsArray.append(resultObj);
     }
     root["results"] = resultsArray;
-    root["totalResults"] = static_cast<int>(allResults.size());
+    root["totalResults"] = rowCount;
     
     QJsonDocument doc(root);
     QFile file(fileName);
@@ -347,19 +444,16 @@ void BombeWindow::onExportResultsClicked() {
 }
 
 void BombeWindow::onResultSelected() {
-    auto items = resultsList->selectedItems();
-    if (items.isEmpty()) return;
+    int row = resultsView->currentIndex().row();
+    if (row < 0 || row >= resultsModel->rowCount()) return;
     
-    int index = resultsList->row(items.first());
-    if (index < 0 || index >= allResults.size()) return;
-    
-    const auto& result = allResults[index];
+    CandidateResult result = resultsModel->resultAt(row);
     
     QString detail = QString("Selected: #%1\n"
                            "Position: %2, Rotors: %3\n"
                            "Match rate: %4%, Plugboard pairs: %5\n"
                            "Crib offset: %6")
-        .arg(index + 1)
+        .arg(resultsModel->rankAt(row))
         .arg(QString::fromStdString(result.getPositionString()))
         .arg(QString::fromStdString(result.getRotorString()))
         .arg(result.matchRate * 100, 0, 'f', 1)
@@ -373,58 +467,73 @@ void BombeWindow::onAttackProgress(const QString& message) {
     logEdit->append(message);
 }
 
-void BombeWindow::onAttackFinished(const std::vector<BombeResult>& results) {
-    allResults = results;
+void BombeWindow::onAttackFinished(const std::shared_ptr<const PackedCandidateSet>& results) {
     showResults(results);
     
     startButton->setEnabled(true);
+    estimateButton->setEnabled(true);
     stopButton->setEnabled(false);
     progressBar->setVisible(false);
-    exportButton->setEnabled(!results.empty());
 }
 
 void BombeWindow::onAttackError(const QString& error) {
     QMessageBox::critical(this, "Error", error);
     
     startButton->setEnabled(true);
+    estimateButton->setEnabled(true);
     stopButton->setEnabled(false);
     progressBar->setVisible(false);
 }
 
-void BombeWindow::showResults(const std::vector<BombeResult>& results) {
-    if (results.empty()) {
+void BombeWindow::showResults(const std::shared_ptr<const PackedCandidateSet>& results) {
+    if (!results || results->empty()) {
+        resultsModel->clear();
         resultLabel->setText("有効なローター位置が見つかりませんでした");
         return;
     }
     
-    resultLabel->setText(QString("Found %1 candidates").arg(results.size()));
-    
-    resultsList->clear();
-    for (size_t i = 0; i < std::min(size_t(50), results.size()); ++i) {
-        const auto& result = results[i];
-        QString plugboardStr = "なし";
-        if (!result.plugboard.empty()) {
-            QStringList pairs;
-            for (const auto& [a, b] : result.plugboard) {
-                pairs << QString("%1%2").arg(a).arg(b);
-            }
-            plugboardStr = pairs.join(" ");
+    // The rows appear once the model has applied the current sort and filter
+    selectFirstResult = true;
+    resultsModel->setResults(results);
+}
+
+void BombeWindow::onPairFilterChanged() {
+    int minPairs = minPairsSpin->value();
+    int maxPairs = maxPairsSpin->value();
+    if (minPairs > maxPairs) {
+        // Keep the range valid by moving the other bound along
+        if (sender() == minPairsSpin) {
+            maxPairsSpin->setValue(minPairs);
+        } else {
+            minPairsSpin->setValue(maxPairs);
         }
-        
-        QString item = QString("#%1: %2 (%3) - Score: %4, Match: %5%, PB: %6, Offset: %7")
-            .arg(i + 1)
-            .arg(QString::fromStdString(result.getPositionString()))
-            .arg(QString::fromStdString(result.getRotorString()))
-            .arg(result.score, 0, 'f', 1)
-            .arg(result.matchRate * 100, 0, 'f', 1)
-            .arg(plugboardStr)
-            .arg(result.offset);
-        resultsList->addItem(item);
+        return;
     }
+    resultsModel->setPairFilter(minPairs, maxPairs);
+}
+
+void BombeWindow::onResultsBusyChanged(bool busy) {
+    int total = resultsModel->totalCount();
+    if (busy) {
+        resultLabel->setText(QString("Found %1 candidates (sorting...)").arg(total));
+        return;
+    }
+    if (total == 0) {
+        exportButton->setEnabled(false);
+        return;
+    }
+    
+    int shown = resultsModel->rowCount();
+    resultLabel->setText(shown == total
+        ? QString("Found %1 candidates").arg(total)
+        : QString("Found %1 candidates, showing %2").arg(total).arg(shown));
+    exportButton->setEnabled(shown > 0);
     
-    if (!results.empty()) {
-        resultsList->setCurrentRow(0);
+    if (selectFirstResult && shown > 0) {
+        selectFirstResult = false;
+        resultsView->selectRow(0);
     }
+    resultsView->scrollToTop();
 }
 
 // BombeWorker implementation
@@ -455,6 +564,8 @@ void BombeWorker::doAttack(const QString& crib, const QString& cipher,
     
     // Use BombeAttack class for historically accurate implementation
     BombeAttack bombeAttack(cribStr, cipherStr, rotorTypes, reflectorStr, testAllOrders, searchWithoutPlugboard);
+    // Only the logged top candidates are unpacked; the table reads the packed set
+    bombeAttack.setResultLimit(10);
     
     // Progress callback
     auto progressCallback = [this](const std::string& msg) {
@@ -463,35 +574,49 @@ void BombeWorker::doAttack(const QString& crib, const QString& cipher,
         }
     };
     
+    // ENIGMA_TRACE=path records a Chrome trace-event timeline of this attack
+    QString tracePath = qEnvironmentVariable("ENIGMA_TRACE");
+    std::shared_ptr<TraceRecorder> trace;
+    if (!tracePath.isEmpty()) {
+        trace = std::make_shared<TraceRecorder>();
+        bombeAttack.setTraceRecorder(trace);
+    }
+    
     // Run the attack
     progressCallback("Starting Bombe attack with proper plugboard deduction...");
-    auto candidateResults = bombeAttack.attack(progressCallback);
+    int64_t attackStart = trace ? trace->now() : 0;
+    std::vector<CandidateResult> candidateResults;
+    try {
+        candidateResults = bombeAttack.attack(progressCallback);
+    } catch (const std::exception& e) {
+        // e.g. a crib longer than the packed match field allows
+        emit error(QString("Attack failed: %1").arg(e.what()));
+        return;
+    }
+    if (trace) {
+        trace->record(0, "guiWorker", "gui", attackStart, trace->now());
+        trace->setThreadName(0, "GUI worker (OpenMP thread 0)");
+        try {
+            trace->writeJson(tracePath.toStdString());
+            emit progress(QString("Trace written to %1").arg(tracePath));
+        } catch (const std::exception& e) {
+            emit progress(QString("Trace not written: %1").arg(e.what()));
+        }
+    }
     
     if (stopFlag) {
         bombeAttack.stop();
-        emit finished(std::vector<BombeResult>{});
+        emit finished(nullptr);
         return;
     }
     
-    // Convert CandidateResult to BombeResult
-    std::vector<BombeResult> results;
-    for (const auto& candidate : candidateResults) {
-        BombeResult result;
-        result.score = candidate.score;
-        result.positions = candidate.positions;
-        result.rotorOrder = candidate.rotorOrder;
-        result.plugboard = candidate.plugboard;
-        result.matchRate = candidate.matchRate;
-        result.plugboardPairs = candidate.plugboardPairs;
-        result.offset = candidate.offset;
-        results.push_back(result);
-    }
+    auto results = std::make_shared<const PackedCandidateSet>(bombeAttack.getPackedResults());
     
-    emit progress(QString("\nFound %1 possible settings").arg(results.size()));
+    emit progress(QString("\nFound %1 possible settings").arg(results->size()));
     
     // Show top 10
-    for (size_t i = 0; i < std::min(size_t(10), results.size()); ++i) {
-        const auto& r = results[i];
+    for (size_t i = 0; i < candidateResults.size(); ++i) {
+        const auto& r = candidateResults[i];
         QString plugboardStr;
         for (const auto& [a, b] : r.plugboard) {
             if (!plugboardStr.isEmpty()) plugboardStr += " ";
@@ -513,4 +638,43 @@ void BombeWorker::doAttack(const QString& crib, const QString& cipher,
     emit finished(results);
 }
 
+void BombeWorker::doEstimate(const QString& crib, const QString& cipher,
+                             const QStringList& rotors, const QString& reflector,
+                             bool testAllOrders, bool searchWithoutPlugboard) {
+    std::vector<std::string> rotorTypes;
+    for (const auto& r : rotors) {
+        rotorTypes.push_back(r.toStdString());
+    }
+
+    AttackEstimate estimate;
+    try {
+        BombeAttack bombeAttack(crib.toStdString(), cipher.toStdString(), rotorTypes,
+                                reflector.toStdString(), testAllOrders, searchWithoutPlugboard);
+        estimate = bombeAttack.estimate({CribEntry{crib.toStdString(), -1}});
+    } catch (const std::exception& e) {
+        emit error(QString("Estimate failed: %1").arg(e.what()));
+        return;
+    }
+
+    double seconds = estimate.predictedSeconds;
+    QString runtime = seconds < 120 ? QString("%1 s").arg(seconds, 0, 'f', 1)
+                    : seconds < 7200 ? QString("%1 min").arg(seconds / 60, 0, 'f', 1)
+                    : QString("%1 h").arg(seconds / 3600, 0, 'f', 1);
+    QStringList report;
+    report << "=== Attack Estimate ===";
+    report << QString("Positions: %1 (%2 rotor orders x 17576 x %3 offsets)")
+        .arg(estimate.totalPositions).arg(estimate.rotorOrders).arg(estimate.offsetsPerPosition);
+    report << QString("Menu closures: %1-%2, expected Bombe stops: %3")
+        .arg(estimate.minClosures).arg(estimate.maxClosures).arg(estimate.menuStops, 0, 'g', 3);
+    report << QString("Predicted runtime: %1 on %2 threads (%3 ns/position measured)")
+        .arg(runtime).arg(estimate.threads).arg(estimate.nsPerPosition, 0, 'f', 0);
+    report << QString("Expected candidates: %1 (%2 MB)")
+        .arg(estimate.expectedCandidates, 0, 'f', 0)
+        .arg(estimate.expectedResultBytes / (1024.0 * 1024.0), 0, 'f', 1);
+    for (const auto& warning : estimate.warnings) {
+        report << "Warning: " + QString::fromStdString(warning);
+    }
+    emit estimated(report);
+}
+
 // testPosition method removed - now using BombeAttack class
\ No newline at end of file
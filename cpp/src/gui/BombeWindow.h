@@ -15,38 +15,13 @@ class QComboBox;
 class QCheckBox;
 class QPushButton;
 class QProgressBar;
-class QListWidget;
+class QTableView;
+class QSpinBox;
 class QLabel;
 QT_END_NAMESPACE
 
 class BombeWorker;
-
-struct BombeResult {
-    double score;
-    std::vector<int> positions;
-    std::vector<std::string> rotorOrder;
-    std::vector<std::pair<char, char>> plugboard;
-    double matchRate;
-    int plugboardPairs;
-    int offset;
-    
-    std::string getPositionString() const {
-        std::string result;
-        for (int pos : positions) {
-            result += char('A' + pos);
-        }
-        return result;
-    }
-    
-    std::string getRotorString() const {
-        std::string result;
-        for (size_t i = 0; i < rotorOrder.size(); ++i) {
-            if (i > 0) result += "-";
-            result += rotorOrder[i];
-        }
-        return result;
-    }
-};
+class BombeResultsModel;
 
 class BombeWindow : public QMainWindow {
     Q_OBJECT
@@ -59,23 +34,32 @@ signals:
     void startAttack(const QString& crib, const QString& cipher,
                     const QStringList& rotors, const QString& reflector,
                     bool testAllOrders, bool searchWithoutPlugboard);
+    void startEstimate(const QString& crib, const QString& cipher,
+                       const QStringList& rotors, const QString& reflector,
+                       bool testAllOrders, bool searchWithoutPlugboard);
 
 private slots:
     void onStartAttackClicked();
+    void onEstimateClicked();
     void onStopAttackClicked();
     void onClearLogClicked();
     void onSaveSettingsClicked();
     void onLoadSettingsClicked();
     void onExportResultsClicked();
     void onResultSelected();
+    void onPairFilterChanged();
+    void onResultsBusyChanged(bool busy);
     
     void onAttackProgress(const QString& message);
-    void onAttackFinished(const std::vector<BombeResult>& results);
+    void onAttackFinished(const std::shared_ptr<const PackedCandidateSet>& results);
     void onAttackError(const QString& error);
+    void onEstimateFinished(const QStringList& report);
 
 private:
     void setupUi();
-    void showResults(const std::vector<BombeResult>& results);
+    void ensureWorker();
+    QStringList selectedRotors() const;
+    void showResults(const std::shared_ptr<const PackedCandidateSet>& results);
     
     // UI elements
     QLineEdit* cribEdit;
@@ -88,10 +72,13 @@ private:
     QCheckBox* searchWithoutPlugboardCheck;
     
     QTextEdit* logEdit;
-    QListWidget* resultsList;
+    QTableView* resultsView;
+    QSpinBox* minPairsSpin;
+    QSpinBox* maxPairsSpin;
     QLabel* resultLabel;
     
     QPushButton* startButton;
+    QPushButton* estimateButton;
     QPushButton* stopButton;
     QPushButton* clearButton;
     QPushButton* saveSettingsButton;
@@ -104,8 +91,9 @@ private:
     QThread* workerThread;
     BombeWorker* worker;
     
-    // Results
-    std::vector<BombeResult> allResults;
+    // Results (all candidates stay packed; the model formats visible rows only)
+    BombeResultsModel* resultsModel;
+    bool selectFirstResult = false;
 };
 
 // Worker class for background processing
@@ -121,10 +109,15 @@ public slots:
     void doAttack(const QString& crib, const QString& cipher,
                   const QStringList& rotors, const QString& reflector,
                   bool testAllOrders, bool searchWithoutPlugboard);
+    // Sample run for the pre-attack estimate; the report lines go to estimated()
+    void doEstimate(const QString& crib, const QString& cipher,
+                    const QStringList& rotors, const QString& reflector,
+                    bool testAllOrders, bool searchWithoutPlugboard);
 
 signals:
     void progress(const QString& message);
-    void finished(const std::vector<BombeResult>& results);
+    void estimated(const QStringList& report);
+    void finished(const std::shared_ptr<const PackedCandidateSet>& results);
     void error(const QString& error);
 
 private:
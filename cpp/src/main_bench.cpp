@@ -0,0 +1,587 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "bench/ScalingHarness.h"
+#include "cli/CommandArgs.h"
+#include "core/BombeAttack.h"
+#include "core/DiagonalBoard.h"
+#include "core/EnigmaMachine.h"
+#include "core/PerfCounters.h"
+#include "core/Plugboard.h"
+#include "core/Rotor.h"
+#include "core/RotorConfig.h"
+#include "core/ScramblerTable.h"
+
+// Microbenchmarks for the hot-path kernels. Every benchmark uses fixed inputs
+// so the JSON output can be diffed across commits (see --baseline).
+// "enigma_bench scaling" runs whole attacks on synthetic traffic instead.
+
+// Reaches the private BombeAttack kernels (declared friend in BombeAttack.h)
+class BombeBench {
+public:
+    static std::vector<std::pair<char, char>> deducePlugboardWiring(
+        BombeAttack& attack, const ScramblerTable& table, const std::vector<int>& states,
+        const std::string& crib, int offset, bool& hasConflict, AttackStats& stats) {
+        return attack.deducePlugboardWiring(table, states, crib, offset, hasConflict, stats);
+    }
+
+    static void testPosition(BombeAttack& attack, const ScramblerTable& table,
+                             const std::vector<int>& states, const std::string& crib,
+                             int offset, int startState, uint16_t contextId,
+                             std::vector<PackedCandidate>& results, AttackStats& stats) {
+        attack.testPosition(table, states, crib, offset, startState, contextId, results, stats);
+    }
+};
+
+namespace {
+
+using json = nlohmann::ordered_json;
+
+// Weather report opening, the classic Bletchley crib
+const std::string PLAINTEXT =
+    "WETTERVORHERSAGEBISKAYAXXNORDWESTLICHEWINDEMITTELSTAERKEXXSICHTWEITEZEHNSEEMEILEN"
+    "XXBEDECKTXXLUFTDRUCKFALLENDXXTEMPERATURZWOLFGRADXXENDE";
+const std::string CRIB = "WETTERVORHERSAGE";
+const std::vector<std::string> ROTORS = {"I", "II", "III"};
+const std::vector<std::string> PLUGBOARD = {"AR", "BL", "FK", "GH", "UX", "CM", "DZ", "EQ", "IP", "NO"};
+const std::vector<int> START_POSITIONS = {3, 4, 5};
+
+// Keeps results observable so the compiler cannot drop the measured work
+volatile uint64_t sinkValue = 0;
+
+struct Measurement {
+    std::string name;
+    std::string unit;
+    uint64_t iterations = 0;
+    std::vector<double> nsPerOp;  // one entry per repetition
+    PerfReading perf;             // hardware counters over all repetitions (--perf)
+};
+
+// body(n) performs n operations and returns a checksum of their results
+using Body = std::function<uint64_t(uint64_t)>;
+
+struct Benchmark {
+    std::string name;
+    std::string unit;
+    Body body;
+};
+
+double runOnce(const Body& body, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    sinkValue = sinkValue + body(iterations);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+Measurement measure(const Benchmark& benchmark, double minTimeNs, int repetitions,
+                    const PerfCounters* perf) {
+    // Grow the iteration count until one run takes about minTimeNs
+    uint64_t iterations = 1;
+    double elapsed = runOnce(benchmark.body, iterations);
+    while (elapsed < minTimeNs && iterations < (uint64_t(1) << 40)) {
+        double scale = elapsed > 0 ? minTimeNs * 1.2 / elapsed : 10.0;
+        iterations = (std::max)(iterations + 1, static_cast<uint64_t>(iterations * (std::min)(scale, 10.0)));
+        elapsed = runOnce(benchmark.body, iterations);
+    }
+
+    Measurement measurement{benchmark.name, benchmark.unit, iterations, {}, {}};
+    PerfReading before = perf ? perf->read() : PerfReading();
+    for (int i = 0; i < repetitions; i++) {
+        measurement.nsPerOp.push_back(runOnce(benchmark.body, iterations) / iterations);
+    }
+    if (perf) {
+        measurement.perf = perf->read() - before;
+    }
+    return measurement;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+std::unique_ptr<EnigmaMachine> makeMachine() {
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : ROTORS) {
+        const auto& definition = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(definition.wiring, definition.getFirstNotch()));
+    }
+    auto machine = std::make_unique<EnigmaMachine>(
+        std::move(rotors),
+        std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at("B").wiring),
+        std::make_unique<Plugboard>(PLUGBOARD));
+    machine->setRotorPositions(START_POSITIONS);
+    return machine;
+}
+
+// Fixed spread of start states plus the true one, as the attack loop would visit them
+std::vector<int> sampleStates() {
+    std::vector<int> states;
+    for (int i = 0; i < 255; i++) {
+        states.push_back((i * 6869 + 17) % ScramblerTable::NUM_STATES);
+    }
+    states.push_back(ScramblerTable::stateIndex(START_POSITIONS));
+    return states;
+}
+
+std::vector<Benchmark> buildBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"Rotor::encryptForward", "char", [](uint64_t n) {
+        const auto& definition = enigma::ROTOR_DEFINITIONS.at("I");
+        Rotor rotor(definition.wiring, definition.getFirstNotch(), 1);
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            rotor.setPosition(static_cast<int>(i % 26));
+            sum += rotor.encryptForward(PLAINTEXT[i % PLAINTEXT.size()]);
+        }
+        return sum;
+    }});
+
+    benchmarks.push_back({"EnigmaMachine::encryptChar", "char", [](uint64_t n) {
+        auto machine = makeMachine();
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            sum += machine->encryptChar(PLAINTEXT[i % PLAINTEXT.size()]);
+        }
+        return sum;
+    }});
+
+    benchmarks.push_back({"EnigmaMachine::stepRotors", "step", [](uint64_t n) {
+        auto machine = makeMachine();
+        for (uint64_t i = 0; i < n; i++) {
+            machine->stepRotors();
+        }
+        auto positions = machine->getRotorPositions();
+        return static_cast<uint64_t>(positions[0] + positions[1] * 26 + positions[2] * 676);
+    }});
+
+    benchmarks.push_back({"Plugboard::swap", "char", [](uint64_t n) {
+        Plugboard plugboard(PLUGBOARD);
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            sum += plugboard.swap(PLAINTEXT[i % PLAINTEXT.size()]);
+        }
+        return sum;
+    }});
+
+    benchmarks.push_back({"DiagonalBoard::hasContradiction", "call", [](uint64_t n) {
+        // A consistent 10-pair hypothesis and one that wires E to two letters
+        std::map<char, char> consistent;
+        for (const auto& pair : PLUGBOARD) {
+            consistent[pair[0]] = pair[1];
+            consistent[pair[1]] = pair[0];
+        }
+        std::map<char, char> contradictory = consistent;
+        contradictory['E'] = 'S';
+        contradictory['S'] = 'E';
+        DiagonalBoard board;
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            sum += board.hasContradiction(i % 2 ? contradictory : consistent);
+        }
+        return sum;
+    }});
+
+    // Shared fixture for the BombeAttack kernels: ciphertext produced with a
+    // 10-pair plugboard so wiring deduction takes its full path
+    auto machine = makeMachine();
+    auto cipher = std::make_shared<std::string>(machine->encrypt(PLAINTEXT));
+    auto table = ScramblerTable::get(ROTORS, "B");
+    auto sequences = std::make_shared<std::vector<std::vector<int>>>();
+    for (int state : sampleStates()) {
+        sequences->push_back(table->stateSequence(state, static_cast<int>(cipher->size())));
+    }
+    auto attack = std::make_shared<BombeAttack>(CRIB, *cipher, ROTORS, "B");
+
+    benchmarks.push_back({"BombeAttack::deducePlugboardWiring", "position",
+                          [attack, table, sequences](uint64_t n) {
+        AttackStats stats;
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            bool hasConflict = false;
+            const auto& states = (*sequences)[i % sequences->size()];
+            auto wiring = BombeBench::deducePlugboardWiring(*attack, *table, states, CRIB, 0, hasConflict,
+                                                            stats);
+            sum += wiring.size() + hasConflict;
+        }
+        return sum;
+    }});
+
+    benchmarks.push_back({"BombeAttack::testPosition", "position",
+                          [attack, table, sequences](uint64_t n) {
+        auto samples = sampleStates();
+        std::vector<PackedCandidate> results;
+        AttackStats stats;
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            size_t sample = i % sequences->size();
+            BombeBench::testPosition(*attack, *table, (*sequences)[sample], CRIB, 0,
+                                     samples[sample], 0, results, stats);
+            sum += results.size();
+            results.clear();
+        }
+        return sum;
+    }});
+
+    return benchmarks;
+}
+
+json buildContext() {
+    return {
+#if defined(_MSC_VER)
+        {"compiler", "msvc " + std::to_string(_MSC_VER)},
+#elif defined(__clang__)
+        {"compiler", "clang " __clang_version__},
+#elif defined(__GNUC__)
+        {"compiler", "gcc " __VERSION__},
+#else
+        {"compiler", "unknown"},
+#endif
+#ifdef NDEBUG
+        {"build", "release"},
+#else
+        {"build", "debug"},
+#endif
+        {"hardwareThreads", std::thread::hardware_concurrency()},
+    };
+}
+
+json toJson(const std::vector<Measurement>& measurements, double minTimeMs, int repetitions,
+            const PerfCounters* perf) {
+    json context = buildContext();
+    context["minTimeMs"] = minTimeMs;
+    context["repetitions"] = repetitions;
+    if (perf) {
+        context["perfCounters"] = perf->available() ? "available" : perf->unavailableReason();
+    }
+
+    json results = json::array();
+    for (const auto& m : measurements) {
+        json result = {
+            {"name", m.name},
+            {"unit", m.unit},
+            {"iterations", m.iterations},
+            {"nsPerOp", median(m.nsPerOp)},
+            {"nsMin", *std::min_element(m.nsPerOp.begin(), m.nsPerOp.end())},
+            {"nsMax", *std::max_element(m.nsPerOp.begin(), m.nsPerOp.end())},
+        };
+        if (!m.perf.empty()) {
+            // Counters are per operation, like nsPerOp
+            double ops = static_cast<double>(m.iterations) * m.nsPerOp.size();
+            json counters = json::object();
+            for (int event = 0; event < PerfReading::EVENT_COUNT; event++) {
+                if (m.perf.has(event)) {
+                    counters[PerfCounters::eventName(event)] = m.perf.values[event] / ops;
+                }
+            }
+            if (m.perf.ipc() > 0) {
+                counters["ipc"] = m.perf.ipc();
+            }
+            result["perf"] = counters;
+        }
+        results.push_back(result);
+    }
+    return {{"schema", 1}, {"context", context}, {"benchmarks", results}};
+}
+
+// Prints the change against an earlier run; returns the worst slowdown in percent
+double compareWithBaseline(const json& current, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open baseline: " + path);
+    }
+    json baseline = json::parse(file);
+
+    std::map<std::string, double> previous;
+    for (const auto& entry : baseline.at("benchmarks")) {
+        previous[entry.at("name").get<std::string>()] = entry.at("nsPerOp").get<double>();
+    }
+
+    double worst = 0.0;
+    std::cerr << std::left << std::setw(38) << "benchmark" << std::right
+              << std::setw(12) << "base ns" << std::setw(12) << "now ns" << std::setw(10) << "change\n";
+    for (const auto& entry : current.at("benchmarks")) {
+        std::string name = entry.at("name").get<std::string>();
+        double now = entry.at("nsPerOp").get<double>();
+        std::cerr << std::left << std::setw(38) << name << std::right << std::fixed << std::setprecision(2);
+        auto found = previous.find(name);
+        if (found == previous.end() || found->second <= 0) {
+            std::cerr << std::setw(12) << "-" << std::setw(12) << now << std::setw(10) << "new" << "\n";
+            continue;
+        }
+        double change = (now - found->second) / found->second * 100.0;
+        worst = (std::max)(worst, change);
+        std::cerr << std::setw(12) << found->second << std::setw(12) << now
+                  << std::setw(9) << std::showpos << change << std::noshowpos << "%\n";
+    }
+    return worst;
+}
+
+void printUsage() {
+    std::cout << "Usage: enigma_bench [--filter TEXT] [--min-time MS] [--repetitions N]\n";
+    std::cout << "                    [--out FILE] [--baseline FILE [--max-regression PCT]] [--list] [--perf]\n";
+    std::cout << "       enigma_bench scaling [--crib-lengths 16] [--cipher-lengths 60] [--rotor-sets 3]\n";
+    std::cout << "                    [--threads 1,2,4,...] [--samples 1] [--plugs 0] [--seed 1] [--out FILE]\n\n";
+    std::cout << "Runs the core kernel microbenchmarks and writes JSON to stdout (or --out).\n";
+    std::cout << "With --baseline, prints the change per benchmark to stderr; with --max-regression,\n";
+    std::cout << "exits with 1 when any benchmark is slower than the baseline by more than PCT percent.\n";
+    std::cout << "--perf adds hardware counters per operation (Linux perf_event_open) to each result.\n\n";
+    std::cout << "scaling generates known-answer messages from random keys (reproducible per --seed),\n";
+    std::cout << "attacks each one at every thread count (all orders of the first N rotors, crib offset\n";
+    std::cout << "unknown) and reports total time, time to the first correct candidate, whether the\n";
+    std::cout << "key was found, and speedup/efficiency relative to the smallest thread count.\n";
+}
+
+std::vector<int> parseIntList(const CommandArgs& args, const std::string& name, const std::vector<int>& defaults) {
+    if (!args.has(name)) {
+        return defaults;
+    }
+    std::vector<int> values;
+    for (const auto& item : args.getList(name, {})) {
+        size_t used = 0;
+        int value = std::stoi(item, &used);
+        if (used != item.size() || value <= 0) {
+            throw std::invalid_argument("--" + name + " expects positive integers");
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        throw std::invalid_argument("--" + name + " expects positive integers");
+    }
+    return values;
+}
+
+std::vector<int> defaultThreadCounts() {
+    int hardware = (std::max)(1u, std::thread::hardware_concurrency());
+    std::vector<int> counts;
+    for (int threads = 1; threads < hardware; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+json pointToJson(const ScalingPoint& point) {
+    return {
+        {"cribLength", point.cribLength},
+        {"cipherLength", point.cipherLength},
+        {"rotorSetSize", point.rotorSetSize},
+        {"sample", point.sample},
+        {"threads", point.threads},
+        {"totalSeconds", point.totalSeconds},
+        {"firstCorrectSeconds", point.found ? json(point.firstCorrectSeconds) : json(nullptr)},
+        {"found", point.found},
+        {"rawCandidates", point.rawCandidates},
+        {"candidates", point.candidates},
+    };
+}
+
+// Median time per thread count for each workload shape, relative to the smallest thread count
+json buildCurves(const std::vector<ScalingPoint>& points) {
+    using Shape = std::tuple<int, int, int>;
+    std::map<Shape, std::map<int, std::vector<const ScalingPoint*>>> groups;
+    for (const auto& point : points) {
+        groups[Shape{point.rotorSetSize, point.cipherLength, point.cribLength}][point.threads].push_back(&point);
+    }
+
+    json curves = json::array();
+    for (const auto& [shape, byThreads] : groups) {
+        json curve = {
+            {"rotorSetSize", std::get<0>(shape)},
+            {"cipherLength", std::get<1>(shape)},
+            {"cribLength", std::get<2>(shape)},
+        };
+        int baseThreads = byThreads.begin()->first;
+        double baseSeconds = 0.0;
+        json rows = json::array();
+        for (const auto& [threads, runs] : byThreads) {
+            std::vector<double> totals;
+            std::vector<double> firsts;
+            int found = 0;
+            for (const auto* run : runs) {
+                totals.push_back(run->totalSeconds);
+                if (run->found) {
+                    firsts.push_back(run->firstCorrectSeconds);
+                    found++;
+                }
+            }
+            double seconds = median(totals);
+            if (threads == baseThreads) {
+                baseSeconds = seconds;
+            }
+            double speedup = seconds > 0 ? baseSeconds / seconds : 0.0;
+            rows.push_back({
+                {"threads", threads},
+                {"medianSeconds", seconds},
+                {"medianFirstCorrectSeconds", firsts.empty() ? json(nullptr) : json(median(firsts))},
+                {"speedup", speedup},
+                {"efficiency", speedup * baseThreads / threads},
+                {"found", found},
+                {"samples", runs.size()},
+            });
+        }
+        curve["baseThreads"] = baseThreads;
+        curve["points"] = rows;
+        curves.push_back(curve);
+    }
+    return curves;
+}
+
+int runScaling(const CommandArgs& args) {
+    ScalingHarness::Matrix matrix;
+    try {
+        matrix.cribLengths = parseIntList(args, "crib-lengths", matrix.cribLengths);
+        matrix.cipherLengths = parseIntList(args, "cipher-lengths", matrix.cipherLengths);
+        matrix.rotorSetSizes = parseIntList(args, "rotor-sets", matrix.rotorSetSizes);
+        matrix.threads = parseIntList(args, "threads", defaultThreadCounts());
+        matrix.samples = (std::max)(1, args.getInt("samples", 1));
+        matrix.plugPairs = args.getInt("plugs", 0);
+        matrix.seed = static_cast<uint64_t>(std::stoull(args.get("seed", "1")));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+
+    std::cerr << std::left << std::setw(7) << "rotors" << std::setw(8) << "cipher" << std::setw(6) << "crib"
+              << std::setw(8) << "sample" << std::setw(9) << "threads" << std::setw(11) << "total s"
+              << std::setw(11) << "first s" << "found\n";
+    auto points = ScalingHarness::runMatrix(matrix, [](const ScalingPoint& point) {
+        std::cerr << std::left << std::setw(7) << point.rotorSetSize << std::setw(8) << point.cipherLength
+                  << std::setw(6) << point.cribLength << std::setw(8) << point.sample
+                  << std::setw(9) << point.threads << std::fixed << std::setprecision(3)
+                  << std::setw(11) << point.totalSeconds << std::setw(11);
+        if (point.found) {
+            std::cerr << point.firstCorrectSeconds;
+        } else {
+            std::cerr << "-";
+        }
+        std::cerr << (point.found ? "yes" : "no") << "\n";
+    });
+
+    json pointsJson = json::array();
+    for (const auto& point : points) {
+        pointsJson.push_back(pointToJson(point));
+    }
+    json output = {
+        {"schema", 1},
+        {"context", buildContext()},
+        {"matrix", {
+            {"cribLengths", matrix.cribLengths},
+            {"cipherLengths", matrix.cipherLengths},
+            {"rotorSetSizes", matrix.rotorSetSizes},
+            {"threads", matrix.threads},
+            {"samples", matrix.samples},
+            {"plugPairs", matrix.plugPairs},
+            {"seed", matrix.seed},
+        }},
+        {"curves", buildCurves(points)},
+        {"points", pointsJson},
+    };
+
+    if (args.has("out")) {
+        std::ofstream file(args.get("out"));
+        if (!file) {
+            throw std::runtime_error("Cannot write " + args.get("out"));
+        }
+        file << output.dump(2) << "\n";
+    } else {
+        std::cout << output.dump(2) << "\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> rawArgs(argv + 1, argv + argc);
+    CommandArgs args(rawArgs, {"list", "help", "perf"});
+    bool scaling = args.positional().size() == 1 && args.positional()[0] == "scaling";
+    if (!args.error().empty() || (!args.positional().empty() && !scaling) || args.has("help")) {
+        printUsage();
+        return 2;
+    }
+    int minTime = 0;
+    int repetitions = 0;
+    int maxRegression = 0;
+    try {
+        minTime = args.getInt("min-time", 200);
+        repetitions = (std::max)(1, args.getInt("repetitions", 5));
+        maxRegression = args.getInt("max-regression", 0);
+    } catch (const UsageError& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+
+    try {
+        if (scaling) {
+            return runScaling(args);
+        }
+
+        std::vector<Benchmark> benchmarks = buildBenchmarks();
+        if (args.has("list")) {
+            for (const auto& benchmark : benchmarks) {
+                std::cout << benchmark.name << "\n";
+            }
+            return 0;
+        }
+
+        std::string filter = args.get("filter");
+        double minTimeMs = (std::max)(1, minTime);
+
+        std::unique_ptr<PerfCounters> perf;
+        if (args.has("perf")) {
+            perf = std::make_unique<PerfCounters>();
+            if (!perf->available()) {
+                std::cerr << "Hardware counters unavailable: " << perf->unavailableReason() << "\n";
+            }
+        }
+
+        std::vector<Measurement> measurements;
+        for (const auto& benchmark : benchmarks) {
+            if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+                continue;
+            }
+            measurements.push_back(measure(benchmark, minTimeMs * 1e6, repetitions,
+                                           perf && perf->available() ? perf.get() : nullptr));
+            std::cerr << benchmark.name << ": " << std::fixed << std::setprecision(2)
+                      << median(measurements.back().nsPerOp) << " ns/" << benchmark.unit << "\n";
+        }
+
+        json output = toJson(measurements, minTimeMs, repetitions, perf.get());
+        if (args.has("out")) {
+            std::ofstream file(args.get("out"));
+            if (!file) {
+                throw std::runtime_error("Cannot write " + args.get("out"));
+            }
+            file << output.dump(2) << "\n";
+        } else {
+            std::cout << output.dump(2) << "\n";
+        }
+
+        if (args.has("baseline")) {
+            double worst = compareWithBaseline(output, args.get("baseline"));
+            if (args.has("max-regression") && worst > maxRegression) {
+                std::cerr << "Slowest regression " << std::setprecision(1) << worst
+                          << "% exceeds --max-regression\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
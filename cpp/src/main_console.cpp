@@ -12,6 +12,16 @@
 #include "core/Plugboard.h"
 #include "core/EnigmaMachine.h"
 #include "core/RotorConfig.h"
+#include "cli/CyclometerCommand.h"
+#include "cli/ZygalskiCommand.h"
+#include "cli/BanburismusCommand.h"
+#include "cli/DailyKeyCommand.h"
+#include "cli/CribIndexCommand.h"
+#include "cli/ResultsCommand.h"
+#include "cli/BombeCommand.h"
+#include "cli/DaemonCommand.h"
+#include "cli/TuneCommand.h"
+#include "cli/CommandArgs.h"
 
 using json = nlohmann::json;
 
@@ -399,7 +409,70 @@ private:
     }
 };
 
-int main() {
+void printCommandUsage() {
+    std::cout << "Usage: EnigmaSimulatorCpp [command] [arguments]\n";
+    std::cout << "Without a command the interactive menu is started.\n\n";
+    std::cout << "Commands:\n";
+    std::cout << "  bombe      - Run the Bombe attack headless (NDJSON progress on stderr)\n";
+    std::cout << "  daemon     - Serve Bombe jobs over a Unix socket with warm caches\n";
+    std::cout << "  cyclometer - Build or query the Rejewski cyclometer catalog\n";
+    std::cout << "  zygalski   - Build Zygalski sheets or search them with female indicators\n";
+    std::cout << "  banburismus - Find messages in depth and constrain the right-hand rotor\n";
+    std::cout << "  daykey     - Attack a day's traffic jointly for its shared rotor order and plugboard\n";
+    std::cout << "  cribindex  - Look up settings from the ciphertext of a stereotyped opening\n";
+    std::cout << "  results    - Show the top results or merge and sort result files\n";
+    std::cout << "  tune       - Measure the fastest thread count and chunk size for this host\n";
+}
+
+int runCommand(const std::string& command, const std::vector<std::string>& args) {
+    if (command == "bombe") {
+        return runBombeCommand(args);
+    }
+    if (command == "daemon") {
+        return runDaemonCommand(args);
+    }
+    if (command == "cyclometer") {
+        return runCyclometerCommand(args);
+    }
+    if (command == "zygalski") {
+        return runZygalskiCommand(args);
+    }
+    if (command == "banburismus") {
+        return runBanburismusCommand(args);
+    }
+    if (command == "daykey") {
+        return runDailyKeyCommand(args);
+    }
+    if (command == "cribindex") {
+        return runCribIndexCommand(args);
+    }
+    if (command == "results") {
+        return runResultsCommand(args);
+    }
+    if (command == "tune") {
+        return runTuneCommand(args);
+    }
+    if (command == "help" || command == "--help" || command == "-h") {
+        printCommandUsage();
+        return 0;
+    }
+
+    std::cerr << "Unknown command: " << command << "\n";
+    printCommandUsage();
+    return 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::vector<std::string> args(argv + 2, argv + argc);
+        try {
+            return runCommand(argv[1], args);
+        } catch (const UsageError& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 2;
+        }
+    }
+
     std::cout << "=== Enigma Machine Simulator (C++ Version) ===\n\n";
     
     EnigmaConsole console;
@@ -0,0 +1,36 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cli/CommandArgs.h"
+#include "core/ScramblerTableStore.h"
+
+// Builds the shared scrambler table store that the console and GUI
+// applications map read-only (see ENIGMA_TABLE_STORE).
+int main(int argc, char* argv[]) {
+    std::vector<std::string> rawArgs(argv + 1, argv + argc);
+    CommandArgs args(rawArgs);
+    if (!args.error().empty() || args.positional().empty()) {
+        std::cout << "Usage: enigma_tablegen <output> [--rotors I,II,III,IV,V,VI,VII,VIII] [--reflectors B,C]\n";
+        return 2;
+    }
+
+    auto rotors = args.getList("rotors", {"I", "II", "III", "IV", "V", "VI", "VII", "VIII"});
+    auto reflectors = args.getList("reflectors", {"B", "C"});
+
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        size_t tables = ScramblerTableStore::build(args.positional()[0], rotors, reflectors,
+            [](const std::string& message) { std::cout << message << "\n"; });
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - startTime);
+
+        std::cout << "Wrote " << tables << " tables to " << args.positional()[0]
+                  << " in " << elapsed.count() << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
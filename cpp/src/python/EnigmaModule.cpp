@@ -0,0 +1,553 @@
+// Python bindings for the C++ engine (module enigma_cpp).
+// Build with -DENIGMA_BUILD_PYTHON=ON; see README.md.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "core/BombeAttack.h"
+#include "core/EnigmaMachine.h"
+#include "core/ResultSink.h"
+#include "core/RotorConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace py = pybind11;
+
+namespace {
+
+void checkComponents(const std::vector<std::string>& rotors, const std::string& reflector) {
+    for (const auto& type : rotors) {
+        if (enigma::ROTOR_DEFINITIONS.find(type) == enigma::ROTOR_DEFINITIONS.end()) {
+            throw py::value_error("Unknown rotor: " + type);
+        }
+    }
+    if (enigma::REFLECTOR_DEFINITIONS.find(reflector) == enigma::REFLECTOR_DEFINITIONS.end()) {
+        throw py::value_error("Unknown reflector: " + reflector);
+    }
+}
+
+std::vector<int> parseLetters(const std::string& text, const char* what) {
+    if (text.size() != 3) {
+        throw py::value_error(std::string(what) + " must be three letters");
+    }
+    std::vector<int> values;
+    for (char c : text) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (c < 'A' || c > 'Z') {
+            throw py::value_error(std::string(what) + " must be three letters");
+        }
+        values.push_back(c - 'A');
+    }
+    return values;
+}
+
+// A contiguous 1-D buffer of 8-bit characters (bytes, bytearray, memoryview, numpy uint8/S1)
+void checkByteBuffer(const py::buffer_info& info) {
+    if (info.itemsize != 1 || info.ndim != 1 || (info.size > 1 && info.strides[0] != 1)) {
+        throw py::value_error("Expected a contiguous one-dimensional buffer of 8-bit characters");
+    }
+}
+
+size_t countLetters(const char* input, size_t length) {
+    size_t letters = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (std::isalpha(static_cast<unsigned char>(input[i]))) {
+            letters++;
+        }
+    }
+    return letters;
+}
+
+class PyEnigmaMachine {
+public:
+    PyEnigmaMachine(const std::vector<std::string>& rotors,
+                    const std::string& reflector,
+                    const std::string& positions,
+                    const std::string& rings,
+                    py::object plugboard) {
+        if (rotors.size() != 3) {
+            throw py::value_error("Exactly three rotors are required");
+        }
+        checkComponents(rotors, reflector);
+        std::vector<int> ringSettings = parseLetters(rings, "rings");
+
+        std::vector<std::unique_ptr<Rotor>> machineRotors;
+        for (size_t i = 0; i < rotors.size(); i++) {
+            const auto& definition = enigma::ROTOR_DEFINITIONS.at(rotors[i]);
+            machineRotors.push_back(std::make_unique<Rotor>(
+                definition.wiring, definition.getFirstNotch(), ringSettings[i]));
+        }
+
+        std::vector<std::string> pairs;
+        if (py::isinstance<py::str>(plugboard)) {
+            std::istringstream stream(plugboard.cast<std::string>());
+            std::string pair;
+            while (stream >> pair) {
+                pairs.push_back(pair);
+            }
+        } else if (!plugboard.is_none()) {
+            pairs = plugboard.cast<std::vector<std::string>>();
+        }
+        for (auto& pair : pairs) {
+            for (auto& c : pair) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            if (pair.size() != 2 || pair[0] < 'A' || pair[0] > 'Z' || pair[1] < 'A' || pair[1] > 'Z') {
+                throw py::value_error("Invalid plugboard pair: " + pair);
+            }
+        }
+
+        machine_ = std::make_unique<EnigmaMachine>(
+            std::move(machineRotors),
+            std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at(reflector).wiring),
+            std::make_unique<Plugboard>(pairs));
+        machine_->setRotorPositions(parseLetters(positions, "positions"));
+    }
+
+    py::str encryptText(const py::str& text) {
+        std::string input = text;
+        std::string output(countLetters(input.data(), input.size()), '\0');
+        {
+            py::gil_scoped_release release;
+            encryptLetters(input.data(), input.size(), &output[0]);
+        }
+        return py::str(output);
+    }
+
+    // Reads the input buffer in place and allocates the result bytes once
+    py::bytes encryptBuffer(const py::buffer& data) {
+        py::buffer_info input = data.request();
+        checkByteBuffer(input);
+        const char* begin = static_cast<const char*>(input.ptr);
+        size_t length = static_cast<size_t>(input.size);
+
+        size_t letters = countLetters(begin, length);
+        py::bytes result(nullptr, letters);
+        char* output = PyBytes_AS_STRING(result.ptr());
+        {
+            py::gil_scoped_release release;
+            encryptLetters(begin, length, output);
+        }
+        return result;
+    }
+
+    // Writes into a caller-provided buffer (bytearray, numpy array, ...) without copies
+    size_t encryptInto(const py::buffer& data, const py::buffer& out) {
+        py::buffer_info input = data.request();
+        py::buffer_info output = out.request(true);
+        checkByteBuffer(input);
+        checkByteBuffer(output);
+        const char* begin = static_cast<const char*>(input.ptr);
+        size_t length = static_cast<size_t>(input.size);
+
+        size_t letters = countLetters(begin, length);
+        if (letters > static_cast<size_t>(output.size)) {
+            throw py::value_error("Output buffer needs " + std::to_string(letters) + " bytes");
+        }
+        py::gil_scoped_release release;
+        encryptLetters(begin, length, static_cast<char*>(output.ptr));
+        return letters;
+    }
+
+    void seek(const std::string& positions) {
+        std::vector<int> values = parseLetters(positions, "positions");
+        std::lock_guard<std::mutex> lock(mutex_);
+        machine_->setRotorPositions(values);
+    }
+
+    std::string positions() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string text;
+        for (int position : machine_->getRotorPositions()) {
+            text += static_cast<char>('A' + position);
+        }
+        return text;
+    }
+
+private:
+    std::unique_ptr<EnigmaMachine> machine_;
+    std::mutex mutex_;  // encryption runs without the GIL
+
+    // Letters are upper-cased, everything else is skipped (same as EnigmaMachine::encrypt)
+    void encryptLetters(const char* input, size_t length, char* output) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < length; i++) {
+            char c = input[i];
+            if (c >= 'a' && c <= 'z') {
+                c = static_cast<char>(c - 'a' + 'A');
+            }
+            if (c >= 'A' && c <= 'Z') {
+                *output++ = machine_->encryptChar(c);
+            }
+        }
+    }
+};
+
+// Candidates handed from the search threads to a Python iterator.
+// write() blocks while the queue is full so a slow consumer throttles the search.
+class QueueSink : public ResultSink {
+public:
+    enum class Pop { Item, Empty, Finished };
+
+    explicit QueueSink(size_t capacity) : capacity_((std::max)(capacity, size_t(1))) {}
+
+    void write(const CandidateResult& result) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        spaceAvailable_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+        if (closed_) {
+            return;
+        }
+        queue_.push_back(result);
+        count_++;
+        itemAvailable_.notify_one();
+    }
+
+    Pop pop(CandidateResult& result, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        itemAvailable_.wait_for(lock, timeout, [this] { return finished_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return finished_ ? Pop::Finished : Pop::Empty;
+        }
+        result = std::move(queue_.front());
+        queue_.pop_front();
+        spaceAvailable_.notify_one();
+        return Pop::Item;
+    }
+
+    // The search has returned; remaining items can still be popped
+    void finish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        itemAvailable_.notify_all();
+    }
+
+    // The consumer is gone; drop further writes and wake blocked writers
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        spaceAvailable_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable itemAvailable_;
+    std::condition_variable spaceAvailable_;
+    std::deque<CandidateResult> queue_;
+    bool finished_ = false;
+    bool closed_ = false;
+};
+
+// Iterates the merged, sorted candidates of a finished run, unpacking one at a time
+class CandidateIterator {
+public:
+    CandidateIterator(const PackedCandidateSet& results, size_t limit)
+        : results_(results), end_(limit > 0 ? (std::min)(limit, results.size()) : results.size()) {}
+
+    CandidateResult next() {
+        if (index_ >= end_ || index_ >= results_.size()) {
+            throw py::stop_iteration();
+        }
+        return results_.unpack(index_++);
+    }
+
+private:
+    const PackedCandidateSet& results_;
+    size_t end_;
+    size_t index_ = 0;
+};
+
+class PyBombeAttack;
+
+class CandidateStream {
+public:
+    CandidateStream(PyBombeAttack& owner, size_t capacity);
+    ~CandidateStream() { shutdown(); }
+
+    CandidateResult next();
+
+private:
+    PyBombeAttack& owner_;
+    std::shared_ptr<QueueSink> sink_;
+    std::thread worker_;
+    std::exception_ptr error_;
+
+    void shutdown();
+};
+
+std::vector<CribEntry> parseCribs(const py::object& cribs, int position) {
+    std::vector<std::string> texts;
+    if (py::isinstance<py::str>(cribs)) {
+        texts.push_back(cribs.cast<std::string>());
+    } else {
+        texts = cribs.cast<std::vector<std::string>>();
+    }
+    if (texts.empty()) {
+        throw py::value_error("At least one crib is required");
+    }
+    std::vector<CribEntry> entries;
+    for (const auto& text : texts) {
+        entries.push_back(CribEntry{text, position});
+    }
+    return entries;
+}
+
+class PyBombeAttack {
+public:
+    PyBombeAttack(const py::object& cribs,
+                  const std::string& cipher,
+                  const std::vector<std::string>& rotors,
+                  const std::string& reflector,
+                  bool allOrders,
+                  bool noPlugboard,
+                  int cribPosition,
+                  bool mergeEquivalent,
+                  int threads)
+        : cribs_(parseCribs(cribs, cribPosition)),
+          attack_(validated(cribs_, rotors, reflector), cipher, rotors, reflector, allOrders, noPlugboard) {
+        attack_.setMergeEquivalent(mergeEquivalent);
+        // Candidates stay packed and are unpacked one at a time by the iterators
+        attack_.setResultLimit(1);
+        if (threads > 0) {
+            attack_.setMaxThreads(threads);
+        }
+    }
+
+    // Blocks without holding the GIL; callbacks re-acquire it
+    size_t run(const py::object& progress, const py::object& log) {
+        begin();
+        std::mutex errorMutex;
+        std::exception_ptr callbackError;
+        auto record = [&](std::exception_ptr error) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!callbackError) {
+                callbackError = error;
+            }
+            attack_.stop();
+        };
+
+        // Always installed so Ctrl+C reaches the search even without a callback
+        attack_.setProgressHandler([&](long long done, long long total) {
+            py::gil_scoped_acquire acquire;
+            try {
+                if (PyErr_CheckSignals() != 0) {
+                    throw py::error_already_set();
+                }
+                if (!progress.is_none()) {
+                    progress(done, total);
+                }
+            } catch (...) {
+                record(std::current_exception());
+            }
+        });
+        std::function<void(const std::string&)> logCallback;
+        if (!log.is_none()) {
+            logCallback = [&](const std::string& message) {
+                py::gil_scoped_acquire acquire;
+                try {
+                    log(message);
+                } catch (...) {
+                    record(std::current_exception());
+                }
+            };
+        }
+
+        try {
+            py::gil_scoped_release release;
+            attack_.attack(cribs_, logCallback);
+        } catch (...) {
+            end();
+            throw;
+        }
+        end();
+        if (callbackError) {
+            std::rethrow_exception(callbackError);
+        }
+        return attack_.getPackedResults().size();
+    }
+
+    void stop() { attack_.stop(); }
+
+    CandidateIterator candidates(size_t limit) {
+        if (running_) {
+            throw std::runtime_error("Candidates are not available while the attack is running");
+        }
+        return CandidateIterator(attack_.getPackedResults(), limit);
+    }
+
+    size_t size() const {
+        return running_ ? 0 : attack_.getPackedResults().size();
+    }
+
+private:
+    friend class CandidateStream;
+
+    std::vector<CribEntry> cribs_;
+    BombeAttack attack_;
+    std::atomic<bool> running_{false};
+    bool started_ = false;
+
+    // Checks the machine components before BombeAttack is constructed; returns the first crib
+    static const std::string& validated(const std::vector<CribEntry>& cribs,
+                                        const std::vector<std::string>& rotors,
+                                        const std::string& reflector) {
+        if (rotors.size() < 3) {
+            throw py::value_error("At least three rotors are required");
+        }
+        checkComponents(rotors, reflector);
+        return cribs.front().text;
+    }
+
+    // A stopped BombeAttack cannot be restarted, so each object runs once
+    void begin() {
+        if (started_) {
+            throw std::runtime_error("This attack has already been run; create a new BombeAttack");
+        }
+        started_ = true;
+        running_ = true;
+    }
+
+    void end() {
+        attack_.setProgressHandler(nullptr);
+        running_ = false;
+    }
+};
+
+CandidateStream::CandidateStream(PyBombeAttack& owner, size_t capacity)
+    : owner_(owner), sink_(std::make_shared<QueueSink>(capacity)) {
+    owner_.begin();
+    owner_.attack_.setResultSink(sink_, true);
+    worker_ = std::thread([this] {
+        try {
+            owner_.attack_.attack(owner_.cribs_);
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        sink_->finish();
+    });
+}
+
+CandidateResult CandidateStream::next() {
+    CandidateResult result;
+    while (true) {
+        QueueSink::Pop state;
+        {
+            py::gil_scoped_release release;
+            state = sink_->pop(result, std::chrono::milliseconds(100));
+        }
+        if (state == QueueSink::Pop::Item) {
+            return result;
+        }
+        if (state == QueueSink::Pop::Finished) {
+            shutdown();
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+            throw py::stop_iteration();
+        }
+        if (PyErr_CheckSignals() != 0) {
+            owner_.attack_.stop();
+            shutdown();
+            throw py::error_already_set();
+        }
+    }
+}
+
+void CandidateStream::shutdown() {
+    if (!worker_.joinable()) {
+        return;
+    }
+    owner_.attack_.stop();  // no-op if the search already returned
+    sink_->close();
+    {
+        py::gil_scoped_release release;
+        worker_.join();
+    }
+    owner_.attack_.setResultSink(nullptr);
+    owner_.end();
+}
+
+} // namespace
+
+PYBIND11_MODULE(enigma_cpp, m) {
+    m.doc() = "C++ Enigma engine: machine simulation and Bombe attack";
+
+    py::class_<CandidateResult>(m, "Candidate")
+        .def_readonly("score", &CandidateResult::score)
+        .def_readonly("positions", &CandidateResult::positions)
+        .def_readonly("rotor_order", &CandidateResult::rotorOrder)
+        .def_readonly("plugboard", &CandidateResult::plugboard)
+        .def_readonly("match_rate", &CandidateResult::matchRate)
+        .def_readonly("plugboard_pairs", &CandidateResult::plugboardPairs)
+        .def_readonly("offset", &CandidateResult::offset)
+        .def_readonly("crib", &CandidateResult::crib)
+        .def_readonly("equivalents", &CandidateResult::equivalentCount)
+        .def_property_readonly("position_string", &CandidateResult::getPositionString)
+        .def_property_readonly("rotor_string", &CandidateResult::getRotorString)
+        .def("__repr__", [](const CandidateResult& c) {
+            std::ostringstream oss;
+            oss << "<Candidate " << c.getRotorString() << " " << c.getPositionString()
+                << " score=" << c.score << " offset=" << c.offset << ">";
+            return oss.str();
+        });
+
+    py::class_<CandidateIterator>(m, "CandidateIterator")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &CandidateIterator::next);
+
+    py::class_<CandidateStream>(m, "CandidateStream")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &CandidateStream::next);
+
+    py::class_<PyEnigmaMachine>(m, "EnigmaMachine")
+        .def(py::init<const std::vector<std::string>&, const std::string&, const std::string&,
+                      const std::string&, py::object>(),
+             py::arg("rotors") = std::vector<std::string>{"I", "II", "III"},
+             py::arg("reflector") = "B",
+             py::arg("positions") = "AAA",
+             py::arg("rings") = "AAA",
+             py::arg("plugboard") = py::none(),
+             "Rotors, positions and rings use the engine order: the first rotor is the fast one.")
+        .def("encrypt", &PyEnigmaMachine::encryptText, py::arg("text"),
+             "Encrypt a str; non-letters are dropped.")
+        .def("encrypt", &PyEnigmaMachine::encryptBuffer, py::arg("data"),
+             "Encrypt a bytes-like object (bytes, bytearray, numpy uint8) and return bytes.")
+        .def("encrypt_into", &PyEnigmaMachine::encryptInto, py::arg("data"), py::arg("out"),
+             "Encrypt into a writable buffer; returns the number of letters written.")
+        .def("seek", &PyEnigmaMachine::seek, py::arg("positions"))
+        .def_property_readonly("positions", &PyEnigmaMachine::positions);
+
+    py::class_<PyBombeAttack>(m, "BombeAttack")
+        .def(py::init<const py::object&, const std::string&, const std::vector<std::string>&,
+                      const std::string&, bool, bool, int, bool, int>(),
+             py::arg("cribs"),
+             py::arg("cipher"),
+             py::arg("rotors") = std::vector<std::string>{"I", "II", "III"},
+             py::arg("reflector") = "B",
+             py::arg("all_orders") = false,
+             py::arg("no_plugboard") = false,
+             py::arg("crib_position") = -1,
+             py::arg("merge_equivalent") = true,
+             py::arg("threads") = 0)
+        .def("run", &PyBombeAttack::run,
+             py::arg("progress") = py::none(), py::arg("log") = py::none(),
+             "Run the search with the GIL released; returns the number of merged candidates.")
+        .def("stream", [](PyBombeAttack& attack, size_t queueSize) {
+                 return std::make_unique<CandidateStream>(attack, queueSize);
+             },
+             py::arg("queue_size") = 4096, py::keep_alive<0, 1>(),
+             "Run the search in the background and yield raw candidates as they are found.")
+        .def("candidates", &PyBombeAttack::candidates, py::arg("limit") = 0, py::keep_alive<0, 1>(),
+             "Iterate the merged candidates of a finished run, best first.")
+        .def("stop", &PyBombeAttack::stop)
+        .def("__len__", &PyBombeAttack::size);
+}
@@ -0,0 +1,71 @@
+#include "TestHarness.h"
+#include "core/PackedCandidate.h"
+#include "gui/BombeResultRows.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Five candidates for the crib WETTER with distinct scores, so the score order is
+// 0: 100 (no plugs), 1: 98, 2: 96, 3: 83.3 (5 of 6 letters), 4: 50 (3 of 6)
+PackedCandidateSet scoredSet() {
+    PackedCandidateSet set;
+    uint16_t first = set.internContext({"II", "I", "III"}, "WETTER", 0);
+    uint16_t second = set.internContext({"I", "II", "III"}, "WETTER", 0);
+    // Appended out of order; sort() puts them in score order
+    set.append({PackedCandidate::make(first, 300, 1, 3, {{'C', 'D'}}),
+                PackedCandidate::make(first, 200, 2, 6, {{'A', 'B'}, {'E', 'F'}}),
+                PackedCandidate::make(first, 100, 3, 6, {}),
+                PackedCandidate::make(second, 10, 0, 5, {}),
+                PackedCandidate::make(second, 50, 1, 6, {{'A', 'B'}})});
+    set.sort();
+    return set;
+}
+
+std::vector<uint32_t> rows(const PackedCandidateSet& set, BombeRowKey key, bool descending,
+                           int minPairs = 0, int maxPairs = 13) {
+    BombeRowQuery query;
+    query.key = key;
+    query.descending = descending;
+    query.minPairs = minPairs;
+    query.maxPairs = maxPairs;
+    return buildBombeResultRows(set, query);
+}
+
+} // namespace
+
+ENIGMA_TEST(BombeResultRows, RankAndScoreFollowTheSetOrder) {
+    PackedCandidateSet set = scoredSet();
+    CHECK_EQ(set.score(set[0]), 100.0);
+    CHECK_EQ(set.score(set[4]), 50.0);
+
+    CHECK(rows(set, BombeRowKey::Rank, false) == std::vector<uint32_t>({0, 1, 2, 3, 4}));
+    CHECK(rows(set, BombeRowKey::Rank, true) == std::vector<uint32_t>({4, 3, 2, 1, 0}));
+    // Ascending score is worst first, the reverse of the rank order
+    CHECK(rows(set, BombeRowKey::Score, false) == std::vector<uint32_t>({4, 3, 2, 1, 0}));
+    CHECK(rows(set, BombeRowKey::Score, true) == std::vector<uint32_t>({0, 1, 2, 3, 4}));
+}
+
+ENIGMA_TEST(BombeResultRows, PairFilterKeepsTheOrder) {
+    PackedCandidateSet set = scoredSet();
+    CHECK(rows(set, BombeRowKey::Rank, false, 1, 1) == std::vector<uint32_t>({1, 4}));
+    CHECK(rows(set, BombeRowKey::Rank, true, 1, 1) == std::vector<uint32_t>({4, 1}));
+    CHECK(rows(set, BombeRowKey::Score, true, 0, 0) == std::vector<uint32_t>({0, 3}));
+    CHECK(rows(set, BombeRowKey::Offset, false, 1, 13) == std::vector<uint32_t>({1, 4, 2}));
+    CHECK(rows(set, BombeRowKey::Rank, false, 3, 13).empty());
+}
+
+ENIGMA_TEST(BombeResultRows, KeyedSortIsStableOnScore) {
+    PackedCandidateSet set = scoredSet();
+    // Pair counts 0, 1, 2, 0, 1: ties stay best-first in both directions
+    CHECK(rows(set, BombeRowKey::Pairs, false) == std::vector<uint32_t>({0, 3, 1, 4, 2}));
+    CHECK(rows(set, BombeRowKey::Pairs, true) == std::vector<uint32_t>({2, 1, 4, 0, 3}));
+    // "I-II-III" sorts before "II-I-III"
+    CHECK(rows(set, BombeRowKey::Rotors, false) == std::vector<uint32_t>({1, 3, 0, 2, 4}));
+    CHECK(rows(set, BombeRowKey::Rotors, true) == std::vector<uint32_t>({0, 2, 4, 1, 3}));
+    // States 100, 50, 200, 10, 300 and offsets 3, 1, 2, 0, 1
+    CHECK(rows(set, BombeRowKey::Position, false) == std::vector<uint32_t>({3, 1, 0, 2, 4}));
+    CHECK(rows(set, BombeRowKey::Offset, false) == std::vector<uint32_t>({3, 1, 4, 2, 0}));
+    CHECK(rows(set, BombeRowKey::Match, true) == std::vector<uint32_t>({0, 1, 2, 3, 4}));
+}
@@ -0,0 +1,85 @@
+#include "TestHarness.h"
+#include "capi/enigma_c.h"
+
+#include <cstring>
+#include <string>
+
+ENIGMA_TEST(CApi, MachineStatusCodes) {
+    enigma_machine* machine = nullptr;
+    CHECK_EQ(enigma_machine_create("I,II,NOPE", "B", nullptr, nullptr, nullptr, &machine), ENIGMA_INVALID_ARGUMENT);
+    CHECK(machine == nullptr);
+    CHECK(std::strlen(enigma_last_error()) > 0);
+    CHECK_EQ(enigma_machine_create("I,II,III", "X", nullptr, nullptr, nullptr, &machine), ENIGMA_INVALID_ARGUMENT);
+    CHECK_EQ(enigma_machine_create("I,II,III", "B", nullptr, nullptr, "AB C1", &machine), ENIGMA_INVALID_ARGUMENT);
+    CHECK_EQ(enigma_machine_create(nullptr, "B", nullptr, nullptr, nullptr, &machine), ENIGMA_INVALID_ARGUMENT);
+
+    CHECK_EQ(enigma_machine_create("I,II,III", "B", "QEV", nullptr, "AQ EM", &machine), ENIGMA_OK);
+    CHECK(machine != nullptr);
+    CHECK_EQ(std::string(enigma_last_error()), "");
+
+    // Too small: nothing happens, the required size is reported
+    const char* message = "Wetter vorhersage";
+    char output[32] = {};
+    size_t written = 0;
+    CHECK_EQ(enigma_machine_encrypt(machine, message, std::strlen(message), output, 4, &written),
+             ENIGMA_BUFFER_TOO_SMALL);
+    CHECK_EQ(written, 16u);
+    char positions[4] = {};
+    CHECK_EQ(enigma_machine_get_positions(machine, positions, sizeof(positions)), ENIGMA_OK);
+    CHECK_EQ(std::string(positions), "QEV");
+    CHECK_EQ(enigma_machine_get_positions(machine, positions, 3), ENIGMA_BUFFER_TOO_SMALL);
+
+    CHECK_EQ(enigma_machine_encrypt(machine, message, std::strlen(message), output, sizeof(output), &written),
+             ENIGMA_OK);
+    CHECK_EQ(written, 16u);
+    std::string cipher(output, written);
+
+    CHECK_EQ(enigma_machine_seek(machine, "QEV"), ENIGMA_OK);
+    char plain[32] = {};
+    CHECK_EQ(enigma_machine_encrypt(machine, cipher.c_str(), cipher.size(), plain, sizeof(plain), &written),
+             ENIGMA_OK);
+    CHECK_EQ(std::string(plain, written), "WETTERVORHERSAGE");
+    CHECK_EQ(enigma_machine_seek(machine, "Q1"), ENIGMA_INVALID_ARGUMENT);
+
+    enigma_machine_destroy(machine);
+}
+
+ENIGMA_TEST(CApi, AttackStatusCodes) {
+    enigma_attack_options options;
+    enigma_attack_options_init(&options);
+    enigma_attack* attack = nullptr;
+    CHECK_EQ(enigma_attack_create(&options, &attack), ENIGMA_INVALID_ARGUMENT);
+
+    enigma_attack_options uninitialised;
+    std::memset(&uninitialised, 0, sizeof(uninitialised));
+    uninitialised.cribs = "WETTER";
+    uninitialised.cipher = "ABCDEF";
+    CHECK_EQ(enigma_attack_create(&uninitialised, &attack), ENIGMA_INVALID_ARGUMENT);
+
+    options.cribs = "WETTERVORHERSAGE";
+    options.cipher = "QLBRJOLTOAPILBKZNDFZJOBHYEMBJSVKVGA";
+    options.rotors = "I,II,NOPE";
+    CHECK_EQ(enigma_attack_create(&options, &attack), ENIGMA_INVALID_ARGUMENT);
+
+    // Key II-I-III at DRI without plugs (same traffic as the README example)
+    options.rotors = "II,I,III";
+    options.crib_position = 0;
+    options.no_plugboard = 1;
+    options.threads = 1;
+    CHECK_EQ(enigma_attack_create(&options, &attack), ENIGMA_OK);
+    CHECK_EQ(enigma_attack_run(attack, nullptr, nullptr, nullptr), ENIGMA_OK);
+
+    size_t count = enigma_attack_result_count(attack);
+    CHECK(count > 0);
+    enigma_result result;
+    CHECK_EQ(enigma_attack_get_result(attack, 0, &result), ENIGMA_OK);
+    CHECK_EQ(result.score, 100.0);
+    CHECK_EQ(std::string(result.rotors), "II-I-III");
+    CHECK_EQ(std::string(result.positions), "DRI");
+    CHECK_EQ(enigma_attack_get_result(attack, count, &result), ENIGMA_OUT_OF_RANGE);
+    CHECK_EQ(enigma_attack_get_result(attack, 0, nullptr), ENIGMA_INVALID_ARGUMENT);
+
+    enigma_attack_cancel(attack);
+    CHECK_EQ(enigma_attack_run(attack, nullptr, nullptr, nullptr), ENIGMA_CANCELLED);
+    enigma_attack_destroy(attack);
+}
@@ -0,0 +1,134 @@
+#include "TestHarness.h"
+#include "core/CribIndex.h"
+#include "core/EnigmaMachine.h"
+#include "core/RotorConfig.h"
+#include "core/ScramblerTable.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string encryptPlain(const std::string& text, const std::vector<std::string>& order,
+                         const std::string& reflector, const std::vector<int>& positions) {
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : order) {
+        const auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+    }
+    EnigmaMachine machine(std::move(rotors),
+                          std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at(reflector).wiring),
+                          std::make_unique<Plugboard>());
+    machine.setRotorPositions(positions);
+    return machine.encrypt(text);
+}
+
+bool containsKey(const std::vector<CribIndexMatch>& matches, const std::string& rotors,
+                 const std::string& reflector, const std::string& position) {
+    for (const auto& match : matches) {
+        if (match.getRotorString() == rotors && match.reflectorType == reflector &&
+            match.getPositionString() == position) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+ENIGMA_TEST(CribIndex, AppendAndQuery) {
+    std::string path = tempPath("cribs.idx");
+    std::remove(path.c_str());
+    {
+        CribIndex index(path);
+        CHECK_EQ(index.getSegments().size(), 0u);
+        CHECK_EQ(index.addCrib("Wetter vorhersage", {"I", "II", "III"}, {"B", "C"}),
+                 6u * 2 * ScramblerTable::NUM_STATES);
+        CHECK_EQ(index.addCrib("ANXKOMMANDO", {"I", "II", "III"}, {"B"}), 6u * ScramblerTable::NUM_STATES);
+    }
+
+    // A fresh instance reads both segments back from the file
+    CribIndex index(path);
+    auto segments = index.getSegments();
+    CHECK_EQ(segments.size(), 2u);
+    CHECK_EQ(segments[0].crib, "WETTERVORHERSAGE");
+    CHECK(segments[0].reflectorTypes == std::vector<std::string>({"B", "C"}));
+    CHECK_EQ(segments[0].orderCount, 6u);
+
+    std::string cipher = encryptPlain("WETTERVORHERSAGEBISKAYA", {"III", "I", "II"}, "C", {4, 11, 19});
+    auto matches = index.query(cipher);
+    CHECK(containsKey(matches, "III-I-II", "C", "ELT"));
+    for (const auto& match : matches) {
+        CHECK_EQ(match.crib, "WETTERVORHERSAGE");
+    }
+
+    std::string command = encryptPlain("ANXKOMMANDOXX", {"II", "III", "I"}, "B", {0, 0, 25});
+    CHECK(containsKey(index.query(command), "II-III-I", "B", "AAZ"));
+    CHECK(index.query("QWE").empty());
+    std::remove(path.c_str());
+}
+
+ENIGMA_TEST(CribIndex, DuplicateCheckComparesRotorOrders) {
+    std::string path = tempPath("duplicates.idx");
+    std::remove(path.c_str());
+    CribIndex index(path);
+    index.addCrib("WETTERBERICHT", {"I", "II", "III"}, {"B"});
+
+    // Same crib, same settings in another order: rejected
+    CHECK_THROWS(index.addCrib("WETTERBERICHT", {"III", "II", "I"}, {"B"}), std::invalid_argument);
+    // Same number of orders but different rotors: a new segment
+    index.addCrib("WETTERBERICHT", {"I", "II", "IV"}, {"B"});
+    CHECK_EQ(index.getSegments().size(), 2u);
+
+    std::string cipher = encryptPlain("WETTERBERICHT", {"IV", "II", "I"}, "B", {7, 7, 7});
+    CHECK(containsKey(index.query(cipher), "IV-II-I", "B", "HHH"));
+    std::remove(path.c_str());
+}
+
+ENIGMA_TEST(CribIndex, InterruptedAppendIsDiscarded) {
+    std::string path = tempPath("interrupted.idx");
+    std::remove(path.c_str());
+    {
+        CribIndex index(path);
+        index.addCrib("WETTERBERICHT", {"I", "II", "III"}, {"B"});
+    }
+    {
+        // Leftovers of an append that never updated the segment count
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << std::string(5000, 'X');
+    }
+
+    CribIndex index(path);
+    CHECK_EQ(index.getSegments().size(), 1u);
+    index.addCrib("ANXKOMMANDO", {"I", "II", "III"}, {"B"});
+
+    CribIndex reopened(path);
+    CHECK_EQ(reopened.getSegments().size(), 2u);
+    std::string cipher = encryptPlain("ANXKOMMANDO", {"I", "III", "II"}, "B", {1, 2, 3});
+    CHECK(containsKey(reopened.query(cipher), "I-III-II", "B", "BCD"));
+    std::remove(path.c_str());
+}
+
+ENIGMA_TEST(CribIndex, OutOfRangeSettingsAreRejected) {
+    std::string path = tempPath("settings.idx");
+    std::remove(path.c_str());
+    {
+        CribIndex index(path);
+        index.addCrib("WETTERBERICHT", {"I", "II", "III"}, {"B"});
+    }
+
+    // File header (16 bytes), segment header (120 bytes) and 6 rotor orders (24 bytes each);
+    // the first entry's setting then names a seventh order that the segment does not have
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(16 + 120 + 6 * 24 + 4);
+        const char badSetting[2] = {6, 0};
+        file.write(badSetting, sizeof(badSetting));
+    }
+    CHECK_THROWS(CribIndex(path).getSegments(), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,109 @@
+#include "TestHarness.h"
+#include "core/Cyclometer.h"
+#include "core/EnigmaMachine.h"
+#include "core/RotorConfig.h"
+#include "core/ScramblerTable.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Message keys sent twice at the ground position, as in the pre-1940 indicator procedure
+std::vector<std::string> doubledIndicators(const std::vector<std::string>& order, int groundState,
+                                           const std::vector<std::pair<char, char>>& plugs, int count) {
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : order) {
+        const auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+    }
+    EnigmaMachine machine(std::move(rotors),
+                          std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at("B").wiring),
+                          std::make_unique<Plugboard>(plugs));
+
+    std::mt19937 random(static_cast<unsigned>(groundState));
+    std::vector<std::string> indicators;
+    for (int i = 0; i < count; i++) {
+        std::string key;
+        for (int j = 0; j < 3; j++) {
+            key += static_cast<char>('A' + random() % 26);
+        }
+        machine.setRotorPositions(ScramblerTable::statePositions(groundState));
+        indicators.push_back(machine.encrypt(key + key));
+    }
+    return indicators;
+}
+
+} // namespace
+
+// The cycle structure of AD/BE/CF read off intercepted indicators must match the
+// product computed from the scrambler table, whatever the plugboard
+ENIGMA_TEST(Cyclometer, IndicatorsMatchTableCharacteristic) {
+    std::vector<std::string> order = {"III", "I", "II"};
+    ScramblerTable table(order, "B");
+    for (int groundState : {0, 4321, 17000}) {
+        Cyclometer::Characteristic expected = Cyclometer::characteristicAt(table, groundState);
+        auto plain = doubledIndicators(order, groundState, {}, 400);
+        auto plugged = doubledIndicators(order, groundState, {{'A', 'J'}, {'K', 'Y'}, {'P', 'D'}, {'S', 'X'}}, 400);
+        CHECK_EQ(Cyclometer::characteristicFromIndicators(plain), expected);
+        CHECK_EQ(Cyclometer::characteristicFromIndicators(plugged), expected);
+    }
+}
+
+ENIGMA_TEST(Cyclometer, CycleLengthsComeInPairs) {
+    ScramblerTable table({"I", "II", "III"}, "B");
+    std::string description = Cyclometer::describe(Cyclometer::characteristicAt(table, 1234));
+    CHECK(description.find("AD:") != std::string::npos);
+
+    // Each product permutes all 26 letters, and its cycles of each length come in pairs
+    for (const char* product : {"AD:", "BE:", "CF:"}) {
+        size_t begin = description.find(product) + 3;
+        size_t end = description.find('|', begin);
+        std::istringstream lengths(description.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+        int countOfLength[27] = {};
+        int total = 0;
+        int length = 0;
+        while (lengths >> length) {
+            CHECK(length >= 1 && length <= 13);
+            countOfLength[length]++;
+            total += length;
+        }
+        CHECK_EQ(total, 26);
+        for (int count : countOfLength) {
+            CHECK_EQ(count % 2, 0);
+        }
+    }
+}
+
+ENIGMA_TEST(Cyclometer, TooFewIndicatorsAreRejected) {
+    auto indicators = doubledIndicators({"I", "II", "III"}, 77, {}, 3);
+    CHECK_THROWS(Cyclometer::characteristicFromIndicators(indicators), std::invalid_argument);
+}
+
+ENIGMA_TEST(Cyclometer, OutOfRangeCatalogEntriesAreRejected) {
+    std::string path = tempPath("catalog.cyc");
+    std::remove(path.c_str());
+    CHECK_EQ(Cyclometer::buildCatalog(path, {"I", "II", "III"}, "B"), 6u * ScramblerTable::NUM_STATES);
+    {
+        Cyclometer catalog(path);
+        CHECK_EQ(catalog.getOrderCount(), 6u);
+    }
+
+    // Header (32 bytes) and 6 rotor-order records (24 bytes each), then 8-byte entries;
+    // point the first entry's rotor order past the table
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(32 + 6 * 24 + 4);
+        const char badOrder[2] = {6, 0};
+        file.write(badOrder, sizeof(badOrder));
+    }
+    CHECK_THROWS(Cyclometer(path).getEntryCount(), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,99 @@
+#include "TestHarness.h"
+#include "core/EnigmaMachine.h"
+#include "core/NgramScorer.h"
+#include "core/PlugboardHillClimber.h"
+#include "core/RotorConfig.h"
+#include "core/ScramblerTable.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char* CORPUS =
+    "WETTERVORHERSAGEFUERDIENORDSEEHEUTEMORGENBEWOELKTSPAETERREGENWINDAUSWESTSTAERKEFUENF"
+    "ANDASOBERKOMMANDODERWEHRMACHTDIEEINHEITENSTEHENBEREITZUMANGRIFFBEIDERDAEMMERUNG"
+    "KEINEBESONDERENVORKOMMNISSEDIEVERSORGUNGISTGESICHERTNAECHSTERBERICHTUMZWOELFUHR";
+
+std::string encryptWithKey(const std::string& plain, const std::vector<std::string>& order,
+                           const std::vector<int>& positions,
+                           const std::vector<std::pair<char, char>>& plugs) {
+    std::vector<std::unique_ptr<Rotor>> rotors;
+    for (const auto& type : order) {
+        const auto& def = enigma::ROTOR_DEFINITIONS.at(type);
+        rotors.push_back(std::make_unique<Rotor>(def.wiring, def.getFirstNotch()));
+    }
+    EnigmaMachine machine(std::move(rotors),
+                          std::make_unique<Reflector>(enigma::REFLECTOR_DEFINITIONS.at("B").wiring),
+                          std::make_unique<Plugboard>(plugs));
+    machine.setRotorPositions(positions);
+    return machine.encrypt(plain);
+}
+
+} // namespace
+
+// The incremental delta of every move must equal rescoring the whole plaintext
+ENIGMA_TEST(HillClimber, DeltaMatchesFullRescore) {
+    std::vector<std::string> order = {"II", "I", "III"};
+    std::vector<int> positions = {3, 17, 8};
+    std::string cipher = encryptWithKey(CORPUS, order, positions, {{'A', 'Q'}, {'E', 'M'}, {'N', 'Z'}});
+
+    NgramScorer scorer = NgramScorer::fromCorpus(CORPUS, 3);
+    ScramblerTable table(order, "B");
+    PlugboardHillClimber climber(cipher, table, ScramblerTable::stateIndex(positions), scorer);
+    climber.setPlugboard(std::vector<std::pair<char, char>>{{'A', 'Q'}});
+    CHECK_NEAR(climber.getScore(), scorer.scoreText(climber.getPlaintext()), 1e-6);
+
+    std::mt19937 random(7);
+    int applied = 0;
+    for (int step = 0; step < 300; step++) {
+        std::vector<std::pair<char, char>> pairs = climber.getPlugboardPairs();
+        char partner[26];
+        for (int i = 0; i < 26; i++) partner[i] = static_cast<char>('A' + i);
+        for (const auto& [a, b] : pairs) {
+            partner[a - 'A'] = b;
+            partner[b - 'A'] = a;
+        }
+
+        char a = static_cast<char>('A' + random() % 26);
+        char b = static_cast<char>('A' + random() % 26);
+        PlugboardHillClimber::Move move{PlugboardHillClimber::Move::Add, a, b, 0.0};
+        if (partner[a - 'A'] == a && partner[b - 'A'] == b && a != b) {
+            move.delta = climber.evaluateAdd(a, b);
+        } else if (partner[a - 'A'] != a && random() % 2 == 0) {
+            move = {PlugboardHillClimber::Move::Remove, a, a, climber.evaluateRemove(a)};
+        } else if (partner[a - 'A'] != a && b != a && b != partner[a - 'A']) {
+            move = {PlugboardHillClimber::Move::Swap, a, b, climber.evaluateSwap(a, b)};
+        } else {
+            continue;
+        }
+
+        double before = climber.getScore();
+        climber.apply(move);
+        applied++;
+        double rescored = scorer.scoreText(climber.getPlaintext());
+        CHECK_NEAR(climber.getScore(), rescored, 1e-6);
+        CHECK_NEAR(move.delta, rescored - before, 1e-6);
+        CHECK_EQ(climber.getPairCount(), static_cast<int>(climber.getPlugboardPairs().size()));
+    }
+    CHECK(applied > 100);
+}
+
+// With the right rotors and start, climbing from an empty plugboard improves the score
+ENIGMA_TEST(HillClimber, ClimbNeverLowersTheScore) {
+    std::vector<std::string> order = {"I", "II", "III"};
+    std::vector<int> positions = {0, 5, 20};
+    std::string cipher = encryptWithKey(CORPUS, order, positions, {{'B', 'R'}, {'C', 'X'}});
+
+    NgramScorer scorer = NgramScorer::fromCorpus(CORPUS, 3);
+    ScramblerTable table(order, "B");
+    PlugboardHillClimber climber(cipher, table, ScramblerTable::stateIndex(positions), scorer);
+    climber.setPlugboard(std::vector<std::pair<char, char>>{});
+    double start = climber.getScore();
+    double end = climber.climb();
+    CHECK(end >= start);
+    CHECK_NEAR(end, scorer.scoreText(climber.getPlaintext()), 1e-6);
+}
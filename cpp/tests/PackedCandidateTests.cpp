@@ -0,0 +1,147 @@
+#include "TestHarness.h"
+#include "core/BombeAttack.h"
+#include "core/PackedCandidate.h"
+#include "core/ScramblerTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Two start states that step onto the same state (the middle rotor's double step),
+// so every window they produce is identical
+std::pair<int, int> convergingStates(const ScramblerTable& table) {
+    std::vector<int> firstFrom(ScramblerTable::NUM_STATES, -1);
+    for (int state = 0; state < ScramblerTable::NUM_STATES; state++) {
+        int next = table.next(state);
+        if (firstFrom[next] >= 0) {
+            return {firstFrom[next], state};
+        }
+        firstFrom[next] = state;
+    }
+    return {-1, -1};
+}
+
+} // namespace
+
+ENIGMA_TEST(PackedCandidate, PacksFieldsAtTheirLimits) {
+    const int lastState = ScramblerTable::NUM_STATES - 1;
+    PackedCandidate candidate = PackedCandidate::make(513, lastState, PackedCandidate::OFFSET_BLOCK - 1,
+                                                      PackedCandidate::MAX_CRIB_LENGTH, {{'A', 'Z'}, {'Q', 'E'}});
+    CHECK_EQ(candidate.contextId, 513);
+    CHECK_EQ(candidate.state(), lastState);
+    CHECK_EQ(candidate.offsetLow(), PackedCandidate::OFFSET_BLOCK - 1);
+    CHECK_EQ(candidate.matches(), PackedCandidate::MAX_CRIB_LENGTH);
+    CHECK_EQ(candidate.pairCount(), 2);
+    CHECK_EQ(static_cast<int>(candidate.stecker['A' - 'A']), 'Z' - 'A');
+    CHECK_EQ(static_cast<int>(candidate.stecker['Z' - 'A']), 'A' - 'A');
+    CHECK_EQ(static_cast<int>(candidate.stecker['B' - 'A']), 'B' - 'A');
+
+    CHECK_THROWS(PackedCandidate::make(0, ScramblerTable::NUM_STATES, 0, 0, {}), std::invalid_argument);
+    CHECK_THROWS(PackedCandidate::make(0, 0, PackedCandidate::OFFSET_BLOCK, 0, {}), std::invalid_argument);
+    CHECK_THROWS(PackedCandidate::make(0, 0, 0, PackedCandidate::MAX_CRIB_LENGTH + 1, {}), std::invalid_argument);
+}
+
+ENIGMA_TEST(PackedCandidate, UnpacksThroughItsContext) {
+    PackedCandidateSet set;
+    uint16_t context = set.internContext({"II", "I", "III"}, "WETTERBERICHT", 2);
+    CHECK_EQ(set.internContext({"II", "I", "III"}, "WETTERBERICHT", 2), context);
+    CHECK(set.internContext({"II", "I", "III"}, "WETTERBERICHT", 3) != context);
+
+    int state = ScramblerTable::stateIndex({3, 17, 8});
+    set.append({PackedCandidate::make(context, state, 5, 13, {{'C', 'A'}, {'X', 'Y'}}),
+                PackedCandidate::make(context, state, 6, 10, {})});
+
+    CandidateResult full = set.unpack(0);
+    CHECK(full.rotorOrder == std::vector<std::string>({"II", "I", "III"}));
+    CHECK(full.positions == std::vector<int>({3, 17, 8}));
+    CHECK_EQ(full.crib, "WETTERBERICHT");
+    CHECK_EQ(full.offset, 2 * PackedCandidate::OFFSET_BLOCK + 5);
+    std::vector<std::pair<char, char>> expectedPlugs = {{'A', 'C'}, {'X', 'Y'}};
+    CHECK(full.plugboard == expectedPlugs);
+    CHECK_EQ(full.plugboardPairs, 2);
+    CHECK_EQ(full.score, 96.0);
+    CHECK_EQ(full.matchRate, 1.0);
+    CHECK_EQ(full.equivalentCount, 1);
+
+    CandidateResult partial = set.unpack(1);
+    CHECK_NEAR(partial.matchRate, 10.0 / 13, 1e-12);
+    CHECK_NEAR(partial.score, 1000.0 / 13, 1e-9);
+}
+
+ENIGMA_TEST(PackedCandidate, SortMatchesComparisonSort) {
+    PackedCandidateSet set;
+    // Context and crib length
+    std::vector<std::pair<uint16_t, int>> contexts = {
+        {set.internContext({"I", "II", "III"}, "WETTERVORHERSAGE", 0), 16},
+        {set.internContext({"III", "II", "I"}, "WETTERVORHERSAGE", 1), 16},
+        {set.internContext({"I", "II", "III"}, "ANXKOMMANDO", 0), 11},
+    };
+
+    std::mt19937 random(12345);
+    std::vector<PackedCandidate> records;
+    for (int i = 0; i < 20000; i++) {
+        auto [context, cribLength] = contexts[random() % contexts.size()];
+        int matches = random() % 4 == 0 ? cribLength : static_cast<int>(random() % (cribLength + 1));
+        std::vector<std::pair<char, char>> plugs;
+        for (int p = 0, count = static_cast<int>(random() % 6); p < count; p++) {
+            plugs.emplace_back(static_cast<char>('A' + 2 * p), static_cast<char>('B' + 2 * p));
+        }
+        records.push_back(PackedCandidate::make(context, static_cast<int>(random() % ScramblerTable::NUM_STATES),
+                                                static_cast<int>(random() % PackedCandidate::OFFSET_BLOCK),
+                                                matches, plugs));
+    }
+    set.append(records);
+    set.sort();
+
+    // Score descending, then context, start state and offset; stable for equal keys
+    std::stable_sort(records.begin(), records.end(), [&set](const PackedCandidate& a, const PackedCandidate& b) {
+        double scoreA = set.score(a);
+        double scoreB = set.score(b);
+        if (scoreA != scoreB) return scoreA > scoreB;
+        if (a.contextId != b.contextId) return a.contextId < b.contextId;
+        if (a.state() != b.state()) return a.state() < b.state();
+        return a.offsetLow() < b.offsetLow();
+    });
+    CHECK_EQ(set.size(), records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        CHECK(std::memcmp(&set[i], &records[i], sizeof(PackedCandidate)) == 0);
+    }
+}
+
+ENIGMA_TEST(PackedCandidate, MergesCandidatesWithTheSameWindow) {
+    auto table = ScramblerTable::get({"I", "II", "III"}, "B");
+    auto [first, second] = convergingStates(*table);
+    CHECK(first >= 0);
+    int other = (second + 1000) % ScramblerTable::NUM_STATES;
+
+    PackedCandidateSet set;
+    uint16_t context = set.internContext({"I", "II", "III"}, "WETTERVORHERSAGE", 0);
+    std::vector<std::pair<char, char>> plugs = {{'A', 'B'}};
+    set.append({PackedCandidate::make(context, first, 0, 16, plugs),
+                PackedCandidate::make(context, other, 0, 16, plugs),
+                PackedCandidate::make(context, second, 0, 16, plugs),
+                PackedCandidate::make(context, second, 0, 16, {{'A', 'C'}})});
+
+    CHECK_EQ(set.mergeEquivalent("B"), 1u);
+    CHECK_EQ(set.size(), 3u);
+    // The first of each class is kept, in its original place
+    CHECK_EQ(set[0].state(), first);
+    CHECK_EQ(set.equivalentCount(0), 2u);
+    CHECK_EQ(set[1].state(), other);
+    CHECK_EQ(set.equivalentCount(1), 1u);
+    CHECK_EQ(set[2].pairCount(), 1);
+    CHECK_EQ(set.unpack(0).equivalentCount, 2);
+
+    // Sorting after a merge carries the counts along
+    set.sort();
+    size_t merged = 0;
+    for (size_t i = 0; i < set.size(); i++) {
+        if (set[i].state() == first) merged = i;
+    }
+    CHECK_EQ(set.equivalentCount(merged), 2u);
+}
@@ -0,0 +1,117 @@
+#include "TestHarness.h"
+#include "core/BombeAttack.h"
+#include "core/ResultReader.h"
+#include "core/ResultSink.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<CandidateResult> sampleResults() {
+    CandidateResult full;
+    full.score = 96.0;
+    full.positions = {3, 17, 8};
+    full.rotorOrder = {"II", "I", "III"};
+    full.plugboard = {{'A', 'Q'}, {'E', 'M'}};
+    full.matchRate = 1.0;
+    full.plugboardPairs = 2;
+    full.offset = 1030;
+    full.crib = "WETTERVORHERSAGE";
+    full.equivalentCount = 3;
+
+    CandidateResult partial;
+    partial.score = 56.25;
+    partial.positions = {0, 25, 12};
+    partial.rotorOrder = {"V", "IV", "I"};
+    partial.matchRate = 0.5625;
+    partial.plugboardPairs = 0;
+    partial.offset = 0;
+    partial.crib = "ANXKOMMANDO";
+    return {full, partial};
+}
+
+void writeResults(const std::string& path, const std::vector<CandidateResult>& results) {
+    auto sink = ResultSink::open(path);
+    for (const auto& result : results) {
+        sink->write(result);
+    }
+    sink->flush();
+    CHECK_EQ(sink->count(), results.size());
+}
+
+std::vector<CandidateResult> readResults(const std::string& path) {
+    ResultReader reader(path);
+    std::vector<CandidateResult> results;
+    CandidateResult result;
+    while (reader.next(result)) {
+        results.push_back(result);
+    }
+    return results;
+}
+
+void checkSame(const CandidateResult& actual, const CandidateResult& expected) {
+    CHECK_EQ(actual.score, expected.score);
+    CHECK(actual.positions == expected.positions);
+    CHECK(actual.rotorOrder == expected.rotorOrder);
+    CHECK(actual.plugboard == expected.plugboard);
+    CHECK_EQ(actual.matchRate, expected.matchRate);
+    CHECK_EQ(actual.plugboardPairs, expected.plugboardPairs);
+    CHECK_EQ(actual.offset, expected.offset);
+    CHECK_EQ(actual.crib, expected.crib);
+    CHECK_EQ(actual.equivalentCount, expected.equivalentCount);
+}
+
+void roundTrip(const std::string& path, bool binary) {
+    auto expected = sampleResults();
+    writeResults(path, expected);
+
+    CHECK_EQ(ResultReader(path).isBinary(), binary);
+    auto actual = readResults(path);
+    std::remove(path.c_str());
+
+    CHECK_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        checkSame(actual[i], expected[i]);
+    }
+}
+
+} // namespace
+
+ENIGMA_TEST(ResultFile, BinaryRoundTrip) {
+    roundTrip(tempPath("results.bin"), true);
+}
+
+ENIGMA_TEST(ResultFile, NdjsonRoundTrip) {
+    roundTrip(tempPath("results.ndjson"), false);
+}
+
+ENIGMA_TEST(ResultFile, TruncatedBinaryRecordThrows) {
+    std::string path = tempPath("truncated.bin");
+    writeResults(path, sampleResults());
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+    ResultReader reader(path);
+    CandidateResult result;
+    CHECK(reader.next(result));
+    CHECK_THROWS(reader.next(result), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+ENIGMA_TEST(ResultFile, TopKAcrossFiles) {
+    std::string first = tempPath("top1.bin");
+    std::string second = tempPath("top2.ndjson");
+    auto results = sampleResults();
+    writeResults(first, {results[1]});
+    writeResults(second, {results[0]});
+
+    auto top = ResultMerger::topK({first, second}, 1);
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+    CHECK_EQ(top.size(), 1u);
+    checkSame(top[0], results[0]);
+}
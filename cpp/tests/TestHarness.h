@@ -0,0 +1,77 @@
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Minimal self-registering test cases for the enigma_tests executable.
+// ctest runs one suite per invocation ("enigma_tests PackedCandidate"), see CMakeLists.txt.
+struct TestFailure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+void registerTest(const char* name, void (*body)());
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*body)()) { registerTest(name, body); }
+};
+
+// "file:line: " prefix for failure messages
+std::string testLocation(const char* file, int line);
+
+// Path in the system temp directory, unique to this process; removed by the caller
+std::string tempPath(const std::string& name);
+
+#define ENIGMA_TEST(suite, name)                                                         \
+    static void suite##_##name();                                                        \
+    static TestRegistrar suite##_##name##_registrar(#suite "." #name, suite##_##name);   \
+    static void suite##_##name()
+
+#define CHECK(condition)                                                                 \
+    do {                                                                                 \
+        if (!(condition)) {                                                              \
+            throw TestFailure(testLocation(__FILE__, __LINE__) + "CHECK(" #condition ")"); \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                       \
+    do {                                                                                 \
+        const auto& actualValue = (actual);                                              \
+        const auto& expectedValue = (expected);                                          \
+        if (!(actualValue == expectedValue)) {                                           \
+            std::ostringstream message;                                                  \
+            message << testLocation(__FILE__, __LINE__) << #actual << " == " #expected   \
+                    << " (got " << actualValue << ", expected " << expectedValue << ")"; \
+            throw TestFailure(message.str());                                            \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                          \
+    do {                                                                                 \
+        double actualValue = (actual);                                                   \
+        double expectedValue = (expected);                                               \
+        if (!(actualValue - expectedValue <= (tolerance) &&                              \
+              expectedValue - actualValue <= (tolerance))) {                             \
+            std::ostringstream message;                                                  \
+            message << testLocation(__FILE__, __LINE__) << #actual << " ~ " #expected    \
+                    << " (got " << actualValue << ", expected " << expectedValue << ")"; \
+            throw TestFailure(message.str());                                            \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_THROWS(expression, exceptionType)                                          \
+    do {                                                                                 \
+        bool thrown = false;                                                             \
+        try {                                                                            \
+            (void)(expression);                                                          \
+        } catch (const exceptionType&) {                                                 \
+            thrown = true;                                                               \
+        }                                                                                \
+        if (!thrown) {                                                                   \
+            throw TestFailure(testLocation(__FILE__, __LINE__) + #expression             \
+                              " did not throw " #exceptionType);                         \
+        }                                                                                \
+    } while (0)
+
+#endif // TEST_HARNESS_H
@@ -0,0 +1,67 @@
+#include "TestHarness.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TestCase {
+    std::string name;
+    void (*body)();
+};
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+} // namespace
+
+void registerTest(const char* name, void (*body)()) {
+    registry().push_back({name, body});
+}
+
+std::string testLocation(const char* file, int line) {
+    return std::filesystem::path(file).filename().string() + ":" + std::to_string(line) + ": ";
+}
+
+std::string tempPath(const std::string& name) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("enigma_tests_" + std::to_string(getpid()) + "_" + name);
+    return path.string();
+}
+
+// Usage: enigma_tests [SUITE]   (runs every test whose name starts with "SUITE.")
+int main(int argc, char** argv) {
+    std::string prefix = argc > 1 ? std::string(argv[1]) + "." : "";
+
+    int run = 0;
+    int failed = 0;
+    for (const auto& test : registry()) {
+        if (test.name.compare(0, prefix.size(), prefix) != 0) continue;
+        run++;
+        try {
+            test.body();
+            std::cout << "[  OK  ] " << test.name << "\n";
+        } catch (const std::exception& e) {
+            failed++;
+            std::cout << "[ FAIL ] " << test.name << ": " << e.what() << "\n";
+        }
+    }
+
+    if (run == 0) {
+        std::cout << "No tests match " << (argc > 1 ? argv[1] : "") << "\n";
+        return 1;
+    }
+    std::cout << run - failed << "/" << run << " passed\n";
+    return failed == 0 ? 0 : 1;
+}